@@ -14,6 +14,9 @@
  * It could make for a simpiler implementation, so much of the attempt is still
  * here and commeneted out.
  */
+#ifndef INT128_HPP
+#define INT128_HPP
+
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
@@ -205,3 +208,5 @@ private:
 typedef LargeIntWrapper<int128_t, boost::multiprecision::int128_t>  int128_w;
 
 } }
+
+#endif        //  #ifndef INT128_HPP
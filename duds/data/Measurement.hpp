@@ -7,6 +7,9 @@
  *
  * Copyright (C) 2017  Jeff Jackowski
  */
+#ifndef MEASUREMENT_HPP
+#define MEASUREMENT_HPP
+
 #include <duds/data/Sample.hpp>
 
 namespace duds { namespace data {
@@ -80,3 +83,5 @@ struct CompactMeasurement {
 };
 
 } }
+
+#endif        //  #ifndef MEASUREMENT_HPP
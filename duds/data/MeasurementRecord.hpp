@@ -0,0 +1,340 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef MEASUREMENTRECORD_HPP
+#define MEASUREMENTRECORD_HPP
+
+#include <duds/data/Measurement.hpp>
+#include <duds/general/Spinlock.hpp>
+#include <boost/uuid/uuid_hash.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace duds { namespace data {
+
+/**
+ * The base for errors about measurement records.
+ */
+struct MeasurementRecordError : virtual std::exception, virtual boost::exception { };
+
+/**
+ * A GenericMeasurement holds a value that cannot be represented by a
+ * GenericMeasurementRecord.
+ */
+struct MeasurementRecordBadType : MeasurementRecordError { };
+
+/**
+ * A GenericMeasurement holds more values than a GenericMeasurementRecord
+ * can hold.
+ */
+struct MeasurementRecordTooLong : MeasurementRecordError { };
+
+/**
+ * An instrument index was not found in an InstrumentIndexTable.
+ */
+struct MeasurementRecordBadIndex : MeasurementRecordError { };
+
+/**
+ * The number of values that were in the measurement.
+ */
+typedef boost::error_info<struct Info_RecordLength, std::size_t>
+	MeasurementRecordLength;
+
+/**
+ * The instrument index that was not found.
+ */
+typedef boost::error_info<struct Info_RecordInstrument, std::uint32_t>
+	MeasurementRecordInstrument;
+
+/**
+ * The quality information of a GenericMeasurementRecord. Single precision is
+ * plenty for describing the quality of a sample, and keeps the record small.
+ * Unknown values are held as infinity, the same as with GenericSample.
+ */
+struct PackedQuality {
+	/**
+	 * How far from correct the values could be.
+	 */
+	float accuracy;
+	/**
+	 * How much the values may vary when the measured property is the same.
+	 */
+	float precision;
+	/**
+	 * The smallest increment the instrument can represent.
+	 */
+	float resolution;
+	/**
+	 * How far from correct the timestamp could be in seconds.
+	 */
+	float timeAccuracy;
+	/**
+	 * Sets all fields to the unspecified value.
+	 */
+	void clear() {
+		accuracy = precision = resolution = timeAccuracy =
+			unspecified<float>();
+	}
+};
+
+/**
+ * A measurement from an instrument held in a fixed size record that can be
+ * copied like a plain struct. It is intended for instruments that produce
+ * samples at high rates, such as inertial measurement units and power
+ * monitors, where GenericMeasurement costs too much: its value is a
+ * GenericValue variant that may allocate, it carries a UUID and four double
+ * quality fields for both the value and the timestamp, and it is passed
+ * around in a std::shared_ptr. This record instead holds a small index to
+ * identify the instrument, a NanoTime, a fixed size array of numbers that all
+ * share one Unit, and PackedQuality. It may be passed by value, queued in
+ * duds::general::MpscRing, and written to storage without conversion.
+ *
+ * An InstrumentIndexTable can assign the indices and map them back to the
+ * instrument's UUID. toMeasurement() and fromMeasurement() convert between
+ * this record and the generic form. A record with one value converts to a
+ * Quantity, and a record with more values converts to a one dimensional
+ * QuantityNddArray.
+ *
+ * @tparam VT  The type of the values. It must be an arithmetic type.
+ * @tparam N   The maximum number of values.
+ *
+ * @author  Jeff Jackowski
+ */
+template <class VT = double, std::size_t N = 1>
+struct GenericMeasurementRecord {
+	static_assert(
+		std::is_arithmetic<VT>::value,
+		"GenericMeasurementRecord values must be numbers"
+	);
+	static_assert(
+		(N > 0) && (N <= 0xFFFF),
+		"GenericMeasurementRecord must hold 1 to 65535 values"
+	);
+	/**
+	 * The type of the values.
+	 */
+	typedef VT Value;
+	/**
+	 * The maximum number of values.
+	 */
+	static constexpr std::size_t Capacity = N;
+	/**
+	 * When the values were sampled.
+	 */
+	duds::time::interstellar::NanoTime time;
+	/**
+	 * Identifies the instrument that produced the values.
+	 */
+	std::uint32_t instrument;
+	/**
+	 * The units of all the values.
+	 */
+	Unit unit;
+	/**
+	 * The quality of the values and the timestamp.
+	 */
+	PackedQuality quality;
+	/**
+	 * The number of values in use, starting from the first.
+	 */
+	std::uint16_t length;
+	/**
+	 * The sampled values.
+	 */
+	VT values[N];
+	/**
+	 * Sets the record to hold no values and unspecified quality. The time,
+	 * instrument, and unit are not changed.
+	 */
+	void clear() {
+		length = 0;
+		quality.clear();
+	}
+};
+
+/**
+ * A record for a single value, like a voltage or a temperature.
+ */
+typedef GenericMeasurementRecord<double, 1>  MeasurementRecord;
+
+/**
+ * A record for three values, like a sample from one part of an inertial
+ * measurement unit.
+ */
+typedef GenericMeasurementRecord<float, 3>  TriaxialMeasurementRecord;
+
+/**
+ * Assigns small integers to identify instruments in a
+ * GenericMeasurementRecord, and finds the UUID for an assigned integer.
+ * Indices start at zero and increase by one for each new UUID. The object is
+ * thread-safe.
+ *
+ * @author  Jeff Jackowski
+ */
+class InstrumentIndexTable : boost::noncopyable {
+	/**
+	 * Maps UUIDs to indices.
+	 */
+	std::unordered_map<
+		boost::uuids::uuid,
+		std::uint32_t,
+		boost::hash<boost::uuids::uuid>
+	>  indices;
+	/**
+	 * Maps indices to UUIDs.
+	 */
+	std::vector<boost::uuids::uuid> origins;
+	/**
+	 * Protects the containers.
+	 */
+	mutable duds::general::Spinlock block;
+public:
+	/**
+	 * Returns the index for the given UUID, assigning one if needed.
+	 */
+	std::uint32_t index(const boost::uuids::uuid &origin) {
+		duds::general::SpinLockGuard lock(block);
+		auto res = indices.emplace(origin, (std::uint32_t)origins.size());
+		if (res.second) {
+			origins.push_back(origin);
+		}
+		return res.first->second;
+	}
+	/**
+	 * Returns the UUID assigned the given index.
+	 * @throw MeasurementRecordBadIndex  The index has not been assigned.
+	 */
+	boost::uuids::uuid origin(std::uint32_t index) const {
+		duds::general::SpinLockGuard lock(block);
+		if (index >= origins.size()) {
+			DUDS_THROW_EXCEPTION(MeasurementRecordBadIndex() <<
+				MeasurementRecordInstrument(index)
+			);
+		}
+		return origins[index];
+	}
+	/**
+	 * Returns the number of assigned indices.
+	 */
+	std::size_t size() const {
+		duds::general::SpinLockGuard lock(block);
+		return origins.size();
+	}
+};
+
+/**
+ * Makes a Measurement from a GenericMeasurementRecord.
+ * @param rec     The record.
+ * @param origin  The UUID of the instrument that made the record.
+ * @return        A measurement with a Quantity if the record has one value,
+ *                or a one dimensional QuantityNddArray otherwise.
+ */
+template <class VT, std::size_t N>
+Measurement toMeasurement(
+	const GenericMeasurementRecord<VT, N> &rec,
+	const boost::uuids::uuid &origin
+) {
+	Measurement m;
+	m.timestamp.clear();
+	m.timestamp.value = rec.time;
+	m.timestamp.accuracy = rec.quality.timeAccuracy;
+	m.measured.origin = origin;
+	m.measured.accuracy = rec.quality.accuracy;
+	m.measured.precision = rec.quality.precision;
+	m.measured.resolution = rec.quality.resolution;
+	m.measured.estError = Measurement::Sample::unspecified();
+	if (rec.length == 1) {
+		m.measured.value = Quantity((double)rec.values[0], rec.unit);
+	} else {
+		QuantityNddArray qa;
+		qa.unit = rec.unit;
+		qa.array.remake({ (std::size_t)rec.length });
+		std::copy(rec.values, rec.values + rec.length, qa.array.begin());
+		m.measured.value = std::move(qa);
+	}
+	return m;
+}
+
+// declared in Sample.hpp to hold internal data structures
+namespace _it_needs_to_go_somewhere_ {
+	/**
+	 * Copies numbers out of a GenericValue and into a
+	 * GenericMeasurementRecord.
+	 */
+	template <class VT, std::size_t N>
+	class RecordFiller : public boost::static_visitor<> {
+		GenericMeasurementRecord<VT, N> &rec;
+		template <class Iter>
+		void fill(Iter begin, std::size_t len) {
+			if (len > N) {
+				DUDS_THROW_EXCEPTION(MeasurementRecordTooLong() <<
+					MeasurementRecordLength(len)
+				);
+			}
+			rec.length = (std::uint16_t)len;
+			for (std::size_t i = 0; i < len; ++begin, ++i) {
+				rec.values[i] = (VT)*begin;
+			}
+		}
+	public:
+		RecordFiller(GenericMeasurementRecord<VT, N> &r) : rec(r) { }
+		void operator()(double d) {
+			rec.unit = Unit(0);
+			fill(&d, 1);
+		}
+		void operator()(const Quantity &q) {
+			rec.unit = q.unit;
+			fill(&q.value, 1);
+		}
+		void operator()(const QuantityNddArray &qa) {
+			rec.unit = qa.unit;
+			fill(qa.array.begin(), qa.array.size());
+		}
+		template <class T, std::size_t L>
+		void operator()(const std::array<T, L> &a) {
+			rec.unit = Unit(0);
+			fill(a.begin(), L);
+		}
+		template <class T>
+		void operator()(const T &) {
+			DUDS_THROW_EXCEPTION(MeasurementRecordBadType());
+		}
+	};
+}
+
+/**
+ * Fills a GenericMeasurementRecord from a Measurement. Numbers, Quantity
+ * objects, QuantityNddArray objects, and arrays of numbers can be converted.
+ * The record's values are converted to type @a VT with a cast.
+ * @param rec         The record to fill.
+ * @param m           The source measurement.
+ * @param instrument  The index for the originating instrument.
+ * @throw MeasurementRecordBadType  The measurement's value cannot be held in
+ *                                  a record.
+ * @throw MeasurementRecordTooLong  The measurement has more than @a N values.
+ */
+template <class VT, std::size_t N>
+void fromMeasurement(
+	GenericMeasurementRecord<VT, N> &rec,
+	const Measurement &m,
+	std::uint32_t instrument
+) {
+	_it_needs_to_go_somewhere_::RecordFiller<VT, N> filler(rec);
+	boost::apply_visitor(filler, m.measured.value);
+	rec.time = m.timestamp.value;
+	rec.instrument = instrument;
+	rec.quality.accuracy = (float)m.measured.accuracy;
+	rec.quality.precision = (float)m.measured.precision;
+	rec.quality.resolution = (float)m.measured.resolution;
+	rec.quality.timeAccuracy = m.timestamp.accuracy;
+}
+
+} }
+
+#endif        //  #ifndef MEASUREMENTRECORD_HPP
@@ -7,6 +7,9 @@
  *
  * Copyright (C) 2017  Jeff Jackowski
  */
+#ifndef SAMPLE_HPP
+#define SAMPLE_HPP
+
 #include <duds/data/GenericValue.hpp>
 #include <boost/uuid/nil_generator.hpp>
 #include <limits>
@@ -295,3 +298,5 @@ struct ExtraCompactSample {
 };
 
 } }
+
+#endif        //  #ifndef SAMPLE_HPP
@@ -0,0 +1,95 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESERRORS_HPP
+#define TIMESERIESERRORS_HPP
+
+#include <boost/exception/exception.hpp>
+#include <boost/exception/info.hpp>
+#include <exception>
+#include <cstdint>
+#include <string>
+
+namespace duds { namespace data {
+
+/**
+ * The base class for errors related to time series storage.
+ */
+struct TimeSeriesError : virtual std::exception, virtual boost::exception { };
+
+/**
+ * A file operation failed. The error number from the operating system is
+ * attached with boost::errinfo_errno.
+ */
+struct TimeSeriesFileError : TimeSeriesError { };
+
+/**
+ * The file is not a time series file.
+ */
+struct TimeSeriesNotStoreError : TimeSeriesError { };
+
+/**
+ * The file uses a version of the format that is not supported.
+ */
+struct TimeSeriesUnsupportedVersionError : TimeSeriesError { };
+
+/**
+ * The file cannot be used on this system because it is big endian, or because
+ * the file's segments are not aligned to this system's page size.
+ */
+struct TimeSeriesIncompatibleError : TimeSeriesError { };
+
+/**
+ * The file is shorter than its header requires, or ends in a partial
+ * segment.
+ */
+struct TimeSeriesTruncatedError : TimeSeriesError { };
+
+/**
+ * A value, or its units, do not match the type stored in the time series.
+ */
+struct TimeSeriesTypeMismatch : TimeSeriesError { };
+
+/**
+ * A value has a type that cannot be stored in a time series.
+ */
+struct TimeSeriesUnsupportedValue : TimeSeriesError { };
+
+/**
+ * The segment size requested for a new file is not usable.
+ */
+struct TimeSeriesBadSegmentSize : TimeSeriesError { };
+
+/**
+ * The name of the file involved in the error.
+ */
+typedef boost::error_info<struct Info_TimeSeriesFileName, std::string>
+	TimeSeriesFileName;
+
+/**
+ * The version of the file format.
+ */
+typedef boost::error_info<struct Info_TimeSeriesVersion, std::uint32_t>
+	TimeSeriesVersion;
+
+/**
+ * The segment size in bytes.
+ */
+typedef boost::error_info<struct Info_TimeSeriesSegmentSize, std::uint32_t>
+	TimeSeriesSegmentSize;
+
+/**
+ * The value type stored in the file, from TimeSeriesValueType.
+ */
+typedef boost::error_info<struct Info_TimeSeriesValueType, std::uint32_t>
+	TimeSeriesStoredType;
+
+} }
+
+#endif        //  #ifndef TIMESERIESERRORS_HPP
@@ -0,0 +1,93 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/data/TimeSeriesFormat.hpp>
+#include <duds/data/TimeSeriesErrors.hpp>
+#include <duds/general/Errors.hpp>
+#include <unistd.h>
+
+namespace duds { namespace data {
+
+void TimeSeriesValueTraits<int128_w>::encode(void *dest, const int128_w &v) {
+	std::uint64_t half[2];
+	#ifdef HAVE_INT128
+	half[0] = (std::uint64_t)v.value;
+	half[1] = (std::uint64_t)(v.value >> 64);
+	#else
+	// Boost's integer is stored as sign and magnitude; make two's complement
+	boost::multiprecision::uint128_t mag(abs(v.value));
+	half[0] = static_cast<std::uint64_t>(mag & 0xFFFFFFFFFFFFFFFFull);
+	half[1] = static_cast<std::uint64_t>(mag >> 64);
+	if (v.value < 0) {
+		half[0] = ~half[0] + 1;
+		half[1] = ~half[1] + (half[0] == 0);
+	}
+	#endif
+	std::memcpy(dest, half, Bytes);
+}
+
+int128_w TimeSeriesValueTraits<int128_w>::decode(const void *src) {
+	std::uint64_t half[2];
+	std::memcpy(half, src, Bytes);
+	#ifdef HAVE_INT128
+	return int128_w(((int128_t)(std::int64_t)half[1] << 64) | half[0]);
+	#else
+	bool neg = (half[1] >> 63) != 0;
+	if (neg) {
+		half[0] = ~half[0] + 1;
+		half[1] = ~half[1] + (half[0] == 0);
+	}
+	boost::multiprecision::uint128_t mag(half[1]);
+	mag = (mag << 64) | half[0];
+	int128_t v(mag);
+	return int128_w(neg ? int128_t(-v) : v);
+	#endif
+}
+
+std::size_t timeSeriesPageSize() {
+	static const std::size_t page = sysconf(_SC_PAGESIZE);
+	return page;
+}
+
+void timeSeriesCheckHeader(const TimeSeriesFileHeader &hdr, std::uint64_t length) {
+	static const std::uint16_t one = 1;
+	if (std::memcmp(hdr.magic, "DTSF", 4)) {
+		DUDS_THROW_EXCEPTION(TimeSeriesNotStoreError());
+	}
+	if (*(const char*)&one != 1) {
+		DUDS_THROW_EXCEPTION(TimeSeriesIncompatibleError());
+	}
+	if (hdr.version != 1) {
+		DUDS_THROW_EXCEPTION(TimeSeriesUnsupportedVersionError() <<
+			TimeSeriesVersion(hdr.version)
+		);
+	}
+	if (!timeSeriesValueBytes(hdr.valueType)) {
+		DUDS_THROW_EXCEPTION(TimeSeriesNotStoreError() <<
+			TimeSeriesStoredType(hdr.valueType)
+		);
+	}
+	std::size_t page = timeSeriesPageSize();
+	if (!hdr.segmentBytes ||
+		(hdr.dataOffset < sizeof(TimeSeriesFileHeader)) ||
+		(hdr.dataOffset % page) ||
+		(hdr.segmentBytes % page)
+	) {
+		DUDS_THROW_EXCEPTION(TimeSeriesIncompatibleError() <<
+			TimeSeriesSegmentSize(hdr.segmentBytes)
+		);
+	}
+	if ((length < hdr.dataOffset) ||
+		((length - hdr.dataOffset) % hdr.segmentBytes)
+	) {
+		DUDS_THROW_EXCEPTION(TimeSeriesTruncatedError());
+	}
+}
+
+} }
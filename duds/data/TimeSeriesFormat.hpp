@@ -0,0 +1,287 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESFORMAT_HPP
+#define TIMESERIESFORMAT_HPP
+
+#include <duds/data/Int128.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace duds { namespace data {
+
+/**
+ * @page DUDSdataTimeSeries  Time series file format
+ *
+ * A time series file holds the measurements from one instrument, identified
+ * by its UUID, as an append-only log. TimeSeriesWriter appends to the file,
+ * TimeSeriesReader scans it, and TimeSeriesStore keeps one file per
+ * instrument in a directory. The file is used in place through memory
+ * mappings, so all values are in the host's byte order, which must be little
+ * endian.
+ *
+ * The file starts with a header, TimeSeriesFileHeader, padded to the page
+ * size of the system that made the file. The header records the type and
+ * units of the values; every value in the file has the same type and units.
+ * The rest of the file is a sequence of segments, all the same size. The
+ * segment size is a multiple of the page size so that each segment can be
+ * mapped on its own. A new segment is added by extending the file when the
+ * last segment is full, so an append takes constant time.
+ *
+ * Each segment starts with a TimeSeriesSegmentHeader that holds the number
+ * of records in the segment, and the time of the first, last, earliest and
+ * latest record. The earliest and latest times serve as an index for range
+ * queries. The segment then holds two columns:
+ * - The time column follows the segment header and grows toward the end of
+ *   the segment. Each time is stored as the difference from the previous
+ *   time in the segment, or from the first time for the first record, in
+ *   nanoseconds. The difference is zig-zag encoded to allow time to go
+ *   backwards, and then stored in a variable length form using the low 7
+ *   bits of each byte, least significant bits first, with the high bit set
+ *   on all but the last byte. Samples taken at a steady rate take two or
+ *   three bytes.
+ * - The value column starts at the end of the segment and grows toward the
+ *   start. Value N of the segment is at the end of the segment minus
+ *   N + 1 times the value size. The value types are listed in
+ *   TimeSeriesValueType.
+ *
+ * The segment is full when the columns would overlap. The record count is
+ * updated after the record is written, so a reader, or the file left behind
+ * after the writing process crashes, never has a partially written record.
+ * This does not hold if the system loses power or crashes: the kernel may
+ * write the page holding the count before the pages holding the record, so
+ * a counted record may be missing from the file. Only the data present when
+ * TimeSeriesWriter::sync() last returned is certain to be intact.
+ */
+
+/**
+ * The types of values that can be stored in a time series file.
+ */
+enum TimeSeriesValueType : std::uint32_t {
+	/**
+	 * A double, 8 bytes.
+	 */
+	TimeSeriesDouble = 1,
+	/**
+	 * Three doubles, like a QuantityXyz, 24 bytes.
+	 */
+	TimeSeriesXyz = 2,
+	/**
+	 * A 128-bit two's complement integer, int128_w, 16 bytes.
+	 */
+	TimeSeriesInt128 = 3
+};
+
+/**
+ * The header at the start of a time series file.
+ */
+struct TimeSeriesFileHeader {
+	/**
+	 * "DTSF"
+	 */
+	char magic[4];
+	/**
+	 * The version of the format; 1.
+	 */
+	std::uint32_t version;
+	/**
+	 * The offset of the first segment; the size of the header with padding.
+	 */
+	std::uint32_t dataOffset;
+	/**
+	 * The size of every segment in bytes.
+	 */
+	std::uint32_t segmentBytes;
+	/**
+	 * The type of the values; a TimeSeriesValueType.
+	 */
+	std::uint32_t valueType;
+	/**
+	 * The units of the values, as given by Unit::value().
+	 */
+	std::int32_t unit;
+	/**
+	 * Reserved; zero.
+	 */
+	std::uint32_t reserved0[2];
+	/**
+	 * The UUID of the instrument that produced the values.
+	 */
+	std::uint8_t origin[16];
+	/**
+	 * Reserved; zero.
+	 */
+	std::uint32_t reserved1[4];
+};
+
+static_assert(sizeof(TimeSeriesFileHeader) == 64, "TimeSeriesFileHeader has padding");
+
+/**
+ * The header at the start of each segment in a time series file.
+ */
+struct TimeSeriesSegmentHeader {
+	/**
+	 * The time of the first record in nanoseconds; the base for the time
+	 * differences.
+	 */
+	std::uint64_t first;
+	/**
+	 * The time of the last record appended.
+	 */
+	std::uint64_t last;
+	/**
+	 * The earliest time in the segment.
+	 */
+	std::uint64_t earliest;
+	/**
+	 * The latest time in the segment.
+	 */
+	std::uint64_t latest;
+	/**
+	 * The number of records in the segment.
+	 */
+	std::uint32_t count;
+	/**
+	 * The number of bytes used by the time column.
+	 */
+	std::uint32_t timeBytes;
+	/**
+	 * Reserved; zero.
+	 */
+	std::uint64_t reserved;
+};
+
+static_assert(sizeof(TimeSeriesSegmentHeader) == 48, "TimeSeriesSegmentHeader has padding");
+
+/**
+ * The largest number of bytes used to store a time difference.
+ */
+constexpr std::size_t TimeSeriesMaxDeltaBytes = 10;
+
+/**
+ * Stores a time difference in the variable length form used by the time
+ * column.
+ * @param delta  The difference from the previous time.
+ * @param out    Where to put the encoded difference. It must have room for
+ *               TimeSeriesMaxDeltaBytes.
+ * @return       The number of bytes used.
+ */
+inline std::size_t timeSeriesEncodeDelta(std::int64_t delta, std::uint8_t *out) {
+	// zig-zag: small magnitudes of either sign become small numbers
+	std::uint64_t z = ((std::uint64_t)delta << 1) ^ (std::uint64_t)(delta >> 63);
+	std::size_t len = 0;
+	while (z > 0x7F) {
+		out[len++] = (std::uint8_t)(z | 0x80);
+		z >>= 7;
+	}
+	out[len++] = (std::uint8_t)z;
+	return len;
+}
+
+/**
+ * Reads a time difference stored by timeSeriesEncodeDelta().
+ * @param in  The start of the encoded difference. It is advanced past the
+ *            difference.
+ */
+inline std::int64_t timeSeriesDecodeDelta(const std::uint8_t *&in) {
+	std::uint64_t z = 0;
+	int shift = 0;
+	std::uint8_t b;
+	do {
+		b = *in++;
+		z |= (std::uint64_t)(b & 0x7F) << shift;
+		shift += 7;
+	} while ((b & 0x80) && (shift < 64));
+	return (std::int64_t)(z >> 1) ^ -(std::int64_t)(z & 1);
+}
+
+/**
+ * Relates C++ types to the types stored in a time series file, and converts
+ * between them.
+ * @tparam V  The C++ type: double, std::array<double, 3>, or int128_w.
+ */
+template <class V>
+struct TimeSeriesValueTraits;
+
+template <>
+struct TimeSeriesValueTraits<double> {
+	static constexpr TimeSeriesValueType Type = TimeSeriesDouble;
+	static constexpr std::size_t Bytes = 8;
+	static void encode(void *dest, const double &v) {
+		std::memcpy(dest, &v, Bytes);
+	}
+	static double decode(const void *src) {
+		double v;
+		std::memcpy(&v, src, Bytes);
+		return v;
+	}
+};
+
+template <>
+struct TimeSeriesValueTraits< std::array<double, 3> > {
+	static constexpr TimeSeriesValueType Type = TimeSeriesXyz;
+	static constexpr std::size_t Bytes = 24;
+	static void encode(void *dest, const std::array<double, 3> &v) {
+		std::memcpy(dest, v.data(), Bytes);
+	}
+	static std::array<double, 3> decode(const void *src) {
+		std::array<double, 3> v;
+		std::memcpy(v.data(), src, Bytes);
+		return v;
+	}
+};
+
+template <>
+struct TimeSeriesValueTraits<int128_w> {
+	static constexpr TimeSeriesValueType Type = TimeSeriesInt128;
+	static constexpr std::size_t Bytes = 16;
+	static void encode(void *dest, const int128_w &v);
+	static int128_w decode(const void *src);
+};
+
+/**
+ * Returns the number of bytes used to store a value of the given type, or
+ * zero if the type is not valid.
+ */
+inline std::size_t timeSeriesValueBytes(std::uint32_t type) {
+	switch (type) {
+		case TimeSeriesDouble:
+			return TimeSeriesValueTraits<double>::Bytes;
+		case TimeSeriesXyz:
+			return TimeSeriesValueTraits< std::array<double, 3> >::Bytes;
+		case TimeSeriesInt128:
+			return TimeSeriesValueTraits<int128_w>::Bytes;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Returns the page size of the system; the file header and segments must be
+ * multiples of this size.
+ */
+std::size_t timeSeriesPageSize();
+
+/**
+ * Checks that a time series file header is valid and usable on this system.
+ * @param hdr     The header from the start of the file.
+ * @param length  The size of the file in bytes.
+ * @throw TimeSeriesNotStoreError     The file is not a time series file.
+ * @throw TimeSeriesUnsupportedVersionError
+ * @throw TimeSeriesIncompatibleError The file's segments are not aligned
+ *                                    to this system's pages, or this system
+ *                                    is big endian.
+ * @throw TimeSeriesTruncatedError    The file ends with a partial segment.
+ */
+void timeSeriesCheckHeader(const TimeSeriesFileHeader &hdr, std::uint64_t length);
+
+} }
+
+#endif        //  #ifndef TIMESERIESFORMAT_HPP
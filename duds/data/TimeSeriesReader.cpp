@@ -0,0 +1,130 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/data/TimeSeriesReader.hpp>
+#include <duds/data/TimeSeriesErrors.hpp>
+#include <duds/general/Errors.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace duds { namespace data {
+
+TimeSeriesReader::TimeSeriesReader(const std::string &path) :
+fname(path), map(nullptr), mapBytes(0), ordered(true) {
+	fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(errno) << TimeSeriesFileName(path)
+		);
+	}
+	try {
+		struct stat st;
+		TimeSeriesFileHeader hdr;
+		if (fstat(fd, &st)) {
+			DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+				boost::errinfo_errno(errno)
+			);
+		}
+		if ((st.st_size < (off_t)sizeof(hdr)) ||
+			(pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr))
+		) {
+			DUDS_THROW_EXCEPTION(TimeSeriesNotStoreError());
+		}
+		timeSeriesCheckHeader(hdr, st.st_size);
+		dataOffset = hdr.dataOffset;
+		segBytes = hdr.segmentBytes;
+		vtype = (TimeSeriesValueType)hdr.valueType;
+		valBytes = timeSeriesValueBytes(vtype);
+		vunit = Unit(hdr.unit);
+		std::copy(hdr.origin, hdr.origin + sizeof(hdr.origin), uuid.begin());
+		refresh();
+	} catch (boost::exception &be) {
+		if (map) {
+			munmap((void*)map, mapBytes);
+		}
+		close(fd);
+		be << TimeSeriesFileName(path);
+		throw;
+	}
+}
+
+TimeSeriesReader::~TimeSeriesReader() {
+	if (map) {
+		munmap((void*)map, mapBytes);
+	}
+	close(fd);
+}
+
+void TimeSeriesReader::refresh() {
+	struct stat st;
+	if (fstat(fd, &st)) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(errno) << TimeSeriesFileName(fname)
+		);
+	}
+	std::uint64_t length = st.st_size;
+	if ((length < dataOffset) || ((length - dataOffset) % segBytes)) {
+		// a writer may be extending the file; only use whole segments
+		length = dataOffset + (length - dataOffset) / segBytes * segBytes;
+	}
+	if (length != mapBytes) {
+		if (map) {
+			munmap((void*)map, mapBytes);
+			map = nullptr;
+			mapBytes = 0;
+		}
+		void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED) {
+			DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+				boost::errinfo_errno(errno) << TimeSeriesFileName(fname)
+			);
+		}
+		map = (const char*)addr;
+		mapBytes = length;
+	}
+	// rebuild the index from the segment headers
+	std::size_t segs = (mapBytes - dataOffset) / segBytes;
+	index.resize(segs);
+	ordered = true;
+	for (std::size_t s = 0; s < segs; ++s) {
+		const TimeSeriesSegmentHeader *sh = header(s);
+		if (sh->count) {
+			std::atomic_thread_fence(std::memory_order_acquire);
+			index[s].earliest = sh->earliest;
+			index[s].latest = sh->latest;
+		} else {
+			// an empty segment can only be the last one
+			index[s].earliest = index[s].latest = s ? index[s - 1].latest : 0;
+		}
+		if (s && (index[s].earliest < index[s - 1].latest)) {
+			ordered = false;
+		}
+	}
+}
+
+void TimeSeriesReader::checkType(TimeSeriesValueType t) const {
+	if (t != vtype) {
+		DUDS_THROW_EXCEPTION(TimeSeriesTypeMismatch() <<
+			TimeSeriesStoredType(vtype) << TimeSeriesFileName(fname)
+		);
+	}
+}
+
+std::size_t TimeSeriesReader::size() const {
+	std::size_t total = 0;
+	for (std::size_t s = 0; s < index.size(); ++s) {
+		total += header(s)->count;
+	}
+	return total;
+}
+
+} }
@@ -0,0 +1,243 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESREADER_HPP
+#define TIMESERIESREADER_HPP
+
+#include <duds/data/TimeSeriesFormat.hpp>
+#include <duds/data/Unit.hpp>
+#include <duds/time/interstellar/Interstellar.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace duds { namespace data {
+
+/**
+ * Reads values from a time series file. The format is described in
+ * @ref DUDSdataTimeSeries. The whole file is mapped into memory read-only.
+ * The time range of each segment is kept in an index so that a range scan
+ * only decodes the segments that may hold records in the range. When the
+ * segments are in time order, as they are when the samples are appended in
+ * the order they were taken, the first segment to scan is found with a
+ * binary search.
+ *
+ * The file may be appended to while it is read. Records added to segments
+ * that were in the file when it was mapped are seen by later scans; call
+ * refresh() to see new segments.
+ *
+ * The object is not thread-safe.
+ *
+ * @author  Jeff Jackowski
+ */
+class TimeSeriesReader : boost::noncopyable {
+	/**
+	 * The time range of a segment.
+	 */
+	struct Span {
+		/**
+		 * The earliest time in the segment.
+		 */
+		std::uint64_t earliest;
+		/**
+		 * The latest time in the segment.
+		 */
+		std::uint64_t latest;
+	};
+	/**
+	 * The time range of each segment, in file order.
+	 */
+	std::vector<Span> index;
+	/**
+	 * The name of the file; used for errors.
+	 */
+	std::string fname;
+	/**
+	 * The mapped file, or nullptr if nothing is mapped.
+	 */
+	const char *map;
+	/**
+	 * The size of the mapping.
+	 */
+	std::uint64_t mapBytes;
+	/**
+	 * The file descriptor.
+	 */
+	int fd;
+	/**
+	 * The offset of the first segment.
+	 */
+	std::uint32_t dataOffset;
+	/**
+	 * The size of each segment.
+	 */
+	std::uint32_t segBytes;
+	/**
+	 * The size of each value.
+	 */
+	std::uint32_t valBytes;
+	/**
+	 * The type of the values.
+	 */
+	TimeSeriesValueType vtype;
+	/**
+	 * The units of the values.
+	 */
+	Unit vunit;
+	/**
+	 * The UUID of the instrument.
+	 */
+	boost::uuids::uuid uuid;
+	/**
+	 * True when every segment's earliest time is no earlier than the
+	 * previous segment's latest time.
+	 */
+	bool ordered;
+	/**
+	 * Returns the header of the given segment.
+	 */
+	const TimeSeriesSegmentHeader *header(std::size_t segment) const {
+		return (const TimeSeriesSegmentHeader*)(
+			map + dataOffset + segment * (std::size_t)segBytes
+		);
+	}
+	/**
+	 * Throws TimeSeriesTypeMismatch if @a t is not the stored type.
+	 */
+	void checkType(TimeSeriesValueType t) const;
+public:
+	/**
+	 * Opens and maps a time series file.
+	 * @param path  The name of the file.
+	 * @throw TimeSeriesFileError         The file could not be opened or
+	 *                                    mapped.
+	 * @throw TimeSeriesNotStoreError     The file is not a time series file.
+	 * @throw TimeSeriesUnsupportedVersionError
+	 * @throw TimeSeriesIncompatibleError The file's segments are not aligned
+	 *                                    to this system's pages, or this
+	 *                                    system is big endian.
+	 * @throw TimeSeriesTruncatedError    The file ends with a partial segment.
+	 */
+	TimeSeriesReader(const std::string &path);
+	/**
+	 * Unmaps and closes the file.
+	 */
+	~TimeSeriesReader();
+	/**
+	 * Maps any segments added to the file since it was last mapped, and
+	 * rebuilds the index.
+	 * @throw TimeSeriesFileError       The file could not be mapped.
+	 * @throw TimeSeriesTruncatedError  The file ends with a partial segment.
+	 */
+	void refresh();
+	/**
+	 * Returns the UUID of the instrument that produced the values.
+	 */
+	const boost::uuids::uuid &origin() const {
+		return uuid;
+	}
+	/**
+	 * Returns the type of the stored values.
+	 */
+	TimeSeriesValueType type() const {
+		return vtype;
+	}
+	/**
+	 * Returns the units of the stored values.
+	 */
+	Unit unit() const {
+		return vunit;
+	}
+	/**
+	 * Returns the number of mapped segments.
+	 */
+	std::size_t segments() const {
+		return index.size();
+	}
+	/**
+	 * Returns the number of records in the mapped segments.
+	 */
+	std::size_t size() const;
+	/**
+	 * Calls a function with every record whose time is within a range,
+	 * inclusive of both ends. The records are visited in the order they were
+	 * appended.
+	 * @tparam V     double, std::array<double, 3>, or int128_w. It must match
+	 *               the type of the file.
+	 * @tparam F     A function taking a const NanoTime reference and a
+	 *               const V reference.
+	 * @param from   The start of the range.
+	 * @param to     The end of the range.
+	 * @param func   The function to call with each record.
+	 * @return       The number of records passed to @a func.
+	 * @throw TimeSeriesTypeMismatch  The file holds a different type.
+	 */
+	template <class V, class F>
+	std::size_t scan(
+		const duds::time::interstellar::NanoTime &from,
+		const duds::time::interstellar::NanoTime &to,
+		F &&func
+	) const {
+		typedef TimeSeriesValueTraits<V>  Traits;
+		checkType(Traits::Type);
+		const std::uint64_t start = from.time_since_epoch().count();
+		const std::uint64_t end = to.time_since_epoch().count();
+		std::size_t segment = 0;
+		if (ordered && !index.empty()) {
+			// skip segments that end before the range; the last segment's
+			// span may be out of date, so it is never skipped here
+			segment = std::partition_point(
+				index.begin(),
+				index.end() - 1,
+				[start](const Span &s) { return s.latest < start; }
+			) - index.begin();
+		}
+		std::size_t found = 0;
+		for (; segment < index.size(); ++segment) {
+			const TimeSeriesSegmentHeader *sh = header(segment);
+			std::uint32_t count = sh->count;
+			// records counted are completely written
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (!count || (sh->latest < start)) {
+				continue;
+			}
+			if (sh->earliest > end) {
+				if (ordered) {
+					break;
+				}
+				continue;
+			}
+			const char *seg = (const char*)sh;
+			const std::uint8_t *tp = (const std::uint8_t*)(sh + 1);
+			const char *val = seg + segBytes;
+			std::uint64_t t = sh->first;
+			for (std::uint32_t r = 0; r < count; ++r) {
+				t += timeSeriesDecodeDelta(tp);
+				val -= valBytes;
+				if ((t >= start) && (t <= end)) {
+					func(
+						duds::time::interstellar::NanoTime(
+							duds::time::interstellar::Nanoseconds(t)
+						),
+						Traits::decode(val)
+					);
+					++found;
+				}
+			}
+		}
+		return found;
+	}
+};
+
+} }
+
+#endif        //  #ifndef TIMESERIESREADER_HPP
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/data/TimeSeriesStore.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+namespace duds { namespace data {
+
+TimeSeriesStore::TimeSeriesStore(
+	const std::string &directory,
+	std::uint32_t segmentBytes
+) : dir(directory), segBytes(segmentBytes) {
+	if (!dir.empty() && (dir.back() != '/')) {
+		dir.push_back('/');
+	}
+}
+
+std::string TimeSeriesStore::path(const boost::uuids::uuid &origin) const {
+	return dir + boost::uuids::to_string(origin) + ".dts";
+}
+
+void TimeSeriesStore::append(const Measurement &m) {
+	std::lock_guard<std::mutex> lock(block);
+	std::unique_ptr<TimeSeriesWriter> &w = writers[m.measured.origin];
+	if (!w) {
+		Unit u;
+		TimeSeriesValueType t;
+		try {
+			t = timeSeriesTypeOf(m, u);
+			w.reset(new TimeSeriesWriter(
+				path(m.measured.origin), m.measured.origin, t, u, segBytes
+			));
+		} catch (...) {
+			writers.erase(m.measured.origin);
+			throw;
+		}
+	}
+	w->append(m);
+}
+
+std::unique_ptr<TimeSeriesReader> TimeSeriesStore::reader(
+	const boost::uuids::uuid &origin
+) {
+	return std::unique_ptr<TimeSeriesReader>(
+		new TimeSeriesReader(path(origin))
+	);
+}
+
+void TimeSeriesStore::sync() {
+	std::lock_guard<std::mutex> lock(block);
+	for (auto &w : writers) {
+		w.second->sync();
+	}
+}
+
+} }
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESSTORE_HPP
+#define TIMESERIESSTORE_HPP
+
+#include <duds/data/TimeSeriesWriter.hpp>
+#include <duds/data/TimeSeriesReader.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace duds { namespace data {
+
+/**
+ * Keeps a time series file for each instrument in a directory. The files are
+ * named after the instrument's UUID with a ".dts" extension. A file is
+ * opened, or created, when the first measurement from its instrument is
+ * appended, and stays open until the store is destroyed.
+ *
+ * The functions may be called from multiple threads.
+ *
+ * @author  Jeff Jackowski
+ */
+class TimeSeriesStore : boost::noncopyable {
+	/**
+	 * The open files.
+	 */
+	std::map< boost::uuids::uuid, std::unique_ptr<TimeSeriesWriter> > writers;
+	/**
+	 * The directory holding the files.
+	 */
+	std::string dir;
+	/**
+	 * Protects @a writers and the writers in it.
+	 */
+	std::mutex block;
+	/**
+	 * The segment size for new files.
+	 */
+	std::uint32_t segBytes;
+public:
+	/**
+	 * Makes a store that uses the given directory. The directory must
+	 * already exist.
+	 * @param directory     The directory for the files.
+	 * @param segmentBytes  The segment size used for new files.
+	 */
+	TimeSeriesStore(
+		const std::string &directory,
+		std::uint32_t segmentBytes = TimeSeriesWriter::DefaultSegmentBytes
+	);
+	/**
+	 * Returns the name of the file used for the given instrument.
+	 */
+	std::string path(const boost::uuids::uuid &origin) const;
+	/**
+	 * Appends a measurement to the file for the instrument in
+	 * Measurement::measured::origin. The file's value type and units are
+	 * taken from the first measurement stored in it.
+	 * @throw TimeSeriesTypeMismatch      The measurement's value or units do
+	 *                                    not match the file.
+	 * @throw TimeSeriesUnsupportedValue  The measurement's value cannot be
+	 *                                    stored.
+	 * @throw TimeSeriesError             The file could not be opened or
+	 *                                    extended.
+	 */
+	void append(const Measurement &m);
+	/**
+	 * Opens the file for the given instrument for reading.
+	 * @throw TimeSeriesError  The file could not be opened.
+	 */
+	std::unique_ptr<TimeSeriesReader> reader(const boost::uuids::uuid &origin);
+	/**
+	 * Waits until all open files have been written.
+	 * @throw TimeSeriesFileError  A write failed.
+	 */
+	void sync();
+};
+
+typedef std::shared_ptr<TimeSeriesStore>  TimeSeriesStoreSptr;
+
+} }
+
+#endif        //  #ifndef TIMESERIESSTORE_HPP
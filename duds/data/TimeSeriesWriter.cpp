@@ -0,0 +1,275 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/data/TimeSeriesWriter.hpp>
+#include <duds/data/TimeSeriesErrors.hpp>
+#include <duds/general/Errors.hpp>
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace duds { namespace data {
+
+TimeSeriesWriter::TimeSeriesWriter(
+	const std::string &path,
+	const boost::uuids::uuid &origin,
+	TimeSeriesValueType type,
+	Unit unit,
+	std::uint32_t segmentBytes
+) : fname(path), seg(nullptr), sh(nullptr), vtype(type), vunit(unit),
+segments(0) {
+	valBytes = timeSeriesValueBytes(type);
+	if (!valBytes) {
+		DUDS_THROW_EXCEPTION(TimeSeriesUnsupportedValue() <<
+			TimeSeriesStoredType(type) << TimeSeriesFileName(path)
+		);
+	}
+	fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(errno) << TimeSeriesFileName(path)
+		);
+	}
+	try {
+		struct stat st;
+		if (fstat(fd, &st)) {
+			DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+				boost::errinfo_errno(errno)
+			);
+		}
+		TimeSeriesFileHeader hdr;
+		if (st.st_size == 0) {
+			// new file
+			std::size_t page = timeSeriesPageSize();
+			std::uint64_t size = ((std::uint64_t)segmentBytes + page - 1) /
+				page * page;
+			if ((size < (sizeof(TimeSeriesSegmentHeader) +
+				TimeSeriesMaxDeltaBytes + valBytes)) || (size > 0x80000000)
+			) {
+				DUDS_THROW_EXCEPTION(TimeSeriesBadSegmentSize() <<
+					TimeSeriesSegmentSize(segmentBytes)
+				);
+			}
+			std::memset(&hdr, 0, sizeof(hdr));
+			std::memcpy(hdr.magic, "DTSF", 4);
+			hdr.version = 1;
+			hdr.dataOffset = dataOffset = page;
+			hdr.segmentBytes = segBytes = size;
+			hdr.valueType = type;
+			hdr.unit = unit.value();
+			std::memcpy(hdr.origin, origin.data, sizeof(hdr.origin));
+			if ((pwrite(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) ||
+				ftruncate(fd, dataOffset)
+			) {
+				DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+					boost::errinfo_errno(errno)
+				);
+			}
+		} else {
+			// existing file
+			if ((st.st_size < (off_t)sizeof(hdr)) ||
+				(pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr))
+			) {
+				DUDS_THROW_EXCEPTION(TimeSeriesNotStoreError());
+			}
+			timeSeriesCheckHeader(hdr, st.st_size);
+			if ((hdr.valueType != type) ||
+				(hdr.unit != unit.value()) ||
+				std::memcmp(hdr.origin, origin.data, sizeof(hdr.origin))
+			) {
+				DUDS_THROW_EXCEPTION(TimeSeriesTypeMismatch() <<
+					TimeSeriesStoredType(hdr.valueType)
+				);
+			}
+			dataOffset = hdr.dataOffset;
+			segBytes = hdr.segmentBytes;
+			segments = (st.st_size - dataOffset) / segBytes;
+			if (segments) {
+				mapLast();
+			}
+		}
+	} catch (boost::exception &be) {
+		close(fd);
+		be << TimeSeriesFileName(path);
+		throw;
+	}
+}
+
+TimeSeriesWriter::~TimeSeriesWriter() {
+	if (seg) {
+		munmap(seg, segBytes);
+	}
+	close(fd);
+}
+
+void TimeSeriesWriter::mapLast() {
+	void *addr = mmap(
+		nullptr,
+		segBytes,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED,
+		fd,
+		dataOffset + (off_t)(segments - 1) * segBytes
+	);
+	if (addr == MAP_FAILED) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(errno) << TimeSeriesFileName(fname)
+		);
+	}
+	seg = (char*)addr;
+	sh = (TimeSeriesSegmentHeader*)seg;
+}
+
+void TimeSeriesWriter::addSegment() {
+	if (seg) {
+		// start writing the full segment now rather than at some later time
+		msync(seg, segBytes, MS_ASYNC);
+		munmap(seg, segBytes);
+		seg = nullptr;
+		sh = nullptr;
+	}
+	// allocate the space now so that a full disk is reported here rather
+	// than with SIGBUS when writing to the mapping; the new space is zero
+	int err = posix_fallocate(
+		fd,
+		dataOffset + (off_t)segments * segBytes,
+		segBytes
+	);
+	if (err) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(err) << TimeSeriesFileName(fname)
+		);
+	}
+	++segments;
+	mapLast();
+}
+
+void TimeSeriesWriter::checkType(TimeSeriesValueType t) const {
+	if (t != vtype) {
+		DUDS_THROW_EXCEPTION(TimeSeriesTypeMismatch() <<
+			TimeSeriesStoredType(vtype) << TimeSeriesFileName(fname)
+		);
+	}
+}
+
+void TimeSeriesWriter::appendEncoded(
+	const duds::time::interstellar::NanoTime &time,
+	const void *val
+) {
+	std::uint64_t t = time.time_since_epoch().count();
+	std::uint8_t enc[TimeSeriesMaxDeltaBytes];
+	std::size_t len = 0;
+	if (!seg) {
+		addSegment();
+	} else if (sh->count) {
+		len = timeSeriesEncodeDelta((std::int64_t)(t - sh->last), enc);
+		if ((sizeof(TimeSeriesSegmentHeader) + sh->timeBytes + len +
+			(sh->count + 1) * (std::size_t)valBytes) > segBytes
+		) {
+			addSegment();
+		}
+	}
+	std::uint32_t count = sh->count;
+	if (!count) {
+		sh->first = sh->earliest = sh->latest = t;
+		len = timeSeriesEncodeDelta(0, enc);
+	} else if (t < sh->earliest) {
+		sh->earliest = t;
+	} else if (t > sh->latest) {
+		sh->latest = t;
+	}
+	std::memcpy(seg + segBytes - (count + 1) * (std::size_t)valBytes, val, valBytes);
+	std::memcpy(seg + sizeof(TimeSeriesSegmentHeader) + sh->timeBytes, enc, len);
+	sh->timeBytes += len;
+	sh->last = t;
+	// the record must be complete before it is counted
+	std::atomic_thread_fence(std::memory_order_release);
+	sh->count = count + 1;
+}
+
+/**
+ * Finds the time series value type and units of a GenericValue.
+ */
+struct TimeSeriesTypeOfVisitor :
+public boost::static_visitor<TimeSeriesValueType> {
+	Unit &unit;
+	TimeSeriesTypeOfVisitor(Unit &u) : unit(u) { }
+	TimeSeriesValueType operator()(double) const {
+		unit = Unit(0);
+		return TimeSeriesDouble;
+	}
+	TimeSeriesValueType operator()(const Quantity &q) const {
+		unit = q.unit;
+		return TimeSeriesDouble;
+	}
+	TimeSeriesValueType operator()(const QuantityNddArray &qa) const {
+		if ((qa.array.numdims() != 1) || (qa.array.size() != 3)) {
+			DUDS_THROW_EXCEPTION(TimeSeriesUnsupportedValue());
+		}
+		unit = qa.unit;
+		return TimeSeriesXyz;
+	}
+	TimeSeriesValueType operator()(const int128_w &) const {
+		unit = Unit(0);
+		return TimeSeriesInt128;
+	}
+	template <class T>
+	TimeSeriesValueType operator()(const T &) const {
+		DUDS_THROW_EXCEPTION(TimeSeriesUnsupportedValue());
+	}
+};
+
+TimeSeriesValueType timeSeriesTypeOf(const Measurement &m, Unit &unit) {
+	return boost::apply_visitor(TimeSeriesTypeOfVisitor(unit), m.measured.value);
+}
+
+void TimeSeriesWriter::append(const Measurement &m) {
+	Unit u;
+	TimeSeriesValueType t = timeSeriesTypeOf(m, u);
+	if ((t != vtype) || (u != vunit)) {
+		DUDS_THROW_EXCEPTION(TimeSeriesTypeMismatch() <<
+			TimeSeriesStoredType(vtype) << TimeSeriesFileName(fname)
+		);
+	}
+	switch (t) {
+		case TimeSeriesDouble:
+			if (const double *d = boost::get<double>(&m.measured.value)) {
+				append(m.timestamp.value, *d);
+			} else {
+				append(
+					m.timestamp.value,
+					boost::get<Quantity>(m.measured.value).value
+				);
+			}
+			break;
+		case TimeSeriesXyz: {
+			const QuantityNddArray &qa =
+				boost::get<QuantityNddArray>(m.measured.value);
+			std::array<double, 3> xyz;
+			std::copy(qa.array.begin(), qa.array.end(), xyz.begin());
+			append(m.timestamp.value, xyz);
+			break;
+		}
+		default:
+			append(m.timestamp.value, boost::get<int128_w>(m.measured.value));
+	}
+}
+
+void TimeSeriesWriter::sync() {
+	if (seg && msync(seg, segBytes, MS_SYNC)) {
+		DUDS_THROW_EXCEPTION(TimeSeriesFileError() <<
+			boost::errinfo_errno(errno) << TimeSeriesFileName(fname)
+		);
+	}
+}
+
+} }
@@ -0,0 +1,204 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESWRITER_HPP
+#define TIMESERIESWRITER_HPP
+
+#include <duds/data/TimeSeriesFormat.hpp>
+#include <duds/data/Measurement.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace duds { namespace data {
+
+/**
+ * Appends values to a time series file. The format is described in
+ * @ref DUDSdataTimeSeries. Only the last segment of the file is mapped
+ * into memory; an append copies the value and time difference into the
+ * mapping, so it does not make a system call except when a new segment is
+ * needed. The data reaches the file when the kernel writes back the mapped
+ * pages, or when sync() is called.
+ *
+ * Only one writer should use a file at a time. Readers may use the file
+ * while it is written. The object is not thread-safe.
+ *
+ * @author  Jeff Jackowski
+ */
+class TimeSeriesWriter : boost::noncopyable {
+	/**
+	 * The name of the file; used for errors.
+	 */
+	std::string fname;
+	/**
+	 * The mapped last segment, or nullptr if the file has no segments.
+	 */
+	char *seg;
+	/**
+	 * The header of the last segment.
+	 */
+	TimeSeriesSegmentHeader *sh;
+	/**
+	 * The file descriptor.
+	 */
+	int fd;
+	/**
+	 * The offset of the first segment.
+	 */
+	std::uint32_t dataOffset;
+	/**
+	 * The size of each segment.
+	 */
+	std::uint32_t segBytes;
+	/**
+	 * The size of each value.
+	 */
+	std::uint32_t valBytes;
+	/**
+	 * The type of the values.
+	 */
+	TimeSeriesValueType vtype;
+	/**
+	 * The units of the values.
+	 */
+	Unit vunit;
+	/**
+	 * The number of segments in the file.
+	 */
+	std::size_t segments;
+	/**
+	 * Extends the file by a segment and maps it in place of the current
+	 * segment.
+	 */
+	void addSegment();
+	/**
+	 * Maps the last segment.
+	 */
+	void mapLast();
+	/**
+	 * Appends a record with an already encoded value.
+	 */
+	void appendEncoded(
+		const duds::time::interstellar::NanoTime &time,
+		const void *val
+	);
+	/**
+	 * Throws TimeSeriesTypeMismatch if @a t is not the stored type.
+	 */
+	void checkType(TimeSeriesValueType t) const;
+public:
+	/**
+	 * The default size of a segment.
+	 */
+	static constexpr std::uint32_t DefaultSegmentBytes = 1024 * 1024;
+	/**
+	 * Opens a time series file for appending, or creates it if it does not
+	 * exist.
+	 * @param path          The name of the file.
+	 * @param origin        The UUID of the instrument.
+	 * @param type          The type of the values.
+	 * @param unit          The units of the values.
+	 * @param segmentBytes  The size of each segment for a new file. It is
+	 *                      rounded up to a multiple of the page size. An
+	 *                      existing file keeps its own segment size.
+	 * @throw TimeSeriesFileError         The file could not be opened,
+	 *                                    created, or mapped.
+	 * @throw TimeSeriesNotStoreError     The file is not a time series file.
+	 * @throw TimeSeriesUnsupportedVersionError
+	 * @throw TimeSeriesIncompatibleError The file's segments are not aligned
+	 *                                    to this system's pages, or this
+	 *                                    system is big endian.
+	 * @throw TimeSeriesTruncatedError    The file ends with a partial segment.
+	 * @throw TimeSeriesTypeMismatch      An existing file holds a different
+	 *                                    instrument, value type, or units.
+	 * @throw TimeSeriesBadSegmentSize    The segment size is too small to
+	 *                                    hold a record.
+	 */
+	TimeSeriesWriter(
+		const std::string &path,
+		const boost::uuids::uuid &origin,
+		TimeSeriesValueType type,
+		Unit unit,
+		std::uint32_t segmentBytes = DefaultSegmentBytes
+	);
+	/**
+	 * Unmaps and closes the file without waiting for it to be written.
+	 */
+	~TimeSeriesWriter();
+	/**
+	 * Returns the type of the stored values.
+	 */
+	TimeSeriesValueType type() const {
+		return vtype;
+	}
+	/**
+	 * Returns the units of the stored values.
+	 */
+	Unit unit() const {
+		return vunit;
+	}
+	/**
+	 * Returns the size of each segment in bytes.
+	 */
+	std::uint32_t segmentBytes() const {
+		return segBytes;
+	}
+	/**
+	 * Returns the number of segments in the file.
+	 */
+	std::size_t segmentCount() const {
+		return segments;
+	}
+	/**
+	 * Appends a value. The type of @a V must match the type of the file.
+	 * @tparam V     double, std::array<double, 3>, or int128_w.
+	 * @param time   The time the value was sampled.
+	 * @param value  The value.
+	 * @throw TimeSeriesTypeMismatch  The file holds a different type.
+	 * @throw TimeSeriesFileError     The file could not be extended.
+	 */
+	template <class V>
+	void append(const duds::time::interstellar::NanoTime &time, const V &value) {
+		typedef TimeSeriesValueTraits<V>  Traits;
+		checkType(Traits::Type);
+		char buf[Traits::Bytes];
+		Traits::encode(buf, value);
+		appendEncoded(time, buf);
+	}
+	/**
+	 * Appends the value and time of a measurement. The measured value may be
+	 * a double, a Quantity, a QuantityNddArray with three elements, or an
+	 * int128_w. Quantity values must have the same units as the file.
+	 * The quality information and origin are not stored.
+	 * @throw TimeSeriesTypeMismatch      The measurement's value or units do
+	 *                                    not match the file.
+	 * @throw TimeSeriesUnsupportedValue  The measurement's value cannot be
+	 *                                    stored.
+	 * @throw TimeSeriesFileError         The file could not be extended.
+	 */
+	void append(const Measurement &m);
+	/**
+	 * Waits until the last segment has been written to the file. Earlier
+	 * segments are scheduled for writing when they fill.
+	 * @throw TimeSeriesFileError  The write failed.
+	 */
+	void sync();
+};
+
+/**
+ * Returns the time series value type, and the units, needed to store the
+ * value of a measurement.
+ * @param m     The measurement.
+ * @param unit  Set to the units of the value.
+ * @throw TimeSeriesUnsupportedValue  The measurement's value cannot be
+ *                                    stored.
+ */
+TimeSeriesValueType timeSeriesTypeOf(const Measurement &m, Unit &unit);
+
+} }
+
+#endif        //  #ifndef TIMESERIESWRITER_HPP
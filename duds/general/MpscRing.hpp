@@ -0,0 +1,431 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef MPSCRING_HPP
+#define MPSCRING_HPP
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <limits>
+#include <type_traits>
+#include <boost/noncopyable.hpp>
+
+namespace duds { namespace general {
+
+/**
+ * The size of a cache line assumed for padding to avoid false sharing between
+ * data modified by different threads. 64 bytes is correct for current x86 and
+ * ARM processors.
+ */
+constexpr std::size_t CacheLineSize = 64;
+
+/**
+ * A bounded, lock-free queue that can be filled from many threads and
+ * emptied from one. The storage is allocated once at construction, so
+ * queueing an item never allocates memory beyond what the item itself
+ * requires. Each slot in the ring carries a sequence number that tells
+ * producers and the consumer whether the slot is free or filled; this is
+ * Dmitry Vyukov's bounded queue algorithm. The positions used by producers
+ * and the consumer, along with the counters, are kept on separate cache lines
+ * so that the threads do not contend over the same line more than needed.
+ *
+ * What happens when a producer finds the ring full is set by an
+ * OverflowPolicy. Under DropOldest, the producer removes the oldest item
+ * itself; this is why the consumer side also uses an atomic exchange, and is
+ * also why more than one thread may technically remove items. If the
+ * consumer has already taken the oldest item but not yet released its slot,
+ * as happens during drain(), the producer waits for the slot rather than
+ * dropping a newer item. Only one thread
+ * should call the consumer functions, pop() and drain(), but they remain
+ * correct if more than one does.
+ *
+ * The number of items dropped and the largest number of items held at once
+ * are tracked to help size the ring.
+ *
+ * @tparam T  The item type. It must be move constructible, and its move
+ *            constructor and destructor should not throw. Items can only be
+ *            added with constructors that do not throw; a slot is claimed
+ *            before the item is constructed, and the consumer would wait
+ *            forever on a slot that is never filled.
+ *
+ * @author  Jeff Jackowski
+ */
+template <class T>
+class MpscRing : boost::noncopyable {
+public:
+	/**
+	 * Options for handling an attempt to add an item to a full ring.
+	 */
+	enum OverflowPolicy {
+		/**
+		 * The oldest item is removed to make room for the new item.
+		 */
+		DropOldest,
+		/**
+		 * The new item is not added.
+		 */
+		DropNewest,
+		/**
+		 * The producer yields until the consumer makes room.
+		 */
+		Block
+	};
+private:
+	/**
+	 * A location for an item in the ring.
+	 */
+	struct Slot {
+		/**
+		 * Equal to the slot's position when free for a producer, and to the
+		 * position plus one when holding an item for the consumer.
+		 */
+		std::atomic<std::size_t> seq;
+		/**
+		 * Storage for the item.
+		 */
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+		T *item() {
+			return reinterpret_cast<T*>(&data);
+		}
+	};
+	/**
+	 * The slots. The number of slots is a power of two.
+	 */
+	std::unique_ptr<Slot[]> slots;
+	/**
+	 * The mask applied to a position to find its slot.
+	 */
+	std::size_t mask;
+	/**
+	 * The handling of a full ring.
+	 */
+	std::atomic<OverflowPolicy> overflow;
+	/**
+	 * The position of the next item to add; used by producers.
+	 */
+	alignas(CacheLineSize) std::atomic<std::size_t> head;
+	/**
+	 * The position of the next item to remove; used by the consumer.
+	 */
+	alignas(CacheLineSize) std::atomic<std::size_t> tail;
+	/**
+	 * The number of items dropped because the ring was full.
+	 */
+	alignas(CacheLineSize) std::atomic<std::uint64_t> drops;
+	/**
+	 * The largest number of items held at once.
+	 */
+	std::atomic<std::size_t> hwm;
+	/**
+	 * Claims a slot to fill, handling a full ring according to the overflow
+	 * policy.
+	 * @return  The claimed position, or std::numeric_limits<std::size_t>::max()
+	 *          if the item must be dropped.
+	 */
+	std::size_t claim() {
+		std::size_t pos = head.load(std::memory_order_relaxed);
+		while (true) {
+			Slot &s = slots[pos & mask];
+			std::size_t seq = s.seq.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = (std::ptrdiff_t)(seq - pos);
+			if (diff == 0) {
+				if (head.compare_exchange_weak(
+					pos, pos + 1, std::memory_order_relaxed
+				)) {
+					return pos;
+				}
+				// pos was updated by compare_exchange_weak
+			} else if (diff < 0) {
+				// full
+				switch (overflow.load(std::memory_order_relaxed)) {
+					case DropNewest:
+						drops.fetch_add(1, std::memory_order_relaxed);
+						return std::numeric_limits<std::size_t>::max();
+					case DropOldest:
+						// only remove the item in the needed slot so that
+						// one push drops at most one item
+						if (discard(pos - mask - 1)) {
+							drops.fetch_add(1, std::memory_order_relaxed);
+						} else {
+							// the item is being filled, or was taken by the
+							// consumer and will soon be released
+							std::this_thread::yield();
+						}
+						break;
+					default:
+						std::this_thread::yield();
+				}
+				pos = head.load(std::memory_order_relaxed);
+			} else {
+				// another producer took the slot
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+	/**
+	 * Marks a claimed and filled slot as ready for the consumer, and updates
+	 * the high-water mark.
+	 */
+	void publish(std::size_t pos) {
+		slots[pos & mask].seq.store(pos + 1, std::memory_order_release);
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		if (t <= pos) {
+			std::size_t used = pos + 1 - t;
+			std::size_t prev = hwm.load(std::memory_order_relaxed);
+			while ((used > prev) && !hwm.compare_exchange_weak(
+				prev, used, std::memory_order_relaxed
+			)) { }
+		}
+	}
+	/**
+	 * Claims up to @a max filled slots for removal.
+	 * @param pos  Set to the position of the first claimed slot.
+	 * @return     The number of slots claimed.
+	 */
+	std::size_t take(std::size_t &pos, std::size_t max) {
+		pos = tail.load(std::memory_order_relaxed);
+		while (true) {
+			std::size_t num = 0;
+			// count consecutive filled slots
+			while ((num < max) && (slots[(pos + num) & mask].seq.load(
+				std::memory_order_acquire
+			) == pos + num + 1)) {
+				++num;
+			}
+			if (!num) {
+				std::size_t seq = slots[pos & mask].seq.load(
+					std::memory_order_acquire
+				);
+				// empty, or the oldest slot is still being filled?
+				if ((std::ptrdiff_t)(seq - (pos + 1)) <= 0) {
+					return 0;
+				}
+				// another thread removed the item
+				pos = tail.load(std::memory_order_relaxed);
+			} else if (tail.compare_exchange_weak(
+				pos, pos + num, std::memory_order_relaxed
+			)) {
+				return num;
+			}
+			// pos was updated by compare_exchange_weak
+		}
+	}
+	/**
+	 * Destroys the item in a claimed slot and frees the slot for producers.
+	 */
+	void release(std::size_t pos) {
+		Slot &s = slots[pos & mask];
+		s.item()->~T();
+		s.seq.store(pos + mask + 1, std::memory_order_release);
+	}
+	/**
+	 * Removes and destroys the item at the given position if it is the
+	 * oldest item and has not been taken by the consumer.
+	 * @param pos  The position of the item to remove.
+	 * @return     True if the item was removed.
+	 */
+	bool discard(std::size_t pos) {
+		if (slots[pos & mask].seq.load(std::memory_order_acquire) !=
+			pos + 1
+		) {
+			return false;
+		}
+		std::size_t t = pos;
+		if (!tail.compare_exchange_strong(
+			t, pos + 1, std::memory_order_relaxed
+		)) {
+			return false;
+		}
+		release(pos);
+		return true;
+	}
+	/**
+	 * Removes and destroys the oldest item.
+	 * @return  True if an item was removed.
+	 */
+	bool discard() {
+		std::size_t pos;
+		if (take(pos, 1)) {
+			release(pos);
+			return true;
+		}
+		return false;
+	}
+public:
+	/**
+	 * Makes an empty ring.
+	 * @param capacity  The maximum number of items. It is rounded up to a
+	 *                  power of two, with a minimum of two.
+	 * @param policy    The handling of attempts to add items to a full ring.
+	 */
+	MpscRing(std::size_t capacity, OverflowPolicy policy = DropOldest) :
+	overflow(policy), head(0), tail(0), drops(0), hwm(0) {
+		std::size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		mask = size - 1;
+		slots.reset(new Slot[size]);
+		for (std::size_t s = 0; s < size; ++s) {
+			slots[s].seq.store(s, std::memory_order_relaxed);
+		}
+	}
+	/**
+	 * Destroys any remaining items.
+	 */
+	~MpscRing() {
+		clear();
+	}
+	/**
+	 * Returns the maximum number of items the ring can hold.
+	 */
+	std::size_t capacity() const {
+		return mask + 1;
+	}
+	/**
+	 * Returns the number of items in the ring. The result may be out of date
+	 * by the time it is returned if other threads are using the ring.
+	 */
+	std::size_t size() const {
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		std::size_t h = head.load(std::memory_order_relaxed);
+		return (h > t) ? h - t : 0;
+	}
+	/**
+	 * True if the ring was empty when checked.
+	 */
+	bool empty() const {
+		return size() == 0;
+	}
+	/**
+	 * Returns the handling of attempts to add items to a full ring.
+	 */
+	OverflowPolicy policy() const {
+		return overflow.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Changes the handling of attempts to add items to a full ring. This
+	 * affects producers already waiting under the Block policy.
+	 */
+	void policy(OverflowPolicy p) {
+		overflow.store(p, std::memory_order_relaxed);
+	}
+	/**
+	 * Returns the number of items dropped because the ring was full.
+	 */
+	std::uint64_t dropped() const {
+		return drops.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Returns the largest number of items held by the ring at once.
+	 */
+	std::size_t highWaterMark() const {
+		return hwm.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Sets the drop count and the high-water mark to zero.
+	 */
+	void resetCounters() {
+		drops.store(0, std::memory_order_relaxed);
+		hwm.store(0, std::memory_order_relaxed);
+	}
+	/**
+	 * Constructs an item in the ring. Safe to call from any number of
+	 * threads.
+	 * @param args  The arguments for the item's constructor. The constructor
+	 *              used must be declared noexcept.
+	 * @return      False if the item was dropped under the DropNewest policy.
+	 *              Dropping the oldest item to make room still returns true.
+	 */
+	template <class... Args>
+	bool emplace(Args &&... args) {
+		static_assert(std::is_nothrow_constructible<T, Args&&...>::value,
+			"The item's constructor must not throw; a claimed slot must be "
+			"published."
+		);
+		std::size_t pos = claim();
+		if (pos == std::numeric_limits<std::size_t>::max()) {
+			return false;
+		}
+		new (slots[pos & mask].item()) T(std::forward<Args>(args)...);
+		publish(pos);
+		return true;
+	}
+	/**
+	 * Copies an item into the ring.
+	 * @copydetails emplace()
+	 */
+	bool push(const T &item) {
+		return emplace(item);
+	}
+	/**
+	 * Moves an item into the ring.
+	 * @copydetails emplace()
+	 */
+	bool push(T &&item) {
+		return emplace(std::move(item));
+	}
+	/**
+	 * Removes the oldest item.
+	 * @param item  Move assigned the removed item.
+	 * @return      True if an item was removed, or false if the ring was
+	 *              empty.
+	 */
+	bool pop(T &item) {
+		std::size_t pos;
+		if (!take(pos, 1)) {
+			return false;
+		}
+		item = std::move(*slots[pos & mask].item());
+		release(pos);
+		return true;
+	}
+	/**
+	 * Removes a batch of items, oldest first, and passes each one to a
+	 * function. The whole batch is claimed with one atomic operation, which
+	 * makes this less costly per item than pop(). Items added after the
+	 * batch is claimed are not included.
+	 * @param func  The function to call with each item as an rvalue
+	 *              reference. It must not use this ring, and should not throw;
+	 *              if it does, the remaining items in the batch are destroyed.
+	 * @param max   The maximum number of items to remove.
+	 * @return      The number of items removed.
+	 */
+	template <class Func>
+	std::size_t drain(
+		Func &&func,
+		std::size_t max = std::numeric_limits<std::size_t>::max()
+	) {
+		std::size_t pos;
+		std::size_t num = take(pos, max), n = 0;
+		try {
+			for (; n < num; ++n) {
+				func(std::move(*slots[(pos + n) & mask].item()));
+				release(pos + n);
+			}
+		} catch (...) {
+			for (; n < num; ++n) {
+				release(pos + n);
+			}
+			throw;
+		}
+		return num;
+	}
+	/**
+	 * Removes and destroys all items.
+	 */
+	void clear() {
+		while (discard()) { }
+	}
+};
+
+} }
+
+#endif        //  #ifndef MPSCRING_HPP
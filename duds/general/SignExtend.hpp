@@ -1,3 +1,6 @@
+#ifndef SIGNEXTEND_HPP
+#define SIGNEXTEND_HPP
+
 #include <type_traits>
 
 namespace duds { namespace general {
@@ -21,11 +24,13 @@ namespace duds { namespace general {
  * @license   Public domain
  */
 template <unsigned B, typename T>
-inline typename std::make_signed<T>::type SignExtend(const T x) {
+constexpr typename std::make_signed<T>::type SignExtend(const T x) {
 	struct {
 		typename std::make_signed<T>::type x:B;
-	} s;
-	return s.x = (typename std::make_signed<T>::type)x;
+	} s = { (typename std::make_signed<T>::type)x };
+	return s.x;
 }
 
 } }
+
+#endif        //  #ifndef SIGNEXTEND_HPP
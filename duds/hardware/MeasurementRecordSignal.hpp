@@ -0,0 +1,245 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/MeasurementSignalSink.hpp>
+#include <duds/hardware/MeasurementSignalSource.hpp>
+#include <duds/data/MeasurementRecord.hpp>
+#include <atomic>
+
+namespace duds { namespace hardware {
+
+/**
+ * Handles sending signals of measurement records. This is the counterpart of
+ * GenericMeasurementSignalSource for duds::data::GenericMeasurementRecord:
+ * the record is passed to the slots by value, so sending a signal does not
+ * allocate memory or touch a reference count. There is no old measurement
+ * signal; records from the same instrument are expected to be sent in the
+ * order they were sampled.
+ *
+ * This class is intened to be used as a base class. The function to send
+ * signals is protected to limit access. The constructors are also protected.
+ *
+ * @tparam Record  The record type; a duds::data::GenericMeasurementRecord.
+ *
+ * @author  Jeff Jackowski
+ */
+template <class Record>
+class MeasurementRecordSignalSource {
+public:
+	/**
+	 * The type used for event listeners that are told of records.
+	 */
+	typedef boost::signals2::signal<void (Record)>  RecordSignal;
+protected:
+	/**
+	 * The signal invoked for each new record.
+	 * @note  Declared as mutable to allow changes to this member when the
+	 *        object is stored in containers like std::set that keep const
+	 *        elements.
+	 */
+	mutable RecordSignal newRecord;
+	/**
+	 * This class is intened to be used as a base class.
+	 */
+	MeasurementRecordSignalSource() = default;
+public:
+	/**
+	 * Make a connection to receive signals for new records.
+	 */
+	boost::signals2::connection newRecordConnect(
+		const typename RecordSignal::slot_type &slot,
+		boost::signals2::connect_position at = boost::signals2::at_back
+	) {
+		return newRecord.connect(slot, at);
+	}
+	/**
+	 * Make a connection to receive signals for new records.
+	 */
+	boost::signals2::connection newRecordConnect(
+		const typename RecordSignal::group_type &group,
+		const typename RecordSignal::slot_type &slot,
+		boost::signals2::connect_position at = boost::signals2::at_back
+	) {
+		return newRecord.connect(group, slot, at);
+	}
+	/**
+	 * Disconnect a group from the new record signal.
+	 */
+	void newRecordDisconnect(const typename RecordSignal::group_type &group) {
+		newRecord.disconnect(group);
+	}
+	/**
+	 * Disconnect a slot from the new record signal.
+	 */
+	template<typename S>
+	void newRecordDisconnect(const S &slotFunc) {
+		newRecord.disconnect(slotFunc);
+	}
+};
+
+/**
+ * Receives measurement signals from @ref GenericInstrument "Instruments"
+ * and sends them on as measurement records. This allows code that works with
+ * records to use instruments that only produce generic measurements.
+ * Measurements that cannot be held in a @a Record are counted and dropped.
+ *
+ * @tparam Record  The record type; a duds::data::GenericMeasurementRecord.
+ *
+ * @author  Jeff Jackowski
+ */
+template <class Record>
+class MeasurementToRecordAdapter :
+	public GenericMeasurementSignalSink<
+		duds::data::GenericValue,
+		double,
+		duds::time::interstellar::NanoTime,
+		float
+	>,
+	public MeasurementRecordSignalSource<Record>
+{
+public:
+	typedef typename GenericMeasurementSignalSink<
+		duds::data::GenericValue,
+		double,
+		duds::time::interstellar::NanoTime,
+		float
+	>::Instrument  Instrument;
+private:
+	/**
+	 * Assigns the instrument indices put in the records.
+	 */
+	std::shared_ptr<duds::data::InstrumentIndexTable> table;
+	/**
+	 * The number of measurements that could not be converted.
+	 */
+	std::atomic<std::uint64_t> failures;
+	/**
+	 * Converts the measurement and sends the record.
+	 */
+	void send(const duds::data::Measurement &m) {
+		Record rec;
+		try {
+			duds::data::fromMeasurement(
+				rec, m, table->index(m.measured.origin)
+			);
+		} catch (duds::data::MeasurementRecordError &) {
+			failures.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		this->newRecord(rec);
+	}
+protected:
+	virtual void handleNewMeasure(
+		const std::shared_ptr<Instrument> &,
+		const std::shared_ptr<const duds::data::Measurement> &m
+	) {
+		send(*m);
+	}
+	virtual void handleOldMeasure(
+		const std::shared_ptr<Instrument> &,
+		const std::shared_ptr<const duds::data::Measurement> &m
+	) {
+		send(*m);
+	}
+public:
+	/**
+	 * Makes an adapter.
+	 * @param t  The table that assigns indices to instruments. It may be
+	 *           shared with a RecordToMeasurementAdapter to reverse the
+	 *           conversion.
+	 */
+	MeasurementToRecordAdapter(
+		const std::shared_ptr<duds::data::InstrumentIndexTable> &t
+	) : table(t), failures(0) { }
+	/**
+	 * Returns the number of measurements that could not be held in a
+	 * record.
+	 */
+	std::uint64_t unconverted() const {
+		return failures.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Receives measurement records and sends them on as generic measurement
+ * signals. This allows code that works with generic measurements to receive
+ * data from the record signal path, at the cost of allocating a Measurement
+ * for each record. The conversion is skipped when nothing is connected to
+ * the new measurement signal.
+ *
+ * The adapter is a function object that can be connected to a
+ * MeasurementRecordSignalSource; use boost::ref or std::ref to avoid copying
+ * the adapter:
+ * @code
+ * source.newRecordConnect(boost::ref(adapter));
+ * @endcode
+ *
+ * @tparam Record  The record type; a duds::data::GenericMeasurementRecord.
+ *
+ * @author  Jeff Jackowski
+ */
+template <class Record>
+class RecordToMeasurementAdapter :
+	public MeasurementSignalSource,
+	boost::noncopyable
+{
+	/**
+	 * Finds the UUID for the instrument index in a record.
+	 */
+	std::shared_ptr<duds::data::InstrumentIndexTable> table;
+	/**
+	 * The Instrument objects passed along with the measurement, indexed by
+	 * the instrument index in the records.
+	 */
+	std::vector< std::shared_ptr<Instrument> > insts;
+public:
+	/**
+	 * Makes an adapter.
+	 * @param t  The table that maps the instrument indices in records to
+	 *           UUIDs.
+	 */
+	RecordToMeasurementAdapter(
+		const std::shared_ptr<duds::data::InstrumentIndexTable> &t
+	) : table(t) { }
+	/**
+	 * Sets the Instrument object sent in the signal for measurements from the
+	 * instrument with the given index. Without this, an empty pointer is
+	 * sent.
+	 * @note  This function is not thread-safe; use it before connecting the
+	 *        adapter.
+	 */
+	void instrument(std::uint32_t index, const std::shared_ptr<Instrument> &i) {
+		if (insts.size() <= index) {
+			insts.resize(index + 1);
+		}
+		insts[index] = i;
+	}
+	/**
+	 * Converts the record to a Measurement and sends it in the new
+	 * measurement signal.
+	 * @throw duds::data::MeasurementRecordBadIndex  The record's instrument
+	 *        index is not in the InstrumentIndexTable.
+	 */
+	void operator()(Record rec) {
+		if (newMeasure.empty()) {
+			return;
+		}
+		std::shared_ptr<const duds::data::Measurement> m =
+			std::make_shared<const duds::data::Measurement>(
+				duds::data::toMeasurement(rec, table->origin(rec.instrument))
+			);
+		std::shared_ptr<Instrument> i;
+		if (rec.instrument < insts.size()) {
+			i = insts[rec.instrument];
+		}
+		newMeasure(i, m);
+	}
+};
+
+} }
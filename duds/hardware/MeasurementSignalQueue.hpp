@@ -8,20 +8,29 @@
  * Copyright (C) 2017  Jeff Jackowski
  */
 #include <duds/hardware/MeasurementSignalSink.hpp>
-#include <duds/general/Spinlock.hpp>
-#include <utility>
+#include <duds/general/MpscRing.hpp>
+#include <vector>
 
 namespace duds { namespace hardware {
 
 /**
  * Queues mesurement signals for later processing. The queue is thread-safe to
- * allow queueing and dequeueing from multiple threads. It can be used to
- * store signals from many threads and later process the signals on one thread.
+ * allow queueing from multiple threads, and it can be used to store signals
+ * from many threads and later process the signals on one thread.
  * The advantages of such a setup are less thread synchronization and avoiding
  * taking up time on the thread that sent the signal. The disadvantage is a
  * greater latency to responding to the signal when ignoring the time taken to
  * handle a signal.
  *
+ * The signals are held in a duds::general::MpscRing, so the queue has a fixed
+ * capacity that is allocated once, queueing a signal does not take a lock or
+ * allocate memory, and signals are removed in batches. The handling of
+ * signals that arrive when the queue is full is selected with the ring's
+ * OverflowPolicy. The number of dropped signals and the most signals held at
+ * once are counted to help with sizing the queue.
+ *
+ * Only one thread should remove signals from the queue.
+ *
  * @todo           Could make a derived class that can resend the signals
  *                 using GenericMeasurementSignalSource.
  *
@@ -46,7 +55,8 @@ template <
 	typename... ISArgs
 >
 class GenericMeasurementSignalQueue :
-	public GenericMeasurementSignalSink<SVT, SQT, TVT, TQT>
+	public GenericMeasurementSignalSink<SVT, SQT, TVT, TQT>,
+	boost::noncopyable
 {
 public:
 	typedef GenericInstrument<SVT, SQT, TVT, TQT>  Instrument;
@@ -76,22 +86,25 @@ public:
 			const IS<Instrument> &i,
 			const std::shared_ptr<const Measurement> &m,
 			EventType e
-		) : insturment(i), measurement(m), type(e) { }
+		) noexcept : insturment(i), measurement(m), type(e) { }
 	};
 	/**
-	 * The list type used to store information from incoming signals.
+	 * The ring type used to store information from incoming signals.
 	 */
-	typedef std::list<SignalData>  EventList;
-private:
+	typedef duds::general::MpscRing<SignalData>  EventRing;
 	/**
-	 * Storage of signal data.
+	 * The handling of signals that arrive when the queue is full.
 	 */
-	EventList events;
+	typedef typename EventRing::OverflowPolicy  OverflowPolicy;
+	/**
+	 * The container type used to hand over a batch of signal information.
+	 */
+	typedef std::vector<SignalData>  EventList;
+private:
 	/**
-	 * Used to allow only one thread access to @a events. The accesses are
-	 * likely quick in most cases, so a spinlock is used instead of a mutex.
+	 * Storage of signal data.
 	 */
-	mutable duds::general::Spinlock block;
+	EventRing events;
 protected:
 	/**
 	 * Receives a new measurement signal and queues its information.
@@ -100,8 +113,7 @@ protected:
 		const std::shared_ptr<Instrument> &i,
 		const std::shared_ptr<const Measurement> &m
 	) {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		events.emplace_back(i, m, NewMeasurement);
+		events.emplace(i, m, NewMeasurement);
 	}
 	/**
 	 * Receives an old measurement signal and queues its information.
@@ -110,169 +122,125 @@ protected:
 		const std::shared_ptr<Instrument> &i,
 		const std::shared_ptr<const Measurement> &m
 	) {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		events.emplace_back(i, m, OldMeasurement);
+		events.emplace(i, m, OldMeasurement);
 	}
 public:
-	GenericMeasurementSignalQueue() = default;
-	GenericMeasurementSignalQueue(const GenericMeasurementSignalQueue &sq) {
-		std::lock_guard<duds::general::Spinlock> lock(sq.block);
-		events = sq.events;
-	}
-	GenericMeasurementSignalQueue(GenericMeasurementSignalQueue &&sq) {
-		std::lock_guard<duds::general::Spinlock> lock(sq.block);
-		events = std::move(sq.events);
+	/**
+	 * Makes an empty queue.
+	 * @param capacity  The maximum number of signals held. It is rounded up
+	 *                  to a power of two.
+	 * @param policy    The handling of signals that arrive when the queue is
+	 *                  full.
+	 */
+	GenericMeasurementSignalQueue(
+		std::size_t capacity = 256,
+		OverflowPolicy policy = EventRing::DropOldest
+	) : events(capacity, policy) { }
+	/**
+	 * Returns the maximum number of signals the queue can hold.
+	 */
+	std::size_t capacity() const {
+		return events.capacity();
 	}
-	GenericMeasurementSignalQueue &operator = (
-		const GenericMeasurementSignalQueue &sq
-	) {
-		std::unique_lock<duds::general::Spinlock> lock0(block, std::defer_lock);
-		std::unique_lock<duds::general::Spinlock> lock1(sq.block, std::defer_lock);
-		std::lock(lock0, lock1);
-		events = sq.events;
+	/**
+	 * Returns the number of queued signals. The result may be out of date by
+	 * the time it is returned.
+	 */
+	std::size_t size() const {
+		return events.size();
 	}
-	GenericMeasurementSignalQueue &operator = (
-		GenericMeasurementSignalQueue &&sq
-	) {
-		std::unique_lock<duds::general::Spinlock> lock0(block, std::defer_lock);
-		std::unique_lock<duds::general::Spinlock> lock1(sq.block, std::defer_lock);
-		std::lock(lock0, lock1);
-		events = std::move(sq.events);
+	/**
+	 * Returns the handling of signals that arrive when the queue is full.
+	 */
+	OverflowPolicy policy() const {
+		return events.policy();
 	}
 	/**
-	 * Swaps the internal signal data list with another
-	 * GenericMeasurementSignalQueue object.
+	 * Changes the handling of signals that arrive when the queue is full.
 	 */
-	void swap(GenericMeasurementSignalQueue &sq) {
-		std::unique_lock<duds::general::Spinlock> lock0(block, std::defer_lock);
-		std::unique_lock<duds::general::Spinlock> lock1(sq.block, std::defer_lock);
-		std::lock(lock0, lock1);
-		events.swap(sq.events);
+	void policy(OverflowPolicy p) {
+		events.policy(p);
 	}
 	/**
-	 * Returns a copy of the signal events stored internally.
+	 * Returns the number of signals dropped because the queue was full.
 	 */
-	EventList copy() const {
-		EventList copy;
-		{
-			std::lock_guard<duds::general::Spinlock> lock(block);
-			copy = events;
-		}
-		return copy;
+	std::uint64_t dropped() const {
+		return events.dropped();
 	}
 	/**
-	 * Creates a copy of the ignal events stored internally.
-	 * @param copy  The list that will hold a copy of the internal list.
+	 * Returns the largest number of signals held at once.
 	 */
-	void copy(EventList &copy) const {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		copy = events;
+	std::size_t highWaterMark() const {
+		return events.highWaterMark();
 	}
 	/**
-	 * Returns a move-constructed list of the signal events stored internally.
-	 * @post  No signal events are stored; @a events is empty.
+	 * Sets the drop count and the high-water mark to zero.
 	 */
-	EventList move() {
-		EventList copy;
-		{
-			std::lock_guard<duds::general::Spinlock> lock(block);
-			copy = std::move(events);
-		}
-		return copy;
+	void resetCounters() {
+		events.resetCounters();
 	}
 	/**
-	 * Move-assigns to a given list the signal events stored internally.
-	 * @post  No signal events are stored; @a events is empty.
+	 * Removes queued signal data, oldest first, and passes each to a
+	 * function as an rvalue reference.
+	 * @param func  The function to call. It must not remove signals from
+	 *              this queue.
+	 * @param max   The maximum number of signals to remove.
+	 * @return      The number of signals removed.
 	 */
-	void move(EventList &copy) {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		copy = std::move(events);
+	template <class Func>
+	std::size_t drain(
+		Func &&func,
+		std::size_t max = std::numeric_limits<std::size_t>::max()
+	) {
+		return events.drain(std::forward<Func>(func), max);
 	}
 	/**
-	 * Push signal data onto the end (newest side) of the internal list.
-	 * @param sd  The information to push.
+	 * Returns a list of the queued signal data, oldest first.
+	 * @post  The returned signals are no longer queued.
 	 */
-	void pushBack(const SignalData &sd) {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		events.push_back(sd);
+	EventList move() {
+		EventList copy;
+		move(copy);
+		return copy;
 	}
 	/**
-	 * Push signal data onto the front (oldest side) of the internal list.
-	 * @param sd  The information to push.
+	 * Appends the queued signal data, oldest first, to the given list.
+	 * Reusing the same list avoids allocating memory once the list has grown
+	 * large enough.
+	 * @param copy  The list that will receive the signal data.
+	 * @post  The appended signals are no longer queued.
 	 */
-	void pushFront(const SignalData &sd) {
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		events.push_front(sd);
+	void move(EventList &copy) {
+		copy.reserve(copy.size() + events.size());
+		events.drain([&copy](SignalData &&sd) {
+			copy.push_back(std::move(sd));
+		});
 	}
 	/**
-	 * Pop signal data from the end (newest side) of the internal list and
-	 * return that data.
+	 * Push signal data onto the end (newest side) of the queue.
+	 * @param sd  The information to push.
+	 * @return    False if the data was dropped because the queue is full.
 	 */
-	SignalData popBack() {
-		SignalData sd;
-		{
-			std::lock_guard<duds::general::Spinlock> lock(block);
-			sd = std::move(events.back());
-			events.pop_back();
-		}
-		return sd;
+	bool pushBack(const SignalData &sd) {
+		return events.push(sd);
 	}
 	/**
-	 * Pop signal data from the front (oldest side) of the internal list and
-	 * return that data.
+	 * Pop signal data from the front (oldest side) of the queue.
+	 * @param sd  Assigned the removed signal data.
+	 * @return    True if signal data was removed, or false if the queue was
+	 *            empty.
 	 */
-	SignalData popFront() {
-		SignalData sd;
-		{
-			std::lock_guard<duds::general::Spinlock> lock(block);
-			sd = std::move(events.front());
-			events.pop_front();
-		}
-		return sd;
+	bool popFront(SignalData &sd) {
+		return events.pop(sd);
 	}
 	/**
 	 * Clear the signal data stored internally.
 	 */
 	void clear() {
-		std::lock_guard<duds::general::Spinlock> lock(block);
 		events.clear();
 	}
 };
 
-/**
- * Swap support for GenericMeasurementSignalQueue.
- * This allows std::swap to work with GenericMeasurementSignalQueue objects.
- *
- * @param  sq0     The first signal queue.
- * @param  sq1     The second signal queue. It must use the same template
- *                 parameters as the first.
- *
- * @tparam SVT     Sample value type
- * @tparam SQT     Sample quality type
- * @tparam TVT     Time value type
- * @tparam TQT     Time quality type
- * @tparam IS      The Instrument storage type. Should be either
- *                 std::shared_ptr or std::weak_ptr.
- * @tparam ISArgs  Additional template parameters to @a IS other than the
- *                 data type being stored. In most cases, this can be ommitted.
- *
- * @author Jeff Jackowski
- */
-template <
-	class SVT,
-	class SQT,
-	class TVT,
-	class TQT,
-	template <typename> class IS,
-	typename ... ISArgs
->
-void swap(
-	GenericMeasurementSignalQueue<SVT, SQT, TVT, TQT, IS, ISArgs ...> &sq0,
-	GenericMeasurementSignalQueue<SVT, SQT, TVT, TQT, IS, ISArgs ...> &sq1
-) {
-	sq0.swap(sq1);
-}
-
 typedef GenericMeasurementSignalQueue<
 	duds::data::GenericValue,
 	double,
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TIMESERIESSINK_HPP
+#define TIMESERIESSINK_HPP
+
+#include <duds/hardware/MeasurementSignalSink.hpp>
+#include <duds/data/TimeSeriesStore.hpp>
+#include <duds/data/TimeSeriesErrors.hpp>
+#include <atomic>
+
+namespace duds { namespace hardware {
+
+/**
+ * Receives measurement signals from @ref GenericInstrument "Instruments"
+ * and appends the measurements to a duds::data::TimeSeriesStore. New and old
+ * measurements are both stored; the files keep the time of each record, so
+ * old measurements do not need to be told apart. Measurements that cannot be
+ * stored, such as those with a value type the store does not support, are
+ * counted and dropped so that an error does not propagate into the signal
+ * sender.
+ *
+ * @author  Jeff Jackowski
+ */
+class TimeSeriesSink : public GenericMeasurementSignalSink<
+	duds::data::GenericValue,
+	double,
+	duds::time::interstellar::NanoTime,
+	float
+> {
+public:
+	typedef GenericMeasurementSignalSink<
+		duds::data::GenericValue,
+		double,
+		duds::time::interstellar::NanoTime,
+		float
+	>::Instrument  Instrument;
+private:
+	/**
+	 * Where the measurements go.
+	 */
+	duds::data::TimeSeriesStoreSptr store;
+	/**
+	 * The number of measurements that could not be stored.
+	 */
+	std::atomic<std::uint64_t> failures;
+	/**
+	 * Stores the measurement.
+	 */
+	void put(const duds::data::Measurement &m) {
+		try {
+			store->append(m);
+		} catch (duds::data::TimeSeriesError &) {
+			failures.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+protected:
+	virtual void handleNewMeasure(
+		const std::shared_ptr<Instrument> &,
+		const std::shared_ptr<const duds::data::Measurement> &m
+	) {
+		put(*m);
+	}
+	virtual void handleOldMeasure(
+		const std::shared_ptr<Instrument> &,
+		const std::shared_ptr<const duds::data::Measurement> &m
+	) {
+		put(*m);
+	}
+public:
+	/**
+	 * Makes a sink that stores measurements in the given store.
+	 */
+	TimeSeriesSink(const duds::data::TimeSeriesStoreSptr &s) :
+	store(s), failures(0) { }
+	/**
+	 * Returns the store receiving the measurements.
+	 */
+	const duds::data::TimeSeriesStoreSptr &timeSeriesStore() const {
+		return store;
+	}
+	/**
+	 * Returns the number of measurements that could not be stored.
+	 */
+	std::uint64_t unstored() const {
+		return failures.load(std::memory_order_relaxed);
+	}
+};
+
+} }
+
+#endif        //  #ifndef TIMESERIESSINK_HPP
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/hardware/devices/SampleScheduler.hpp>
+#include <duds/general/Errors.hpp>
+#include <map>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace duds { namespace hardware { namespace devices {
+
+/**
+ * Returns the time on CLOCK_MONOTONIC in nanoseconds; the clock used by the
+ * timerfds.
+ */
+static std::int64_t monotonicNow() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (std::int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+SampleScheduler::Group::Group(SampleScheduler *o) : owner(o) {
+	tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (tfd < 0) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerTimerError() <<
+			boost::errinfo_errno(errno)
+		);
+	}
+}
+
+SampleScheduler::Group::~Group() {
+	close(tfd);
+}
+
+void SampleScheduler::Group::arm() {
+	std::int64_t next = owner->jobs[jobs.front()].deadline;
+	for (unsigned int idx : jobs) {
+		next = std::min(next, owner->jobs[idx].deadline);
+	}
+	itimerspec its = { };
+	its.it_value.tv_sec = next / 1000000000ll;
+	its.it_value.tv_nsec = next % 1000000000ll;
+	// a deadline that has already passed causes an immediate expiration
+	if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, nullptr)) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerTimerError() <<
+			boost::errinfo_errno(errno)
+		);
+	}
+}
+
+void SampleScheduler::Group::respond(duds::os::linux::Poller *, int) {
+	// clear the expiration; the count is not needed since missed deadlines
+	// are found from the time
+	std::uint64_t expirations;
+	if (read(tfd, &expirations, sizeof(expirations)) < 0) {
+		// EAGAIN: the timer was set again before this ran; nothing to clear
+	}
+	for (unsigned int idx : jobs) {
+		Job &job = owner->jobs[idx];
+		std::int64_t start = monotonicNow();
+		if (job.deadline > start) {
+			continue;
+		}
+		std::exception_ptr err;
+		try {
+			job.task();
+		} catch (...) {
+			err = std::current_exception();
+		}
+		std::int64_t end = monotonicNow();
+		std::int64_t period = job.period.count();
+		// the number of later deadlines that have already passed
+		std::int64_t missed = (end - job.deadline) / period;
+		std::chrono::nanoseconds jitter(start - job.deadline);
+		std::chrono::nanoseconds duration(end - start);
+		// keep the phase of the original schedule
+		job.deadline += (missed + 1) * period;
+		std::lock_guard<duds::general::Spinlock> lock(owner->statLock);
+		Statistics &stats = job.stats;
+		++stats.runs;
+		stats.overruns += missed;
+		stats.lastJitter = jitter;
+		stats.totalJitter += jitter;
+		if (jitter > stats.maxJitter) {
+			stats.maxJitter = jitter;
+		}
+		if (duration > stats.maxDuration) {
+			stats.maxDuration = duration;
+		}
+		if (err) {
+			++stats.failures;
+			job.error = err;
+		}
+	}
+	arm();
+}
+
+SampleScheduler::SampleScheduler(unsigned int workerThreads) :
+waker(std::make_shared<Waker>()),
+maxWorkers(workerThreads ? workerThreads : 1),
+active(false) {
+	stopfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (stopfd < 0) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerTimerError() <<
+			boost::errinfo_errno(errno)
+		);
+	}
+}
+
+SampleScheduler::~SampleScheduler() {
+	stop();
+	close(stopfd);
+}
+
+unsigned int SampleScheduler::add(
+	Task &&task,
+	std::chrono::nanoseconds period,
+	const std::string &bus
+) {
+	if (running()) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerRunning());
+	}
+	if (period.count() <= 0) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerBadPeriod());
+	}
+	jobs.emplace_back();
+	Job &job = jobs.back();
+	job.task = std::move(task);
+	job.bus = bus;
+	job.period = period;
+	job.deadline = 0;
+	return jobs.size() - 1;
+}
+
+void SampleScheduler::run(Worker *w) {
+	try {
+		while (active.load(std::memory_order_acquire)) {
+			w->poller.wait();
+		}
+	} catch (...) {
+		// the Poller failed; nothing more can be done on this thread
+	}
+}
+
+void SampleScheduler::start() {
+	if (running() || jobs.empty()) {
+		return;
+	}
+	try {
+		// group the jobs by bus
+		std::map<std::string, Group*> named;
+		for (unsigned int idx = 0; idx < jobs.size(); ++idx) {
+			Group *g = nullptr;
+			if (!jobs[idx].bus.empty()) {
+				g = named[jobs[idx].bus];
+			}
+			if (!g) {
+				groups.push_back(std::make_shared<Group>(this));
+				g = groups.back().get();
+				if (!jobs[idx].bus.empty()) {
+					named[jobs[idx].bus] = g;
+				}
+			}
+			g->jobs.push_back(idx);
+		}
+		// clear any stop event left from the last run
+		std::uint64_t count;
+		if (read(stopfd, &count, sizeof(count)) < 0) {
+			// EAGAIN: no event to clear
+		}
+		std::size_t numWorkers = std::min<std::size_t>(maxWorkers, groups.size());
+		for (std::size_t w = 0; w < numWorkers; ++w) {
+			workers.emplace_back(new Worker);
+			workers.back()->poller.add(waker, stopfd);
+		}
+		// everything starts now
+		std::int64_t now = monotonicNow();
+		for (Job &job : jobs) {
+			job.deadline = now;
+		}
+		for (std::size_t g = 0; g < groups.size(); ++g) {
+			workers[g % numWorkers]->poller.add(groups[g], groups[g]->tfd);
+			groups[g]->arm();
+		}
+	} catch (...) {
+		workers.clear();
+		groups.clear();
+		throw;
+	}
+	active.store(true, std::memory_order_release);
+	for (std::unique_ptr<Worker> &w : workers) {
+		w->thread = std::thread(&SampleScheduler::run, this, w.get());
+	}
+}
+
+void SampleScheduler::stop() {
+	if (!running()) {
+		return;
+	}
+	active.store(false, std::memory_order_release);
+	// the event stays readable until read, so it wakes every worker
+	std::uint64_t one = 1;
+	if (write(stopfd, &one, sizeof(one)) < 0) {
+		// only fails if the counter would overflow, which still wakes the
+		// workers
+	}
+	for (std::unique_ptr<Worker> &w : workers) {
+		w->thread.join();
+	}
+	workers.clear();
+	groups.clear();
+}
+
+void SampleScheduler::checkTask(unsigned int id) const {
+	if (id >= jobs.size()) {
+		DUDS_THROW_EXCEPTION(SampleSchedulerBadTask() <<
+			SampleSchedulerTask(id)
+		);
+	}
+}
+
+SampleScheduler::Statistics SampleScheduler::statistics(unsigned int id) const {
+	checkTask(id);
+	std::lock_guard<duds::general::Spinlock> lock(statLock);
+	return jobs[id].stats;
+}
+
+void SampleScheduler::resetStatistics() {
+	std::lock_guard<duds::general::Spinlock> lock(statLock);
+	for (Job &job : jobs) {
+		job.stats = Statistics();
+	}
+}
+
+std::exception_ptr SampleScheduler::lastError(unsigned int id) const {
+	checkTask(id);
+	std::lock_guard<duds::general::Spinlock> lock(statLock);
+	return jobs[id].error;
+}
+
+} } }
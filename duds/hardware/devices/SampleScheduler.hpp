@@ -0,0 +1,364 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef SAMPLESCHEDULER_HPP
+#define SAMPLESCHEDULER_HPP
+
+#include <duds/os/linux/Poller.hpp>
+#include <duds/general/Spinlock.hpp>
+#include <boost/exception/info.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace duds { namespace hardware { namespace devices {
+
+/**
+ * The base class for all SampleScheduler errors.
+ */
+struct SampleSchedulerError : virtual std::exception, virtual boost::exception { };
+
+/**
+ * A timerfd or eventfd could not be made or used. The exception will include
+ * the error code in a boost::errinfo_errno attribute.
+ */
+struct SampleSchedulerTimerError : SampleSchedulerError { };
+
+/**
+ * An attempt was made to add a task while the scheduler is running.
+ */
+struct SampleSchedulerRunning : SampleSchedulerError { };
+
+/**
+ * A task was given a period that is not greater than zero.
+ */
+struct SampleSchedulerBadPeriod : SampleSchedulerError { };
+
+/**
+ * A task identifier does not refer to a task of the scheduler.
+ */
+struct SampleSchedulerBadTask : SampleSchedulerError { };
+
+/**
+ * The identifier of the task involved in the error.
+ */
+typedef boost::error_info<struct Info_SampleSchedulerTask, unsigned int>
+	SampleSchedulerTask;
+
+/**
+ * Samples instruments at fixed rates. Each task, usually a call to an
+ * instrument's sample() function, is given a period and is run when its
+ * deadline arrives. The next deadline is the previous deadline plus the
+ * period, rather than the time the task finished plus the period, so the
+ * sampling rate does not drift like it does with a loop around
+ * std::this_thread::sleep_for(). A task that runs late, or that takes longer
+ * than its period, skips the deadlines it missed instead of running several
+ * times in a burst; each skipped deadline is counted as an overrun.
+ *
+ * Tasks that use the same bus are placed in the same group by giving them the
+ * same bus name, like "/dev/i2c-1" or "spi0". The tasks of a group are only
+ * run one at a time and always on the same thread, so instruments on the
+ * same bus do not contend for the bus or for a ChipSelectManager. Tasks with
+ * an empty bus name are each put in their own group. Each group has a
+ * timerfd set for the group's next deadline using CLOCK_MONOTONIC. The
+ * groups are spread across a small number of worker threads; each worker
+ * waits on the timers of its groups with a duds::os::linux::Poller.
+ *
+ * Tasks are added before the scheduler is started. An exception thrown by
+ * a task is caught, counted, and kept for lastError() so that one failing
+ * instrument does not stop the others.
+ *
+ * @author  Jeff Jackowski
+ */
+class SampleScheduler : boost::noncopyable {
+public:
+	/**
+	 * The function type for a task.
+	 */
+	typedef std::function<void()>  Task;
+	/**
+	 * Timing statistics for a task.
+	 */
+	struct Statistics {
+		/**
+		 * The number of times the task was run.
+		 */
+		std::uint64_t runs = 0;
+		/**
+		 * The number of deadlines skipped because the task was still running,
+		 * or was waiting for another task in its group, when they passed.
+		 */
+		std::uint64_t overruns = 0;
+		/**
+		 * The number of times the task threw an exception.
+		 */
+		std::uint64_t failures = 0;
+		/**
+		 * The time from the deadline until the task started for the most
+		 * recent run.
+		 */
+		std::chrono::nanoseconds lastJitter = std::chrono::nanoseconds(0);
+		/**
+		 * The longest time from a deadline until the task started.
+		 */
+		std::chrono::nanoseconds maxJitter = std::chrono::nanoseconds(0);
+		/**
+		 * The sum of the time from the deadline until the task started for
+		 * all runs. Divide by @a runs for the mean.
+		 */
+		std::chrono::nanoseconds totalJitter = std::chrono::nanoseconds(0);
+		/**
+		 * The longest time the task took to run.
+		 */
+		std::chrono::nanoseconds maxDuration = std::chrono::nanoseconds(0);
+	};
+private:
+	/**
+	 * A task and its schedule.
+	 */
+	struct Job {
+		/**
+		 * The function to run.
+		 */
+		Task task;
+		/**
+		 * The bus used by the task; used to form groups.
+		 */
+		std::string bus;
+		/**
+		 * The time between deadlines.
+		 */
+		std::chrono::nanoseconds period;
+		/**
+		 * The next deadline in nanoseconds on CLOCK_MONOTONIC. Only used by
+		 * the thread running the job's group.
+		 */
+		std::int64_t deadline;
+		/**
+		 * Timing statistics; protected by @a statLock.
+		 */
+		Statistics stats;
+		/**
+		 * The last exception thrown by the task; protected by @a statLock.
+		 */
+		std::exception_ptr error;
+	};
+	/**
+	 * Tasks that are run on the same thread, one at a time, using a
+	 * timerfd to wait for the earliest deadline.
+	 */
+	class Group : public duds::os::linux::PollResponder {
+		/**
+		 * The scheduler that owns the jobs.
+		 */
+		SampleScheduler *owner;
+	public:
+		/**
+		 * The indices of the jobs in the group.
+		 */
+		std::vector<unsigned int> jobs;
+		/**
+		 * The timerfd.
+		 */
+		int tfd;
+		Group(SampleScheduler *o);
+		~Group();
+		/**
+		 * Sets the timer for the earliest deadline of the group's jobs.
+		 */
+		void arm();
+		/**
+		 * Runs the jobs whose deadlines have passed, and then sets the timer
+		 * for the next deadline.
+		 */
+		virtual void respond(duds::os::linux::Poller *, int);
+	};
+	/**
+	 * Does nothing in response to the stop event; the event makes
+	 * Poller::wait() return.
+	 */
+	class Waker : public duds::os::linux::PollResponder {
+	public:
+		virtual void respond(duds::os::linux::Poller *, int) { }
+	};
+	/**
+	 * A worker thread and the Poller it uses to wait on the timers of its
+	 * groups.
+	 */
+	struct Worker {
+		duds::os::linux::Poller poller;
+		std::thread thread;
+	};
+	/**
+	 * All the tasks. The index is the task identifier.
+	 */
+	std::vector<Job> jobs;
+	/**
+	 * The groups made by start().
+	 */
+	std::vector< std::shared_ptr<Group> > groups;
+	/**
+	 * The workers made by start().
+	 */
+	std::vector< std::unique_ptr<Worker> > workers;
+	/**
+	 * Responds to events on @a stopfd.
+	 */
+	std::shared_ptr<Waker> waker;
+	/**
+	 * Protects the statistics and errors of all jobs.
+	 */
+	mutable duds::general::Spinlock statLock;
+	/**
+	 * An eventfd that becomes readable to wake the workers when stopping.
+	 */
+	int stopfd;
+	/**
+	 * The maximum number of worker threads.
+	 */
+	unsigned int maxWorkers;
+	/**
+	 * True while the workers should continue to run.
+	 */
+	std::atomic<bool> active;
+	/**
+	 * The function run by the worker threads.
+	 */
+	void run(Worker *w);
+	/**
+	 * Throws SampleSchedulerBadTask if @a id is not a task.
+	 */
+	void checkTask(unsigned int id) const;
+public:
+	/**
+	 * Makes a scheduler with no tasks.
+	 * @param workerThreads  The maximum number of worker threads. No more
+	 *                       threads than groups are started. Zero is treated
+	 *                       as one.
+	 * @throw SampleSchedulerTimerError  The eventfd could not be made.
+	 */
+	SampleScheduler(unsigned int workerThreads = 1);
+	/**
+	 * Stops the scheduler.
+	 */
+	~SampleScheduler();
+	/**
+	 * Adds a task.
+	 * @param task    The function to run at each deadline.
+	 * @param period  The time between deadlines.
+	 * @param bus     The name of the bus the task uses. Tasks with the same
+	 *                name are run one at a time on the same thread. An empty
+	 *                name puts the task in a group of its own.
+	 * @return        The identifier of the task, used to get its statistics.
+	 * @throw SampleSchedulerRunning    The scheduler is running.
+	 * @throw SampleSchedulerBadPeriod  The period is not greater than zero.
+	 */
+	unsigned int add(
+		Task &&task,
+		std::chrono::nanoseconds period,
+		const std::string &bus = std::string()
+	);
+	/**
+	 * Adds a task that calls an instrument's sample() function, like
+	 * INA219::sample() or LSM9DS1AccelGyro::sample().
+	 * @param inst    The instrument. The scheduler keeps a copy of the
+	 *                pointer until it is destroyed.
+	 * @param period  The time between samples.
+	 * @param bus     The name of the bus the instrument uses.
+	 * @throw SampleSchedulerRunning    The scheduler is running.
+	 * @throw SampleSchedulerBadPeriod  The period is not greater than zero.
+	 */
+	template <class Inst>
+	unsigned int addInstrument(
+		const std::shared_ptr<Inst> &inst,
+		std::chrono::nanoseconds period,
+		const std::string &bus = std::string()
+	) {
+		return add([inst]() { inst->sample(); }, period, bus);
+	}
+	/**
+	 * Adds a task that calls a GenericDevice's sample(const ClockSptr &)
+	 * function.
+	 * @param dev     The device. The scheduler keeps a copy of the pointer
+	 *                until it is destroyed.
+	 * @param clock   The clock that provides the time for the samples.
+	 * @param period  The time between samples.
+	 * @param bus     The name of the bus the device uses.
+	 * @throw SampleSchedulerRunning    The scheduler is running.
+	 * @throw SampleSchedulerBadPeriod  The period is not greater than zero.
+	 */
+	template <class Dev, class Clk>
+	unsigned int addDevice(
+		const std::shared_ptr<Dev> &dev,
+		const std::shared_ptr<Clk> &clock,
+		std::chrono::nanoseconds period,
+		const std::string &bus = std::string()
+	) {
+		return add([dev, clock]() { dev->sample(clock); }, period, bus);
+	}
+	/**
+	 * Returns the number of tasks.
+	 */
+	unsigned int tasks() const {
+		return jobs.size();
+	}
+	/**
+	 * Returns the number of task groups; valid while running.
+	 */
+	unsigned int groupCount() const {
+		return groups.size();
+	}
+	/**
+	 * Returns the number of worker threads; valid while running.
+	 */
+	unsigned int workerCount() const {
+		return workers.size();
+	}
+	/**
+	 * True when the scheduler is running.
+	 */
+	bool running() const {
+		return !workers.empty();
+	}
+	/**
+	 * Groups the tasks, starts the worker threads, and sets the first
+	 * deadline of all tasks to the present time. Does nothing if already
+	 * running.
+	 * @throw SampleSchedulerTimerError  A timerfd could not be made or set.
+	 * @throw duds::os::linux::PollerError
+	 */
+	void start();
+	/**
+	 * Stops the worker threads after they finish any task they are running.
+	 * Must not be called from a task.
+	 */
+	void stop();
+	/**
+	 * Returns a copy of the timing statistics of a task.
+	 * @throw SampleSchedulerBadTask  @a id is not a task.
+	 */
+	Statistics statistics(unsigned int id) const;
+	/**
+	 * Sets all timing statistics of all tasks to zero.
+	 */
+	void resetStatistics();
+	/**
+	 * Returns the last exception thrown by a task, or an empty pointer if the
+	 * task has not thrown.
+	 * @throw SampleSchedulerBadTask  @a id is not a task.
+	 */
+	std::exception_ptr lastError(unsigned int id) const;
+};
+
+} } }
+
+#endif        //  #ifndef SAMPLESCHEDULER_HPP
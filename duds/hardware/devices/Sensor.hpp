@@ -153,7 +153,7 @@ public:
 	 * replaced when the device is sampled, so repeated calls to this function
 	 * can return different objects.
 	 */
-	ConstMeasurementSptr &measurement() const {
+	const ConstMeasurementSptr &measurement() const {
 		return meas;
 	}
 };
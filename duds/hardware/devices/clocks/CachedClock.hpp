@@ -0,0 +1,349 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef CACHEDCLOCK_HPP
+#define CACHEDCLOCK_HPP
+
+#include <duds/hardware/devices/clocks/Clock.hpp>
+#include <duds/general/Spinlock.hpp>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <time.h>
+
+namespace duds { namespace hardware { namespace devices { namespace clocks {
+
+/**
+ * The UUID for the cached clock device.
+ */
+constexpr boost::uuids::uuid CachedClockDeviceId = {
+	0x6e, 0x1f, 0x93, 0xc4,
+	0x0b, 0x57,
+	0x4d, 0x8a,
+	0x9a, 0x31,
+	0xe2, 0x4c, 0x7d, 0x05, 0xb8, 0x6f
+};
+
+/**
+ * Provides the time of another clock without sampling that clock for every
+ * request. The other clock, the source, is sampled once per interval along
+ * with CLOCK_MONOTONIC_RAW. Requests for the time read CLOCK_MONOTONIC_RAW,
+ * which Linux provides through the vDSO without a system call on most
+ * platforms, and add the elapsed time to the last sample from the source.
+ * This is intended for sampling many instruments at a high rate, where
+ * sampling a clock like GenericLinuxClock for each instrument would add a
+ * call to adjtimex() and 128-bit integer math to every sample.
+ *
+ * The elapsed time is scaled by the rate of the source measured between its
+ * last two samples, so a source that is being slewed by NTP or another
+ * time service is followed closely. A measured rate further than
+ * @a MaxDrift from one, which happens when the source is stepped, is not
+ * used. The quality values are copied from the source's sample, and the
+ * accuracy is increased by half the time taken to sample the source plus
+ * @a MaxDrift times the elapsed time. Unspecified quality values remain
+ * unspecified.
+ *
+ * The source is sampled again by the first request that finds the interval
+ * has passed. Other threads making requests at the same time continue to use
+ * the previous sample rather than waiting. Times from before and after a
+ * new source sample may not be monotonic if the source has been adjusted.
+ *
+ * The functions may be called from multiple threads.
+ *
+ * @tparam SVT  Sample value type
+ * @tparam SQT  Sample quality type
+ * @tparam TVT  Time value type; a std::chrono::time_point type such as
+ *              duds::time::interstellar::NanoTime.
+ * @tparam TQT  Time quality type
+ *
+ * @author  Jeff Jackowski
+ */
+template<class SVT, class SQT, class TVT, class TQT>
+class GenericCachedClock :
+public duds::hardware::devices::clocks::GenericClock<SVT, SQT, TVT, TQT> {
+public:
+	typedef duds::data::GenericMeasurement<SVT, SQT, TVT, TQT> Measurement;
+	typedef typename GenericClock<SVT, SQT, TVT, TQT>::ClockSptr  ClockSptr;
+	/**
+	 * The largest difference in rate between CLOCK_MONOTONIC_RAW and the
+	 * source that is assumed when computing the accuracy; 500 parts per
+	 * million, the most the Linux kernel will slew its clock.
+	 */
+	static constexpr double MaxDrift = 500e-6;
+	// the override below would otherwise hide this
+	using GenericClock<SVT, SQT, TVT, TQT>::sampleTime;
+private:
+	using duds::hardware::devices::GenericDevice<SVT, SQT, TVT, TQT>::sens;
+	using duds::hardware::devices::GenericDevice<SVT, SQT, TVT, TQT>::setMeasurement;
+	/**
+	 * A sample from the source clock and when it was taken.
+	 */
+	struct Anchor {
+		/**
+		 * The sample from the source.
+		 */
+		typename Measurement::TimeSample sample;
+		/**
+		 * The value of CLOCK_MONOTONIC_RAW in nanoseconds when @a sample was
+		 * taken; the middle of the time taken to sample the source.
+		 */
+		std::int64_t raw;
+		/**
+		 * Half the time taken to sample the source in nanoseconds.
+		 */
+		std::int64_t halfWidth;
+		/**
+		 * The rate of the source relative to CLOCK_MONOTONIC_RAW.
+		 */
+		double rate;
+	};
+	/**
+	 * The clock that provides the time.
+	 */
+	ClockSptr src;
+	/**
+	 * The most recent sample from the source; protected by @a block.
+	 */
+	Anchor anchor;
+	/**
+	 * The time in nanoseconds between samples of the source.
+	 */
+	std::atomic<std::int64_t> period;
+	/**
+	 * The number of times the source was sampled.
+	 */
+	std::atomic<std::uint64_t> srcSamples;
+	/**
+	 * True while a thread is sampling the source.
+	 */
+	std::atomic<bool> refreshing;
+	/**
+	 * Protects @a anchor.
+	 */
+	mutable duds::general::Spinlock block;
+	/**
+	 * Returns the value of CLOCK_MONOTONIC_RAW in nanoseconds.
+	 */
+	static std::int64_t rawNow() {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+		return (std::int64_t)ts.tv_sec * std::nano::den + ts.tv_nsec;
+	}
+	/**
+	 * Returns a copy of the anchor.
+	 */
+	Anchor current() const {
+		std::lock_guard<duds::general::Spinlock> lock(block);
+		return anchor;
+	}
+	/**
+	 * Samples the source and makes it the new anchor.
+	 */
+	void refresh() {
+		Anchor next;
+		std::int64_t before = rawNow();
+		src->sampleTime(next.sample);
+		std::int64_t after = rawNow();
+		next.raw = before + (after - before) / 2;
+		next.halfWidth = (after - before + 1) / 2;
+		next.rate = 1.0;
+		std::lock_guard<duds::general::Spinlock> lock(block);
+		if (srcSamples.load(std::memory_order_relaxed) &&
+			(next.raw > anchor.raw)
+		) {
+			// the rate of the source over the last interval
+			std::int64_t srcElapsed = std::chrono::duration_cast<
+				std::chrono::duration<std::int64_t, std::nano>
+			>(next.sample.value - anchor.sample.value).count();
+			double rate = (double)srcElapsed / (double)(next.raw - anchor.raw);
+			// ignore a stepped clock
+			if (std::abs(rate - 1.0) <= MaxDrift) {
+				next.rate = rate;
+			}
+		}
+		anchor = next;
+		srcSamples.fetch_add(1, std::memory_order_relaxed);
+	}
+	/**
+	 * Computes the time from an anchor.
+	 * @param time  Where to put the time.
+	 * @param a     The anchor.
+	 * @param now   The present value of CLOCK_MONOTONIC_RAW.
+	 */
+	void interpolate(
+		typename Measurement::TimeSample &time,
+		const Anchor &a,
+		std::int64_t now
+	) const {
+		typedef typename Measurement::TimeSample::Quality Quality;
+		std::int64_t elapsed = now - a.raw;
+		time = a.sample;
+		time.value += std::chrono::duration_cast<typename TVT::duration>(
+			std::chrono::duration<std::int64_t, std::nano>(
+				std::llround(elapsed * a.rate)
+			)
+		);
+		// uncertainty added by not sampling the source now
+		double added = ((double)a.halfWidth + (double)elapsed * MaxDrift) /
+			(double)std::nano::den;
+		if (time.accuracy != duds::data::unspecified<Quality>()) {
+			time.accuracy += (Quality)added;
+		}
+		if (time.estError != duds::data::unspecified<Quality>()) {
+			time.estError += (Quality)(a.halfWidth / (double)std::nano::den);
+		}
+		time.origin = sens[0]->uuid();
+	}
+	struct Token { };
+public:
+	/**
+	 * Constructs a new cached clock device and samples the source.
+	 * @private
+	 */
+	GenericCachedClock(const ClockSptr &source, std::int64_t interval, Token) :
+	GenericClock<SVT, SQT, TVT, TQT>(CachedClockDeviceId), src(source),
+	period(interval), srcSamples(0), refreshing(false) {
+		refresh();
+	}
+	/**
+	 * Makes a new cached clock device.
+	 * @param source    The clock that provides the time, such as a
+	 *                  GenericLinuxClock. It is sampled before this function
+	 *                  returns.
+	 * @param interval  The time between samples of the source.
+	 * @throw ClockError  The source clock failed to provide the time.
+	 */
+	static std::shared_ptr< GenericCachedClock<SVT, SQT, TVT, TQT> > make(
+		const ClockSptr &source,
+		std::chrono::nanoseconds interval = std::chrono::milliseconds(100)
+	) {
+		return std::make_shared< GenericCachedClock<SVT, SQT, TVT, TQT> >(
+			source, interval.count(), Token()
+		);
+	}
+	/**
+	 * Returns the clock that provides the time.
+	 */
+	const ClockSptr &source() const {
+		return src;
+	}
+	/**
+	 * Returns the time between samples of the source.
+	 */
+	std::chrono::nanoseconds interval() const {
+		return std::chrono::nanoseconds(period.load(std::memory_order_relaxed));
+	}
+	/**
+	 * Changes the time between samples of the source. A shorter interval
+	 * keeps the accuracy closer to that of the source at the cost of more
+	 * frequent source samples.
+	 */
+	void interval(std::chrono::nanoseconds i) {
+		period.store(i.count(), std::memory_order_relaxed);
+	}
+	/**
+	 * Returns the number of times the source has been sampled.
+	 */
+	std::uint64_t sourceSamples() const {
+		return srcSamples.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Returns the rate of the source relative to CLOCK_MONOTONIC_RAW used
+	 * for the present interval.
+	 */
+	double rate() const {
+		return current().rate;
+	}
+	/**
+	 * Samples the source now rather than waiting for the interval to pass.
+	 * @throw ClockError  The source clock failed to provide the time.
+	 */
+	void update() {
+		refresh();
+	}
+	virtual void sampleTime(typename Measurement::TimeSample &time) {
+		Anchor a = current();
+		// read after the anchor so the elapsed time is not negative
+		std::int64_t now = rawNow();
+		if (((now - a.raw) >= period.load(std::memory_order_relaxed)) &&
+			!refreshing.exchange(true, std::memory_order_acquire)
+		) {
+			try {
+				refresh();
+			} catch (...) {
+				refreshing.store(false, std::memory_order_release);
+				throw;
+			}
+			refreshing.store(false, std::memory_order_release);
+			a = current();
+			now = rawNow();
+		}
+		interpolate(time, a, now);
+	}
+	virtual void sample() {
+		std::shared_ptr<Measurement> m =
+			std::make_shared<Measurement>();
+		typename Measurement::TimeSample ts;
+		sampleTime(ts);
+		m->measured.origin = ts.origin;
+		m->measured.value = ts.value;
+		m->measured.accuracy = ts.accuracy;
+		m->measured.precision = ts.precision;
+		m->measured.resolution = ts.resolution;
+		m->measured.estError = ts.estError;
+		// no timestamp
+		m->timestamp.clear();
+		// store the measurement
+		setMeasurement(std::move(m));
+	}
+	virtual void sample(const ClockSptr &clock) {
+		std::shared_ptr<Measurement> m =
+			std::make_shared<Measurement>();
+		typename Measurement::TimeSample ts;
+		sampleTime(ts);
+		m->measured.origin = ts.origin;
+		m->measured.value = ts.value;
+		m->measured.accuracy = ts.accuracy;
+		m->measured.precision = ts.precision;
+		m->measured.resolution = ts.resolution;
+		m->measured.estError = ts.estError;
+		// if the supplied clock driver is this clock driver . . .
+		if (this == clock.get()) {
+			// use the same time
+			m->timestamp = ts;
+		} else if (clock) {
+			// sample the other clock
+			clock->sampleTime(m->timestamp);
+		} else {
+			// no timestamp
+			m->timestamp.clear();
+		}
+		// store the measurement
+		setMeasurement(std::move(m));
+	}
+	virtual bool unambiguous() const noexcept {
+		return src->unambiguous();
+	}
+};
+
+/**
+ * General use cached clock driver type.
+ */
+typedef GenericCachedClock<
+	duds::data::GenericValue,
+	double,
+	duds::time::interstellar::NanoTime,
+	float
+>  CachedClock;
+
+typedef std::shared_ptr<CachedClock>  CachedClockSptr;
+
+} } } }
+
+#endif        //  #ifndef CACHEDCLOCK_HPP
@@ -12,6 +12,7 @@
 #include <duds/hardware/display/DisplayErrors.hpp>
 #include <duds/general/ReverseBits.hpp>
 #include <duds/general/YieldingWait.hpp>
+#include <algorithm>
 #include <thread>
 
 namespace duds { namespace hardware { namespace devices { namespace displays {
@@ -184,7 +185,8 @@ void ST7920::initialize() {
 	// defeat image change logic
 	img.clearImage();
 	// output a cleared frame; previous frame will be briefly visible
-	outputFrame(&img);
+	resetDamageSource();
+	outputFrame(&img, nullptr);
 }
 
 void ST7920::off() {
@@ -210,6 +212,8 @@ void ST7920::writeBlock(
 	sendByte(acc, (pos & 0x3F) | 0x80);
 	wait();
 	sendByte(acc, ((pos >> 8) & 0x3F) | 0x80);
+	// two address bytes plus two bytes for each 16-bit value
+	sentBytes(2 + (end - start + 1) * 2);
 	do {
 		// BppImage and the display use the opposite ordering of bits
 		std::uint16_t out = duds::general::ReverseBits(*start);
@@ -221,48 +225,82 @@ void ST7920::writeBlock(
 	} while (start++ != end);
 }
 
-void ST7920::outputFrame(const duds::ui::graphics::BppImage *img) {
-	Access acc;
-	preparePins(acc);
+void ST7920::planFrame(
+	std::vector<Transfer> &plan,
+	const duds::ui::graphics::BppImage &current,
+	const duds::ui::graphics::BppImage &next,
+	const duds::ui::graphics::ImageDamage *dmg
+) {
+	plan.clear();
+	// nothing changed?
+	if (dmg && dmg->empty()) {
+		return;
+	}
 	// width in 16-bit ints
-	int wblk = width() / 16 + (((width() % 16) > 0) ? 1 : 0);
+	int wblk = current.width() / 16 + (((current.width() % 16) > 0) ? 1 : 0);
+	// range of lines to examine
+	int h = 0, hend = current.height();
+	if (dmg) {
+		h = dmg->firstLine();
+		hend = dmg->endLine();
+	}
 	// loop through the images
-	for (int h = 0; h < height(); ++h) {
+	for (; h < hend; ++h) {
+		// range of 16-bit ints to examine on this line
+		int w = 0, wend = wblk;
+		if (dmg) {
+			duds::ui::graphics::ImageDamage::Span span = dmg->line(h);
+			if (span.empty()) {
+				continue;
+			}
+			w = span.left / 16;
+			wend = (span.right + 15) / 16;
+		}
 		// pointers to two-byte ints of image data; display works with 2 bytes
-		std::uint16_t *dpix = (std::uint16_t*)frmbuf.bufferLine(h);     // dest
-		const std::uint16_t *spix = (std::uint16_t*)img->bufferLine(h); // src
-		std::uint16_t *cx = nullptr, *lx; // first and last changed X coordinate
-		int spos; // starting location of change
-		for (int w = 0; w < wblk; ++dpix, ++spix, ++w) {
+		const std::uint16_t *dpix =
+			(const std::uint16_t*)current.bufferLine(h);
+		const std::uint16_t *spix = (const std::uint16_t*)next.bufferLine(h);
+		// index of the first transfer for this line
+		std::size_t lineStart = plan.size();
+		for (; w < wend; ++w) {
 			// find differences between frame buffer and new image
-			if (*dpix != *spix) {
-				// record new value
-				*dpix = *spix;
-				// no change pending?
-				if (!cx) {
-					// mark this change
-					cx = lx = dpix;
-					spos = w;
-				}
-				// more than 1 spot (two bytes) since last change?
-				else if (lx < (dpix - 1)) {
-					// send pending change
-					writeBlock(acc, cx, lx, h | (spos << 8));
-					// mark new change
-					cx = lx = dpix;
-					spos = w;
-				}
-				// add to pending change
-				else {
-					lx = dpix;
+			if (dpix[w] != spix[w]) {
+				// close enough to the last change on this line to merge?
+				if (
+					(plan.size() > lineStart) &&
+					((w - plan.back().last - 1) <= maxMergeGap)
+				) {
+					plan.back().last = w;
+				} else {
+					plan.push_back(Transfer {
+						(std::uint8_t)h, (std::uint8_t)w, (std::uint8_t)w
+					});
 				}
 			}
 		}
-		// have pending change?
-		if (cx) {
-			// send pending change
-			writeBlock(acc, cx, lx, h | (spos << 8));
-		}
+	}
+}
+
+void ST7920::sendPlan(const duds::ui::graphics::BppImage *img) {
+	Access acc;
+	preparePins(acc);
+	for (const Transfer &t : plan) {
+		const std::uint16_t *src =
+			(const std::uint16_t*)img->bufferLine(t.line);
+		writeBlock(acc, src + t.first, src + t.last, t.line | (t.first << 8));
+		// the display has the data; record it in the frame buffer
+		std::uint16_t *dest = (std::uint16_t*)frmbuf.bufferLine(t.line);
+		std::copy(src + t.first, src + t.last + 1, dest + t.first);
+	}
+}
+
+void ST7920::outputFrame(
+	const duds::ui::graphics::BppImage *img,
+	const duds::ui::graphics::ImageDamage *dmg
+) {
+	planFrame(plan, frmbuf, *img, dmg);
+	if (!plan.empty()) {
+		sendPlan(img);
 	}
 }
 
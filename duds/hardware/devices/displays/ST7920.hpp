@@ -40,6 +40,44 @@ namespace duds { namespace hardware { namespace devices { namespace displays {
  * @author  Jeff Jackowski
  */
 class ST7920 : public duds::hardware::display::BppGraphicDisplay {
+public:
+	enum {
+		/**
+		 * The number of bytes sent to set the address before writing a block
+		 * of pixel data.
+		 */
+		addressBytes = 2,
+		/**
+		 * The number of bytes sent for each 16 pixel wide word of pixel data.
+		 */
+		wordBytes = 2,
+		/**
+		 * The largest number of unchanged words between two changed runs on the
+		 * same line that will be resent rather than sending a new address.
+		 * The display increments its horizontal address after each word, so
+		 * resending unchanged words is no more costly than setting the address
+		 * when it takes no more bytes.
+		 */
+		maxMergeGap = addressBytes / wordBytes
+	};
+	/**
+	 * A contiguous run of 16-bit words on one line to send to the display.
+	 */
+	struct Transfer {
+		/**
+		 * The line, or Y coordinate.
+		 */
+		std::uint8_t line;
+		/**
+		 * The first word to send.
+		 */
+		std::uint8_t first;
+		/**
+		 * The last word to send; may be the same as @a first.
+		 */
+		std::uint8_t last;
+	};
+private:
 	/**
 	 * Represents the 5 output lines, other than enable, that are needed to
 	 * communicate with the LCD. The pins are, in order:
@@ -92,6 +130,11 @@ class ST7920 : public duds::hardware::display::BppGraphicDisplay {
 		 */
 		nibbleFlag = 0x400
 	};
+	/**
+	 * The transfers required to update the display with the next frame.
+	 * Kept as a member to avoid allocating memory for each frame.
+	 */
+	std::vector<Transfer> plan;
 	/**
 	 * Waits until the time in @a soonestSend has passed. This is used to assure
 	 * that the display isn't sent data too rapidly while allowing the thread
@@ -158,13 +201,49 @@ class ST7920 : public duds::hardware::display::BppGraphicDisplay {
 		const std::uint16_t *end,
 		int pos
 	);
+	/**
+	 * Sends all the transfers in @a plan to the display using a single
+	 * access to the pins. The pixel data is taken from @a img, and each
+	 * transfer is copied into @a frmbuf only after it has been sent, so
+	 * @a frmbuf never holds pixels the display did not receive.
+	 * @param img  The new image to show.
+	 */
+	void sendPlan(const duds::ui::graphics::BppImage *img);
 	/**
 	 * Writes out only the changed portions of the image to the display, and
-	 * updates the image in @a frmbuf to match.
+	 * updates the image in @a frmbuf to match. The changes are planned with
+	 * planFrame() before any access to the display's pins is requested.
+	 * If sending fails, @a frmbuf keeps the old contents of the parts that
+	 * were not sent, so they will be sent with the next frame.
 	 * @param img  The new image to show.
+	 * @param dmg  The parts of @a img that may have changed, or nullptr to
+	 *             compare the whole image with @a frmbuf.
 	 */
-	virtual void outputFrame(const duds::ui::graphics::BppImage *img);
+	virtual void outputFrame(
+		const duds::ui::graphics::BppImage *img,
+		const duds::ui::graphics::ImageDamage *dmg
+	);
 public:
+	/**
+	 * Finds the differences between two images and stores the transfers
+	 * needed to send them to the display in @a plan. Changed runs on the same
+	 * line are merged when resending the unchanged words between them costs
+	 * no more than sending another address; see @a maxMergeGap. This does
+	 * not communicate with the display.
+	 * @param plan     Where to put the transfers. Any previous contents are
+	 *                 removed.
+	 * @param current  The image shown on the display.
+	 * @param next     The new image to show. It must have the same
+	 *                 dimensions as @a current.
+	 * @param dmg      The parts of @a next that may differ from @a current,
+	 *                 or nullptr to compare the whole image.
+	 */
+	static void planFrame(
+		std::vector<Transfer> &plan,
+		const duds::ui::graphics::BppImage &current,
+		const duds::ui::graphics::BppImage &next,
+		const duds::ui::graphics::ImageDamage *dmg
+	);
 	/**
 	 * Initializes the object with an invalid display size and no pins to use.
 	 */
@@ -31,9 +31,61 @@ void SimulatedBppDisplay::configure(const duds::ui::graphics::ImageDimensions &i
 	}
 	frmbuf.resize(id);
 	bottom = false;
+	resetDamageSource();
 }
 
-void SimulatedBppDisplay::outputFrame(const duds::ui::graphics::BppImage *img) {
+void SimulatedBppDisplay::outputLine(
+	const duds::ui::graphics::BppImage *img,
+	int h
+) {
+	// start border
+	std::cout << '|';
+	// initialize pointer to the start of the line
+	const duds::ui::graphics::BppImage::PixelBlock *pb = img->bufferLine(h);
+	// setup the mask for the bit to check
+	duds::ui::graphics::BppImage::PixelBlock mask = 1;
+	// go through the whole width
+	for (int w = width(); w > 0; --w) {
+		// check for set pixel
+		if (*pb & mask) {
+			std::cout << 'X';
+		} else {
+			std::cout << ' ';
+		}
+		// advance to next pixel
+		mask <<= 1;
+		// gone past the end of the pixel block?
+		if (!mask) {
+			// advance to the next block
+			mask = 1;
+			++pb;
+		}
+	}
+	// end border
+	std::cout << "|\n";
+	// count as if sent to a display that takes whole bytes of pixels
+	sentBytes((width() + 7) / 8);
+}
+
+void SimulatedBppDisplay::outputFrame(
+	const duds::ui::graphics::BppImage *img,
+	const duds::ui::graphics::ImageDamage *dmg
+) {
+	frmbuf = *img;
+	// only redraw damaged lines if the whole frame is already shown
+	if (dmg && bottom) {
+		for (int h = dmg->firstLine(); h < dmg->endLine(); ++h) {
+			if (dmg->lineDamaged(h)) {
+				// move cursor up from below the frame to the line
+				std::cout << "\033[" << height() + 1 - h << 'A';
+				outputLine(img, h);
+				// return to below the frame
+				std::cout << "\033[" << height() - h << 'B';
+			}
+		}
+		std::cout.flush();
+		return;
+	}
 	if (bottom) {
 		// return cursor to top
 		std::cout << "\033[" << height() + 2 << 'A';
@@ -47,31 +99,7 @@ void SimulatedBppDisplay::outputFrame(const duds::ui::graphics::BppImage *img) {
 	std::cout << "*\n";
 	// output image
 	for (int h = 0; h < height(); ++h) {
-		// start border
-		std::cout << '|';
-		// initialize pointer to the start of the line
-		const duds::ui::graphics::BppImage::PixelBlock *pb = img->bufferLine(h);
-		// setup the mask for the bit to check
-		duds::ui::graphics::BppImage::PixelBlock mask = 1;
-		// go through the whole width
-		for (int w = width(); w > 0; --w) {
-			// check for set pixel
-			if (*pb & mask) {
-				std::cout << 'X';
-			} else {
-				std::cout << ' ';
-			}
-			// advance to next pixel
-			mask <<= 1;
-			// gone past the end of the pixel block?
-			if (!mask) {
-				// advance to the next block
-				mask = 1;
-				++pb;
-			}
-		}
-		// end border
-		std::cout << "|\n";
+		outputLine(img, h);
 	}
 	// output border
 	std::cout << '*';
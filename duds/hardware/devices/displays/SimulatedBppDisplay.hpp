@@ -24,11 +24,23 @@ class SimulatedBppDisplay : public duds::hardware::display::BppGraphicDisplay {
 	 */
 	bool bottom = false;
 	/**
-	 * Writes out only the changed portions of the image to the display, and
-	 * updates the image in @a frmbuf to match.
+	 * Writes out a single line of the image, including the side borders.
+	 * @param img  The image to show.
+	 * @param h    The line to write.
+	 */
+	void outputLine(const duds::ui::graphics::BppImage *img, int h);
+	/**
+	 * Writes out the image to the terminal, and updates the image in
+	 * @a frmbuf to match. The whole frame is drawn unless damage information
+	 * is provided and a frame has already been drawn; in that case only the
+	 * damaged lines are redrawn.
 	 * @param img  The new image to show.
+	 * @param dmg  The parts of @a img that may have changed, or nullptr.
 	 */
-	virtual void outputFrame(const duds::ui::graphics::BppImage *img);
+	virtual void outputFrame(
+		const duds::ui::graphics::BppImage *img,
+		const duds::ui::graphics::ImageDamage *dmg
+	);
 public:
 	/**
 	 * Creates the object with an invalid display size.
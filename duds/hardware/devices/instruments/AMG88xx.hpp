@@ -8,7 +8,7 @@
  * Copyright (C) 2018  Jeff Jackowski
  */
 #include <duds/hardware/interface/I2c.hpp>
-#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
 #include <duds/data/Quantity.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
@@ -49,9 +49,26 @@ class AMG88xx : boost::noncopyable {
 	 */
 	std::unique_ptr<duds::hardware::interface::I2c> com;
 	/**
-	 * Used to read in sampled data from the device.
+	 * The thermistor temperature; 12-bit signed magnitude.
 	 */
-	duds::hardware::interface::Conversation read;
+	typedef duds::hardware::interface::Register<0x0E, 2>  Thermistor;
+	/**
+	 * The pixel temperatures; 12-bit two's complement.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::RegisterField<
+			duds::hardware::interface::Register<0x80, 2>, 0, 12, true
+		>,
+		64
+	>  Pixels;
+	/**
+	 * Used to read in the thermistor temperature from the device.
+	 */
+	duds::hardware::interface::RegisterRead<Thermistor> readTherm;
+	/**
+	 * Used to read in the temperature image from the device.
+	 */
+	duds::hardware::interface::RegisterRead<Pixels> readImg;
 	/**
 	 * Temperature image.
 	 */
@@ -86,7 +86,7 @@ using namespace FXOS8700CQ_internal;
 // Device uses big-endian data unaligned to address value
 
 FXOS8700CQ::FXOS8700CQ(std::unique_ptr<duds::hardware::interface::I2c> &i2ccom) :
-com(std::move(i2ccom)), datarate(0) {
+com(std::move(i2ccom)), fifolen(0), overflow(false), datarate(0) {
 	try {
 		duds::hardware::interface::Conversation firstcon;
 		// verify ID
@@ -160,6 +160,10 @@ void FXOS8700CQ::configure(
 	) {
 		DUDS_THROW_EXCEPTION(FXOS8700CQBadMagnitude());
 	}
+	// the watermark field has room for more samples than the FIFO can hold
+	if (settings.fifo && (settings.fifoWatermark > FifoDepth)) {
+		DUDS_THROW_EXCEPTION(FXOS8700CQBadWatermark());
+	}
 	{ // sample rate configuration
 		float f = freq;
 		// the update rate is halved when both the accelerometer and
@@ -238,49 +242,23 @@ void FXOS8700CQ::configure(
 	*/
 	conv.clear();
 
-	// no FIFO
+	// FIFO off; also empties the FIFO
 	conv.addOutputVector() <<
 		(std::uint8_t)(RegFifoConfig) << (std::uint8_t)0;
 	com->converse(conv);
-
-	cfg = settings;
-	// make the conversation to read in the device's sample data
-	bufq.clear();
-	if (settings.magnetometer) {
-		bufq.addOutputVector() << (std::uint8_t)RegMagStatus;
+	conv.clear();
+	if (settings.fifo && settings.accelerometer) {
+		// circular mode; the new sample overwrites the oldest when full
+		conv.addOutputVector() << (std::uint8_t)(RegFifoConfig) <<
+			(std::uint8_t)(0x40 | settings.fifoWatermark);
+		com->converse(conv);
 	} else {
-		bufq.addOutputVector() << (std::uint8_t)RegStatus;
+		settings.fifo = 0;
 	}
-	bufq.addInputVector(1);
+	fifolen = 0;
+	overflow = false;
 
-	input.clear();
-	if (settings.magnetometer) {
-		// prefer to read from the magnetometer side to get the "time aligned"
-		// accelerometer sample, because that sounds nice, like it might mean
-		// something useful
-		input.addOutputVector() << (std::uint8_t)RegMagSample;
-		if (settings.accelerometer) {
-			input.addInputVector(12).bigEndian(true);
-		} else {
-			input.addInputVector(6).bigEndian(true);
-		}
-	} else {
-		input.addOutputVector() << (std::uint8_t)(RegSamples);
-		input.addInputVector(6).bigEndian(true);
-	}
-	/*
-	if (settings.accelerometer) {
-		input.addOutputVector() << (std::uint8_t)(RegSamples);
-		if (settings.magnetometer) {
-			input.addInputVector(12).bigEndian(true);
-		} else {
-			input.addInputVector(6).bigEndian(true);
-		}
-	} else {
-		input.addOutputVector() << (std::uint8_t)(RegMagSample);
-		input.addInputVector(6).bigEndian(true);
-	}
-	*/
+	cfg = settings;
 }
 
 void FXOS8700CQ::start() {
@@ -326,42 +304,86 @@ void FXOS8700CQ::suspend() {
 }
 
 bool FXOS8700CQ::sample() {
-	com->converse(bufq);
-	duds::hardware::interface::ConversationExtractor ex(bufq);
-	std::int8_t status;
-	ex >> status;
-	// have new samples for all axes?
-	if ((status & 7) == 7) {
-		// read them
-		com->converse(input);
-		// parse input
-		duds::hardware::interface::ConversationExtractor ex(input);
-		if (cfg.magnetometer) {
-			ex >> magn.x >> magn.y >> magn.z;
+	bool res = false;
+	if (cfg.fifo) {
+		if (sampleFifo()) {
+			accl = fifo[fifolen - 1].accl;
+			res = true;
 		}
-		if (cfg.accelerometer) {
-			ex >> accl.x >> accl.y >> accl.z;
-			// accelerometer data is read from different registers depending
-			// on the use of the magnetometer
-			if (cfg.magnetometer) {
-				// the 2 MSb's may not be set properly for a 16-bit signed int
-				accl.x = duds::general::SignExtend<14>(accl.x);
-				accl.y = duds::general::SignExtend<14>(accl.y);
-				accl.z = duds::general::SignExtend<14>(accl.z);
+	} else if (!cfg.magnetometer) {
+		fifoq.converse(*com);
+		// have new samples for all axes?
+		if ((fifoq.get() & 7) == 7) {
+			accin.converse(*com);
+			for (int a = 0; a < 3; ++a) {
+				// 14-bit samples are left justified
+				accl.vals[a] = accin.get<AccelSample>(a) >> 2;
+			}
+			return true;
+		}
+		return false;
+	}
+	if (cfg.magnetometer) {
+		magq.converse(*com);
+		// have new samples for all axes?
+		if ((magq.get() & 7) == 7) {
+			// prefer to read from the magnetometer side to get the "time
+			// aligned" accelerometer sample, because that sounds nice, like it
+			// might mean something useful
+			if (cfg.accelerometer && !cfg.fifo) {
+				bothin.converse(*com);
+				for (int a = 0; a < 3; ++a) {
+					magn.vals[a] = bothin.get<MagSample>(a);
+					accl.vals[a] = bothin.get<AlignedAccelSample>(a);
+				}
 			} else {
-				// the registers hold the number shifted so that the 8 most
-				// significant bits are all in the same byte, leaving 2 bits
-				// in the least significant byte unused; shift them to place
-				// properly in 16-bit ints
-				accl.x >>= 2;
-				accl.y >>= 2;
-				accl.z >>= 2;
+				magin.converse(*com);
+				for (int a = 0; a < 3; ++a) {
+					magn.vals[a] = magin.get<MagSample>(a);
+				}
 			}
+			res = true;
 		}
-		return true;
 	}
-	return false;
+	return res;
 }
 
+std::size_t FXOS8700CQ::sampleFifo() {
+	fifolen = 0;
+	if (!cfg.fifo) {
+		return 0;
+	}
+	duds::time::interstellar::NanoTime qtime =
+		duds::time::interstellar::NanoClock::now();
+	fifoq.converse(*com);
+	overflow = fifoq.get<FifoOverflow>();
+	std::size_t count = fifoq.get<FifoCount>();
+	if (!count) {
+		return 0;
+	}
+	// When the FIFO is enabled, the address wraps from the end of the
+	// accelerometer sample back to its start at RegSamples rather than
+	// continuing on to the magnetometer, so all buffered samples are read in
+	// one burst. Samples taken during the read are left for the next call.
+	fifoin.clear();
+	fifoin.addOutput({ (std::uint8_t)RegSamples });
+	const char *data = fifoin.addInput(count * 6);
+	com->converse(fifoin);
+	// the newest sample was taken sometime in the period before the query
+	duds::time::interstellar::Nanoseconds period(
+		(std::uint64_t)(1e9 / datarate)
+	);
+	qtime = qtime - period / 2 - period * (count - 1);
+	for (std::size_t idx = 0; idx < count; ++idx, data += 6) {
+		FifoSample &fs = fifo[idx];
+		for (int a = 0; a < 3; ++a) {
+			// 14-bit samples are left justified
+			fs.accl.vals[a] = AccelSample::decode(data, a) >> 2;
+		}
+		fs.time = qtime;
+		qtime = qtime + period;
+	}
+	return fifolen = count;
+}
 
 } } } }
@@ -9,8 +9,10 @@
  */
 #include <duds/hardware/interface/I2c.hpp>
 #include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
 #include <duds/hardware/devices/DeviceErrors.hpp>
 #include <duds/data/QuantityArray.hpp>
+#include <duds/time/interstellar/Interstellar.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
 
@@ -31,6 +33,11 @@ struct FXOS8700CQBadMagnitude : FXOS8700CQError { };
  * be used.
  */
 struct FXOS8700CQNoInsturment : FXOS8700CQError { };
+/**
+ * The requested FIFO watermark is greater than the number of samples the
+ * FIFO can hold.
+ */
+struct FXOS8700CQBadWatermark : FXOS8700CQError { };
 
 typedef boost::error_info<struct Info_UpdateRate, float>  RequestedUpdateRate;
 
@@ -151,21 +158,139 @@ public:
 		 * @todo  Implement a thread for reading.
 		 */
 		unsigned int threadedSample        : 1;
+		/**
+		 * Buffer accelerometer samples in the device's FIFO using its
+		 * circular mode. The buffered samples are read together by
+		 * sampleFifo(). The magnetometer is not buffered.
+		 */
+		unsigned int fifo                  : 1;
+		/**
+		 * The number of buffered samples that will set the FIFO watermark
+		 * flag, and its interrupt if the device is so configured. Zero
+		 * disables the flag. Only used along with @a fifo. The field can
+		 * hold values larger than FifoDepth, but configure() will reject
+		 * them.
+		 */
+		unsigned int fifoWatermark         : 6;
+	};
+	/**
+	 * The number of samples the device's FIFO can hold.
+	 */
+	static constexpr std::size_t FifoDepth = 32;
+	/**
+	 * An accelerometer sample read from the FIFO along with an estimate of
+	 * when it was taken.
+	 */
+	struct FifoSample {
+		/**
+		 * The accelerometer data, shifted like the data from
+		 * rawAccelerometer().
+		 */
+		RawSample accl;
+		/**
+		 * The estimated time the sample was taken. It is computed from the
+		 * time the FIFO was queried and the configured data rate, so it is
+		 * only as accurate as the device's own clock.
+		 */
+		duds::time::interstellar::NanoTime time;
 	};
 private:
 	/**
 	 * The I2C communication interface.
 	 */
 	std::unique_ptr<duds::hardware::interface::I2c> com;
+	/**
+	 * The FIFO status register, F_STATUS. It replaces the data status
+	 * register when the FIFO is enabled.
+	 */
+	typedef duds::hardware::interface::Register<0>  FifoStatus;
+	/**
+	 * The number of unread samples in the FIFO, 0 to 32.
+	 */
+	typedef duds::hardware::interface::RegisterField<FifoStatus, 0, 6>
+		FifoCount;
+	/**
+	 * Set when the FIFO was full and a sample was overwritten.
+	 */
+	typedef duds::hardware::interface::RegisterField<FifoStatus, 7, 1>
+		FifoOverflow;
+	/**
+	 * An accelerometer sample; the 14-bit values are left justified.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::Register<1, 2, true, true>, 3
+	>  AccelSample;
+	/**
+	 * The magnetometer data status register, M_DR_STATUS.
+	 */
+	typedef duds::hardware::interface::Register<0x32>  MagStatus;
+	/**
+	 * The latest magnetometer sample.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::Register<0x33, 2, true, true>, 3
+	>  MagSample;
+	/**
+	 * The accelerometer sample that follows the magnetometer sample. Unlike
+	 * AccelSample, the 14-bit values are right justified.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::RegisterField<
+			duds::hardware::interface::Register<0x39, 2, true>, 0, 14, true
+		>, 3
+	>  AlignedAccelSample;
+	/**
+	 * A magnetometer sample followed by the accelerometer sample taken with
+	 * it.
+	 */
+	typedef duds::hardware::interface::RegisterBurst<
+		MagSample, AlignedAccelSample
+	>  MagAccelSample;
+	/**
+	 * Reads the STATUS register. It holds the FIFO status when the FIFO is
+	 * used, and the accelerometer data status otherwise.
+	 */
+	duds::hardware::interface::RegisterRead<FifoStatus> fifoq;
+	/**
+	 * Reads the magnetometer data status.
+	 */
+	duds::hardware::interface::RegisterRead<MagStatus> magq;
+	/**
+	 * Reads a sample when only the accelerometer is used.
+	 */
+	duds::hardware::interface::RegisterRead<AccelSample> accin;
+	/**
+	 * Reads a magnetometer sample when the accelerometer is not used or its
+	 * samples come from the FIFO.
+	 */
+	duds::hardware::interface::RegisterRead<MagSample> magin;
+	/**
+	 * Reads a sample when both instruments are used without the FIFO.
+	 */
+	duds::hardware::interface::RegisterRead<MagAccelSample> bothin;
+	/**
+	 * Reads all the samples in the FIFO with one burst; rebuilt for the
+	 * number of samples on each use.
+	 */
+	duds::hardware::interface::FixedConversation<FifoDepth * 6 + 1, 2>
+		fifoin;
+	/**
+	 * The samples read by the last call to sampleFifo().
+	 */
+	FifoSample fifo[FifoDepth];
+	/**
+	 * The number of samples in @a fifo.
+	 */
+	std::size_t fifolen;
+	/**
+	 * True if the FIFO overflowed prior to the last call to sampleFifo().
+	 */
+	bool overflow;
 	/**
 	 * The conversation used to initialize the device. It is created in init()
 	 * and held for later use by resume().
 	 */
 	duds::hardware::interface::Conversation initialize;
-	/**
-	 * The conversation used to read in samples from the device.
-	 */
-	duds::hardware::interface::Conversation input, bufq;
 	/**
 	 * The values supplied by the device.
 	 */
@@ -211,6 +336,8 @@ public:
 	 * @throw FXOS8700CQBadMagnitude  The requested maximum magnetude for the
 	 *                                accelerometer is either not supported or
 	 *                                an invalid value.
+	 * @throw FXOS8700CQBadWatermark  The FIFO is requested with a watermark
+	 *                                greater than FifoDepth.
 	 * @throw FXOS8700CQBadDataRate
 	 */
 	void configure(float freq, Settings settings);
@@ -236,10 +363,42 @@ public:
 		start();
 	}
 	/**
-	 * Reads sampled data from the device.
+	 * Reads sampled data from the device. If the FIFO is in use, this calls
+	 * sampleFifo() and keeps the newest accelerometer sample, then reads the
+	 * magnetometer if it is in use and has a new sample.
 	 * @return  True if the device had new data.
 	 */
 	bool sample();
+	/**
+	 * Reads all the accelerometer samples buffered in the device's FIFO using
+	 * one query of the FIFO's status and one burst read of the samples. This
+	 * allows reading the device once for up to 32 samples rather than for
+	 * each sample. The samples are given times spaced by the sample period,
+	 * with the newest sample half a period before the FIFO status was read.
+	 * @pre     configure() was called with the @a fifo setting.
+	 * @return  The number of samples read; the same as fifoSize().
+	 */
+	std::size_t sampleFifo();
+	/**
+	 * Returns the samples read by the last call to sampleFifo(), oldest
+	 * first.
+	 */
+	const FifoSample *fifoSamples() const {
+		return fifo;
+	}
+	/**
+	 * Returns the number of samples read by the last call to sampleFifo().
+	 */
+	std::size_t fifoSize() const {
+		return fifolen;
+	}
+	/**
+	 * True if the FIFO was full and lost samples prior to the last call to
+	 * sampleFifo(). This means the FIFO is not being read often enough.
+	 */
+	bool fifoOverflow() const {
+		return overflow;
+	}
 	/**
 	 * Returns the confiured sampling rate. The value will be zero if
 	 * configure() has not yet been called, or if it failed.
@@ -9,58 +9,42 @@
  */
 #include <duds/hardware/devices/instruments/ISL29125.hpp>
 #include <duds/hardware/devices/DeviceErrors.hpp>
-#include <duds/hardware/interface/ConversationExtractor.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
 
 ISL29125::ISL29125(std::unique_ptr<duds::hardware::interface::I2c> &c) :
-com(std::move(c)) {
-	// make conversation to read input so it can be reused
-	// address -- green
-	input.addOutputVector() << (std::int8_t)9;
-	// read in 6 bytes
-	input.addInputVector(6);
-}
+com(std::move(c)) { }
 
 ISL29125::~ISL29125() {
 	suspend();
 }
 
 void ISL29125::init(bool wide) {
-	// remake the initialization conversation
-	initialize.clear();
-	initialize.addOutputVector() <<
-		// address -- config
-		(std::int8_t)1 <<
-		// config byte -- run, set range
-		(std::int8_t)(0x5 | (wide ? 0x8 : 0));
-	com->converse(initialize);
+	// run, set range
+	initialize.set<Mode>(5).set<Range>(wide);
+	initialize.converse(*com);
 }
 
 void ISL29125::suspend() {
-	duds::hardware::interface::Conversation conv;
-	conv.addOutputVector() <<
-		// address -- config
-		(std::int8_t)1 <<
-		// config byte -- stop
-		(std::int8_t)0;
-	com->converse(conv);
+	duds::hardware::interface::RegisterWrite<Config1> conv;
+	// stop
+	conv.converse(*com);
 }
 
 void ISL29125::resume() {
-	if (initialize.empty()) {
+	if (initialize.get<Mode>() == 0) {
 		DUDS_THROW_EXCEPTION(DeviceUninitalized());
 	}
-	com->converse(initialize);
+	initialize.converse(*com);
 }
 
 void ISL29125::sample() {
 	// get input
-	com->converse(input);
-	// parse input
-	duds::hardware::interface::ConversationExtractor ex(input);
+	input.converse(*com);
 	// the device uses a peculiar ordering
-	ex >> g >> r >> b;
+	g = input.get<Green>();
+	r = input.get<Red>();
+	b = input.get<Blue>();
 }
 
 } } } }
@@ -11,7 +11,7 @@
 #define ISL29125_HPP
 
 #include <duds/hardware/interface/I2c.hpp>
-#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
 
@@ -26,14 +26,40 @@ class ISL29125 : boost::noncopyable {
 	 * The I2C communication interface.
 	 */
 	std::unique_ptr<duds::hardware::interface::I2c> com;
+	/**
+	 * The first configuration register.
+	 */
+	typedef duds::hardware::interface::Register<1>  Config1;
+	/**
+	 * The operating mode; 0 is off, 5 samples all colors.
+	 */
+	typedef duds::hardware::interface::RegisterField<Config1, 0, 3>  Mode;
+	/**
+	 * Set for the wide range (10000 lux), clear for 375 lux.
+	 */
+	typedef duds::hardware::interface::RegisterField<Config1, 3, 1>  Range;
+	/**
+	 * The green sample.
+	 */
+	typedef duds::hardware::interface::Register<9, 2>  Green;
+	/**
+	 * The red sample.
+	 */
+	typedef duds::hardware::interface::Register<0xB, 2>  Red;
+	/**
+	 * The blue sample.
+	 */
+	typedef duds::hardware::interface::Register<0xD, 2>  Blue;
 	/**
 	 * Output used to initialize the device.
 	 */
-	duds::hardware::interface::Conversation initialize;
+	duds::hardware::interface::RegisterWrite<Config1> initialize;
 	/**
 	 * Used to read in the sampled data.
 	 */
-	duds::hardware::interface::Conversation input;
+	duds::hardware::interface::RegisterRead<
+		duds::hardware::interface::RegisterBurst<Green, Red, Blue>
+	> input;
 	/**
 	 * Red brightness.
 	 */
@@ -59,6 +59,12 @@ enum AccelGyroRegs {
 	AgrFifoStatus            /**< FIFO_SRC */
 };
 
+/**
+ * FIFO_CTRL value for continuous mode; the new sample overwrites the oldest
+ * when full. The threshold is placed in the lower 5 bits.
+ */
+constexpr std::uint8_t FifoModeContinuous = 0xC0;
+
 /**
  * The registers for the magnetometer device.
  * They have been renamed to be more readable, understandable, and consistent
@@ -187,7 +193,7 @@ using namespace LSM9DS1_internal;
 
 LSM9DS1AccelGyro::LSM9DS1AccelGyro(
 	std::unique_ptr<duds::hardware::interface::I2c> &i2c
-) : agcom(std::move(i2c)), agdatarate(0)
+) : agcom(std::move(i2c)), fifolen(0), overrun(false), agdatarate(0)
 {
 	try {
 		duds::hardware::interface::Conversation firstcon;
@@ -273,7 +279,11 @@ void LSM9DS1AccelGyro::configure(float freq, Settings settings) {
 	duds::hardware::interface::Conversation conv;
 	// start with accel/gyro; in power-down state after suspend()
 	if (settings.accelerometer) {
-		// no FIFO; already done by reset
+		// FIFO to bypass mode; also empties the FIFO
+		conv.addOutputVector() << (std::uint8_t)AgrFifoConfig <<
+			(std::uint8_t)0;
+		agcom->converse(conv);
+		conv.clear();
 		// config gyro
 		std::uint8_t tmpregs[3] = {
 			(std::uint8_t)((agdrval << 5) | settings.gyroRange),
@@ -292,31 +302,23 @@ void LSM9DS1AccelGyro::configure(float freq, Settings settings) {
 		conv.addOutputVector() << (std::uint8_t)AgrAccelConfig6 << tmpregs[0];
 		agcom->converse(conv);
 		conv.clear();
-		// gyro sleep
-		if (!settings.gyroscope) {
-			conv.addOutputVector() << (std::uint8_t)AgrConfig9 <<
-				(std::uint8_t)0x40;
+		// gyro sleep & FIFO enable
+		conv.addOutputVector() << (std::uint8_t)AgrConfig9 << (std::uint8_t)(
+			(settings.gyroscope ? 0 : 0x40) | (settings.fifo ? 2 : 0)
+		);
+		agcom->converse(conv);
+		conv.clear();
+		if (settings.fifo) {
+			conv.addOutputVector() << (std::uint8_t)AgrFifoConfig <<
+				(std::uint8_t)(FifoModeContinuous | settings.fifoThreshold);
 			agcom->converse(conv);
 			conv.clear();
 		}
 	}
+	fifolen = 0;
+	overrun = false;
 	cfg = settings;
 
-	// make the conversation to read in the device's status
-	statq.clear();
-	statq.addOutputVector() << (std::uint8_t)AgrStatusPreAccel;
-	statq.addInputVector(1);
-	// conversation to read accelerometer and gyroscope samples
-	agsample.clear();
-	if (settings.accelerometer) {
-		if (settings.gyroscope) {
-			agsample.addOutputVector() << (std::uint8_t)AgrGyroSampleX;
-			agsample.addInputVector(12);
-		} else {
-			agsample.addOutputVector() << (std::uint8_t)AgrAccelSampleX;
-			agsample.addInputVector(6);
-		}
-	}
 }
 
 void LSM9DS1AccelGyro::suspend() {
@@ -331,24 +333,82 @@ void LSM9DS1AccelGyro::suspend() {
 }
 
 bool LSM9DS1AccelGyro::sample() {
+	if (cfg.fifo) {
+		if (sampleFifo()) {
+			accl = fifo[fifolen - 1].accl;
+			gyro = fifo[fifolen - 1].gyro;
+			return true;
+		}
+		return false;
+	}
 	if (cfg.accelerometer) {
-		agcom->converse(statq);
-		duds::hardware::interface::ConversationExtractor ex(statq);
-		std::int8_t status;
-		ex >> status;
-		if (status & 3) {
-			agcom->converse(agsample);
-			ex.reset(agsample);
+		statq.converse(*agcom);
+		if (statq.get() & 3) {
 			if (cfg.gyroscope) {
-				ex >> gyro.x >> gyro.y >> gyro.z;
+				agsample.converse(*agcom);
+				for (int a = 0; a < 3; ++a) {
+					gyro.vals[a] = agsample.get<GyroAccelSample>(a);
+					accl.vals[a] = agsample.get<GyroAccelSample>(a + 3);
+				}
+			} else {
+				asample.converse(*agcom);
+				for (int a = 0; a < 3; ++a) {
+					accl.vals[a] = asample.get<AccelSample>(a);
+				}
 			}
-			ex >> accl.x >> accl.y >> accl.z;
 			return true;
 		}
 	}
 	return false;
 }
 
+std::size_t LSM9DS1AccelGyro::sampleFifo() {
+	fifolen = 0;
+	if (!cfg.accelerometer || !cfg.fifo) {
+		return 0;
+	}
+	duds::time::interstellar::NanoTime qtime =
+		duds::time::interstellar::NanoClock::now();
+	fifoq.converse(*agcom);
+	overrun = fifoq.get<FifoOverrun>();
+	std::size_t count = fifoq.get<FifoCount>();
+	if (!count) {
+		return 0;
+	}
+	// The address wraps around to the start of the sample after the last
+	// accelerometer register when the FIFO is enabled, so all buffered
+	// samples are read in one burst. Samples taken during the read are left
+	// for the next call.
+	std::size_t ssize = cfg.gyroscope ? 12 : 6;
+	fifoin.clear();
+	fifoin.addOutput({
+		(std::uint8_t)(cfg.gyroscope ? AgrGyroSampleX : AgrAccelSampleX)
+	});
+	const char *data = fifoin.addInput(count * ssize);
+	agcom->converse(fifoin);
+	// the newest sample was taken sometime in the period before the query
+	duds::time::interstellar::Nanoseconds period(
+		(std::uint64_t)(1e9 / agdatarate)
+	);
+	qtime = qtime - period / 2 - period * (count - 1);
+	for (std::size_t idx = 0; idx < count; ++idx, data += ssize) {
+		FifoSample &fs = fifo[idx];
+		if (cfg.gyroscope) {
+			for (int a = 0; a < 3; ++a) {
+				fs.gyro.vals[a] = GyroAccelSample::decode(data, a);
+				fs.accl.vals[a] = GyroAccelSample::decode(data, a + 3);
+			}
+		} else {
+			for (int a = 0; a < 3; ++a) {
+				fs.accl.vals[a] = AccelSample::decode(data, a);
+			}
+		}
+		fs.time = qtime;
+		qtime = qtime + period;
+	}
+	return fifolen = count;
+}
+
 void LSM9DS1AccelGyro::accelerometerQuantity(ConvertedQuantity &ps) const {
 	ps.x() = accl.x * AccelScaleToUnits[cfg.accelRange];
 	ps.y() = accl.y * AccelScaleToUnits[cfg.accelRange];
@@ -457,18 +517,6 @@ void LSM9DS1Mag::configure(float freq,	Settings settings) {
 		magcom->converse(conv);
 	}
 	cfg = settings;
-
-	// make the conversation to read in the device's status; works for both
-	// devices
-	statq.clear();
-	statq.addOutputVector() << (std::uint8_t)MagStatus;
-	statq.addInputVector(1);
-	// conversation to read magnetometer samples
-	magsample.clear();
-	if (settings.magnetometer) {
-		magsample.addOutputVector() << (std::uint8_t)MagSampleX;
-		magsample.addInputVector(6);
-	}
 }
 
 void LSM9DS1Mag::suspend() {
@@ -480,14 +528,12 @@ void LSM9DS1Mag::suspend() {
 
 bool LSM9DS1Mag::sample() {
 	if (cfg.magnetometer) {
-		magcom->converse(statq);
-		duds::hardware::interface::ConversationExtractor ex(statq);
-		std::int8_t status;
-		ex >> status;
-		if (status & 7) {
-			magcom->converse(magsample);
-			ex.reset(magsample);
-			ex >> magn.x >> magn.y >> magn.z;
+		statq.converse(*magcom);
+		if (statq.get() & 7) {
+			magsample.converse(*magcom);
+			for (int a = 0; a < 3; ++a) {
+				magn.vals[a] = magsample.get<Sample>(a);
+			}
 			// The documentation has a confusing diagram of the axes showing that
 			// the magnetometer's axes are different from the others while rotating
 			// the chip 90 degrees. Modify the axes to match the axes of the others.
@@ -9,8 +9,10 @@
  */
 #include <duds/hardware/interface/I2c.hpp>
 #include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
 #include <duds/hardware/devices/DeviceErrors.hpp>
 #include <duds/data/QuantityArray.hpp>
+#include <duds/time/interstellar/Interstellar.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
 
@@ -132,21 +134,119 @@ public:
 		 */
 		unsigned int gyroLowPower         : 1;
 		unsigned int gyroHighPass         : 1;
+		/**
+		 * Buffer samples in the device's FIFO using its continuous mode. The
+		 * buffered samples are read together by sampleFifo().
+		 */
+		unsigned int fifo                 : 1;
+		/**
+		 * The number of buffered samples that will set the FIFO threshold
+		 * flag, and its interrupt if the device is so configured. Only used
+		 * along with @a fifo.
+		 */
+		unsigned int fifoThreshold        : 5;
+	};
+	/**
+	 * The number of samples the device's FIFO can hold.
+	 */
+	static constexpr std::size_t FifoDepth = 32;
+	/**
+	 * A sample read from the FIFO along with an estimate of when it was taken.
+	 */
+	struct FifoSample {
+		/**
+		 * The accelerometer data.
+		 */
+		RawSample accl;
+		/**
+		 * The gyroscope data; only valid if the gyroscope is in use.
+		 */
+		RawSample gyro;
+		/**
+		 * The estimated time the sample was taken. It is computed from the
+		 * time the FIFO was queried and the configured data rate, so it is
+		 * only as accurate as the device's own clock.
+		 */
+		duds::time::interstellar::NanoTime time;
 	};
 private:
 	/**
 	 * The I2C communication interface.
 	 */
 	std::unique_ptr<duds::hardware::interface::I2c> agcom;
+	/**
+	 * The FIFO status register, FIFO_SRC.
+	 */
+	typedef duds::hardware::interface::Register<0x2F>  FifoStatus;
+	/**
+	 * The number of unread samples in the FIFO, 0 to 32.
+	 */
+	typedef duds::hardware::interface::RegisterField<FifoStatus, 0, 6>
+		FifoCount;
+	/**
+	 * Set when the FIFO was full and a sample was overwritten.
+	 */
+	typedef duds::hardware::interface::RegisterField<FifoStatus, 6, 1>
+		FifoOverrun;
+	/**
+	 * Reads the FIFO status.
+	 */
+	duds::hardware::interface::RegisterRead<FifoStatus> fifoq;
+	/**
+	 * Reads all the samples in the FIFO with one burst; rebuilt for the
+	 * number of samples on each use.
+	 */
+	duds::hardware::interface::FixedConversation<FifoDepth * 12 + 1, 2>
+		fifoin;
+	/**
+	 * The samples read by the last call to sampleFifo().
+	 */
+	FifoSample fifo[FifoDepth];
+	/**
+	 * The number of samples in @a fifo.
+	 */
+	std::size_t fifolen;
+	/**
+	 * True if the FIFO overran prior to the last call to sampleFifo().
+	 */
+	bool overrun;
 	/**
 	 * The conversation used to initialize the device. It is created in init()
 	 * and held for later use by resume().
 	 */
 	duds::hardware::interface::Conversation initialize;
 	/**
-	 * The conversation used to read in samples from the device.
+	 * The general status register, STATUS_REG, as found just before the
+	 * accelerometer sample.
+	 */
+	typedef duds::hardware::interface::Register<0x27>  Status;
+	/**
+	 * A gyroscope sample followed by an accelerometer sample. The registers
+	 * are not contiguous; reads continue from the end of the gyroscope sample
+	 * at the start of the accelerometer sample, so the data is described as
+	 * six values starting from the gyroscope sample.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::Register<0x18, 2, false, true>, 6
+	>  GyroAccelSample;
+	/**
+	 * An accelerometer sample.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::Register<0x28, 2, false, true>, 3
+	>  AccelSample;
+	/**
+	 * Reads the status.
 	 */
-	duds::hardware::interface::Conversation agsample, statq;
+	duds::hardware::interface::RegisterRead<Status> statq;
+	/**
+	 * Reads a sample when both the accelerometer and gyroscope are used.
+	 */
+	duds::hardware::interface::RegisterRead<GyroAccelSample> agsample;
+	/**
+	 * Reads a sample when only the accelerometer is used.
+	 */
+	duds::hardware::interface::RegisterRead<AccelSample> asample;
 	/**
 	 * The values supplied by the device.
 	 */
@@ -226,10 +326,41 @@ public:
 		start();
 	}
 	/**
-	 * Reads sampled data from the device.
+	 * Reads sampled data from the device. If the FIFO is in use, this calls
+	 * sampleFifo() and keeps the newest sample.
 	 * @return  True if the device had new data.
 	 */
 	bool sample();
+	/**
+	 * Reads all the samples buffered in the device's FIFO using one query of
+	 * the FIFO's status and one burst read of the samples. This allows
+	 * reading the device once for up to 32 samples rather than for each
+	 * sample. The samples are given times spaced by the sample period, with
+	 * the newest sample half a period before the FIFO status was read.
+	 * @pre     configure() was called with the @a fifo setting.
+	 * @return  The number of samples read; the same as fifoSize().
+	 */
+	std::size_t sampleFifo();
+	/**
+	 * Returns the samples read by the last call to sampleFifo(), oldest
+	 * first.
+	 */
+	const FifoSample *fifoSamples() const {
+		return fifo;
+	}
+	/**
+	 * Returns the number of samples read by the last call to sampleFifo().
+	 */
+	std::size_t fifoSize() const {
+		return fifolen;
+	}
+	/**
+	 * True if the FIFO was full and lost samples prior to the last call to
+	 * sampleFifo(). This means the FIFO is not being read often enough.
+	 */
+	bool fifoOverrun() const {
+		return overrun;
+	}
 	/**
 	 * Returns the confiured sampling rate. The value will be zero if
 	 * configure() has not yet been called, or if it failed.
@@ -375,9 +506,23 @@ private:
 	 */
 	duds::hardware::interface::Conversation initialize;
 	/**
-	 * The conversation used to read in samples from the device.
+	 * The status register, STATUS_REG_M.
+	 */
+	typedef duds::hardware::interface::Register<0x27>  Status;
+	/**
+	 * A magnetometer sample.
+	 */
+	typedef duds::hardware::interface::RegisterArray<
+		duds::hardware::interface::Register<0x28, 2, false, true>, 3
+	>  Sample;
+	/**
+	 * Reads the status.
+	 */
+	duds::hardware::interface::RegisterRead<Status> statq;
+	/**
+	 * Reads a sample.
 	 */
-	duds::hardware::interface::Conversation magsample, statq;
+	duds::hardware::interface::RegisterRead<Sample> magsample;
 	/**
 	 * The values supplied by the device.
 	 */
@@ -9,7 +9,6 @@
  */
 #include <duds/hardware/devices/instruments/TSL2591.hpp>
 #include <duds/hardware/interface/I2cErrors.hpp>
-#include <duds/hardware/interface/ConversationExtractor.hpp>
 
 namespace duds { namespace hardware { namespace devices { namespace instruments {
 
@@ -20,28 +19,6 @@ namespace duds { namespace hardware { namespace devices { namespace instruments
  */
 namespace TSL2591_internal {
 
-/**
- * The device's registers. These really do not fill a byte.
- */
-enum Regs {
-	RegEnable,
-	RegControl, // called config in the doc's list of regs, but control in detail
-	RegDeviceId = 0x12,
-	RegStatus,
-	RegCh0,
-	RegCh1      = 0x16
-};
-
-/**
- * The flags refered to as commands in the documentation.
- */
-enum CmdFlags {
-	Cmd        = 0x80,  // used for all command bytes
-	TransNorm  = 0x20,
-	TransSpec  = 0x60,
-	AddrMask   = 0x1F
-};
-
 /**
  * Flags used to enable various features.
  */
@@ -57,10 +34,6 @@ enum EnableFlags {
  * More configuration flags.
  */
 enum ControlFlags {
-	IntgrTimeShift = 0,
-	IntgrTimeMask  = 0x7,
-	GainShift      = 4,
-	GainMask       = 0x30,
 	Reset          = 0x80
 };
 
@@ -81,26 +54,20 @@ using namespace TSL2591_internal;
 TSL2591::TSL2591(std::unique_ptr<duds::hardware::interface::I2c> &c) :
 com(std::move(c)), scale(0) {
 	try {
-		duds::hardware::interface::Conversation firstcon;
 		// verify ID
-		firstcon.addOutputVector() << (std::int8_t)(Cmd|TransNorm|RegDeviceId);
-		firstcon.addInputVector(1);
-		com->converse(firstcon);
-		duds::hardware::interface::ConversationExtractor ex(firstcon);
-		std::int8_t id;
-		ex >> id;
-		if (id != 0x50) {
+		duds::hardware::interface::RegisterRead<DeviceId, CmdNorm> id;
+		id.converse(*com);
+		if (id.get() != 0x50) {
 			DUDS_THROW_EXCEPTION(DeviceMisidentified() <<
 				duds::hardware::interface::I2cDeviceAddr(com->address())
 			);
 		}
 		// attempt reset
-		firstcon.clear();
-		firstcon.addOutputVector() << (std::int8_t)(Cmd|TransNorm|RegControl) <<
-			(std::int8_t)(Reset);
+		duds::hardware::interface::RegisterWrite<Control, CmdNorm> reset;
+		reset.set(Reset);
 		try {
 			// the reset causes the device to not ack the message
-			com->converse(firstcon);
+			reset.converse(*com);
 		} catch (duds::hardware::interface::I2cErrorNoDevice &) {
 			// bother; ignore it
 		} catch (...) {
@@ -108,11 +75,6 @@ com(std::move(c)), scale(0) {
 			// conversation with the device
 			throw;
 		}
-		// make conversation to read input so it can be reused
-		// address -- green
-		input.addOutputVector() << (std::int8_t)(Cmd|TransNorm|RegCh0);
-		// read in 4 bytes
-		input.addInputVector(4);
 	} catch (...) {
 		// move the I2C communicator back
 		c = std::move(com);
@@ -134,16 +96,10 @@ void TSL2591::init(int gain, int integration) {
 	if ((integration < 0) || (integration > 5)) {
 		DUDS_THROW_EXCEPTION(TSL2591BadIntegration());
 	}
-	// remake the initialization conversation
-	initialize.clear();
-	initialize.addOutputVector() <<
-		// command to start writing at enable register
-		(std::int8_t)(Cmd|TransNorm|RegEnable) <<
-		// make it go
-		(std::int8_t)(OscOn|Sample) <<
-		// set gain and integration time
-		(std::int8_t)(integration | (gain << GainShift));
-	com->converse(initialize);
+	// make it go, and set gain and integration time
+	initialize.set<Enable>(OscOn|Sample).set<IntegrationTime>(integration).
+		set<Gain>(gain);
+	initialize.converse(*com);
 	// datasheet says the values are for the 100ms integration period
 	scale = (double)(integration + 1);
 	// datasheet says the values are for maximum gain
@@ -153,28 +109,23 @@ void TSL2591::init(int gain, int integration) {
 }
 
 void TSL2591::suspend() {
-	duds::hardware::interface::Conversation conv;
-	conv.addOutputVector() <<
-		// command to start writing at enable register
-		(std::int8_t)(Cmd|TransNorm|RegEnable) <<
-		// make it stop
-		(std::int8_t)(0);
-	com->converse(conv);
+	// make it stop
+	duds::hardware::interface::RegisterWrite<Enable, CmdNorm> conv;
+	conv.converse(*com);
 }
 
 void TSL2591::resume() {
-	if (initialize.empty()) {
+	if (initialize.get<Enable>() == 0) {
 		DUDS_THROW_EXCEPTION(DeviceUninitalized());
 	}
-	com->converse(initialize);
+	initialize.converse(*com);
 }
 
 void TSL2591::sample() {
 	// get input
-	com->converse(input);
-	// parse input
-	duds::hardware::interface::ConversationExtractor ex(input);
-	ex >> broad >> ir;
+	input.converse(*com);
+	broad = input.get<Ch0>();
+	ir = input.get<Ch1>();
 }
 
 duds::data::Quantity TSL2591::brightness() const {
@@ -11,7 +11,7 @@
 #define TSL2591_HPP
 
 #include <duds/hardware/interface/I2c.hpp>
-#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
 #include <duds/hardware/devices/DeviceErrors.hpp>
 #include <duds/data/Quantity.hpp>
 
@@ -43,15 +43,54 @@ class TSL2591 : boost::noncopyable {
 	 */
 	std::unique_ptr<duds::hardware::interface::I2c> com;
 	/**
-	 * The conversation used to initialize the device. It is created in init()
+	 * The flags, refered to as commands in the documentation, used with all
+	 * register addresses for normal operation.
+	 */
+	static constexpr std::uint8_t CmdNorm = 0xA0;
+	/**
+	 * Enables the oscillator, sampling, and interrupts.
+	 */
+	typedef duds::hardware::interface::Register<0>  Enable;
+	/**
+	 * The control register; called config in the documentation's list of
+	 * registers, but control in the details.
+	 */
+	typedef duds::hardware::interface::Register<1>  Control;
+	/**
+	 * The integration time selection.
+	 */
+	typedef duds::hardware::interface::RegisterField<Control, 0, 3>
+		IntegrationTime;
+	/**
+	 * The gain selection.
+	 */
+	typedef duds::hardware::interface::RegisterField<Control, 4, 2>  Gain;
+	/**
+	 * Device identification.
+	 */
+	typedef duds::hardware::interface::Register<0x12>  DeviceId;
+	/**
+	 * Channel 0, the full spectrum channel.
+	 */
+	typedef duds::hardware::interface::Register<0x14, 2>  Ch0;
+	/**
+	 * Channel 1, the IR channel.
+	 */
+	typedef duds::hardware::interface::Register<0x16, 2>  Ch1;
+	/**
+	 * The conversation used to initialize the device. It is set in init()
 	 * and held for later use by resume().
 	 */
-	duds::hardware::interface::Conversation initialize;
+	duds::hardware::interface::RegisterWrite<
+		duds::hardware::interface::RegisterBurst<Enable, Control>, CmdNorm
+	> initialize;
 	/**
 	 * The conversation used to query the brightness values. It is created once
 	 * in the constructor to avoid recreating it.
 	 */
-	duds::hardware::interface::Conversation input;
+	duds::hardware::interface::RegisterRead<
+		duds::hardware::interface::RegisterBurst<Ch0, Ch1>, CmdNorm
+	> input;
 	/**
 	 * A scalar value used to partially convert the counts supplied by the
 	 * device into a value in Watts per square meter. It takes into account the
@@ -0,0 +1,26 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/devices/test/AMG88xxModel.hpp>
+#include <cmath>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+void AMG88xxModel::thermistor(double celsius) {
+	long v = std::lround(celsius * 16.0);
+	// 12-bit signed magnitude
+	put(0x0E, v < 0 ? (0x800 | (-v & 0x7FF)) : (v & 0x7FF));
+}
+
+void AMG88xxModel::pixel(unsigned int idx, double celsius) {
+	// 12-bit two's complement
+	put(0x80 + (idx & 63) * 2, std::lround(celsius * 4.0) & 0xFFF);
+}
+
+} } } }
@@ -0,0 +1,46 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef AMG88XXMODEL_HPP
+#define AMG88XXMODEL_HPP
+
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * A simulation of the AMG88xx thermal camera for use with
+ * duds::hardware::interface::test::VirtualI2c.
+ * @author  Jeff Jackowski
+ */
+class AMG88xxModel : public duds::hardware::interface::test::VirtualRegisterDevice {
+public:
+	/**
+	 * Makes a device in its normal operating mode with all temperatures at
+	 * zero.
+	 */
+	AMG88xxModel() = default;
+	/**
+	 * Sets the thermistor temperature.
+	 * @param celsius  The temperature in degrees Celsius. It is rounded to
+	 *                 the device's resolution of 1/16 degree.
+	 */
+	void thermistor(double celsius);
+	/**
+	 * Sets the temperature of a pixel.
+	 * @param idx      The pixel index, 0 to 63.
+	 * @param celsius  The temperature in degrees Celsius. It is rounded to
+	 *                 the device's resolution of 1/4 degree.
+	 */
+	void pixel(unsigned int idx, double celsius);
+};
+
+} } } }
+
+#endif        //  #ifndef AMG88XXMODEL_HPP
@@ -0,0 +1,31 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/devices/test/INA219Model.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * The value of the configuration register after a reset.
+ */
+constexpr std::uint16_t DefaultConfig = 0x399F;
+
+INA219Model::INA219Model() : VirtualRegisterDevice(2, true, false) {
+	value(0, DefaultConfig);
+	busVoltage(0);
+	onWrite(0, [](VirtualRegisterDevice &dev, std::uint8_t) {
+		if (dev.value(0) & 0x8000) {
+			dev.value(0, DefaultConfig);
+			// calibration
+			dev.value(5, 0);
+		}
+	});
+}
+
+} } } }
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef INA219MODEL_HPP
+#define INA219MODEL_HPP
+
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * A simulation of the INA219 current and power monitor for use with
+ * duds::hardware::interface::test::VirtualSmbus. The registers are 16-bits
+ * and big-endian. Writing the reset bit of the configuration register
+ * restores the default configuration. The conversion ready flag is always
+ * set in the bus voltage register.
+ * @author  Jeff Jackowski
+ */
+class INA219Model : public duds::hardware::interface::test::VirtualRegisterDevice {
+public:
+	/**
+	 * Makes a device with the default configuration and zero measurements.
+	 */
+	INA219Model();
+	/**
+	 * Sets the shunt voltage in the device's units of 10uV.
+	 */
+	void shuntVoltage(std::int16_t raw) {
+		value(1, (std::uint16_t)raw);
+	}
+	/**
+	 * Sets the bus voltage in the device's units of 4mV.
+	 */
+	void busVoltage(std::uint16_t raw) {
+		value(2, (raw << 3) | 2);
+	}
+};
+
+} } } }
+
+#endif        //  #ifndef INA219MODEL_HPP
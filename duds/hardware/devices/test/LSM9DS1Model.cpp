@@ -0,0 +1,82 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/devices/test/LSM9DS1Model.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+LSM9DS1AccelGyroModel::LSM9DS1AccelGyroModel() :
+VirtualRegisterDevice(1, false, true, 0x7F), level(32) {
+	reset();
+	// CTRL_REG8; reset flags
+	onWrite(0x22, [this](VirtualRegisterDevice &, std::uint8_t) {
+		if (value(0x22) & 0x81) {
+			reset();
+		}
+	});
+	// STATUS_REG; new data if either instrument has a data rate
+	Hook status = [](VirtualRegisterDevice &dev, std::uint8_t addr) {
+		std::uint8_t stat = 0;
+		if (dev.value(0x20) & 0xE0) {
+			stat |= 1;
+		}
+		if (dev.value(0x10) & 0xE0) {
+			stat |= 2;
+		}
+		dev.value(addr, stat);
+	};
+	onRead(0x17, status);
+	onRead(0x27, status);
+	// FIFO_SRC
+	onRead(0x2F, [this](VirtualRegisterDevice &, std::uint8_t) {
+		std::uint8_t src = 0;
+		// enabled and not bypass mode
+		if ((value(0x23) & 2) && (value(0x2E) & 0xE0)) {
+			src = level;
+			// at or over threshold
+			if (level >= (value(0x2E) & 0x1Fu)) {
+				src |= 0x80;
+			}
+		}
+		value(0x2F, src);
+	});
+}
+
+void LSM9DS1AccelGyroModel::reset() {
+	for (std::uint8_t r = 0x10; r < 0x14; ++r) {
+		value(r, 0);
+	}
+	for (std::uint8_t r = 0x1E; r < 0x25; ++r) {
+		value(r, 0);
+	}
+	value(0x0F, 0x68);  // device ID
+	value(0x1E, 0x38);  // CTRL_REG4
+	value(0x1F, 0x38);  // CTRL_REG5_XL
+	value(0x22, 0x04);  // CTRL_REG8; IF_ADD_INC
+	value(0x2E, 0);     // FIFO_CTRL
+}
+
+std::uint8_t LSM9DS1AccelGyroModel::next(std::uint8_t addr) {
+	switch (addr) {
+		// end of the gyroscope sample
+		case 0x1D:
+			return 0x28;
+		// end of the accelerometer sample
+		case 0x2D:
+			if (value(0x23) & 2) {
+				// back to the start of the combined or accelerometer only
+				// sample
+				return (value(0x10) & 0xE0) ? 0x18 : 0x28;
+			}
+			break;
+	}
+	return VirtualRegisterDevice::next(addr);
+}
+
+} } } }
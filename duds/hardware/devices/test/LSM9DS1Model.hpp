@@ -0,0 +1,77 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef LSM9DS1MODEL_HPP
+#define LSM9DS1MODEL_HPP
+
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * A simulation of the accelerometer and gyroscope of the LSM9DS1 for use with
+ * duds::hardware::interface::test::VirtualI2c or
+ * duds::hardware::interface::test::VirtualMasterSyncSerial. The read flag of
+ * the SPI address byte is ignored.
+ *
+ * The status registers report new data whenever a data rate is configured.
+ * When the FIFO is enabled, the FIFO status reports the level set by
+ * fifoLevel(). Reads continue from the end of the gyroscope sample to the
+ * start of the accelerometer sample, and when the FIFO is enabled, from the
+ * end of the accelerometer sample back to the start of the sample, as
+ * LSM9DS1AccelGyro expects. The sample data does not change unless altered
+ * with accelerometer() or gyroscope().
+ *
+ * @author  Jeff Jackowski
+ */
+class LSM9DS1AccelGyroModel :
+public duds::hardware::interface::test::VirtualRegisterDevice {
+	/**
+	 * The number of samples reported in the FIFO.
+	 */
+	unsigned int level;
+	/**
+	 * Sets the registers to their values after a reset.
+	 */
+	void reset();
+protected:
+	virtual std::uint8_t next(std::uint8_t addr);
+public:
+	/**
+	 * Makes a device with the configuration following a reset.
+	 */
+	LSM9DS1AccelGyroModel();
+	/**
+	 * Sets the accelerometer sample.
+	 */
+	void accelerometer(std::int16_t x, std::int16_t y, std::int16_t z) {
+		put(0x28, (std::uint16_t)x);
+		put(0x2A, (std::uint16_t)y);
+		put(0x2C, (std::uint16_t)z);
+	}
+	/**
+	 * Sets the gyroscope sample.
+	 */
+	void gyroscope(std::int16_t x, std::int16_t y, std::int16_t z) {
+		put(0x18, (std::uint16_t)x);
+		put(0x1A, (std::uint16_t)y);
+		put(0x1C, (std::uint16_t)z);
+	}
+	/**
+	 * Sets the number of samples the FIFO will report, 0 to 32. The default
+	 * is 32, a full FIFO.
+	 */
+	void fifoLevel(unsigned int l) {
+		level = l > 32 ? 32 : l;
+	}
+};
+
+} } } }
+
+#endif        //  #ifndef LSM9DS1MODEL_HPP
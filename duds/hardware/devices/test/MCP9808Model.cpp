@@ -0,0 +1,29 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/devices/test/MCP9808Model.hpp>
+#include <cmath>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+MCP9808Model::MCP9808Model() : VirtualRegisterDevice(2, true, false) {
+	// manufacturer ID
+	value(6, 0x54);
+	// device ID and revision
+	value(7, 0x400);
+	// resolution register is only a byte; highest resolution by default
+	width(8, 1);
+	value(8, 3);
+}
+
+void MCP9808Model::temperature(double celsius) {
+	value(5, (std::uint16_t)std::lround(celsius * 16.0) & 0x1FFF);
+}
+
+} } } }
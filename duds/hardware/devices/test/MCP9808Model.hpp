@@ -0,0 +1,42 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef MCP9808MODEL_HPP
+#define MCP9808MODEL_HPP
+
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * A simulation of the MCP9808 temperature sensor for use with
+ * duds::hardware::interface::test::VirtualSmbus. The registers are 16-bits
+ * and big-endian, except for the 8-bit resolution register. The
+ * manufacturer and device ID registers hold the values expected by the
+ * MCP9808 driver.
+ * @author  Jeff Jackowski
+ */
+class MCP9808Model : public duds::hardware::interface::test::VirtualRegisterDevice {
+public:
+	/**
+	 * Makes a device with the default configuration and a temperature of
+	 * zero.
+	 */
+	MCP9808Model();
+	/**
+	 * Sets the temperature reported by the device.
+	 * @param celsius  The temperature in degrees Celsius. It is rounded to
+	 *                 the device's resolution of 1/16 degree.
+	 */
+	void temperature(double celsius);
+};
+
+} } } }
+
+#endif        //  #ifndef MCP9808MODEL_HPP
@@ -0,0 +1,28 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/devices/test/TSL2591Model.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+TSL2591Model::TSL2591Model() : VirtualRegisterDevice(1, false, true, 0x1F) {
+	// device ID
+	value(0x12, 0x50);
+	// status; valid data
+	value(0x13, 1);
+	onWrite(1, [](VirtualRegisterDevice &dev, std::uint8_t) {
+		if (dev.value(1) & 0x80) {
+			for (std::uint8_t r = 0; r < 0x0C; ++r) {
+				dev.value(r, 0);
+			}
+		}
+	});
+}
+
+} } } }
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef TSL2591MODEL_HPP
+#define TSL2591MODEL_HPP
+
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+
+namespace duds { namespace hardware { namespace devices { namespace test {
+
+/**
+ * A simulation of the TSL2591 light sensor for use with
+ * duds::hardware::interface::test::VirtualI2c. The upper bits of the
+ * command byte are ignored. Writing the reset bit of the control register
+ * clears the configuration.
+ * @author  Jeff Jackowski
+ */
+class TSL2591Model : public duds::hardware::interface::test::VirtualRegisterDevice {
+public:
+	/**
+	 * Makes a device with the default configuration and zero measurements.
+	 */
+	TSL2591Model();
+	/**
+	 * Sets the values of both channels.
+	 * @param ch0  The full spectrum channel.
+	 * @param ch1  The infrared channel.
+	 */
+	void channels(std::uint16_t ch0, std::uint16_t ch1) {
+		put(0x14, ch0);
+		put(0x16, ch1);
+	}
+};
+
+} } } }
+
+#endif        //  #ifndef TSL2591MODEL_HPP
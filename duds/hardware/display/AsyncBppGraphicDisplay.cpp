@@ -0,0 +1,140 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/display/AsyncBppGraphicDisplay.hpp>
+
+namespace duds { namespace hardware { namespace display {
+
+AsyncBppGraphicDisplay::AsyncBppGraphicDisplay(
+	const BppGraphicDisplaySptr &display
+) : BppGraphicDisplay(display->dimensions()), disp(display),
+dispTotalBytes(display->totalBytes()) {
+	frmbuf = disp->frame();
+	worker = std::thread(&AsyncBppGraphicDisplay::run, this);
+}
+
+AsyncBppGraphicDisplay::~AsyncBppGraphicDisplay() {
+	{
+		std::lock_guard<std::mutex> lock(block);
+		quit = true;
+	}
+	workCv.notify_one();
+	worker.join();
+}
+
+void AsyncBppGraphicDisplay::run() {
+	std::unique_lock<std::mutex> lock(block);
+	while (true) {
+		workCv.wait(lock, [this]() { return havePending || quit; });
+		if (quit) {
+			return;
+		}
+		// take the pending frame; the old working frame becomes the buffer
+		// for the next pending frame
+		working.swap(pending);
+		std::chrono::steady_clock::time_point submitted = pendingTime;
+		havePending = false;
+		busy = true;
+		lock.unlock();
+		std::exception_ptr err;
+		try {
+			disp->write(&working);
+		} catch (...) {
+			err = std::current_exception();
+		}
+		std::chrono::nanoseconds latency =
+			std::chrono::steady_clock::now() - submitted;
+		// only this thread uses the wrapped display, so its counters are
+		// stable here; a failed frame may have sent some bytes
+		std::size_t bytes = disp->lastFrameBytes();
+		lock.lock();
+		busy = false;
+		dispFrameBytes = bytes;
+		dispTotalBytes += bytes;
+		if (err) {
+			error = err;
+		} else {
+			++stats.output;
+			stats.lastLatency = latency;
+			stats.totalLatency += latency;
+			if (latency > stats.maxLatency) {
+				stats.maxLatency = latency;
+			}
+		}
+		if (!havePending) {
+			idleCv.notify_all();
+		}
+	}
+}
+
+void AsyncBppGraphicDisplay::rethrowError() {
+	if (error) {
+		std::exception_ptr err = error;
+		error = nullptr;
+		std::rethrow_exception(err);
+	}
+}
+
+void AsyncBppGraphicDisplay::outputFrame(
+	const duds::ui::graphics::BppImage *img,
+	const duds::ui::graphics::ImageDamage *
+) {
+	{
+		std::lock_guard<std::mutex> lock(block);
+		rethrowError();
+		// replacing a frame the worker has yet to take?
+		if (havePending) {
+			++stats.dropped;
+		}
+		// after the first two frames, both buffers are the display's size, so
+		// this copies without allocating
+		pending = *img;
+		pendingTime = std::chrono::steady_clock::now();
+		havePending = true;
+	}
+	workCv.notify_one();
+	frmbuf = *img;
+}
+
+void AsyncBppGraphicDisplay::flush() {
+	std::unique_lock<std::mutex> lock(block);
+	idleCv.wait(lock, [this]() { return !havePending && !busy; });
+	rethrowError();
+}
+
+AsyncBppGraphicDisplay::Statistics AsyncBppGraphicDisplay::statistics() {
+	std::lock_guard<std::mutex> lock(block);
+	return stats;
+}
+
+void AsyncBppGraphicDisplay::resetStatistics() {
+	std::lock_guard<std::mutex> lock(block);
+	stats = Statistics();
+}
+
+std::size_t AsyncBppGraphicDisplay::lastFrameBytes() const {
+	std::lock_guard<std::mutex> lock(block);
+	return dispFrameBytes;
+}
+
+std::uint64_t AsyncBppGraphicDisplay::totalBytes() const {
+	std::lock_guard<std::mutex> lock(block);
+	return dispTotalBytes;
+}
+
+void AsyncBppGraphicDisplay::resetCounters() {
+	{
+		std::lock_guard<std::mutex> lock(block);
+		dispFrameBytes = 0;
+		dispTotalBytes = 0;
+	}
+	BppGraphicDisplay::resetCounters();
+}
+
+} } }
@@ -0,0 +1,215 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef ASYNCBPPGRAPHICDISPLAY_HPP
+#define ASYNCBPPGRAPHICDISPLAY_HPP
+
+#include <duds/hardware/display/BppGraphicDisplay.hpp>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+namespace duds { namespace hardware { namespace display {
+
+/**
+ * Outputs frames to another BppGraphicDisplay on a separate thread so that
+ * write() does not block while the frame is sent to the display.
+ *
+ * Frames given to write() are copied into a pending frame buffer, and a
+ * worker thread writes the most recent pending frame to the wrapped display.
+ * If a new frame is written before the worker takes the pending frame, the
+ * pending frame is replaced and counted as dropped. This keeps a display
+ * that is slower than the producer showing the newest frame without queuing
+ * stale ones. The image in frame() is the last frame given to write(), which
+ * may not yet be shown on the display.
+ *
+ * An exception thrown by the wrapped display on the worker thread is kept
+ * and rethrown by the next call to write() or flush().
+ *
+ * The byte counters, lastFrameBytes() and totalBytes(), report the bytes
+ * sent by the wrapped display as counted after each frame it outputs. The
+ * frame counter, frames(), counts the frames given to write(), including
+ * dropped frames; see Statistics::output for the frames actually shown.
+ *
+ * @note  write() and flush() should be called from only one thread. The
+ *        wrapped display must not be used directly while this object
+ *        exists.
+ *
+ * @author  Jeff Jackowski
+ */
+class AsyncBppGraphicDisplay : public BppGraphicDisplay {
+public:
+	/**
+	 * Counts and times frame output.
+	 */
+	struct Statistics {
+		/**
+		 * The number of frames written to the wrapped display.
+		 */
+		std::uint64_t output = 0;
+		/**
+		 * The number of frames replaced by a newer frame before they were
+		 * written to the wrapped display.
+		 */
+		std::uint64_t dropped = 0;
+		/**
+		 * The time from the call to write() until the frame was written to
+		 * the wrapped display for the most recently output frame.
+		 */
+		std::chrono::nanoseconds lastLatency = std::chrono::nanoseconds(0);
+		/**
+		 * The longest latency of an output frame.
+		 */
+		std::chrono::nanoseconds maxLatency = std::chrono::nanoseconds(0);
+		/**
+		 * The sum of the latency of all output frames. Divide by @a output
+		 * for the mean.
+		 */
+		std::chrono::nanoseconds totalLatency = std::chrono::nanoseconds(0);
+	};
+private:
+	/**
+	 * The display that is given the frames.
+	 */
+	BppGraphicDisplaySptr disp;
+	/**
+	 * The newest frame that has not yet been taken by the worker thread.
+	 */
+	duds::ui::graphics::BppImage pending;
+	/**
+	 * The frame being written by the worker thread. Only used by the worker.
+	 */
+	duds::ui::graphics::BppImage working;
+	/**
+	 * The time @a pending was submitted.
+	 */
+	std::chrono::steady_clock::time_point pendingTime;
+	/**
+	 * Frame output statistics.
+	 */
+	Statistics stats;
+	/**
+	 * An exception thrown by the wrapped display that has yet to be rethrown.
+	 */
+	std::exception_ptr error;
+	/**
+	 * The number of bytes the wrapped display sent for the last frame output
+	 * by the worker thread.
+	 */
+	std::size_t dispFrameBytes = 0;
+	/**
+	 * The number of bytes sent by the wrapped display since construction or
+	 * resetCounters(), including any sent before construction.
+	 */
+	std::uint64_t dispTotalBytes;
+	/**
+	 * Protects all data used by both threads.
+	 */
+	mutable std::mutex block;
+	/**
+	 * Wakes the worker thread when a frame is pending or when quitting.
+	 */
+	std::condition_variable workCv;
+	/**
+	 * Wakes threads in flush() when the worker becomes idle.
+	 */
+	std::condition_variable idleCv;
+	/**
+	 * The worker thread.
+	 */
+	std::thread worker;
+	/**
+	 * True when @a pending holds a frame to output.
+	 */
+	bool havePending = false;
+	/**
+	 * True while the worker thread is writing a frame.
+	 */
+	bool busy = false;
+	/**
+	 * True when the worker thread must terminate.
+	 */
+	bool quit = false;
+	/**
+	 * The worker thread's function.
+	 */
+	void run();
+	/**
+	 * Rethrows and clears @a error if it is set.
+	 * @pre  The caller has a lock on @a block.
+	 */
+	void rethrowError();
+	/**
+	 * Copies the image to the pending frame buffer and wakes the worker
+	 * thread.
+	 * @param img  The new image to show.
+	 * @param dmg  Not used; the wrapped display will compare the whole frame.
+	 * @throw      An exception previously thrown by the wrapped display.
+	 */
+	virtual void outputFrame(
+		const duds::ui::graphics::BppImage *img,
+		const duds::ui::graphics::ImageDamage *dmg
+	);
+public:
+	/**
+	 * Starts a worker thread to output frames to the given display.
+	 * @param display  The display to use. Its dimensions must not change
+	 *                 while this object exists.
+	 * @post  frame() holds a copy of the frame of @a display.
+	 */
+	AsyncBppGraphicDisplay(const BppGraphicDisplaySptr &display);
+	/**
+	 * Stops the worker thread after it finishes any frame it is presently
+	 * writing. A pending frame is not written.
+	 */
+	virtual ~AsyncBppGraphicDisplay();
+	/**
+	 * Returns the wrapped display.
+	 */
+	const BppGraphicDisplaySptr &display() const {
+		return disp;
+	}
+	/**
+	 * Waits until all frames given to write() have been output or dropped.
+	 * @throw  An exception thrown by the wrapped display.
+	 */
+	void flush();
+	/**
+	 * Returns a copy of the current frame output statistics.
+	 */
+	Statistics statistics();
+	/**
+	 * Sets all the frame output statistics to zero.
+	 */
+	void resetStatistics();
+	/**
+	 * Returns the number of bytes the wrapped display sent for the last frame
+	 * output by the worker thread.
+	 */
+	virtual std::size_t lastFrameBytes() const;
+	/**
+	 * Returns the number of bytes sent by the wrapped display since the
+	 * construction of this object or the last call to resetCounters(),
+	 * including any sent by the wrapped display before this object was made.
+	 */
+	virtual std::uint64_t totalBytes() const;
+	/**
+	 * Sets the byte and frame counters to zero. The counters of the wrapped
+	 * display are not changed.
+	 */
+	virtual void resetCounters();
+};
+
+typedef std::shared_ptr<AsyncBppGraphicDisplay>  AsyncBppGraphicDisplaySptr;
+
+} } }
+
+#endif        //  #ifndef ASYNCBPPGRAPHICDISPLAY_HPP
@@ -21,7 +21,16 @@ void BppGraphicDisplay::write(const duds::ui::graphics::BppImage *img) {
 			duds::ui::graphics::ImageErrorTargetDimensions(frmbuf.dimensions())
 		);
 	}
-	outputFrame(img);
+	const duds::ui::graphics::ImageDamage *dmg = nullptr;
+	if ((img == lastImg) && img->trackingDamage()) {
+		dmg = &img->damage();
+	}
+	// forget the image while output is in progress in case it fails
+	lastImg = nullptr;
+	frameBytes = 0;
+	outputFrame(img, dmg);
+	lastImg = img;
+	++frameCnt;
 }
 
 } } }
@@ -16,9 +16,37 @@ namespace duds { namespace hardware { namespace display {
 
 /**
  * Base class for bit-per-pixel graphic displays.
+ *
+ * When the same image object is written repeatedly and that image has
+ * damage tracking enabled (see duds::ui::graphics::BppImage::trackDamage()),
+ * the image's damage is passed along to outputFrame() so that the
+ * implementation can skip examining the unchanged parts of the frame. The
+ * damage must only be cleared after the image has been written to every
+ * display that shows it.
+ *
+ * The number of bytes sent to the display is counted to allow the cost of
+ * updates to be measured.
+ *
  * @author  Jeff Jackowski
  */
 class BppGraphicDisplay {
+	/**
+	 * The image last given to write(). Only used to identify the image; it may
+	 * no longer exist.
+	 */
+	const duds::ui::graphics::BppImage *lastImg = nullptr;
+	/**
+	 * The number of bytes sent for the current or last frame.
+	 */
+	std::size_t frameBytes = 0;
+	/**
+	 * The number of bytes sent since construction or resetCounters().
+	 */
+	std::uint64_t totBytes = 0;
+	/**
+	 * The number of frames written since construction or resetCounters().
+	 */
+	std::uint64_t frameCnt = 0;
 protected:
 	/**
 	 * The frame buffer.
@@ -30,10 +58,32 @@ protected:
 	 * Called by write() after ensuring the dimensions of @a img and @a frmbuf
 	 * match.
 	 * @param img  The new image to show.
+	 * @param dmg  The parts of @a img that may differ from @a frmbuf, or
+	 *             nullptr if any part may differ. Parts not marked as
+	 *             damaged match @a frmbuf.
 	 * @pre   The size of @a img and @a frmbuf are the same.
 	 * @post  The image in @a frmbuf matches the image in @a img.
 	 */
-	virtual void outputFrame(const duds::ui::graphics::BppImage *img) = 0;
+	virtual void outputFrame(
+		const duds::ui::graphics::BppImage *img,
+		const duds::ui::graphics::ImageDamage *dmg
+	) = 0;
+	/**
+	 * Adds to the count of bytes sent to the display. Implementations should
+	 * call this for all data sent to the display.
+	 */
+	void sentBytes(std::size_t bytes) {
+		frameBytes += bytes;
+		totBytes += bytes;
+	}
+	/**
+	 * Causes the next call to write() to provide no damage information to
+	 * outputFrame(). This must be called if @a frmbuf is changed other than
+	 * by outputFrame().
+	 */
+	void resetDamageSource() {
+		lastImg = nullptr;
+	}
 	/**
 	 * Construct with an empty frame buffer.
 	 */
@@ -69,9 +119,40 @@ public:
 	const duds::ui::graphics::ImageDimensions &dimensions() const {
 		return frmbuf.dimensions();
 	}
+	/**
+	 * Returns the number of bytes sent to the display for the last frame
+	 * written by write().
+	 */
+	virtual std::size_t lastFrameBytes() const {
+		return frameBytes;
+	}
+	/**
+	 * Returns the number of bytes sent to the display since construction or
+	 * the last call to resetCounters(), including any sent during
+	 * initialization.
+	 */
+	virtual std::uint64_t totalBytes() const {
+		return totBytes;
+	}
+	/**
+	 * Returns the number of frames written since construction or the last
+	 * call to resetCounters().
+	 */
+	std::uint64_t frames() const {
+		return frameCnt;
+	}
+	/**
+	 * Sets the byte and frame counters to zero.
+	 */
+	virtual void resetCounters() {
+		frameBytes = 0;
+		totBytes = frameCnt = 0;
+	}
 	/**
 	 * Writes the new image to the display.
-	 * @param img  The new image to show on the display.
+	 * @param img  The new image to show on the display. If it is the same
+	 *             object as the image previously written and it is tracking
+	 *             damage, only the damaged areas will be examined for changes.
 	 * @pre   The size of @a img and @a frmbuf are the same.
 	 * @post  The image in @a frmbuf matches the image in @a img.
 	 * @throw DisplaySizeError  The dimensions of the supplied image do not
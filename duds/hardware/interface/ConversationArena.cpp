@@ -0,0 +1,38 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/ConversationArena.hpp>
+#include <duds/general/Errors.hpp>
+#include <cstring>
+
+namespace duds { namespace hardware { namespace interface {
+
+char *ConversationArena::add(std::size_t len, ConversationPart::Flags f) {
+	if ((count == partsCap) || (len > (buffCap - used))) {
+		DUDS_THROW_EXCEPTION(ConversationArenaFull());
+	}
+	Part &p = parts[count++];
+	p.data = buff + used;
+	p.len = len;
+	p.mpf = f;
+	used += len;
+	return p.data;
+}
+
+char *ConversationArena::addOutput(
+	const void *data,
+	std::size_t len,
+	ConversationPart::Flags f
+) {
+	char *dest = addOutput(len, f);
+	std::memcpy(dest, data, len);
+	return dest;
+}
+
+} } }
@@ -0,0 +1,313 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef CONVERSATIONARENA_HPP
+#define CONVERSATIONARENA_HPP
+
+#include <initializer_list>
+#include <boost/noncopyable.hpp>
+#include <duds/hardware/interface/ConversationExtractor.hpp>
+
+namespace duds { namespace hardware { namespace interface {
+
+/**
+ * A ConversationArena lacks the space to hold another part, or more data.
+ */
+struct ConversationArenaFull : ConversationError { };
+
+/**
+ * A conversation with its parts and their data stored in fixed capacity
+ * buffers that are not allocated by this class. Conversation allocates an
+ * object for each part, and often a buffer for each part's data; this class
+ * does not allocate memory. The buffers are supplied by a derived class,
+ * usually FixedConversation, which allows the whole conversation to reside
+ * on the stack or within the object that uses it.
+ *
+ * Parts are added to the end of the conversation with the add functions, and
+ * may be removed all at once with clear(). Once built, a conversation is
+ * used by passing it as a const reference to a Conversationalist. The layout
+ * of a const ConversationArena cannot change, but the input parts will
+ * receive data each time it is used, and the output data may be changed
+ * through the pointers returned when the parts were added. This allows a
+ * conversation to be built once and replayed any number of times without any
+ * memory allocation.
+ *
+ * The parts are described by ConversationArena::Part objects rather than
+ * ConversationPart objects to avoid the virtual function calls and the
+ * separate allocations. Their flags have the same meaning.
+ *
+ * @author  Jeff Jackowski
+ */
+class ConversationArena : boost::noncopyable {
+public:
+	/**
+	 * Describes a section of the conversation; the counterpart to
+	 * ConversationPart.
+	 */
+	class Part {
+		/**
+		 * The start of the part's data.
+		 */
+		char *data;
+		/**
+		 * The length of the part's data in bytes.
+		 */
+		std::size_t len;
+		/**
+		 * The part's flags.
+		 */
+		ConversationPart::Flags mpf;
+		friend class ConversationArena;
+	public:
+		/**
+		 * Returns the flags. These have the same meaning as with
+		 * ConversationPart.
+		 */
+		ConversationPart::Flags flags() const {
+			return mpf;
+		}
+		/**
+		 * True if this part is flagged for input use.
+		 */
+		bool input() const {
+			return mpf & ConversationPart::MpfInput;
+		}
+		/**
+		 * True if this part is flagged for output use.
+		 */
+		bool output() const {
+			return !(mpf & ConversationPart::MpfInput);
+		}
+		/**
+		 * True if this part is flagged for extraction.
+		 */
+		bool extract() const {
+			return mpf & ConversationPart::MpfExtract;
+		}
+		/**
+		 * True if this part is flagged as having a variable length. It is
+		 * only valid for input.
+		 */
+		bool varyingLength() const {
+			return (mpf & ConversationPart::MpfVarlen) &&
+				(mpf & ConversationPart::MpfInput);
+		}
+		/**
+		 * True if this part is flagged as having data in big-endian form.
+		 */
+		bool bigEndian() const {
+			return mpf & ConversationPart::MpfBigendian;
+		}
+		/**
+		 * Returns a pointer to the begining of the part's data. The return
+		 * type is not const because use for input will require a write.
+		 */
+		char *start() const {
+			return data;
+		}
+		/**
+		 * Returns the length of the part's data in bytes.
+		 */
+		std::size_t length() const {
+			return len;
+		}
+	};
+private:
+	/**
+	 * The buffer for the data of all the parts.
+	 */
+	char *buff;
+	/**
+	 * The buffer for the part descriptions.
+	 */
+	Part *parts;
+	/**
+	 * The size of @a buff in bytes.
+	 */
+	std::size_t buffCap;
+	/**
+	 * The number of elements in @a parts.
+	 */
+	std::size_t partsCap;
+	/**
+	 * The number of bytes of @a buff in use.
+	 */
+	std::size_t used;
+	/**
+	 * The number of parts in the conversation.
+	 */
+	std::size_t count;
+protected:
+	/**
+	 * Makes an empty conversation that will use the given buffers.
+	 * @param b   The buffer for part data. It must remain valid for the life
+	 *            of this object.
+	 * @param bc  The size of @a b in bytes.
+	 * @param p   The buffer for part descriptions. It must remain valid for
+	 *            the life of this object.
+	 * @param pc  The number of elements in @a p.
+	 */
+	ConversationArena(char *b, std::size_t bc, Part *p, std::size_t pc) :
+	buff(b), parts(p), buffCap(bc), partsCap(pc), used(0), count(0) { }
+public:
+	/**
+	 * Adds a part and reserves space for its data.
+	 * @param len  The length of the part in bytes.
+	 * @param f    The flags for the part.
+	 * @return     The start of the part's data. The data is not initialized.
+	 * @throw ConversationArenaFull  There is not enough space for the part.
+	 */
+	char *add(std::size_t len, ConversationPart::Flags f);
+	/**
+	 * Adds an output part and reserves space for its data.
+	 * @param len  The length of the part in bytes.
+	 * @param f    Additional flags for the part, such as
+	 *             @ref ConversationPart::MpfBreak "MpfBreak".
+	 * @return     The start of the part's data. The data is not initialized;
+	 *             the caller must write the output data here.
+	 * @throw ConversationArenaFull  There is not enough space for the part.
+	 */
+	char *addOutput(
+		std::size_t len,
+		ConversationPart::Flags f = ConversationPart::Flags::Zero()
+	) {
+		return add(len, f & ~ConversationPart::MpfInput);
+	}
+	/**
+	 * Adds an output part with the given data.
+	 * @param data  The output data; it is copied into the conversation.
+	 * @param len   The length of the data in bytes.
+	 * @param f     Additional flags for the part, such as
+	 *              @ref ConversationPart::MpfBreak "MpfBreak".
+	 * @return      The start of the part's data.
+	 * @throw ConversationArenaFull  There is not enough space for the part.
+	 */
+	char *addOutput(
+		const void *data,
+		std::size_t len,
+		ConversationPart::Flags f = ConversationPart::Flags::Zero()
+	);
+	/**
+	 * Adds an output part with the given bytes.
+	 * @param bytes  The output data; it is copied into the conversation.
+	 * @param f      Additional flags for the part, such as
+	 *               @ref ConversationPart::MpfBreak "MpfBreak".
+	 * @return       The start of the part's data.
+	 * @throw ConversationArenaFull  There is not enough space for the part.
+	 */
+	char *addOutput(
+		std::initializer_list<std::uint8_t> bytes,
+		ConversationPart::Flags f = ConversationPart::Flags::Zero()
+	) {
+		return addOutput(bytes.begin(), bytes.size(), f);
+	}
+	/**
+	 * Adds an input part.
+	 * @param len  The length of the part in bytes.
+	 * @param f    Additional flags for the part. The part is always flagged
+	 *             for input.
+	 * @return     The start of the part's data.
+	 * @throw ConversationArenaFull  There is not enough space for the part.
+	 */
+	char *addInput(
+		std::size_t len,
+		ConversationPart::Flags f = ConversationPart::MpfExtract
+	) {
+		return add(len, f | ConversationPart::MpfInput);
+	}
+	/**
+	 * Removes all parts.
+	 */
+	void clear() {
+		used = count = 0;
+	}
+	/**
+	 * Returns the number of parts within this conversation.
+	 */
+	std::size_t size() const {
+		return count;
+	}
+	/**
+	 * Returns true if the conversation has no parts.
+	 */
+	bool empty() const {
+		return !count;
+	}
+	/**
+	 * Returns the maximum number of parts.
+	 */
+	std::size_t partCapacity() const {
+		return partsCap;
+	}
+	/**
+	 * Returns the maximum number of bytes for the data of all parts.
+	 */
+	std::size_t byteCapacity() const {
+		return buffCap;
+	}
+	/**
+	 * Returns the number of bytes used by the data of all parts.
+	 */
+	std::size_t bytesUsed() const {
+		return used;
+	}
+	/**
+	 * Returns the first part.
+	 */
+	const Part *begin() const {
+		return parts;
+	}
+	/**
+	 * Returns the position after the last part.
+	 */
+	const Part *end() const {
+		return parts + count;
+	}
+	/**
+	 * Returns the part at the given index.
+	 * @pre  @a idx is less than size().
+	 */
+	const Part &operator[](std::size_t idx) const {
+		return parts[idx];
+	}
+	/**
+	 * Returns an extraction object for the data of the indicated part. Since
+	 * the extractor is given only the data, the functions that specify
+	 * endianess must be used.
+	 * @pre  @a idx is less than size().
+	 */
+	ConversationExtractor extract(std::size_t idx) const {
+		return ConversationExtractor(parts[idx].start(), parts[idx].length());
+	}
+};
+
+/**
+ * A ConversationArena with its buffers stored inside the object.
+ * @tparam Bytes  The maximum number of bytes for the data of all parts.
+ * @tparam Parts  The maximum number of parts.
+ * @author  Jeff Jackowski
+ */
+template <std::size_t Bytes, std::size_t Parts = 4>
+class FixedConversation : public ConversationArena {
+	/**
+	 * Storage for the part data.
+	 */
+	char data[Bytes];
+	/**
+	 * Storage for the part descriptions.
+	 */
+	Part partData[Parts];
+public:
+	FixedConversation() :
+	ConversationArena(data, Bytes, partData, Parts) { }
+};
+
+} } }
+
+#endif        //  #ifndef CONVERSATIONARENA_HPP
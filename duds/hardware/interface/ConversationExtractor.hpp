@@ -12,6 +12,9 @@
  * Header for ConversationExtractor; includes all other conversation related
  * header files.
  */
+#ifndef CONVERSATIONEXTRACTOR_HPP
+#define CONVERSATIONEXTRACTOR_HPP
+
 #include <duds/hardware/interface/Conversation.hpp>
 #include <duds/general/Errors.hpp>
 
@@ -87,6 +90,15 @@ public:
 	 */
 	ConversationExtractor(const ConversationPart &cp) :
 	c(nullptr), pos(cp.start()), remain(cp.length()) { }
+	/**
+	 * Constructs to extract from the given buffer, such as the data of a
+	 * ConversationArena part.
+	 * Must use functions that specifiy either big or little endian.
+	 * @param start  The start of the data.
+	 * @param len    The length of the data in bytes.
+	 */
+	ConversationExtractor(const char *start, std::size_t len) :
+	c(nullptr), pos(start), remain(len) { }
 	/**
 	 * Prepares the object to extract another time from the same Conversation
 	 * object used previously. This may be called before extracting all data
@@ -123,6 +135,17 @@ public:
 		pos = cp.start();
 		remain = cp.length();
 	}
+	/**
+	 * Prepares the object to extract from the given buffer.
+	 * Must use functions that specify either big or little endian.
+	 * @param start  The start of the data.
+	 * @param len    The length of the data in bytes.
+	 */
+	void reset(const char *start, std::size_t len) {
+		c = nullptr;
+		pos = start;
+		remain = len;
+	}
 	/**
 	 * Returns true when all the extractible conversation data has been
 	 * extracted.
@@ -475,3 +498,5 @@ ConversationExtractor &operator >> (ConversationExtractor &ce, Int (&a)[N]) {
 }
 
 } } }
+
+#endif        //  #ifndef CONVERSATIONEXTRACTOR_HPP
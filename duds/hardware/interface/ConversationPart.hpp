@@ -11,6 +11,7 @@
 #define CONVERSATIONPART_HPP
 
 #include <cstdint>
+#include <memory>
 #include <duds/general/BitFlags.hpp>
 #include <boost/exception/info.hpp>
 
@@ -215,6 +216,26 @@ public:
 	virtual std::size_t length() const = 0;
 };
 
+/**
+ * Returns the part owned by an element of a Conversation. Along with the
+ * overload for parts held directly, like ConversationArena::Part, this allows
+ * the same template code to iterate over either kind of conversation.
+ */
+inline const ConversationPart &conversationPart(
+	const std::unique_ptr<ConversationPart> &cp
+) {
+	return *cp;
+}
+
+/**
+ * Returns a part held directly by the container, like ConversationArena::Part.
+ * @tparam Part  The type of conversation part.
+ */
+template <class Part>
+inline const Part &conversationPart(const Part &cp) {
+	return cp;
+}
+
 } } }
 
 #endif        //  #ifndef CONVERSATIONPART_HPP
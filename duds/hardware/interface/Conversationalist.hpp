@@ -13,6 +13,7 @@
 namespace duds { namespace hardware { namespace interface {
 
 class Conversation;
+class ConversationArena;
 
 /**
  * Allows a common interface for using Conversation objects for communication.
@@ -29,6 +30,14 @@ public:
 	 * @param conv  The conversation to have with the device on the other end.
 	 */
 	virtual void converse(Conversation &conv) = 0;
+	/**
+	 * Begins a half-duplex conversation with a device using a conversation
+	 * held in a ConversationArena. The conversation is the same as with a
+	 * Conversation object, but implementations must not allocate memory to
+	 * conduct it.
+	 * @param conv  The conversation to have with the device on the other end.
+	 */
+	virtual void converse(const ConversationArena &conv) = 0;
 };
 
 } } }
@@ -380,6 +380,22 @@ public:
 	) const {
 		port()->output(subset(pos), state, &portdata);
 	}
+	/**
+	 * Outputs a precomputed sequence of states to the pins. The port is
+	 * locked and the pins are checked once for the whole sequence, so this is
+	 * much faster than a call to another output function for each change.
+	 * Other threads cannot use the port until the sequence is complete. As
+	 * with the other output functions, the pin configuration will not be
+	 * changed.
+	 * @param wave  The sequence of output states. Position N in the waveform
+	 *              is the pin at position N in this set.
+	 * @throw PinRangeError  The waveform uses more pins than are in this set.
+	 * @throw DigitalPinCannotOutputError  A pin used by the waveform cannot
+	 *                                     output.
+	 */
+	void output(const DigitalPinWaveform &wave) const {
+		port()->outputSequence(pinvec, wave, &portdata);
+	}
 
 	// convenience functions -- may expand later
 
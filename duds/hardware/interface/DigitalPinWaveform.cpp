@@ -0,0 +1,69 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/DigitalPinWaveform.hpp>
+#include <duds/hardware/interface/DigitalPinErrors.hpp>
+
+namespace duds { namespace hardware { namespace interface {
+
+void DigitalPinWaveform::output(
+	unsigned int pos,
+	bool state,
+	std::chrono::nanoseconds delay
+) {
+	if (pos >= MaxPins) {
+		DUDS_THROW_EXCEPTION(PinRangeError());
+	}
+	std::uint64_t mask = (std::uint64_t)1 << pos;
+	add(state ? mask : 0, mask, delay);
+}
+
+void DigitalPinWaveform::write(
+	std::uint64_t val,
+	int bits,
+	std::chrono::nanoseconds delay
+) {
+	if ((bits < 1) || (bits > (int)MaxPins)) {
+		DUDS_THROW_EXCEPTION(PinRangeError());
+	}
+	std::uint64_t mask = (bits < 64) ?
+		(((std::uint64_t)1 << bits) - 1) : ~(std::uint64_t)0;
+	if (val & ~mask) {
+		DUDS_THROW_EXCEPTION(DigitalPinNumericRangeError() <<
+			DigitalPinNumericOutput(val) << DigitalPinNumericBits(bits)
+		);
+	}
+	add(val, mask, delay);
+}
+
+void DigitalPinWaveform::wait(std::chrono::nanoseconds delay) {
+	if (stepv.empty()) {
+		add(0, 0, delay);
+	} else {
+		stepv.back().delay += delay;
+	}
+}
+
+unsigned int DigitalPinWaveform::width() const {
+	unsigned int w = 0;
+	for (std::uint64_t u = used; u; u >>= 1) {
+		++w;
+	}
+	return w;
+}
+
+std::chrono::nanoseconds DigitalPinWaveform::duration() const {
+	std::chrono::nanoseconds d(0);
+	for (const Step &s : stepv) {
+		d += s.delay;
+	}
+	return d;
+}
+
+} } }
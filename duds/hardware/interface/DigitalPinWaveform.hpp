@@ -0,0 +1,185 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef DIGITALPINWAVEFORM_HPP
+#define DIGITALPINWAVEFORM_HPP
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace duds { namespace hardware { namespace interface {
+
+/**
+ * A precomputed sequence of output states for the pins of a
+ * DigitalPinSetAccess object. Each step changes the output state of some or
+ * all of the pins at once, and may be followed by a minimum delay before the
+ * next step. The whole sequence is output by DigitalPinSetAccess::output(const DigitalPinWaveform &)
+ * with one lock of the port and one check of the pins, so bit-banged
+ * protocols avoid the overhead of an output call for every pin change. Ports
+ * may further optimize the output; GpioDevPort uses a single system call per
+ * step.
+ *
+ * Pins are identified by their position in the access object, like the
+ * positions used with DigitalPinSetAccess::output(unsigned int, bool). Up to
+ * 64 positions may be used. The pins are not reconfigured; as with the other
+ * output functions, a pin that is not an output will only have its stored
+ * output state changed.
+ *
+ * The same waveform may be output any number of times and to any access
+ * object with enough pins.
+ *
+ * @author  Jeff Jackowski
+ */
+class DigitalPinWaveform {
+public:
+	/**
+	 * A single change to the output states.
+	 */
+	struct Step {
+		/**
+		 * The output states. Bit N is the state for the pin at position N.
+		 */
+		std::uint64_t states;
+		/**
+		 * The pins to change. Bit N is set to change the pin at position N.
+		 */
+		std::uint64_t mask;
+		/**
+		 * The minimum time to wait after the step before the next step, or
+		 * before the output function returns for the last step.
+		 */
+		std::chrono::nanoseconds delay;
+	};
+private:
+	/**
+	 * The steps in output order.
+	 */
+	std::vector<Step> stepv;
+	/**
+	 * All the pins changed by any step.
+	 */
+	std::uint64_t used = 0;
+public:
+	/**
+	 * The maximum number of pin positions that may be used.
+	 */
+	static constexpr unsigned int MaxPins = 64;
+	/**
+	 * Makes an empty waveform.
+	 */
+	DigitalPinWaveform() = default;
+	/**
+	 * Makes an empty waveform with space for @a steps steps.
+	 */
+	DigitalPinWaveform(std::size_t steps) {
+		stepv.reserve(steps);
+	}
+	/**
+	 * Reserves space for @a steps steps.
+	 */
+	void reserve(std::size_t steps) {
+		stepv.reserve(steps);
+	}
+	/**
+	 * Removes all steps.
+	 */
+	void clear() {
+		stepv.clear();
+		used = 0;
+	}
+	/**
+	 * Adds a step that changes the pins in @a mask.
+	 * @param states  The output states; bit N is for the pin at position N.
+	 *                Bits not in @a mask are ignored.
+	 * @param mask    The pins to change.
+	 * @param delay   The minimum time to wait after this step.
+	 */
+	void add(
+		std::uint64_t states,
+		std::uint64_t mask,
+		std::chrono::nanoseconds delay = std::chrono::nanoseconds(0)
+	) {
+		stepv.push_back(Step { states & mask, mask, delay });
+		used |= mask;
+	}
+	/**
+	 * Adds a step that changes the output state of a single pin.
+	 * @param pos    The position of the pin in the access object.
+	 * @param state  The new output state.
+	 * @param delay  The minimum time to wait after this step.
+	 * @throw PinRangeError  @a pos is not less than MaxPins.
+	 */
+	void output(
+		unsigned int pos,
+		bool state,
+		std::chrono::nanoseconds delay = std::chrono::nanoseconds(0)
+	);
+	/**
+	 * Adds a step that writes out a number in binary to the pins, like
+	 * DigitalPinSetAccess::write(Int, int). The LSb is given to the pin at
+	 * position 0, the next bit to position 1, and so on.
+	 * @param val    The number to write.
+	 * @param bits   The number of bits, and pins, to write.
+	 * @param delay  The minimum time to wait after this step.
+	 * @throw PinRangeError  The number of bits to write is less than 1 or
+	 *                       greater than MaxPins.
+	 * @throw DigitalPinNumericRangeError  The given value is too large to fit
+	 *                                     in the requested number of bits.
+	 */
+	void write(
+		std::uint64_t val,
+		int bits,
+		std::chrono::nanoseconds delay = std::chrono::nanoseconds(0)
+	);
+	/**
+	 * Extends the delay after the last step. If there are no steps, a step
+	 * that changes no pins is added so that the sequence starts with a delay.
+	 * @param delay  The additional time to wait.
+	 */
+	void wait(std::chrono::nanoseconds delay);
+	/**
+	 * Returns the number of steps.
+	 */
+	std::size_t size() const {
+		return stepv.size();
+	}
+	/**
+	 * True if there are no steps.
+	 */
+	bool empty() const {
+		return stepv.empty();
+	}
+	/**
+	 * Returns the steps in output order.
+	 */
+	const std::vector<Step> &steps() const {
+		return stepv;
+	}
+	/**
+	 * Returns a mask of all the pins changed by the waveform.
+	 */
+	std::uint64_t pinsUsed() const {
+		return used;
+	}
+	/**
+	 * Returns the number of pins an access object must have to output this
+	 * waveform; one more than the highest position used.
+	 */
+	unsigned int width() const;
+	/**
+	 * Returns the sum of the delays in the waveform. This is the minimum
+	 * time required for output.
+	 */
+	std::chrono::nanoseconds duration() const;
+};
+
+} } }
+
+#endif        //  #ifndef DIGITALPINWAVEFORM_HPP
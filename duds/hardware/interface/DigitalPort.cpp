@@ -9,6 +9,7 @@
  */
 #include <duds/hardware/interface/DigitalPinAccess.hpp>
 #include <duds/hardware/interface/DigitalPinSetAccess.hpp>
+#include <duds/general/YieldingWait.hpp>
 
 namespace duds { namespace hardware { namespace interface {
 
@@ -431,6 +432,34 @@ void DigitalPort::updateAccess(
 	}
 }
 
+std::vector<DigitalPinConfig> DigitalPort::exchangeConfig(
+	const std::vector<unsigned int> &lids,
+	DigitalPinConfig::Flags clear,
+	DigitalPinConfig::Flags set
+) {
+	std::vector<DigitalPinConfig> prev;
+	prev.reserve(lids.size());
+	std::lock_guard<std::mutex> lock(block);
+	for (unsigned int lid : lids) {
+		DigitalPinConfig &dpc = pins[lid].conf;
+		prev.push_back(dpc);
+		dpc.options.clear(clear);
+		dpc.options |= set;
+	}
+	return prev;
+}
+
+void DigitalPort::restoreConfig(
+	const std::vector<unsigned int> &lids,
+	const std::vector<DigitalPinConfig> &confs
+) noexcept {
+	assert(lids.size() == confs.size());
+	std::lock_guard<std::mutex> lock(block);
+	for (std::size_t idx = 0; idx < lids.size(); ++idx) {
+		pins[lids[idx]].conf = confs[idx];
+	}
+}
+
 DigitalPinConfig DigitalPort::configuration(unsigned int gid) const {
 	unsigned int lid = localId(gid);
 	// assure no changes to the vector of pins
@@ -866,6 +895,42 @@ void DigitalPort::output(
 	outputImpl(pvec, state, pdata);
 }
 
+void DigitalPort::outputSequence(
+	const std::vector<unsigned int> &pvec,
+	const DigitalPinWaveform &wave,
+	DigitalPinAccessBase::PortData *pdata
+) {
+	// the waveform must not use more pins than are available
+	unsigned int width = wave.width();
+	if (width > pvec.size()) {
+		DUDS_THROW_EXCEPTION(PinRangeError() << DigitalPortAffected(this));
+	}
+	// assure no changes to the pins from other threads for the whole sequence
+	std::lock_guard<std::mutex> lock(block);
+	// check existence and output capability of the pins used, once
+	std::uint64_t used = wave.pinsUsed();
+	for (unsigned int pos = 0; pos < width; ++pos) {
+		if (!(used & ((std::uint64_t)1 << pos))) {
+			continue;
+		}
+		unsigned int lid = pvec[pos];
+		// out-of-range & non-existence check
+		if ((lid >= pins.size()) || !pins[lid]) {
+			DUDS_THROW_EXCEPTION(PinDoesNotExist() << DigitalPortAffected(this)
+				<< PinErrorId(globalId(lid))
+			);
+		}
+		// no output capability check
+		if (!pins[lid].cap.canOutput()) {
+			DUDS_THROW_EXCEPTION(DigitalPinCannotOutputError() <<
+				DigitalPortAffected(this) << PinErrorId(globalId(lid))
+			);
+		}
+	}
+	// passed error checks; do the output
+	outputSequenceImpl(pvec, wave, pdata);
+}
+
 void DigitalPort::outputImpl(
 	const std::vector<unsigned int> &pvec,
 	const std::vector<bool> &state,
@@ -882,4 +947,37 @@ void DigitalPort::outputImpl(
 	}
 }
 
+void DigitalPort::outputSequenceImpl(
+	const std::vector<unsigned int> &pvec,
+	const DigitalPinWaveform &wave,
+	DigitalPinAccessBase::PortData *pdata
+) {
+	// vectors reused for each step to avoid repeated allocation
+	std::vector<unsigned int> lids;
+	std::vector<bool> states;
+	lids.reserve(pvec.size());
+	states.reserve(pvec.size());
+	for (const DigitalPinWaveform::Step &step : wave.steps()) {
+		if (step.mask) {
+			lids.clear();
+			states.clear();
+			std::uint64_t mask = step.mask;
+			for (unsigned int pos = 0; mask; ++pos, mask >>= 1) {
+				if (mask & 1) {
+					lids.push_back(pvec[pos]);
+					states.push_back((step.states >> pos) & 1);
+				}
+			}
+			if (lids.size() == 1) {
+				outputImpl(lids.front(), states.front(), pdata);
+			} else {
+				outputImpl(lids, states, pdata);
+			}
+		}
+		if (step.delay.count() > 0) {
+			duds::general::YieldingWait(step.delay);
+		}
+	}
+}
+
 } } }
@@ -12,6 +12,7 @@
 
 #include <duds/hardware/interface/DigitalPinCap.hpp>
 #include <duds/hardware/interface/DigitalPinAccessBase.hpp>
+#include <duds/hardware/interface/DigitalPinWaveform.hpp>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -192,6 +193,33 @@ protected:
 	 * before then to avoid bad behavior, such as a process crash.
 	 */
 	void shutdown();
+	/**
+	 * Changes the recorded configuration of pins that are reserved by an
+	 * object other than an access object, such as GpioDevEvents, after that
+	 * object has configured the hardware. The pins' configurations are
+	 * changed while @a block is locked.
+	 * @param lids   The local IDs of the pins.
+	 * @param clear  The configuration flags to clear from each pin.
+	 * @param set    The configuration flags to set on each pin after
+	 *               clearing @a clear.
+	 * @return       The previous configuration of each pin, in the same order
+	 *               as @a lids, for use with restoreConfig().
+	 */
+	std::vector<DigitalPinConfig> exchangeConfig(
+		const std::vector<unsigned int> &lids,
+		DigitalPinConfig::Flags clear,
+		DigitalPinConfig::Flags set
+	);
+	/**
+	 * Puts back configurations returned by exchangeConfig() while @a block
+	 * is locked.
+	 * @param lids   The local IDs of the pins given to exchangeConfig().
+	 * @param confs  The configurations returned by exchangeConfig().
+	 */
+	void restoreConfig(
+		const std::vector<unsigned int> &lids,
+		const std::vector<DigitalPinConfig> &confs
+	) noexcept;
 
 	/* *  UnimplementedError
 	 * Adds pins to an already constructed port. The pins will be initialized
@@ -435,6 +463,27 @@ protected:
 		const std::vector<bool> &state,
 		DigitalPinAccessBase::PortData *pdata
 	);
+	/**
+	 * Does error checking in advance of calling outputSequenceImpl() to
+	 * output a sequence of states to a set of pins. The port is locked for
+	 * the duration of the sequence.
+	 * @param pvec   The local IDs of the pins. Position N in a step of
+	 *               @a wave is for the pin at @a pvec[N].
+	 * @param wave   The sequence of output states.
+	 * @param pdata  A pointer to the port specific data stored in the
+	 *               corresponding access object for the pins.
+	 * @throw PinRangeError                @a wave uses more pins than are in
+	 *                                     @a pvec.
+	 * @throw PinDoesNotExist              A requested pin is not handled by
+	 *                                     this port.
+	 * @throw DigitalPinCannotOutputError  One of the pins used by @a wave
+	 *                                     cannot be configured as an output.
+	 */
+	void outputSequence(
+		const std::vector<unsigned int> &pvec,
+		const DigitalPinWaveform &wave,
+		DigitalPinAccessBase::PortData *pdata
+	);
 	/**
 	 * Changes the output state of the given pin. If the pin is not configured
 	 * as an output, its configuration will not change. However, this new state
@@ -474,6 +523,27 @@ protected:
 		const std::vector<bool> &state,
 		DigitalPinAccessBase::PortData *pdata
 	);
+	/**
+	 * Outputs each step of a waveform in turn, waiting at least the step's
+	 * delay after each one. The pins have already been checked, and the
+	 * port is locked.
+	 *
+	 * The implementation in DigitalPort calls
+	 * outputImpl(const std::vector<unsigned int> &, const std::vector<bool> &, DigitalPinAccessBase::PortData *)
+	 * for each step that changes pins. Ports that can change several pins
+	 * with less overhead should override this function.
+	 *
+	 * @param pvec   The local IDs of the pins. Position N in a step of
+	 *               @a wave is for the pin at @a pvec[N].
+	 * @param wave   The sequence of output states.
+	 * @param pdata  A pointer to the port specific data stored in the
+	 *               corresponding access object for the pins.
+	 */
+	virtual void outputSequenceImpl(
+		const std::vector<unsigned int> &pvec,
+		const DigitalPinWaveform &wave,
+		DigitalPinAccessBase::PortData *pdata
+	);
 	/**
 	 * Called after a new access object is made to allow a port implementation
 	 * to take further action. The call is made while there is a lock on
@@ -63,6 +63,13 @@ public:
 	 *                             other exceptions.
 	 */
 	virtual void converse(Conversation &conv) = 0;
+	/**
+	 * Conducts I2C communication with a device using a conversation held in
+	 * a ConversationArena. The handling of the conversation and the
+	 * exceptions are the same as with converse(Conversation &).
+	 * @param conv  The conversation to have with the device on the other end.
+	 */
+	virtual void converse(const ConversationArena &conv) = 0;
 	/**
 	 * Returns the address of the device that this object will attempt to
 	 * communicate with.
@@ -38,6 +38,12 @@ struct I2cErrorConversationLength : I2cError { };
  */
 struct I2cErrorNoBus : I2cError { };
 
+/**
+ * An object for a device on one I2C bus was used where a device on another
+ * bus is required.
+ */
+struct I2cErrorWrongBus : I2cError { };
+
 /**
  * The device did not respond to its address (NACK). It could be a transient
  * error, or there may not be a device at the address. Devices that support a
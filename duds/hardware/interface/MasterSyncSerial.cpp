@@ -10,6 +10,7 @@
 #include <duds/hardware/interface/MasterSyncSerialAccess.hpp>
 #include <duds/hardware/interface/MasterSyncSerialErrors.hpp>
 #include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
 #include <duds/general/Errors.hpp>
 
 namespace duds { namespace hardware { namespace interface {
@@ -33,7 +34,8 @@ constexpr MasterSyncSerial::Flags MasterSyncSerial::MssSpiMode1LSb;
 constexpr MasterSyncSerial::Flags MasterSyncSerial::MssSpiMode2LSb;
 constexpr MasterSyncSerial::Flags MasterSyncSerial::MssSpiMode3LSb;
 
-MasterSyncSerial::MasterSyncSerial(Flags f, int p) : minHalfPeriod(p >> 1) {
+MasterSyncSerial::MasterSyncSerial(Flags f, int p) :
+mssacc(nullptr), minHalfPeriod(p >> 1) {
 	flags = f & MssConfigMask;
 }
 
@@ -159,11 +161,11 @@ void MasterSyncSerial::receive(std::uint8_t *buff, duds::general::Bits bits) {
 	transfer(nullptr, buff, bits);
 }
 
-void MasterSyncSerial::converseAlreadyOpen(Conversation &conv) {
+template <class Iter>
+void MasterSyncSerial::converseParts(Iter iter, Iter end) {
 	// visit each conversation part
-	Conversation::PartVector::iterator iter = conv.begin();
-	for (; iter != conv.end(); ++iter) {
-		ConversationPart &cp = *(*iter);
+	for (; iter != end; ++iter) {
+		const auto &cp = conversationPart(*iter);
 		// check for need to provide a break in chip selection, or similar detail
 		if (cp.flags() & ConversationPart::MpfBreak) {
 			// deselect
@@ -182,7 +184,16 @@ void MasterSyncSerial::converseAlreadyOpen(Conversation &conv) {
 	condStop();
 }
 
-void MasterSyncSerial::converse(Conversation &conv) {
+void MasterSyncSerial::converseAlreadyOpen(Conversation &conv) {
+	converseParts(conv.cbegin(), conv.cend());
+}
+
+void MasterSyncSerial::converseAlreadyOpen(const ConversationArena &conv) {
+	converseParts(conv.begin(), conv.end());
+}
+
+template <class Conv>
+void MasterSyncSerial::converseOpenClose(Conv &conv) {
 	if (~flags & MssReady) {
 		DUDS_THROW_EXCEPTION(SyncSerialNotReady());
 	}
@@ -207,4 +218,12 @@ void MasterSyncSerial::converse(Conversation &conv) {
 	flags.clear(MssOpen);
 }
 
+void MasterSyncSerial::converse(Conversation &conv) {
+	converseOpenClose(conv);
+}
+
+void MasterSyncSerial::converse(const ConversationArena &conv) {
+	converseOpenClose(conv);
+}
+
 } } } // namespaces
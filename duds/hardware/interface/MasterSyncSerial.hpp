@@ -103,6 +103,18 @@ public std::enable_shared_from_this<MasterSyncSerial> {
 	 * A pointer to the current access object or nullptr.
 	 */
 	MasterSyncSerialAccess *mssacc;
+	/**
+	 * Implements converseAlreadyOpen() for both conversation types.
+	 * @tparam Iter  The iterator type of the conversation.
+	 */
+	template <class Iter>
+	void converseParts(Iter iter, Iter end);
+	/**
+	 * Implements converse() for both conversation types.
+	 * @tparam Conv  The conversation type.
+	 */
+	template <class Conv>
+	void converseOpenClose(Conv &conv);
 	/**
 	 * Removes the access object from use.
 	 * @throw SyncSerialInvalidAccess  @a acc is not the current access object.
@@ -369,20 +381,32 @@ protected:
 	 * Conversation object defines all input and output parameters. On the
 	 * ConversationPart objects, the @ref ConversationPart::MpfBreak "MpfBreak"
 	 * flag is honored, but the @ref ConversationPart::MpfVarlen "MpfVarlen"
-	 * flag is ignored. The transmit() and receive() functions are called to
-	 * move the data.
+	 * flag is ignored. This implementation calls the transmit() and receive()
+	 * functions to move the data. Derived classes may override this function
+	 * when the whole conversation can be given to the hardware at once.
+	 * @pre   The object is in the open state or the communicating state.
+	 * @post  The object is in the open state, but not the communicating state.
+	 * @param conv  The conversation to have with the device on the other end.
+	 * @throw SyncSerialIoError     An error prevented the communication.
+	 */
+	virtual void converseAlreadyOpen(Conversation &conv);
+	/**
+	 * Has a half-duplex conversation held in a ConversationArena with the
+	 * connected device. Otherwise, this is the same as
+	 * converseAlreadyOpen(Conversation &). Implementations must not allocate
+	 * memory.
 	 * @pre   The object is in the open state or the communicating state.
 	 * @post  The object is in the open state, but not the communicating state.
 	 * @param conv  The conversation to have with the device on the other end.
 	 * @throw SyncSerialIoError     An error prevented the communication.
 	 */
-	void converseAlreadyOpen(Conversation &conv);
+	virtual void converseAlreadyOpen(const ConversationArena &conv);
 public:
 	/**
 	 * Builds a MasterSyncSerial with an invalid clock period and all
 	 * configuration flags clear.
 	 */
-	MasterSyncSerial() : minHalfPeriod(0), flags(0)  { }
+	MasterSyncSerial() : mssacc(nullptr), minHalfPeriod(0), flags(0)  { }
 	/**
 	 * Builds a MasterSyncSerial object.
 	 * @param flags   The initial set of configuration flags.
@@ -499,6 +523,18 @@ public:
 	 * @throw SyncSerialIoError     An error prevented the communication.
 	 */
 	virtual void converse(Conversation &conv);
+	/**
+	 * Has a half-duplex conversation held in a ConversationArena with the
+	 * connected device. Otherwise, this is the same as
+	 * converse(Conversation &).
+	 * @pre   The object is in the ready state, but not the open state. There
+	 *        must not be an access object to use this object.
+	 * @post  The object is in the ready state and not the open state.
+	 * @param conv  The conversation to have with the device on the other end.
+	 * @throw SyncSerialInUse       The object is already in the open state.
+	 * @throw SyncSerialIoError     An error prevented the communication.
+	 */
+	virtual void converse(const ConversationArena &conv);
 };
 
 } } } // namespaces
@@ -266,6 +266,18 @@ public:
 	void converse(Conversation &conv) {
 		mss->converseAlreadyOpen(conv);
 	}
+	/**
+	 * Has a half-duplex conversation held in a ConversationArena with the
+	 * connected device. Otherwise, this is the same as
+	 * converse(Conversation &).
+	 * @pre   The object is in the open state or the communicating state.
+	 * @post  The object is in the open state, but not the communicating state.
+	 * @param conv  The conversation to have with the device on the other end.
+	 * @throw SyncSerialIoError     An error prevented the communication.
+	 */
+	void converse(const ConversationArena &conv) {
+		mss->converseAlreadyOpen(conv);
+	}
 };
 
 } } }
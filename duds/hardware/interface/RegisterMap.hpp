@@ -0,0 +1,452 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Compile-time descriptions of device registers, and the fixed size
+ * conversations to read and write them.
+ *
+ * Many devices are used by writing a register address followed by either
+ * data to write starting at that register, or by reading data starting at
+ * that register. The templates here describe registers by their address,
+ * size, byte order, and sign, as well as bit fields within registers and
+ * arrays of registers. The descriptions are used by RegisterRead and
+ * RegisterWrite to hold a ConversationArena of exactly the needed size, and
+ * to convert between the register data and integers without the run-time
+ * checks of ConversationExtractor.
+ *
+ * A typical driver declares typedefs for its registers:
+ * @code
+ * typedef Register<0x14, 2> Ch0;
+ * typedef Register<0x16, 2> Ch1;
+ * typedef RegisterBurst<Ch0, Ch1> Channels;
+ * RegisterRead<Channels> input;
+ * // . . .
+ * input.converse(*com);
+ * std::uint16_t ch0 = input.get<Ch0>();
+ * @endcode
+ *
+ * The conversations require a Conversationalist, so drivers that talk to
+ * their device through Smbus, like the APDS9301 driver, cannot use them.
+ */
+#ifndef REGISTERMAP_HPP
+#define REGISTERMAP_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <duds/general/SignExtend.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
+#include <duds/hardware/interface/Conversationalist.hpp>
+
+namespace duds { namespace hardware { namespace interface {
+
+/**
+ * The smallest unsigned integer type with at least the given number of bytes.
+ * @tparam Bytes  The number of bytes; must be from 1 to 8.
+ */
+template <std::size_t Bytes>
+using RegisterUint = typename std::conditional<
+	(Bytes <= 1),
+	std::uint8_t,
+	typename std::conditional<
+		(Bytes <= 2),
+		std::uint16_t,
+		typename std::conditional<
+			(Bytes <= 4),
+			std::uint32_t,
+			std::uint64_t
+		>::type
+	>::type
+>::type;
+
+/**
+ * Describes a value held in one or more registers with contiguous addresses.
+ * @tparam Addr    The address of the first register.
+ * @tparam Bytes   The number of bytes, or registers, holding the value.
+ * @tparam Big     True if the most significant byte is at the lowest
+ *                 address.
+ * @tparam Signed  True for a two's complement value.
+ * @author  Jeff Jackowski
+ */
+template <
+	std::uint8_t Addr,
+	std::size_t Bytes = 1,
+	bool Big = false,
+	bool Signed = false
+>
+struct Register {
+	static_assert((Bytes > 0) && (Bytes <= 8),
+		"Registers must be from 1 to 8 bytes long."
+	);
+	/**
+	 * The unsigned integer type that holds the register's bits.
+	 */
+	typedef RegisterUint<Bytes>  Raw;
+	/**
+	 * The integer type of the value.
+	 */
+	typedef typename std::conditional<
+		Signed, typename std::make_signed<Raw>::type, Raw
+	>::type  Type;
+	/**
+	 * The address of the first register.
+	 */
+	static constexpr std::uint8_t address = Addr;
+	/**
+	 * The number of bytes used by the value.
+	 */
+	static constexpr std::size_t size = Bytes;
+	/**
+	 * Returns the bits of the register from the device's data.
+	 * @param buf  The register's data in the order sent by the device.
+	 */
+	static constexpr Raw raw(const char *buf) {
+		Raw r = 0;
+		for (std::size_t b = 0; b < Bytes; ++b) {
+			r |= (Raw)((Raw)(std::uint8_t)buf[b] <<
+				(8 * (Big ? (Bytes - 1 - b) : b))
+			);
+		}
+		return r;
+	}
+	/**
+	 * Returns the value of the register from the device's data.
+	 * @param buf  The register's data in the order sent by the device.
+	 */
+	static constexpr Type decode(const char *buf) {
+		if constexpr (Signed && (sizeof(Raw) > Bytes)) {
+			return duds::general::SignExtend<Bytes * 8>(raw(buf));
+		} else {
+			return (Type)raw(buf);
+		}
+	}
+	/**
+	 * Writes a value in the device's byte order.
+	 * @param buf  The destination of the register's data.
+	 * @param v    The value to write.
+	 */
+	static constexpr void encode(char *buf, Type v) {
+		for (std::size_t b = 0; b < Bytes; ++b) {
+			buf[b] = (char)((Raw)v >> (8 * (Big ? (Bytes - 1 - b) : b)));
+		}
+	}
+};
+
+/**
+ * Describes a bit field within a register.
+ * @tparam Reg     The Register holding the field.
+ * @tparam Shift   The position of the field's least significant bit.
+ * @tparam Bits    The number of bits in the field.
+ * @tparam Signed  True for a two's complement value.
+ * @author  Jeff Jackowski
+ */
+template <class Reg, unsigned Shift, unsigned Bits, bool Signed = false>
+struct RegisterField {
+	/**
+	 * The unsigned integer type that holds the register's bits.
+	 */
+	typedef typename Reg::Raw  Raw;
+	static_assert((Bits > 0) && ((Shift + Bits) <= (Reg::size * 8)),
+		"The field must be inside the register."
+	);
+	/**
+	 * The integer type of the value.
+	 */
+	typedef typename std::conditional<
+		Signed, typename std::make_signed<Raw>::type, Raw
+	>::type  Type;
+	/**
+	 * The address of the first register.
+	 */
+	static constexpr std::uint8_t address = Reg::address;
+	/**
+	 * The number of bytes used by the register holding the field.
+	 */
+	static constexpr std::size_t size = Reg::size;
+	/**
+	 * The bits of the register used by the field.
+	 */
+	static constexpr Raw mask = (Raw)((Bits == (sizeof(Raw) * 8) ?
+		(Raw)~(Raw)0 : (Raw)(((Raw)1 << Bits) - 1)) << Shift
+	);
+	/**
+	 * Returns the field's value from the register's bits.
+	 */
+	static constexpr Type extract(Raw r) {
+		Raw v = (Raw)((r & mask) >> Shift);
+		if constexpr (Signed) {
+			return duds::general::SignExtend<Bits>(v);
+		} else {
+			return v;
+		}
+	}
+	/**
+	 * Returns the register's bits with the field changed to the given value.
+	 */
+	static constexpr Raw insert(Raw r, Type v) {
+		return (Raw)((r & ~mask) | (((Raw)v << Shift) & mask));
+	}
+	/**
+	 * Returns the value of the field from the device's data.
+	 * @param buf  The register's data in the order sent by the device.
+	 */
+	static constexpr Type decode(const char *buf) {
+		return extract(Reg::raw(buf));
+	}
+	/**
+	 * Changes the field's bits in register data; other bits are unchanged.
+	 * @param buf  The register's data in the order used by the device.
+	 * @param v    The value to write.
+	 */
+	static constexpr void encode(char *buf, Type v) {
+		Reg::encode(buf, insert(Reg::raw(buf), v));
+	}
+};
+
+/**
+ * Describes an array of identical registers, or fields, with contiguous
+ * addresses.
+ * @tparam Elem   The Register or RegisterField for the first element.
+ * @tparam Count  The number of elements.
+ * @author  Jeff Jackowski
+ */
+template <class Elem, std::size_t Count>
+struct RegisterArray {
+	/**
+	 * The integer type of the elements.
+	 */
+	typedef typename Elem::Type  Type;
+	/**
+	 * The address of the first register.
+	 */
+	static constexpr std::uint8_t address = Elem::address;
+	/**
+	 * The number of bytes used by the whole array.
+	 */
+	static constexpr std::size_t size = Elem::size * Count;
+	/**
+	 * The number of elements.
+	 */
+	static constexpr std::size_t count = Count;
+	/**
+	 * Returns the value of an element from the device's data.
+	 * @param buf  The array's data in the order sent by the device.
+	 * @param idx  The index of the element.
+	 */
+	static constexpr Type decode(const char *buf, std::size_t idx) {
+		return Elem::decode(buf + idx * Elem::size);
+	}
+	/**
+	 * Writes an element in the device's byte order.
+	 * @param buf  The array's data in the order used by the device.
+	 * @param idx  The index of the element.
+	 * @param v    The value to write.
+	 */
+	static constexpr void encode(char *buf, std::size_t idx, Type v) {
+		Elem::encode(buf + idx * Elem::size, v);
+	}
+};
+
+/**
+ * Describes a set of registers that are read or written together, starting
+ * from the lowest address through the highest. Any registers in between that
+ * are not part of the set are included in the transfer.
+ * @tparam Regs  The Register, RegisterField, or RegisterArray types.
+ * @author  Jeff Jackowski
+ */
+template <class... Regs>
+struct RegisterBurst {
+	static_assert(sizeof...(Regs) > 0, "A burst requires a register.");
+	/**
+	 * The address of the first register.
+	 */
+	static constexpr std::uint8_t address = std::min({ Regs::address... });
+	/**
+	 * The number of bytes from the first register through the last.
+	 */
+	static constexpr std::size_t size =
+		std::max({ (std::size_t)Regs::address + Regs::size... }) - address;
+};
+
+/**
+ * Computes the offset of a register within the data of another register
+ * description, and assures at compile time that it is inside.
+ * @tparam Outer  The register description that holds @a Inner.
+ * @tparam Inner  The register description to find.
+ */
+template <class Outer, class Inner>
+constexpr std::size_t RegisterOffset() {
+	static_assert(
+		(Inner::address >= Outer::address) &&
+		((Inner::address + Inner::size) <= (Outer::address + Outer::size)),
+		"The register is not inside the described range."
+	);
+	return Inner::address - Outer::address;
+}
+
+/**
+ * A reusable conversation that reads a Register, RegisterField,
+ * RegisterArray, or RegisterBurst from a device. The conversation writes the
+ * address of the first register, then reads the data. The data is converted
+ * to integers by get() without any run-time checks; any problem with the
+ * requested register is reported when compiling.
+ * @tparam Reg        The register description.
+ * @tparam AddrFlags  Bits to set along with the address. Some devices use
+ *                    these to select automatic address increment or similar
+ *                    features.
+ * @author  Jeff Jackowski
+ */
+template <class Reg, std::uint8_t AddrFlags = 0>
+class RegisterRead {
+	/**
+	 * The conversation.
+	 */
+	FixedConversation<Reg::size + 1, 2> conv;
+	/**
+	 * The start of the input data.
+	 */
+	const char *data;
+public:
+	/**
+	 * Makes the conversation.
+	 * @param f  Extra flags for the output part of the conversation, such as
+	 *           @ref ConversationPart::MpfBreak "MpfBreak".
+	 */
+	RegisterRead(
+		ConversationPart::Flags f = ConversationPart::Flags::Zero()
+	) {
+		conv.addOutput({ (std::uint8_t)(Reg::address | AddrFlags) }, f);
+		data = conv.addInput(Reg::size);
+	}
+	/**
+	 * Returns the conversation.
+	 */
+	const ConversationArena &conversation() const {
+		return conv;
+	}
+	/**
+	 * Reads the registers from the device.
+	 * @param com  The object used to communicate with the device.
+	 */
+	void converse(Conversationalist &com) const {
+		com.converse(conv);
+	}
+	/**
+	 * Returns the data read from the device.
+	 */
+	const char *buffer() const {
+		return data;
+	}
+	/**
+	 * Returns the value of a register from the last read.
+	 * @tparam R  A Register or RegisterField within @a Reg. The default is
+	 *            @a Reg.
+	 */
+	template <class R = Reg>
+	typename R::Type get() const {
+		return R::decode(data + RegisterOffset<Reg, R>());
+	}
+	/**
+	 * Returns the value of an element of a RegisterArray from the last read.
+	 * @tparam R   A RegisterArray within @a Reg.
+	 * @param idx  The index of the element.
+	 */
+	template <class R>
+	typename R::Type get(std::size_t idx) const {
+		return R::decode(data + RegisterOffset<Reg, R>(), idx);
+	}
+};
+
+/**
+ * A reusable conversation that writes a Register, RegisterField,
+ * RegisterArray, or RegisterBurst to a device. The conversation writes the
+ * address of the first register, followed by the data. The data starts out
+ * zeroed and is changed by set().
+ * @tparam Reg        The register description.
+ * @tparam AddrFlags  Bits to set along with the address. Some devices use
+ *                    these to select automatic address increment or similar
+ *                    features.
+ * @author  Jeff Jackowski
+ */
+template <class Reg, std::uint8_t AddrFlags = 0>
+class RegisterWrite {
+	/**
+	 * The conversation.
+	 */
+	FixedConversation<Reg::size + 1, 1> conv;
+	/**
+	 * The start of the register data.
+	 */
+	char *data;
+public:
+	/**
+	 * Makes the conversation with all register data cleared.
+	 * @param f  Extra flags for the conversation part, such as
+	 *           @ref ConversationPart::MpfBreak "MpfBreak".
+	 */
+	RegisterWrite(
+		ConversationPart::Flags f = ConversationPart::Flags::Zero()
+	) {
+		data = conv.addOutput(Reg::size + 1, f);
+		*data = (char)(Reg::address | AddrFlags);
+		++data;
+		std::memset(data, 0, Reg::size);
+	}
+	/**
+	 * Returns the conversation.
+	 */
+	const ConversationArena &conversation() const {
+		return conv;
+	}
+	/**
+	 * Writes the registers to the device.
+	 * @param com  The object used to communicate with the device.
+	 */
+	void converse(Conversationalist &com) const {
+		com.converse(conv);
+	}
+	/**
+	 * Changes the value of a register or field to write. Fields are changed
+	 * without altering other bits in their register.
+	 * @tparam R  A Register or RegisterField within @a Reg. The default is
+	 *            @a Reg.
+	 * @param  v  The new value.
+	 * @return    This object to allow chaining.
+	 */
+	template <class R = Reg>
+	RegisterWrite &set(typename R::Type v) {
+		R::encode(data + RegisterOffset<Reg, R>(), v);
+		return *this;
+	}
+	/**
+	 * Changes the value of an element of a RegisterArray to write.
+	 * @tparam R   A RegisterArray within @a Reg.
+	 * @param idx  The index of the element.
+	 * @param v    The new value.
+	 * @return     This object to allow chaining.
+	 */
+	template <class R>
+	RegisterWrite &set(std::size_t idx, typename R::Type v) {
+		R::encode(data + RegisterOffset<Reg, R>(), idx, v);
+		return *this;
+	}
+	/**
+	 * Returns the value of a register or field that will be written.
+	 * @tparam R  A Register or RegisterField within @a Reg. The default is
+	 *            @a Reg.
+	 */
+	template <class R = Reg>
+	typename R::Type get() const {
+		return R::decode(data + RegisterOffset<Reg, R>());
+	}
+};
+
+} } }
+
+#endif        //  #ifndef REGISTERMAP_HPP
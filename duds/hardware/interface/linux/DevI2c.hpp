@@ -8,6 +8,7 @@
  * Copyright (C) 2017  Jeff Jackowski
  */
 #include <duds/hardware/interface/I2c.hpp>
+#include <duds/hardware/interface/linux/DevI2cBus.hpp>
 #include <string>
 
 #ifdef linux
@@ -15,8 +16,6 @@
 #undef linux
 #endif
 
-struct i2c_rdwr_ioctl_data;
-
 namespace duds { namespace hardware { namespace interface { namespace linux {
 
 /**
@@ -27,6 +26,12 @@ namespace duds { namespace hardware { namespace interface { namespace linux {
  * the kernel's i2c-gpio driver should be more efficient than implementing the
  * I2C protocol with user-space GPIO support.
  *
+ * Each object communicates with one device through a DevI2cBus. Objects for
+ * devices on the same bus should share a DevI2cBus object, either by using
+ * DevI2cBus::device() or the constructor that takes a bus, so that the
+ * bus's device file is only opened once and the devices may be used together
+ * in a DevI2cBatch.
+ *
  * All thrown exceptions will include an attribute of boost::errinfo_file_name
  * with the device file name, along with
  * @ref duds::hardware::interface::I2cDeviceAddr "I2cDeviceAddr".
@@ -35,25 +40,17 @@ namespace duds { namespace hardware { namespace interface { namespace linux {
  */
 class DevI2c : public duds::hardware::interface::I2c {
 	/**
-	 * Stores the device file name for later error reporting.
-	 */
-	std::string dev;
-	/**
-	 * The file descriptor for the open device.
+	 * The bus with the device.
 	 */
-	int fd;
+	std::shared_ptr<DevI2cBus> bus;
 	/**
 	 * The device (slave) address.
 	 */
 	int addr;
-	/**
-	 * Calls ioctl to request the kernel do the I2C communication, the check
-	 * for error conditions and throw corresponding exception on error.
-	 */
-	void io(i2c_rdwr_ioctl_data &idat);
 public:
 	/**
-	 * Opens the device file for the bus.
+	 * Opens the device file for the bus. The bus is not shared with any other
+	 * DevI2c object.
 	 * @param devname  The path to the device file, usually @a /dev/i2c-N
 	 *                 where N is the number assigned to the bus.
 	 * @param devaddr  The device, or slave, address used as the destination of
@@ -64,9 +61,20 @@ public:
 	 */
 	DevI2c(const std::string &devname, int devaddr);
 	/**
-	 * Closes the device file.
+	 * Uses an already open bus.
+	 * @param i2cbus   The bus with the device.
+	 * @param devaddr  The device, or slave, address used as the destination of
+	 *                 communications.
+	 * @throw I2cErrorUnsupported   A 10-bit address was requested but is not
+	 *                              supported by the kernel's driver.
+	 */
+	DevI2c(const std::shared_ptr<DevI2cBus> &i2cbus, int devaddr);
+	/**
+	 * Returns the bus used by this object.
 	 */
-	~DevI2c();
+	const std::shared_ptr<DevI2cBus> &i2cBus() const {
+		return bus;
+	}
 	/**
 	 * Conducts I2C communication with a device using the Linux i2c-dev driver.
 	 *
@@ -100,6 +108,13 @@ public:
 	 *                             other exceptions.
 	 */
 	virtual void converse(Conversation &conv);
+	/**
+	 * Conducts I2C communication with a device using a conversation held in
+	 * a ConversationArena. The conversation is handled the same as with
+	 * converse(Conversation &), and no memory is allocated.
+	 * @param conv  The conversation to have with the device on the other end.
+	 */
+	virtual void converse(const ConversationArena &conv);
 	virtual int address() const;
 };
 
@@ -0,0 +1,289 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/linux/DevI2c.hpp>
+#include <duds/hardware/interface/I2cErrors.hpp>
+#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
+#include <duds/general/Errors.hpp>
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <fcntl.h>      // for open and O_RDWR
+#include <unistd.h>     // for close
+#include <sys/ioctl.h>  // for ioctl
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+namespace duds { namespace hardware { namespace interface { namespace linux {
+
+// The maximum number of supported I2C messages in a single ioctl call has a
+// typo in some earlier kernels. A fix was put in by 4.4. Attempt to use
+// the non-typo first so that when the typo is eventually removed this code
+// doesn't break.
+#ifdef I2C_RDWR_IOCTL_MAX_MSGS
+#define I2C_MAX_MSGS  I2C_RDWR_IOCTL_MAX_MSGS
+#elif defined(I2C_RDRW_IOCTL_MAX_MSGS)
+#define I2C_MAX_MSGS  I2C_RDRW_IOCTL_MAX_MSGS
+#else
+#error Neither I2C_RDWR_IOCTL_MAX_MSGS nor I2C_RDRW_IOCTL_MAX_MSGS is defined.
+#endif
+
+/**
+ * Fills a buffer of I2C messages from conversations and gives them to the
+ * kernel in a single ioctl call when full, at a break, or when done.
+ */
+class DevI2cBus::MsgBuilder {
+	/**
+	 * The messages.
+	 */
+	i2c_msg msgs[I2C_MAX_MSGS];
+	/**
+	 * The bus that will handle the messages.
+	 */
+	DevI2cBus &bus;
+	/**
+	 * The number of messages in @a msgs.
+	 */
+	int count = 0;
+	/**
+	 * The address used by all the messages, or -1 if there is more than one.
+	 */
+	int addr = -1;
+	/**
+	 * Returns the number of parts from @a iter until the next break or the
+	 * end of the conversation.
+	 */
+	template <class Iter>
+	static int segmentLength(Iter iter, Iter end) {
+		int len = 1;
+		for (++iter; (iter != end) && !(conversationPart(*iter).flags() &
+			ConversationPart::MpfBreak); ++iter
+		) {
+			++len;
+		}
+		return len;
+	}
+	/**
+	 * Adds a single message.
+	 * @tparam Part  Either ConversationPart or ConversationArena::Part.
+	 */
+	template <class Part>
+	void add(int devaddr, const Part &cp, int idx) {
+		__u16 flags;
+		// input part?
+		if (cp.input()) {
+			flags = I2C_M_RD;
+			if (cp.varyingLength()) {
+				// Check for inadequate length.
+				// Kernel header comments seem to imply that I2C_SMBUS_BLOCK_MAX
+				// is not intended to be the correct value for this check
+				// because I2C != SMBus, but kernel code seems to be using it
+				// anyway.
+				if (cp.length() <= 32) {
+					DUDS_THROW_EXCEPTION(I2cErrorPartLength() <<
+						boost::errinfo_file_name(bus.dev) <<
+						I2cDeviceAddr(devaddr) << ConversationPartIndex(idx)
+					);
+				}
+				// possibility that the first byte of the buffer needs to be
+				// set to 1 (number of bytes in addition to max recv len)
+				flags |= I2C_M_RECV_LEN;
+			}
+		} else {
+			flags = 0;
+		}
+		if (devaddr > 127) {
+			flags |= I2C_M_TEN;
+		}
+		if (!count) {
+			addr = devaddr;
+		} else if (addr != devaddr) {
+			addr = -1;
+		}
+		msgs[count].addr = devaddr;
+		msgs[count].flags = flags;
+		msgs[count].len = cp.length();
+		msgs[count].buf = (__u8*)cp.start();
+		++count;
+	}
+public:
+	MsgBuilder(DevI2cBus &b) : bus(b) { }
+	/**
+	 * Adds the messages for a sequence of conversation parts. Messages
+	 * already added may be sent to make room.
+	 * @param devaddr  The device address.
+	 * @param iter     The first part.
+	 * @param end      The end of the parts.
+	 */
+	template <class Iter>
+	void add(int devaddr, Iter iter, Iter end) {
+		for (int idx = 0; iter != end; ++iter, ++idx) {
+			// start of a segment?
+			if (!idx || (conversationPart(*iter).flags() &
+				ConversationPart::MpfBreak)
+			) {
+				int len = segmentLength(iter, end);
+				if (len > I2C_MAX_MSGS) {
+					DUDS_THROW_EXCEPTION(I2cErrorConversationLength() <<
+						boost::errinfo_file_name(bus.dev) <<
+						I2cDeviceAddr(devaddr) << ConversationPartIndex(idx)
+					);
+				}
+				// a break, or not enough room, requires sending what has
+				// been collected so far
+				if (idx || ((count + len) > I2C_MAX_MSGS)) {
+					flush();
+				}
+			}
+			add(devaddr, conversationPart(*iter), idx);
+		}
+	}
+	/**
+	 * Adds the messages of a conversation. Messages already added may be sent
+	 * to make room.
+	 * @param devaddr  The device address.
+	 * @param conv     The conversation.
+	 */
+	void add(int devaddr, const Conversation &conv) {
+		add(devaddr, conv.cbegin(), conv.cend());
+	}
+	/**
+	 * Adds the messages of a conversation. Messages already added may be sent
+	 * to make room.
+	 * @param devaddr  The device address.
+	 * @param conv     The conversation.
+	 */
+	void add(int devaddr, const ConversationArena &conv) {
+		add(devaddr, conv.begin(), conv.end());
+	}
+	/**
+	 * Sends all the collected messages.
+	 */
+	void flush() {
+		if (!count) {
+			return;
+		}
+		i2c_rdwr_ioctl_data idat = {
+			.msgs = msgs,
+			.nmsgs = (__u32)count
+		};
+		count = 0;
+		if (ioctl(bus.fd, I2C_RDWR, &idat) < 0) {
+			int res = errno;
+			try {
+				switch (res) {
+					case EBUSY:
+						DUDS_THROW_EXCEPTION(I2cErrorBusy() <<
+							boost::errinfo_file_name(bus.dev)
+						);
+					case ENXIO:
+					case ENODEV:
+					case EREMOTEIO: // seems to be used for the same thing as
+									// above, but not documented as such in
+									// Linux I2C docs
+						DUDS_THROW_EXCEPTION(I2cErrorNoDevice() <<
+							boost::errinfo_file_name(bus.dev) <<
+							boost::errinfo_errno(res)
+						);
+					case EOPNOTSUPP:
+						DUDS_THROW_EXCEPTION(I2cErrorUnsupported() <<
+							boost::errinfo_file_name(bus.dev)
+						);
+					case EPROTO:
+						DUDS_THROW_EXCEPTION(I2cErrorProtocol() <<
+							boost::errinfo_file_name(bus.dev)
+						);
+					case ETIMEDOUT:
+						DUDS_THROW_EXCEPTION(I2cErrorTimeout() <<
+							boost::errinfo_file_name(bus.dev)
+						);
+					default:
+						DUDS_THROW_EXCEPTION(I2cError() <<
+							boost::errinfo_file_name(bus.dev) <<
+							boost::errinfo_errno(res)
+						);
+				}
+			} catch (I2cError &ie) {
+				// the kernel does not identify the failed message, so the
+				// address is only known if all messages used the same one
+				if (addr >= 0) {
+					ie << I2cDeviceAddr(addr);
+				}
+				throw;
+			}
+		}
+	}
+};
+
+DevI2cBus::DevI2cBus(const std::string &devname) : dev(devname) {
+	fd = open(dev.c_str(), O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		DUDS_THROW_EXCEPTION(I2cErrorNoBus() << boost::errinfo_errno(errno) <<
+			boost::errinfo_file_name(dev)
+		);
+	}
+	if (ioctl(fd, I2C_FUNCS, &funcs) < 0) {
+		int res = errno;
+		close(fd);
+		DUDS_THROW_EXCEPTION(I2cErrorNoBus() << boost::errinfo_errno(res) <<
+			boost::errinfo_file_name(dev)
+		);
+	}
+}
+
+DevI2cBus::~DevI2cBus() {
+	close(fd);
+}
+
+bool DevI2cBus::tenBitAddressing() const {
+	return (funcs & I2C_FUNC_10BIT_ADDR) != 0;
+}
+
+std::unique_ptr<DevI2c> DevI2cBus::device(int devaddr) {
+	return std::unique_ptr<DevI2c>(new DevI2c(shared_from_this(), devaddr));
+}
+
+void DevI2cBus::converse(int devaddr, Conversation &conv) {
+	// empty conversation check
+	if (conv.empty()) {
+		return;  // nothing to do
+	}
+	MsgBuilder mb(*this);
+	mb.add(devaddr, conv);
+	mb.flush();
+}
+
+void DevI2cBus::converse(int devaddr, const ConversationArena &conv) {
+	if (conv.empty()) {
+		return;
+	}
+	MsgBuilder mb(*this);
+	mb.add(devaddr, conv);
+	mb.flush();
+}
+
+void DevI2cBus::converse(DevI2cBatch &batch) {
+	MsgBuilder mb(*this);
+	for (const DevI2cBatch::Entry &e : batch.entries()) {
+		mb.add(e.addr, *e.conv);
+	}
+	mb.flush();
+}
+
+void DevI2cBatch::add(const DevI2c &dev, Conversation &conv) {
+	if (dev.i2cBus() != bus) {
+		DUDS_THROW_EXCEPTION(I2cErrorWrongBus() <<
+			boost::errinfo_file_name(bus->deviceName()) <<
+			I2cDeviceAddr(dev.address())
+		);
+	}
+	add(dev.address(), conv);
+}
+
+} } } }
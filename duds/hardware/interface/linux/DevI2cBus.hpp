@@ -0,0 +1,254 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef DEVI2CBUS_HPP
+#define DEVI2CBUS_HPP
+
+#include <boost/noncopyable.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef linux
+// !@?!#?!#?
+#undef linux
+#endif
+
+namespace duds { namespace hardware { namespace interface {
+
+class Conversation;
+class ConversationArena;
+
+namespace linux {
+
+class DevI2c;
+class DevI2cBatch;
+
+/**
+ * An I2C bus, or adapter, accessed through the Linux kernel's i2c-dev driver.
+ * The device file is opened once and shared by all the DevI2c objects made
+ * for the bus, rather than opening the file for each device address. The
+ * conversations of several devices may also be combined into a single
+ * request to the kernel with a DevI2cBatch object.
+ *
+ * Any number of threads may use the same bus. The kernel handles each request
+ * without interruption from other requests to the same bus.
+ *
+ * All thrown exceptions will include an attribute of boost::errinfo_file_name
+ * with the device file name.
+ *
+ * @author  Jeff Jackowski
+ */
+class DevI2cBus :
+	boost::noncopyable,
+	public std::enable_shared_from_this<DevI2cBus>
+{
+	/**
+	 * Stores the device file name for later error reporting.
+	 */
+	std::string dev;
+	/**
+	 * The file descriptor for the open device.
+	 */
+	int fd;
+	/**
+	 * The functionality flags reported by the kernel.
+	 */
+	unsigned long funcs;
+	/**
+	 * Collects the messages for a request to the kernel.
+	 */
+	class MsgBuilder;
+public:
+	/**
+	 * Opens the device file for the bus.
+	 * @param devname  The path to the device file, usually @a /dev/i2c-N
+	 *                 where N is the number assigned to the bus.
+	 * @throw I2cErrorNoBus  The device file could not be opened, or is not
+	 *                       an I2C bus.
+	 */
+	DevI2cBus(const std::string &devname);
+	/**
+	 * Makes a DevI2cBus object managed by a std::shared_ptr.
+	 * @param devname  The path to the device file, usually @a /dev/i2c-N
+	 *                 where N is the number assigned to the bus.
+	 * @throw I2cErrorNoBus  The device file could not be opened, or is not
+	 *                       an I2C bus.
+	 */
+	static std::shared_ptr<DevI2cBus> make(const std::string &devname) {
+		return std::make_shared<DevI2cBus>(devname);
+	}
+	/**
+	 * Closes the device file.
+	 */
+	~DevI2cBus();
+	/**
+	 * Returns the path of the device file.
+	 */
+	const std::string &deviceName() const {
+		return dev;
+	}
+	/**
+	 * True if the bus master supports 10-bit device addresses.
+	 */
+	bool tenBitAddressing() const;
+	/**
+	 * Makes an object for communicating with the device at the given address
+	 * on this bus.
+	 * @pre   This object is managed by a std::shared_ptr.
+	 * @param devaddr  The device, or slave, address.
+	 * @throw I2cErrorUnsupported  A 10-bit address was requested but is not
+	 *                             supported by the bus master.
+	 */
+	std::unique_ptr<DevI2c> device(int devaddr);
+	/**
+	 * Conducts I2C communication with a device on this bus. See
+	 * DevI2c::converse() for details.
+	 * @param devaddr  The device, or slave, address.
+	 * @param conv     The conversation to have with the device.
+	 */
+	void converse(int devaddr, Conversation &conv);
+	/**
+	 * Conducts I2C communication with a device on this bus. See
+	 * DevI2c::converse() for details.
+	 * @param devaddr  The device, or slave, address.
+	 * @param conv     The conversation to have with the device.
+	 */
+	void converse(int devaddr, const ConversationArena &conv);
+	/**
+	 * Conducts all the conversations in the batch using as few requests to
+	 * the kernel as possible. See DevI2cBatch::converse() for details.
+	 * @param batch  The conversations to have.
+	 */
+	void converse(DevI2cBatch &batch);
+};
+
+/**
+ * A shared pointer to a DevI2cBus object.
+ */
+typedef std::shared_ptr<DevI2cBus>  DevI2cBusSptr;
+
+/**
+ * Conversations with several devices on the same DevI2cBus that are conducted
+ * together. The conversations are placed into as few I2C_RDWR requests to the
+ * kernel as possible, up to the kernel's limit of messages per request. This
+ * avoids the overhead of a system call for each device when sampling several
+ * devices in turn.
+ *
+ * The messages of a single request are separated by repeated start
+ * conditions rather than stop conditions, even between different devices. The
+ * @ref ConversationPart::MpfBreak "MpfBreak" flag is honored by ending the
+ * request before the flagged part, as DevI2c does. A conversation that is
+ * followed by another in the same request must not require a stop condition
+ * at its end; this is not a problem for most devices.
+ *
+ * The batch holds references to the Conversation objects; they must remain
+ * valid while in the batch. The same batch may be used any number of times.
+ *
+ * @author  Jeff Jackowski
+ */
+class DevI2cBatch {
+public:
+	/**
+	 * A conversation and the address of the device that will take part.
+	 */
+	struct Entry {
+		/**
+		 * The conversation.
+		 */
+		Conversation *conv;
+		/**
+		 * The device address.
+		 */
+		int addr;
+	};
+private:
+	/**
+	 * The conversations in the order they will be conducted.
+	 */
+	std::vector<Entry> convs;
+	/**
+	 * The bus used by the conversations.
+	 */
+	std::shared_ptr<DevI2cBus> bus;
+public:
+	/**
+	 * Makes an empty batch for the given bus.
+	 */
+	DevI2cBatch(const std::shared_ptr<DevI2cBus> &b) : bus(b) { }
+	/**
+	 * Adds a conversation with the device at the given address.
+	 * @param devaddr  The device address.
+	 * @param conv     The conversation. It must remain valid while in the
+	 *                 batch.
+	 */
+	void add(int devaddr, Conversation &conv) {
+		convs.push_back(Entry { &conv, devaddr });
+	}
+	/**
+	 * Adds a conversation with the device used by the given DevI2c object.
+	 * @param dev   The device; it must use the same bus as this batch.
+	 * @param conv  The conversation. It must remain valid while in the batch.
+	 * @throw I2cErrorWrongBus  @a dev uses a different bus.
+	 */
+	void add(const DevI2c &dev, Conversation &conv);
+	/**
+	 * Removes all conversations.
+	 */
+	void clear() {
+		convs.clear();
+	}
+	/**
+	 * Returns the number of conversations.
+	 */
+	std::size_t size() const {
+		return convs.size();
+	}
+	/**
+	 * True if there are no conversations.
+	 */
+	bool empty() const {
+		return convs.empty();
+	}
+	/**
+	 * Returns the conversations in the order they will be conducted.
+	 */
+	const std::vector<Entry> &entries() const {
+		return convs;
+	}
+	/**
+	 * Returns the bus used by the batch.
+	 */
+	const std::shared_ptr<DevI2cBus> &i2cBus() const {
+		return bus;
+	}
+	/**
+	 * Conducts all the conversations in order.
+	 *
+	 * If an error occurs, conversations in earlier requests to the kernel
+	 * will have been conducted. The error will include
+	 * @ref duds::hardware::interface::I2cDeviceAddr "I2cDeviceAddr" if all
+	 * the messages of the failed request were to the same device.
+	 *
+	 * @throw I2cErrorConversationLength  A part of a conversation between
+	 *                                    breaks has too many parts for a
+	 *                                    single request to the kernel.
+	 * @throw I2cErrorPartLength   A variable length input part had a buffer
+	 *                             that was not longer than 32 bytes.
+	 * @throw I2cError             Any error that DevI2c::converse() may
+	 *                             throw.
+	 */
+	void converse() {
+		bus->converse(*this);
+	}
+};
+
+} } } }
+
+#endif        //  #ifndef DEVI2CBUS_HPP
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/hardware/interface/linux/GpioDevEvents.hpp>
+#include <algorithm>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+namespace duds { namespace hardware { namespace interface { namespace linux {
+
+GpioDevEvents::GpioDevEvents(
+	GpioDevPort &gp,
+	const std::vector<unsigned int> &gids,
+	DigitalPinConfig::Flags edges,
+	std::chrono::microseconds debounce,
+	std::uint32_t bufferSize
+) : port(&gp), lineFd(-1) {
+	if (!(edges & DigitalPinConfig::EventEdge) ||
+		(edges & (DigitalPinConfig::EventMask & ~DigitalPinConfig::EventEdge))
+	) {
+		DUDS_THROW_EXCEPTION(GpioDevEventConfigError());
+	}
+	if (gids.size() > GPIO_V2_LINES_MAX) {
+		DUDS_THROW_EXCEPTION(GpioDevEventConfigError());
+	}
+	// reserve the pins
+	gp.access(gids, acc);
+	gpio_v2_line_request req;
+	memset(&req, 0, sizeof(gpio_v2_line_request));
+	strncpy(req.consumer, gp.consumer.c_str(), GPIO_MAX_NAME_SIZE - 1);
+	req.event_buffer_size = bufferSize;
+	req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+	if (edges & DigitalPinConfig::EventEdgeRising) {
+		req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+	}
+	if (edges & DigitalPinConfig::EventEdgeFalling) {
+		req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+	}
+	for (unsigned int lid : acc.localIds()) {
+		req.offsets[req.num_lines++] = lid;
+	}
+	if (debounce.count() > 0) {
+		req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+		req.config.attrs[0].attr.debounce_period_us = debounce.count();
+		req.config.attrs[0].mask = (req.num_lines < 64) ?
+			(((std::uint64_t)1 << req.num_lines) - 1) : ~(std::uint64_t)0;
+		req.config.num_attrs = 1;
+	}
+	if (ioctl(gp.chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+		int res = errno;
+		DUDS_THROW_EXCEPTION(GpioDevGetLinehandleError() <<
+			boost::errinfo_errno(res) << boost::errinfo_file_name(gp.devpath)
+		);
+	}
+	lineFd = req.fd;
+	// record the configuration in the port
+	try {
+		prevConf = gp.exchangeConfig(
+			acc.localIds(),
+			DigitalPinConfig::DirMask | DigitalPinConfig::EventMask,
+			DigitalPinConfig::DirInput | edges
+		);
+	} catch (...) {
+		close(lineFd);
+		throw;
+	}
+}
+
+GpioDevEvents::~GpioDevEvents() {
+	close(lineFd);
+	// the pins are no longer used for events
+	port->restoreConfig(acc.localIds(), prevConf);
+}
+
+bool GpioDevEvents::input(unsigned int gid) const {
+	const std::vector<unsigned int> &lids = acc.localIds();
+	std::vector<unsigned int>::const_iterator iter =
+		std::find(lids.begin(), lids.end(), port->localId(gid));
+	assert(iter != lids.end());
+	gpio_v2_line_values vals = {
+		0, (std::uint64_t)1 << (iter - lids.begin())
+	};
+	if (ioctl(lineFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) < 0) {
+		int res = errno;
+		DUDS_THROW_EXCEPTION(GpioDevGetLineValuesError() <<
+			boost::errinfo_errno(res) << PinErrorId(gid)
+		);
+	}
+	return (vals.bits & vals.mask) > 0;
+}
+
+void GpioDevEvents::respondToNextEvent() {
+	gpio_v2_line_event events[16];
+	ssize_t len = read(lineFd, events, sizeof(events));
+	if (len < 0) {
+		int res = errno;
+		DUDS_THROW_EXCEPTION(GpioDevReadEventError() <<
+			boost::errinfo_errno(res)
+		);
+	}
+	// the kernel only provides whole events
+	int cnt = len / sizeof(gpio_v2_line_event);
+	for (int idx = 0; idx < cnt; ++idx) {
+		const gpio_v2_line_event &e = events[idx];
+		GpioEdgeEvent ge = {
+			std::chrono::nanoseconds(e.timestamp_ns),
+			port->globalId(e.offset),
+			e.seqno,
+			e.line_seqno,
+			e.id == GPIO_V2_LINE_EVENT_RISING_EDGE
+		};
+		edgeSig(ge);
+	}
+}
+
+void GpioDevEvents::respond(duds::os::linux::Poller *, int) {
+	respondToNextEvent();
+}
+
+void GpioDevEvents::usePoller(duds::os::linux::Poller &p) {
+	p.add(shared_from_this(), lineFd);
+}
+
+} } } } // namespaces
+
+#endif  // #ifdef GPIO_V2_GET_LINE_IOCTL
@@ -0,0 +1,244 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef GPIODEVEVENTS_HPP
+#define GPIODEVEVENTS_HPP
+
+#include <duds/hardware/interface/linux/GpioDevPort.hpp>
+#include <duds/hardware/interface/DigitalPinSetAccess.hpp>
+#include <duds/os/linux/Poller.hpp>
+#include <boost/signals2/signal.hpp>
+#include <linux/gpio.h>
+#include <chrono>
+
+// version 2 of the kernel's GPIO interface is required for edge events
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+namespace duds { namespace hardware { namespace interface { namespace linux {
+
+/**
+ * The requested events cannot be provided by the GPIO character device.
+ * Only edge events are supported.
+ */
+struct GpioDevEventConfigError : GpioDevPortError { };
+
+/**
+ * An error was reported when reading events from a GPIO line request.
+ */
+struct GpioDevReadEventError : GpioDevPortError { };
+
+/**
+ * An edge detected on a GPIO line by the kernel.
+ */
+struct GpioEdgeEvent {
+	/**
+	 * The time the kernel detected the edge from CLOCK_MONOTONIC.
+	 */
+	std::chrono::nanoseconds timestamp;
+	/**
+	 * The global ID of the pin.
+	 */
+	unsigned int gid;
+	/**
+	 * The sequence number of the event among all events from the same
+	 * GpioDevEvents object. The first event is one. A gap indicates that the
+	 * kernel's event buffer overflowed.
+	 */
+	std::uint32_t seqno;
+	/**
+	 * The sequence number of the event among events from the same pin.
+	 */
+	std::uint32_t lineSeqno;
+	/**
+	 * True for a rising edge, false for a falling edge.
+	 */
+	bool rising;
+};
+
+/**
+ * The signal type used to report GPIO edge events.
+ */
+typedef boost::signals2::signal<void(const GpioEdgeEvent &)>  GpioEdgeSignal;
+
+/**
+ * Reports edges on GPIO input pins detected by the kernel, along with the
+ * kernel's timestamp and sequence numbers for each event, using a
+ * boost::signals2 signal. This removes the need to repeatedly poll the input
+ * state of the pins.
+ *
+ * The pins are reserved from the GpioDevPort for the lifespan of this object
+ * in the same way as access objects, and are configured as inputs. Their
+ * input states may be read with input().
+ *
+ * Events are handled when respondToNextEvent() is called. Normally, this is
+ * done by a Poller after calling usePoller().
+ *
+ * This class is not thread-safe, but this should not be an issue.
+ *
+ * If used with Poller, this object @b must be managed by a std::shared_ptr.
+ *
+ * @author  Jeff Jackowski
+ */
+class GpioDevEvents :
+	boost::noncopyable,
+	public duds::os::linux::PollResponder,
+	public std::enable_shared_from_this<GpioDevEvents>
+{
+	/**
+	 * Handles all edge events.
+	 */
+	GpioEdgeSignal edgeSig;
+	/**
+	 * Reserves the pins.
+	 */
+	DigitalPinSetAccess acc;
+	/**
+	 * The port with the pins.
+	 */
+	GpioDevPort *port;
+	/**
+	 * The configuration of the pins before this object reserved them; put
+	 * back in the port when this object is destroyed.
+	 */
+	std::vector<DigitalPinConfig> prevConf;
+	/**
+	 * The file descriptor of the line request.
+	 */
+	int lineFd;
+public:
+	/**
+	 * Requests edge events for the given pins.
+	 * @param gp        The port with the pins.
+	 * @param gids      The global IDs of the pins. There may be up to 64.
+	 * @param edges     The edges to report; either
+	 *                  DigitalPinConfig::EventEdgeRising,
+	 *                  DigitalPinConfig::EventEdgeFalling, or
+	 *                  DigitalPinConfig::EventEdge for both.
+	 * @param debounce  The debounce period applied by the kernel. Zero
+	 *                  disables debouncing. Not all hardware supports this.
+	 * @param bufferSize  The suggested minimum number of events for the
+	 *                    kernel to buffer, or zero for the kernel's default.
+	 * @throw GpioDevEventConfigError    @a edges does not request any edges,
+	 *                                   or requests other events.
+	 * @throw GpioDevGetLinehandleError  The kernel rejected the request.
+	 * @throw PinDoesNotExist            A pin is not in the port.
+	 */
+	GpioDevEvents(
+		GpioDevPort &gp,
+		const std::vector<unsigned int> &gids,
+		DigitalPinConfig::Flags edges = DigitalPinConfig::EventEdge,
+		std::chrono::microseconds debounce = std::chrono::microseconds(0),
+		std::uint32_t bufferSize = 0
+	);
+	/**
+	 * Creates a GpioDevEvents object managed by a std::shared_ptr.
+	 * @copydetails GpioDevEvents(GpioDevPort &, const std::vector<unsigned int> &, DigitalPinConfig::Flags, std::chrono::microseconds, std::uint32_t)
+	 */
+	static std::shared_ptr<GpioDevEvents> make(
+		GpioDevPort &gp,
+		const std::vector<unsigned int> &gids,
+		DigitalPinConfig::Flags edges = DigitalPinConfig::EventEdge,
+		std::chrono::microseconds debounce = std::chrono::microseconds(0),
+		std::uint32_t bufferSize = 0
+	) {
+		return std::make_shared<GpioDevEvents>(
+			gp, gids, edges, debounce, bufferSize
+		);
+	}
+	/**
+	 * Releases the pins and restores the configuration they had in the port
+	 * before this object was made.
+	 */
+	~GpioDevEvents();
+	/**
+	 * Returns the file descriptor that becomes readable when events are
+	 * available.
+	 */
+	int fileDescriptor() const {
+		return lineFd;
+	}
+	/**
+	 * Reads the current input state of a pin.
+	 * @param gid  The global ID of the pin. It must be one of the pins given
+	 *             to the constructor.
+	 * @throw GpioDevGetLineValuesError  The kernel reported an error.
+	 */
+	bool input(unsigned int gid) const;
+	/**
+	 * Handles the next events. If there are no queued events, this function
+	 * blocks until an event is available. The signal is invoked on this thread
+	 * for each event in the order they occurred.
+	 * @throw GpioDevReadEventError  The kernel reported an error.
+	 */
+	void respondToNextEvent();
+	/**
+	 * Same as calling respondToNextEvent(); used with Poller.
+	 */
+	virtual void respond(duds::os::linux::Poller *, int);
+	/**
+	 * Registers this object with the given Poller so that Poller::wait() will
+	 * invoke respondToNextEvent().
+	 * @pre  This object is managed by a std::shared_ptr.
+	 * @param p  The Poller object.
+	 */
+	void usePoller(duds::os::linux::Poller &p);
+	/**
+	 * Make a connection to the edge event signal.
+	 * See the [Boost reference documentation](https://www.boost.org/doc/libs/1_83_0/doc/html/boost/signals2/signal.html#idp182137616-bb)
+	 * for more details.
+	 */
+	boost::signals2::connection connect(
+		const GpioEdgeSignal::slot_type &slot,
+		boost::signals2::connect_position at = boost::signals2::at_back
+	) {
+		return edgeSig.connect(slot, at);
+	}
+	/**
+	 * Make a connection to the edge event signal.
+	 * See the [Boost reference documentation](https://www.boost.org/doc/libs/1_83_0/doc/html/boost/signals2/signal.html#idp182137616-bb)
+	 * for more details.
+	 */
+	boost::signals2::connection connect(
+		const GpioEdgeSignal::group_type &group,
+		const GpioEdgeSignal::slot_type &slot,
+		boost::signals2::connect_position at = boost::signals2::at_back
+	) {
+		return edgeSig.connect(group, slot, at);
+	}
+	/**
+	 * Disconnect a group from the edge event signal.
+	 */
+	void disconnect(const GpioEdgeSignal::group_type &group) {
+		edgeSig.disconnect(group);
+	}
+	/**
+	 * Disconnect a slot from the edge event signal.
+	 */
+	template<typename Slot>
+	void disconnect(const Slot &slotFunc) {
+		edgeSig.disconnect(slotFunc);
+	}
+	/**
+	 * Disconnects all slots from the edge event signal.
+	 */
+	void disconnectAll() {
+		edgeSig.disconnect_all_slots();
+	}
+};
+
+/**
+ * A shared pointer to a GpioDevEvents object.
+ */
+typedef std::shared_ptr<GpioDevEvents>  GpioDevEventsSptr;
+
+} } } } // namespaces
+
+#endif  // #ifdef GPIO_V2_GET_LINE_IOCTL
+
+#endif        //  #ifndef GPIODEVEVENTS_HPP
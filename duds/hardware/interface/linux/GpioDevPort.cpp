@@ -9,14 +9,17 @@
  */
 #include <boost/exception/errinfo_file_name.hpp>
 #include <boost/exception/errinfo_errno.hpp>
-#include <duds/hardware/interface/linux/GpioDevPort.hpp>
+#include <duds/hardware/interface/linux/GpioRequest.hpp>
 #include <duds/hardware/interface/PinConfiguration.hpp>
+#include <duds/general/YieldingWait.hpp>
 #include <linux/gpio.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
 
 namespace duds { namespace hardware { namespace interface { namespace linux {
 
+#ifndef GPIO_V2_GET_LINE_IOCTL
+
 /**
  * Initializes a gpiohandle_request structure.
  * @param req       The gpiohandle_request structure to be initialized.
@@ -172,70 +175,6 @@ static void SetOutput(int chipFd, gpiohandle_request &req) {
 	}
 }
 
-
-/**
- * An abstraction for using gpiohandle_request object(s).
- * @author  Jeff Jackowski
- */
-class GpioRequest {
-public:
-	virtual ~GpioRequest() { };
-	/**
-	 * Configures the pin at the given offset as an input.
-	 * @param chipFd  The file descriptor for the GPIO device.
-	 * @param offset  The pin offset.
-	 */
-	virtual void inputOffset(int chipFd, std::uint32_t offset) = 0;
-	/**
-	 * Configures the pin at the given offset as an output.
-	 * @param chipFd  The file descriptor for the GPIO device.
-	 * @param offset  The pin offset.
-	 * @param state   The output state for the pin.
-	 */
-	virtual void outputOffset(int chipFd, std::uint32_t offset, bool state) = 0;
-	/**
-	 * Read from all input pins.
-	 * @param chipFd   The file descriptor for the GPIO device.
-	 * @param result   The input states.
-	 * @param offsets  A pointer to the start of an array with the line
-	 *                 offset values for identifying where the input source.
-	 * @param length   The number of line offsets.
-	 */
-	virtual void read(
-		int chipFd,
-		gpiohandle_data &result,
-		std::uint32_t *&offsets,
-		int &length
-	) = 0;
-	/**
-	 * Configures pins as outputs and sets their output states.
-	 * @param chipFd  The file descriptor for the GPIO device.
-	 */
-	virtual void write(int chipFd) = 0;
-	/**
-	 * Sets the output state of a single output pin.
-	 * @pre   The pin is already configured as an output.
-	 * @param chipFd  The file descriptor for the GPIO device.
-	 * @param offset  The pin offset.
-	 * @param state   The output state for the pin.
-	 */
-	virtual void write(int chipFd, std::uint32_t offset, bool state) = 0;
-	/**
-	 * Reads the input state of the indicated pin. Configures the pin as an
-	 * input if not already an input.
-	 * @param chipFd  The file descriptor for the GPIO device.
-	 * @param offset  The pin offset.
-	 */
-	virtual bool inputState(int chipFd, std::uint32_t offset) = 0;
-	/**
-	 * Sets the output state of a single pin in advance of making the output
-	 * request to the port. Use write(int) to output the data.
-	 * @param offset  The pin offset.
-	 * @param state   The output state to store for the pin.
-	 */
-	virtual void outputState(std::uint32_t offset, bool state) = 0;
-};
-
 /**
  * Implements using a single gpiohandle_request object for working with a
  * single pin.
@@ -282,11 +221,15 @@ public:
 	}
 	virtual void read(
 		int chipFd,
-		gpiohandle_data &result,
-		std::uint32_t *&offsets,
+		std::uint64_t &values,
+		std::uint64_t &mask,
+		const std::uint32_t *&offsets,
 		int &length
 	) {
+		gpiohandle_data result;
 		GetInput(chipFd, result, req);
+		values = result.values[0] > 0;
+		mask = 1;
 		offsets = req.lineoffsets;
 		length = 1;
 	}
@@ -399,11 +342,20 @@ public:
 	}
 	virtual void read(
 		int chipFd,
-		gpiohandle_data &result,
-		std::uint32_t *&offsets,
+		std::uint64_t &values,
+		std::uint64_t &mask,
+		const std::uint32_t *&offsets,
 		int &length
 	) {
+		gpiohandle_data result;
 		GetInput(chipFd, result, inReq);
+		values = mask = 0;
+		for (int idx = inReq.lines - 1; idx >= 0; --idx) {
+			mask |= (std::uint64_t)1 << idx;
+			if (result.values[idx]) {
+				values |= (std::uint64_t)1 << idx;
+			}
+		}
 		offsets = inReq.lineoffsets;
 		length = inReq.lines;
 	}
@@ -445,6 +397,8 @@ public:
 	}
 };
 
+#endif  // #ifndef GPIO_V2_GET_LINE_IOCTL
+
 // ---------------------------------------------------------------------------
 
 GpioDevPort::GpioDevPort(
@@ -602,7 +556,9 @@ void GpioDevPort::initPin(std::uint32_t offset, unsigned int pid) {
 		pins[pid].cap.capabilities =
 			DigitalPinCap::Input |
 			DigitalPinCap::OutputPushPull  /*|
-			DigitalPinCap::EventEdgeFalling |  // theses are not yet supported
+			// events are only available through GpioDevEvents, not by
+			// configuring an access object
+			DigitalPinCap::EventEdgeFalling |
 			DigitalPinCap::EventEdgeRising |
 			DigitalPinCap::EventEdgeChange |
 			DigitalPinCap::InterruptOnEvent */;
@@ -615,6 +571,36 @@ bool GpioDevPort::simultaneousOperations() const {
 	return true;
 }
 
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+void GpioDevPort::madeAccess(DigitalPinAccess &acc) {
+	std::unique_ptr<GpioLineRequest> glr(new GpioLineRequest(consumer));
+	const PinEntry &pe = pins[acc.localId()];
+	glr->addOffset(
+		acc.localId(),
+		(pe.conf.options & DigitalPinConfig::DirOutput) > 0,
+		(pe.conf.options & DigitalPinConfig::OutputState) > 0
+	);
+	portData(acc).pointer = glr.release();
+}
+
+void GpioDevPort::madeAccess(DigitalPinSetAccess &acc) {
+	// freed if the pins do not fit in one request
+	std::unique_ptr<GpioLineRequest> glr(new GpioLineRequest(consumer));
+	for (auto pid : acc.localIds()) {
+		const PinEntry &pe = pins[pid];
+		assert(pe.conf.options & DigitalPinConfig::DirMask);
+		glr->addOffset(
+			pid,
+			(pe.conf.options & DigitalPinConfig::DirOutput) > 0,
+			(pe.conf.options & DigitalPinConfig::OutputState) > 0
+		);
+	}
+	portData(acc).pointer = glr.release();
+}
+
+#else
+
 void GpioDevPort::madeAccess(DigitalPinAccess &acc) {
 	portData(acc).pointer = new SingleGpioRequest(consumer, acc.localId());
 }
@@ -641,16 +627,18 @@ void GpioDevPort::madeAccess(DigitalPinSetAccess &acc) {
 	portData(acc).pointer = igr;
 }
 
+#endif  // #ifdef GPIO_V2_GET_LINE_IOCTL
+
 void GpioDevPort::retiredAccess(const DigitalPinAccess &acc) noexcept {
-	SingleGpioRequest *sgr;
-	portDataPtr(acc, &sgr);
-	delete sgr;
+	GpioRequest *gr;
+	portDataPtr(acc, &gr);
+	delete gr;
 }
 
 void GpioDevPort::retiredAccess(const DigitalPinSetAccess &acc) noexcept {
-	IoGpioRequest *igr;
-	portDataPtr(acc, &igr);
-	delete igr;
+	GpioRequest *gr;
+	portDataPtr(acc, &gr);
+	delete gr;
 }
 
 void GpioDevPort::configurePort(
@@ -699,17 +687,18 @@ std::vector<bool> GpioDevPort::inputImpl(
 	DigitalPinAccessBase::PortData *pdata
 ) try {
 	GpioRequest *gr = (GpioRequest*)pdata->pointer;
-	gpiohandle_data result;
-	std::uint32_t *offsets;
+	std::uint64_t values, mask;
+	const std::uint32_t *offsets;
 	int length;
-	gr->read(chipFd, result, offsets, length);
-	assert(length >= pvec.size());
+	gr->read(chipFd, values, mask, offsets, length);
 	// record input states
 	for (int idx = 0; idx < length; ++idx) {
-		pins[offsets[idx]].conf.options.setTo(
-			DigitalPinConfig::InputState,
-			result.values[idx] > 0
-		);
+		if (mask & ((std::uint64_t)1 << idx)) {
+			pins[offsets[idx]].conf.options.setTo(
+				DigitalPinConfig::InputState,
+				(values >> idx) & 1
+			);
+		}
 	}
 	// return input states
 	std::vector<bool> outv(pvec.size());
@@ -775,4 +764,51 @@ void GpioDevPort::outputImpl(
 	throw;
 }
 
+void GpioDevPort::outputSequenceImpl(
+	const std::vector<unsigned int> &pvec,
+	const DigitalPinWaveform &wave,
+	DigitalPinAccessBase::PortData *pdata
+) try {
+	// get the request object to make modifications
+	GpioRequest *gr = (GpioRequest*)pdata->pointer;
+	// find the positions configured for output; the configuration cannot
+	// change while the port is locked
+	std::uint64_t outPos = 0;
+	std::uint64_t used = wave.pinsUsed();
+	for (unsigned int pos = 0; used; ++pos, used >>= 1) {
+		if ((used & 1) &&
+			(pins[pvec[pos]].conf.options & DigitalPinConfig::DirOutput)
+		) {
+			outPos |= (std::uint64_t)1 << pos;
+		}
+	}
+	for (const DigitalPinWaveform::Step &step : wave.steps()) {
+		std::uint64_t mask = step.mask;
+		for (unsigned int pos = 0; mask; ++pos, mask >>= 1) {
+			if (mask & 1) {
+				bool state = (step.states >> pos) & 1;
+				if (outPos & ((std::uint64_t)1 << pos)) {
+					// configure the port data; no output happens yet
+					gr->outputState(pvec[pos], state);
+				}
+				// store new state
+				pins[pvec[pos]].conf.options.setTo(
+					DigitalPinConfig::OutputState,
+					state
+				);
+			}
+		}
+		// one request to the kernel for all changed outputs
+		if (step.mask & outPos) {
+			gr->write(chipFd);
+		}
+		if (step.delay.count() > 0) {
+			duds::general::YieldingWait(step.delay);
+		}
+	}
+} catch (PinError &pe) {
+	pe << boost::errinfo_file_name(devpath);
+	throw;
+}
+
 } } } } // namespaces
@@ -21,6 +21,8 @@ class PinConfiguration;
 
 namespace linux {
 
+class GpioDevEvents;
+
 /**
  * Base class for all errors specific to using the Linux GPIO character
  * device. If the error is reported by the kernel, the attribute
@@ -32,32 +34,64 @@ namespace linux {
 struct GpioDevPortError : PinError { };
 
 /**
- * An error was reported from a GPIO_GET_LINEHANDLE_IOCTL operation.
+ * An error was reported from a GPIO_GET_LINEHANDLE_IOCTL or
+ * GPIO_V2_GET_LINE_IOCTL operation.
  */
 struct GpioDevGetLinehandleError : GpioDevPortError { };
 
 /**
- * An error was reported from a GPIOHANDLE_GET_LINE_VALUES_IOCTL operation.
+ * An error was reported from a GPIOHANDLE_GET_LINE_VALUES_IOCTL or
+ * GPIO_V2_LINE_GET_VALUES_IOCTL operation.
  */
 struct GpioDevGetLineValuesError : GpioDevPortError { };
 
 /**
- * An error was reported from a GPIOHANDLE_SET_LINE_VALUES_IOCTL operation.
+ * An error was reported from a GPIOHANDLE_SET_LINE_VALUES_IOCTL or
+ * GPIO_V2_LINE_SET_VALUES_IOCTL operation.
  */
 struct GpioDevSetLineValuesError : GpioDevPortError { };
 
+/**
+ * An error was reported from a GPIO_V2_LINE_SET_CONFIG_IOCTL operation.
+ */
+struct GpioDevSetConfigError : GpioDevPortError { };
+
+/**
+ * An access object was requested for more pins than a single version 2 line
+ * request can hold, GPIO_V2_LINES_MAX (64). The pin that did not fit is
+ * identified by a PinErrorId attribute holding its local ID.
+ */
+struct GpioDevTooManyLines : GpioDevPortError { };
+
 /**
  * A GPIO implementation using the Linux kernel's GPIO character devices.
  *
+ * When the kernel headers provide version 2 of the GPIO character device
+ * interface (Linux 5.10 and later), each access object uses a single line
+ * request for all of its pins. The lines are requested on first use and kept
+ * for the lifespan of the access object. Direction changes reconfigure the
+ * lines in place with GPIO_V2_LINE_SET_CONFIG_IOCTL, and the states of
+ * multiple pins are read or written with one operation using bit masks. A
+ * DigitalPinSetAccess object may have at most 64 pins in total, inputs and
+ * outputs together; requesting more throws GpioDevTooManyLines. The version
+ * 1 interface used separate requests for inputs and outputs, allowing up to
+ * 64 of each.
+ *
+ * Otherwise, the deprecated version 1 interface is used. It requires
+ * releasing lines and requesting them again to change their direction.
+ *
+ * With the version 2 interface, edges on input pins may be reported by a
+ * GpioDevEvents object.
+ *
  * Limitations:
- * - Input change events (interrupt-like response) are not yet supported.
- * - Port resources are not allocated and kept for the lifespan of
- *   DigitalPinAccess and DigitalPinSetAccess objects. Changing pin
- *   configuration with the GPIO kernel device requires losing the resource
- *   and requesting it again in a non-atomic manner. Another process could
- *   hypothetically get the resource, which will result in an exception and a
- *   broken access object. I see no way to fully resolve this issue given the
- *   current kernel interface.
+ * - Input change events (interrupt-like response) are not supported with the
+ *   version 1 interface.
+ * - With the version 1 interface, port resources are not allocated and kept
+ *   for the lifespan of DigitalPinAccess and DigitalPinSetAccess objects.
+ *   Changing pin configuration requires losing the resource and requesting
+ *   it again in a non-atomic manner. Another process could hypothetically
+ *   get the resource, which will result in an exception and a broken access
+ *   object.
  * - Kernel interface lacks ability to query pin capabilities.
  *   - This driver assumes all pins have input and output capability.
  *   - Open drain and open source support could be determined by attempting
@@ -115,6 +149,7 @@ class GpioDevPort : public DigitalPortIndependentPins {
 	 *                                  the GPIO line ended with an error.
 	 */
 	void initPin(std::uint32_t offset, unsigned int pid);
+	friend GpioDevEvents;
 protected:
 	virtual void madeAccess(DigitalPinAccess &acc);
 	virtual void madeAccess(DigitalPinSetAccess &acc);
@@ -219,6 +254,15 @@ protected:
 		const std::vector<bool> &state,
 		DigitalPinAccessBase::PortData *pdata
 	);
+	/**
+	 * Outputs each step of the waveform with a single request to the kernel
+	 * for the pins that are outputs.
+	 */
+	virtual void outputSequenceImpl(
+		const std::vector<unsigned int> &pvec,
+		const DigitalPinWaveform &wave,
+		DigitalPinAccessBase::PortData *pdata
+	);
 public:
 	/**
 	 * Simultaneous operations are supported; returns true.
@@ -0,0 +1,364 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2018  Jeff Jackowski
+ */
+#ifndef GPIOREQUEST_HPP
+#define GPIOREQUEST_HPP
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/hardware/interface/linux/GpioDevPort.hpp>
+#include <duds/general/Errors.hpp>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cassert>
+#include <cstring>
+
+namespace duds { namespace hardware { namespace interface { namespace linux {
+
+/**
+ * An abstraction for using the kernel's GPIO line request object(s).
+ * @author  Jeff Jackowski
+ */
+class GpioRequest {
+public:
+	virtual ~GpioRequest() { };
+	/**
+	 * Configures the pin at the given offset as an input.
+	 * @param chipFd  The file descriptor for the GPIO device.
+	 * @param offset  The pin offset.
+	 */
+	virtual void inputOffset(int chipFd, std::uint32_t offset) = 0;
+	/**
+	 * Configures the pin at the given offset as an output.
+	 * @param chipFd  The file descriptor for the GPIO device.
+	 * @param offset  The pin offset.
+	 * @param state   The output state for the pin.
+	 */
+	virtual void outputOffset(int chipFd, std::uint32_t offset, bool state) = 0;
+	/**
+	 * Read from all input pins.
+	 * @param chipFd   The file descriptor for the GPIO device.
+	 * @param values   The input states. Bit N is the state of the line at
+	 *                 @a offsets[N].
+	 * @param mask     Bit N is set if bit N of @a values is an input state.
+	 * @param offsets  A pointer to the start of an array with the line
+	 *                 offset values for identifying where the input source.
+	 * @param length   The number of line offsets.
+	 */
+	virtual void read(
+		int chipFd,
+		std::uint64_t &values,
+		std::uint64_t &mask,
+		const std::uint32_t *&offsets,
+		int &length
+	) = 0;
+	/**
+	 * Configures pins as outputs and sets their output states.
+	 * @param chipFd  The file descriptor for the GPIO device.
+	 */
+	virtual void write(int chipFd) = 0;
+	/**
+	 * Sets the output state of a single output pin.
+	 * @pre   The pin is already configured as an output.
+	 * @param chipFd  The file descriptor for the GPIO device.
+	 * @param offset  The pin offset.
+	 * @param state   The output state for the pin.
+	 */
+	virtual void write(int chipFd, std::uint32_t offset, bool state) = 0;
+	/**
+	 * Reads the input state of the indicated pin. Configures the pin as an
+	 * input if not already an input.
+	 * @param chipFd  The file descriptor for the GPIO device.
+	 * @param offset  The pin offset.
+	 */
+	virtual bool inputState(int chipFd, std::uint32_t offset) = 0;
+	/**
+	 * Sets the output state of a single pin in advance of making the output
+	 * request to the port. Use write(int) to output the data.
+	 * @param offset  The pin offset.
+	 * @param state   The output state to store for the pin.
+	 */
+	virtual void outputState(std::uint32_t offset, bool state) = 0;
+};
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+/**
+ * Implements using a single gpio_v2_line_request for working with any number
+ * of pins, up to GPIO_V2_LINES_MAX, that may be a mix of inputs and outputs.
+ * The direction of each line is a configuration attribute of the request, so
+ * a direction change is a GPIO_V2_LINE_SET_CONFIG_IOCTL operation on the
+ * line request's file descriptor rather than releasing the lines and
+ * requesting them again. The lines are requested from the kernel on first
+ * use and are kept until this object is destroyed. Bit N of the masks and
+ * values is for the line at @a req.offsets[N].
+ * @author  Jeff Jackowski
+ */
+class GpioLineRequest : public GpioRequest {
+	/**
+	 * The request object.
+	 */
+	gpio_v2_line_request req;
+	/**
+	 * Lines that are outputs.
+	 */
+	std::uint64_t outMask = 0;
+	/**
+	 * Output states.
+	 */
+	std::uint64_t outVals = 0;
+	/**
+	 * The line request's file descriptor, or -1 if the lines have not been
+	 * requested.
+	 */
+	int lineFd = -1;
+	/**
+	 * True when the configuration has changed since it was last given to the
+	 * kernel.
+	 */
+	bool dirty = false;
+	/**
+	 * Returns the bit for the line with the given offset.
+	 */
+	std::uint64_t bit(std::uint32_t offset) const {
+		for (int idx = req.num_lines - 1; idx >= 0; --idx) {
+			if (req.offsets[idx] == offset) {
+				return (std::uint64_t)1 << idx;
+			}
+		}
+		assert(!"Offset not in request");
+		return 0;
+	}
+	/**
+	 * Returns a mask with a bit set for every line in the request.
+	 */
+	std::uint64_t lines() const {
+		return (req.num_lines < 64) ?
+			(((std::uint64_t)1 << req.num_lines) - 1) : ~(std::uint64_t)0;
+	}
+	/**
+	 * Gives the current configuration to the kernel. The lines are requested
+	 * if they have not been already.
+	 */
+	void configure(int chipFd) {
+		if (lineFd < 0) {
+			makeConfig(req.config);
+			if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+				int res = errno;
+				DUDS_THROW_EXCEPTION(GpioDevGetLinehandleError() <<
+					boost::errinfo_errno(res)
+				);
+			}
+			lineFd = req.fd;
+		} else {
+			gpio_v2_line_config cfg;
+			makeConfig(cfg);
+			if (ioctl(lineFd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &cfg) < 0) {
+				int res = errno;
+				DUDS_THROW_EXCEPTION(GpioDevSetConfigError() <<
+					boost::errinfo_errno(res)
+				);
+			}
+		}
+		dirty = false;
+	}
+	/**
+	 * Reads the states of the lines in @a mask.
+	 */
+	std::uint64_t get(int chipFd, std::uint64_t mask) {
+		if ((lineFd < 0) || dirty) {
+			configure(chipFd);
+		}
+		gpio_v2_line_values vals = { 0, mask };
+		if (ioctl(lineFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) < 0) {
+			int res = errno;
+			DUDS_THROW_EXCEPTION(GpioDevGetLineValuesError() <<
+				boost::errinfo_errno(res)
+			);
+		}
+		return vals.bits;
+	}
+	/**
+	 * Outputs the states of the output lines in @a mask.
+	 */
+	void set(int chipFd, std::uint64_t mask) {
+		if ((lineFd < 0) || dirty) {
+			// the configuration includes the output states
+			configure(chipFd);
+			return;
+		}
+		gpio_v2_line_values vals = { outVals, mask };
+		if (ioctl(lineFd, GPIO_V2_LINE_SET_VALUES_IOCTL, &vals) < 0) {
+			int res = errno;
+			DUDS_THROW_EXCEPTION(GpioDevSetLineValuesError() <<
+				boost::errinfo_errno(res)
+			);
+		}
+	}
+	/**
+	 * Makes the lines in @a mask outputs or inputs without informing the
+	 * kernel.
+	 */
+	void direction(std::uint64_t mask, bool output) {
+		std::uint64_t nmask = output ? (outMask | mask) : (outMask & ~mask);
+		if (nmask != outMask) {
+			outMask = nmask;
+			dirty = true;
+		}
+	}
+	/**
+	 * Sets the output state of the lines in @a mask without informing the
+	 * kernel.
+	 */
+	void state(std::uint64_t mask, bool state) {
+		if (state) {
+			outVals |= mask;
+		} else {
+			outVals &= ~mask;
+		}
+	}
+public:
+	/**
+	 * Makes an empty request.
+	 * @param consumer  The consumer name given to the kernel.
+	 */
+	GpioLineRequest(const std::string &consumer) {
+		memset(&req, 0, sizeof(gpio_v2_line_request));
+		strncpy(req.consumer, consumer.c_str(), GPIO_MAX_NAME_SIZE - 1);
+	}
+	virtual ~GpioLineRequest() {
+		if (lineFd >= 0) {
+			close(lineFd);
+		}
+	}
+	/**
+	 * Adds a line to the request. This must be done before the first use of
+	 * the request.
+	 * @param offset  The line offset. It must not already be in the request.
+	 * @param output  True to make the line an output.
+	 * @param state   The initial output state.
+	 * @throw GpioDevTooManyLines  The request already has GPIO_V2_LINES_MAX
+	 *                             lines.
+	 */
+	void addOffset(std::uint32_t offset, bool output, bool state) {
+		assert(lineFd < 0);
+		if (req.num_lines >= GPIO_V2_LINES_MAX) {
+			DUDS_THROW_EXCEPTION(GpioDevTooManyLines() <<
+				PinErrorId(offset)
+			);
+		}
+		std::uint64_t mask = (std::uint64_t)1 << req.num_lines;
+		req.offsets[req.num_lines++] = offset;
+		direction(mask, output);
+		this->state(mask, state);
+	}
+	/**
+	 * Fills in a line configuration with the direction of each line and the
+	 * states of the outputs.
+	 */
+	void makeConfig(gpio_v2_line_config &cfg) const {
+		memset(&cfg, 0, sizeof(gpio_v2_line_config));
+		cfg.flags = GPIO_V2_LINE_FLAG_INPUT;
+		if (outMask) {
+			cfg.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+			cfg.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+			cfg.attrs[0].mask = outMask;
+			cfg.attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+			cfg.attrs[1].attr.values = outVals;
+			cfg.attrs[1].mask = outMask;
+			cfg.num_attrs = 2;
+		}
+	}
+	/**
+	 * Returns the number of lines in the request.
+	 */
+	unsigned int size() const {
+		return req.num_lines;
+	}
+	/**
+	 * Returns the line offset of the line at index @a idx.
+	 */
+	std::uint32_t offset(unsigned int idx) const {
+		return req.offsets[idx];
+	}
+	/**
+	 * Returns a mask of the lines that are outputs. Bit N is for the line at
+	 * index N.
+	 */
+	std::uint64_t outputs() const {
+		return outMask;
+	}
+	/**
+	 * Returns the output states. Bit N is for the line at index N.
+	 */
+	std::uint64_t outputStates() const {
+		return outVals;
+	}
+	/**
+	 * True once the lines have been requested from the kernel.
+	 */
+	bool requested() const {
+		return lineFd >= 0;
+	}
+	virtual void inputOffset(int chipFd, std::uint32_t offset) {
+		direction(bit(offset), false);
+		configure(chipFd);
+	}
+	virtual void outputOffset(int chipFd, std::uint32_t offset, bool state) {
+		std::uint64_t mask = bit(offset);
+		direction(mask, true);
+		this->state(mask, state);
+		configure(chipFd);
+	}
+	virtual void read(
+		int chipFd,
+		std::uint64_t &values,
+		std::uint64_t &mask,
+		const std::uint32_t *&offsets,
+		int &length
+	) {
+		mask = lines() & ~outMask;
+		values = mask ? (get(chipFd, mask) & mask) : 0;
+		offsets = req.offsets;
+		length = req.num_lines;
+	}
+	virtual void write(int chipFd) {
+		if (outMask) {
+			set(chipFd, outMask);
+		}
+	}
+	virtual void write(int chipFd, std::uint32_t offset, bool state) {
+		std::uint64_t mask = bit(offset);
+		// early exit: already outputing the requested state
+		if ((lineFd >= 0) && !dirty && (outMask & mask) &&
+			(((outVals & mask) > 0) == state)
+		) {
+			return;
+		}
+		direction(mask, true);
+		this->state(mask, state);
+		set(chipFd, mask);
+	}
+	virtual bool inputState(int chipFd, std::uint32_t offset) {
+		std::uint64_t mask = bit(offset);
+		direction(mask, false);
+		return (get(chipFd, mask) & mask) > 0;
+	}
+	virtual void outputState(std::uint32_t offset, bool state) {
+		std::uint64_t mask = bit(offset);
+		direction(mask, true);
+		this->state(mask, state);
+	}
+};
+
+#endif  // #ifdef GPIO_V2_GET_LINE_IOCTL
+
+} } } }
+
+#endif        //  #ifndef GPIOREQUEST_HPP
@@ -8,7 +8,10 @@
  * Copyright (C) 2017  Jeff Jackowski
  */
 #include <duds/hardware/interface/MasterSyncSerialErrors.hpp>
+#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
 #include <duds/general/Errors.hpp>
+#include <boost/exception/errinfo_errno.hpp>
 #include <boost/exception/errinfo_file_name.hpp>
 #include <fcntl.h>
 #include <sys/ioctl.h>
@@ -17,6 +20,14 @@
 
 namespace duds { namespace hardware { namespace interface { namespace linux {
 
+// The size of the transfer array is encoded into the ioctl request number,
+// which limits the number of transfers in a message.
+static_assert(
+	SpiMasterSyncSerial::MsgTransfers * sizeof(spi_ioc_transfer) <
+	(1 << _IOC_SIZEBITS),
+	"Too many transfers for SPI_IOC_MESSAGE"
+);
+
 SpiMasterSyncSerial::SpiMasterSyncSerial() : spifd(-1) { }
 
 SpiMasterSyncSerial::SpiMasterSyncSerial(
@@ -154,5 +165,92 @@ void SpiMasterSyncSerial::transfer(
 	}
 }
 
-} } } } // namespaces
+/**
+ * Fills an array of SPI transfers from conversation parts and gives them to
+ * the kernel as a single message when full or when done.
+ */
+class SpiMasterSyncSerial::MsgBuilder {
+	/**
+	 * The transfers.
+	 */
+	spi_ioc_transfer xfers[MsgTransfers];
+	/**
+	 * The file descriptor for SPI access.
+	 */
+	int spifd;
+	/**
+	 * The number of transfers in @a xfers.
+	 */
+	std::size_t count = 0;
+	/**
+	 * Sends the transfers to the kernel.
+	 */
+	void send() {
+		if (ioctl(spifd, SPI_IOC_MESSAGE(count), xfers) < 0) {
+			DUDS_THROW_EXCEPTION(SyncSerialIoError() <<
+				boost::errinfo_errno(errno)
+			);
+		}
+		count = 0;
+	}
+public:
+	MsgBuilder(int fd) : spifd(fd) { }
+	/**
+	 * Sends the parts from @a iter to @a end in as few messages as possible.
+	 * @tparam Iter  The iterator type of the conversation.
+	 */
+	template <class Iter>
+	void converse(Iter iter, Iter end) {
+		for (; iter != end; ++iter) {
+			const auto &cp = conversationPart(*iter);
+			bool brk = cp.flags() & ConversationPart::MpfBreak;
+			if (count == MsgTransfers) {
+				// on the last transfer of a message, cs_change keeps the
+				// device selected after the message; keep the device
+				// selected unless this part starts with a break
+				xfers[count - 1].cs_change = brk ? 0 : 1;
+				send();
+			} else if (brk && count) {
+				// deselect between the previous part and this one
+				xfers[count - 1].cs_change = 1;
+			}
+			spi_ioc_transfer &x = xfers[count++];
+			std::memset(&x, 0, sizeof(spi_ioc_transfer));
+			if (cp.input()) {
+				x.rx_buf = (ptrdiff_t)cp.start();
+			} else {
+				x.tx_buf = (ptrdiff_t)cp.start();
+			}
+			x.len = cp.length();
+		}
+		if (count) {
+			send();
+		}
+	}
+};
 
+template <class Conv>
+void SpiMasterSyncSerial::converseParts(Conv &conv) {
+	if (conv.empty()) {
+		return;
+	}
+	condStart();
+	try {
+		MsgBuilder mb(spifd);
+		mb.converse(conv.begin(), conv.end());
+	} catch (...) {
+		condStop();
+		throw;
+	}
+	condStop();
+}
+
+void SpiMasterSyncSerial::converseAlreadyOpen(Conversation &conv) {
+	converseParts(conv);
+}
+
+void SpiMasterSyncSerial::converseAlreadyOpen(const ConversationArena &conv) {
+	converseParts(conv);
+}
+
+} } } } // namespaces
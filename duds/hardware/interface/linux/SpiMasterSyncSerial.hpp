@@ -28,11 +28,22 @@ namespace duds { namespace hardware { namespace interface { namespace linux {
  * @todo  Many errors are reported with SyncSerialIoError exceptions; change
  *        this to provide better information on what failed.
  *
+ * A Conversation is given to the kernel as a single SPI message with one
+ * transfer for each ConversationPart, so the whole conversation takes a
+ * single system call and the device remains selected between the parts.
+ * The @ref ConversationPart::MpfBreak "MpfBreak" flag causes the device to be
+ * deselected before the flagged part. Conversations with more than
+ * @ref MsgTransfers parts are split across several messages without
+ * deselecting the device between them, except at breaks. The kernel limits
+ * the total number of bytes in a message; the limit is set by the spidev
+ * module's @a bufsiz parameter and defaults to 4096.
+ *
  * @warning  The device will be selected by the SPI hardware only while data
  *           is being transfered; selection will not follow conversations
  *           (bewteen calls to MasterSyncSerialAccess::start() and
  *           MasterSyncSerialAccess::stop()) like it will with
- *           DigitalPinMasterSyncSerial.
+ *           DigitalPinMasterSyncSerial. Each call to transfer(), transmit(),
+ *           or receive() is a separate message to the kernel.
  *
  * This could be expanded upon by a class that uses a ChipSelect object to
  * allow multiple devices on the same device file so that more devices can
@@ -50,6 +61,10 @@ class SpiMasterSyncSerial : public MasterSyncSerial {
 	 * avoid initializing the whole struct before every transfer.
 	 */
 	spi_ioc_transfer xfer;
+	/**
+	 * Collects the transfers for a message to the kernel.
+	 */
+	class MsgBuilder;
 	/**
 	 * The file descriptor for SPI access.
 	 */
@@ -68,7 +83,41 @@ protected:
 		std::uint8_t * __restrict__ in,
 		duds::general::Bits bits
 	);
+	/**
+	 * Implements converseAlreadyOpen() for both conversation types.
+	 * @tparam Conv  The conversation type.
+	 */
+	template <class Conv>
+	void converseParts(Conv &conv);
+	/**
+	 * Has a half-duplex Conversation with the connected device using as few
+	 * SPI messages as possible.
+	 * @pre   The object is in the open state or the communicating state.
+	 * @post  The object is in the open state, but not the communicating state.
+	 * @param conv  The conversation to have with the device on the other end.
+	 * @throw SyncSerialIoError  An error prevented the communication. This
+	 *                           includes conversations with more data than
+	 *                           the kernel allows in a single message.
+	 */
+	virtual void converseAlreadyOpen(Conversation &conv);
+	/**
+	 * Has a half-duplex conversation held in a ConversationArena with the
+	 * connected device using as few SPI messages as possible. No memory is
+	 * allocated.
+	 * @pre   The object is in the open state or the communicating state.
+	 * @post  The object is in the open state, but not the communicating state.
+	 * @param conv  The conversation to have with the device on the other end.
+	 * @throw SyncSerialIoError  An error prevented the communication. This
+	 *                           includes conversations with more data than
+	 *                           the kernel allows in a single message.
+	 */
+	virtual void converseAlreadyOpen(const ConversationArena &conv);
 public:
+	/**
+	 * The maximum number of transfers, one for each conversation part, in a
+	 * single message to the kernel.
+	 */
+	static constexpr std::size_t MsgTransfers = 64;
 	/**
 	 * Creates the object without a SPI device to use.
 	 */
@@ -0,0 +1,393 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/hardware/interface/linux/bcm283x/GpioMemPort.hpp>
+#include <duds/hardware/interface/PinConfiguration.hpp>
+#include <duds/general/YieldingWait.hpp>
+#include <fstream>
+#include <iterator>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace duds { namespace hardware { namespace interface { namespace linux {
+namespace bcm283x {
+
+/**
+ * The time to wait between steps of the BCM283x pull change sequence. The
+ * datasheet requires 150 cycles of the core clock.
+ */
+static constexpr std::chrono::microseconds PullSetupTime(5);
+
+GpioMemPort::GpioMemPort(
+	const std::vector<unsigned int> &ids,
+	unsigned int firstid,
+	Soc model,
+	const std::string &path
+) : DigitalPortIndependentPins(ids.size(), firstid), gpios(ids.size()),
+devpath(path), soc((model == DetectSoc) ? detect() : model) {
+	int fd = open(path.c_str(), O_RDWR | O_SYNC | O_CLOEXEC);
+	if (fd < 0) {
+		DUDS_THROW_EXCEPTION(DigitalPortDoesNotExistError() <<
+			boost::errinfo_errno(errno) << boost::errinfo_file_name(path)
+		);
+	}
+	void *addr = mmap(
+		nullptr,
+		MapSize,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED,
+		fd,
+		0
+	);
+	int res = errno;
+	// the mapping remains after the file is closed
+	close(fd);
+	if (addr == MAP_FAILED) {
+		DUDS_THROW_EXCEPTION(DigitalPortDoesNotExistError() <<
+			boost::errinfo_errno(res) << boost::errinfo_file_name(path)
+		);
+	}
+	regs = (volatile std::uint32_t*)addr;
+	try {
+		std::vector<unsigned int>::const_iterator iter = ids.begin();
+		for (unsigned int lid = 0; iter != ids.end(); ++iter, ++lid) {
+			initPin(*iter, lid);
+		}
+	} catch (PinError &pe) {
+		munmap((void*)regs, MapSize);
+		pe << boost::errinfo_file_name(path);
+		throw;
+	}
+}
+
+std::shared_ptr<GpioMemPort> GpioMemPort::makeConfiguredPort(
+	PinConfiguration &pc,
+	const std::string &name,
+	const std::string &defaultPath,
+	bool forceDefault
+) {
+	// find the port's config object
+	const PinConfiguration::Port &port = pc.port(name);
+	// work out device file path
+	std::string path;
+	if (forceDefault || port.typeval.empty()) {
+		path = defaultPath;
+	} else {
+		path = port.typeval;
+	}
+	// enumerate the pins
+	std::vector<unsigned int> gpios;
+	unsigned int next = port.idOffset;
+	gpios.reserve(port.pins.size());
+	for (auto const &pin : port.gidIndex()) {
+		// need empty spots?
+		if (pin.gid > next) {
+			// add unavailable pins
+			gpios.insert(gpios.end(), pin.gid - next, -1);
+		}
+		// add available pin
+		gpios.push_back(pin.pid);
+		next = pin.gid + 1;
+	}
+	std::shared_ptr<GpioMemPort> sp = std::make_shared<GpioMemPort>(
+		gpios,
+		port.idOffset,
+		DetectSoc,
+		path
+	);
+	try {
+		pc.attachPort(sp, name);
+	} catch (PinError &pe) {
+		pe << boost::errinfo_file_name(path);
+		throw;
+	}
+	return sp;
+}
+
+GpioMemPort::~GpioMemPort() {
+	shutdown();
+	munmap((void*)regs, MapSize);
+}
+
+GpioMemPort::Soc GpioMemPort::detect() {
+	std::ifstream dt("/proc/device-tree/compatible");
+	std::string compat(
+		(std::istreambuf_iterator<char>(dt)),
+		std::istreambuf_iterator<char>()
+	);
+	if (compat.find("bcm2711") != std::string::npos) {
+		return Bcm2711;
+	}
+	return Bcm283x;
+}
+
+bool GpioMemPort::simultaneousOperations() const {
+	return true;
+}
+
+void GpioMemPort::initPin(unsigned int gpio, unsigned int lid) {
+	if (gpio == (unsigned int)-1) {
+		// line cannot be used
+		pins[lid].markNonexistent();
+		return;
+	}
+	if (gpio >= gpioCount(soc)) {
+		DUDS_THROW_EXCEPTION(GpioMemRangeError() <<
+			PinErrorId(globalId(lid)) << PinErrorPortId(gpio)
+		);
+	}
+	gpios[lid] = gpio;
+	DigitalPinConfig &dpc = pins[lid].conf;
+	dpc.minOutputCurrent = dpc.maxOutputCurrent = 0;
+	// read the function; any alternate function is reported as an input
+	std::uint32_t fsel = (regs[GPFSEL0 + gpio / 10] >> ((gpio % 10) * 3)) & 7;
+	if (fsel == 1) {
+		dpc.options = DigitalPinConfig::DirOutput |
+			DigitalPinConfig::OutputPushPull;
+	} else {
+		dpc.options = DigitalPinConfig::DirInput;
+	}
+	// use the current level as the output state so that a change to output
+	// will not alter the level
+	if (regs[GPLEV0 + (gpio >> 5)] & (1 << (gpio & 31))) {
+		dpc.options |= DigitalPinConfig::OutputState |
+			DigitalPinConfig::InputState;
+	}
+	// only the BCM2711 can report the pull state
+	if (soc == Bcm2711) {
+		std::uint32_t pud = (regs[GPIO_PUP_PDN_CNTRL_REG0 + (gpio >> 4)] >>
+			((gpio & 15) * 2)) & 3;
+		if (pud == 1) {
+			dpc.options |= DigitalPinConfig::InputPullup;
+		} else if (pud == 2) {
+			dpc.options |= DigitalPinConfig::InputPulldown;
+		} else {
+			dpc.options |= DigitalPinConfig::InputNoPull;
+		}
+	}
+	pins[lid].cap.capabilities =
+		DigitalPinCap::Input |
+		DigitalPinCap::OutputPushPull |
+		DigitalPinCap::HasPulldown |
+		DigitalPinCap::ControllablePulldown |
+		DigitalPinCap::HasPullup |
+		DigitalPinCap::ControllablePullup;
+	// the default drive strength
+	pins[lid].cap.maxOutputCurrent = 8;
+}
+
+void GpioMemPort::function(unsigned int gpio, std::uint32_t fsel) {
+	volatile std::uint32_t &reg = regs[GPFSEL0 + gpio / 10];
+	int shift = (gpio % 10) * 3;
+	reg = (reg & ~(7 << shift)) | (fsel << shift);
+}
+
+void GpioMemPort::pull(unsigned int gpio, DigitalPinConfig::Flags pull) {
+	if (soc == Bcm2711) {
+		std::uint32_t pud = 0;
+		if (pull & DigitalPinConfig::InputPullup) {
+			pud = 1;
+		} else if (pull & DigitalPinConfig::InputPulldown) {
+			pud = 2;
+		}
+		volatile std::uint32_t &reg = regs[GPIO_PUP_PDN_CNTRL_REG0 + (gpio >> 4)];
+		int shift = (gpio & 15) * 2;
+		reg = (reg & ~(3 << shift)) | (pud << shift);
+	} else {
+		std::uint32_t pud = 0;
+		if (pull & DigitalPinConfig::InputPullup) {
+			pud = 2;
+		} else if (pull & DigitalPinConfig::InputPulldown) {
+			pud = 1;
+		}
+		// the sequence from the BCM2835 datasheet
+		regs[GPPUD] = pud;
+		duds::general::YieldingWait(PullSetupTime);
+		regs[GPPUDCLK0 + (gpio >> 5)] = 1 << (gpio & 31);
+		duds::general::YieldingWait(PullSetupTime);
+		regs[GPPUD] = 0;
+		regs[GPPUDCLK0 + (gpio >> 5)] = 0;
+	}
+}
+
+void GpioMemPort::configurePort(
+	unsigned int lid,
+	const DigitalPinConfig &cfg,
+	DigitalPinAccessBase::PortData *
+) {
+	// only configure existing pins
+	if (!pins[lid]) {
+		return;
+	}
+	unsigned int gpio = gpios[lid];
+	DigitalPinConfig &dpc = pins[lid].conf;
+	// pull resistor change?
+	DigitalPinConfig::Flags pud = cfg & (
+		DigitalPinConfig::InputNoPull |
+		DigitalPinConfig::InputPulldown |
+		DigitalPinConfig::InputPullup
+	);
+	if (pud && (pud != (dpc.options & (
+		DigitalPinConfig::InputNoPull |
+		DigitalPinConfig::InputPulldown |
+		DigitalPinConfig::InputPullup
+	)))) {
+		pull(gpio, pud);
+	}
+	// compare with the register rather than the configuration so that a pin
+	// using an alternate function is changed
+	std::uint32_t fsel = (regs[GPFSEL0 + gpio / 10] >> ((gpio % 10) * 3)) & 7;
+	if (cfg & DigitalPinConfig::DirOutput) {
+		if (fsel != 1) {
+			// set the output state before the pin starts to output
+			writeGpio(gpio, dpc.options & DigitalPinConfig::OutputState);
+			function(gpio, 1);
+		}
+	} else if (cfg & DigitalPinConfig::DirInput) {
+		if (fsel != 0) {
+			function(gpio, 0);
+		}
+	}
+}
+
+bool GpioMemPort::inputImpl(
+	unsigned int gid,
+	DigitalPinAccessBase::PortData *
+) {
+	unsigned int lid = localId(gid);
+	unsigned int gpio = gpios[lid];
+	bool res = (regs[GPLEV0 + (gpio >> 5)] & (1 << (gpio & 31))) != 0;
+	pins[lid].conf.options.setTo(DigitalPinConfig::InputState, res);
+	return res;
+}
+
+std::vector<bool> GpioMemPort::inputImpl(
+	const std::vector<unsigned int> &pvec,
+	DigitalPinAccessBase::PortData *
+) {
+	// sample both banks at nearly the same time
+	const std::uint32_t lev[2] = { regs[GPLEV0], regs[GPLEV0 + 1] };
+	std::vector<bool> outv;
+	outv.reserve(pvec.size());
+	for (const unsigned int &lid : pvec) {
+		unsigned int gpio = gpios[lid];
+		bool res = (lev[gpio >> 5] & (1 << (gpio & 31))) != 0;
+		pins[lid].conf.options.setTo(DigitalPinConfig::InputState, res);
+		outv.push_back(res);
+	}
+	return outv;
+}
+
+void GpioMemPort::outputImpl(
+	unsigned int lid,
+	bool state,
+	DigitalPinAccessBase::PortData *
+) {
+	DigitalPinConfig &dpc = pins[lid].conf;
+	if (dpc.options & DigitalPinConfig::DirOutput) {
+		writeGpio(gpios[lid], state);
+	}
+	dpc.options.setTo(DigitalPinConfig::OutputState, state);
+}
+
+void GpioMemPort::outputImpl(
+	const std::vector<unsigned int> &pvec,
+	const std::vector<bool> &state,
+	DigitalPinAccessBase::PortData *
+) {
+	std::uint32_t set[2] = { 0, 0 }, clr[2] = { 0, 0 };
+	std::vector<unsigned int>::const_iterator piter = pvec.begin();
+	std::vector<bool>::const_iterator siter = state.begin();
+	for (; piter != pvec.end(); ++piter, ++siter) {
+		DigitalPinConfig &dpc = pins[*piter].conf;
+		// configured for output? might be changing state ahead of config change
+		if (dpc.options & DigitalPinConfig::DirOutput) {
+			unsigned int gpio = gpios[*piter];
+			if (*siter) {
+				set[gpio >> 5] |= 1 << (gpio & 31);
+			} else {
+				clr[gpio >> 5] |= 1 << (gpio & 31);
+			}
+		}
+		// store new state
+		dpc.options.setTo(DigitalPinConfig::OutputState, *siter);
+	}
+	for (int bank = 0; bank < 2; ++bank) {
+		if (set[bank]) {
+			regs[GPSET0 + bank] = set[bank];
+		}
+		if (clr[bank]) {
+			regs[GPCLR0 + bank] = clr[bank];
+		}
+	}
+}
+
+void GpioMemPort::outputSequenceImpl(
+	const std::vector<unsigned int> &pvec,
+	const DigitalPinWaveform &wave,
+	DigitalPinAccessBase::PortData *
+) {
+	// find the register bit for each position used by an output; the
+	// configuration cannot change while the port is locked
+	const unsigned int width = wave.width();
+	std::uint32_t bits[DigitalPinWaveform::MaxPins];
+	std::uint8_t banks[DigitalPinWaveform::MaxPins];
+	std::uint64_t outPos = 0;
+	for (unsigned int pos = 0; pos < width; ++pos) {
+		if ((wave.pinsUsed() & ((std::uint64_t)1 << pos)) &&
+			(pins[pvec[pos]].conf.options & DigitalPinConfig::DirOutput)
+		) {
+			unsigned int gpio = gpios[pvec[pos]];
+			bits[pos] = 1 << (gpio & 31);
+			banks[pos] = gpio >> 5;
+			outPos |= (std::uint64_t)1 << pos;
+		}
+	}
+	std::uint64_t last = 0;
+	for (const DigitalPinWaveform::Step &step : wave.steps()) {
+		last = (last & ~step.mask) | step.states;
+		std::uint32_t set[2] = { 0, 0 }, clr[2] = { 0, 0 };
+		std::uint64_t mask = step.mask & outPos;
+		for (unsigned int pos = 0; mask; ++pos, mask >>= 1) {
+			if (mask & 1) {
+				if (step.states & ((std::uint64_t)1 << pos)) {
+					set[banks[pos]] |= bits[pos];
+				} else {
+					clr[banks[pos]] |= bits[pos];
+				}
+			}
+		}
+		for (int bank = 0; bank < 2; ++bank) {
+			if (set[bank]) {
+				regs[GPSET0 + bank] = set[bank];
+			}
+			if (clr[bank]) {
+				regs[GPCLR0 + bank] = clr[bank];
+			}
+		}
+		if (step.delay.count() > 0) {
+			duds::general::YieldingWait(step.delay);
+		}
+	}
+	// store the final states
+	std::uint64_t used = wave.pinsUsed();
+	for (unsigned int pos = 0; used; ++pos, used >>= 1) {
+		if (used & 1) {
+			pins[pvec[pos]].conf.options.setTo(
+				DigitalPinConfig::OutputState,
+				(last >> pos) & 1
+			);
+		}
+	}
+}
+
+} } } } } // namespaces
@@ -0,0 +1,275 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef GPIOMEMPORT_HPP
+#define GPIOMEMPORT_HPP
+
+#include <duds/hardware/interface/DigitalPortIndependentPins.hpp>
+
+// !@?!#?!#?
+// It was bad enough to find an MS header had "#define interface struct".
+// I was hoping such things wouldn't be here, but I was wrong.
+#undef linux
+
+namespace duds { namespace hardware { namespace interface {
+
+class PinConfiguration;
+
+namespace linux { namespace bcm283x {
+
+/**
+ * A pin number beyond the GPIOs of the SoC was requested.
+ */
+struct GpioMemRangeError : DigitalPortLacksPinError { };
+
+/**
+ * A GPIO implementation that directly uses the GPIO registers of the
+ * Broadcom BCM2835, BCM2836, BCM2837 (collectively BCM283x), and BCM2711
+ * SoCs used on Raspberry Pi boards. The registers are memory mapped from
+ * @c /dev/gpiomem, which the kernel provides to unprivileged processes in the
+ * @c gpio group. Pin operations take no system calls, and the set and clear
+ * registers change the output of many pins with a single write, so this port
+ * is much faster than GpioDevPort and SysFsPort. It is intended for
+ * bit-banged protocols that need high toggle rates.
+ *
+ * The pin IDs used with the constructor and the configuration are the
+ * Broadcom GPIO numbers, not the numbers of the header pins.
+ *
+ * Pins may be configured as inputs or push-pull outputs, and may have a
+ * pull-up or pull-down resistor enabled. The alternate functions of the pins
+ * are not supported. A pin that is using an alternate function will be
+ * switched to input or output when configured. On the BCM283x, the pull
+ * resistor state cannot be read, so pins start with no pull configuration and
+ * changes are made with the timed sequence described in the datasheet.
+ *
+ * Other processes, and the kernel, may use the same registers without
+ * coordination. Output changes through the set and clear registers are safe,
+ * but changing the function select and pull registers is a read-modify-write
+ * operation that may lose a simultaneous change made elsewhere to a pin that
+ * shares the register. Do not use pins that are in use elsewhere.
+ *
+ * A regular file of at least GpioMemPort::MapSize bytes may be given instead
+ * of @c /dev/gpiomem for testing. The file will hold the register values
+ * written by the port, and input states may be placed in the level registers.
+ *
+ * @author  Jeff Jackowski
+ */
+class GpioMemPort : public DigitalPortIndependentPins {
+public:
+	/**
+	 * The supported SoC register layouts.
+	 */
+	enum Soc {
+		/**
+		 * Read @c /proc/device-tree/compatible to select between Bcm283x and
+		 * Bcm2711.
+		 */
+		DetectSoc,
+		/**
+		 * The BCM2835, BCM2836, and BCM2837, with 54 GPIOs.
+		 */
+		Bcm283x,
+		/**
+		 * The BCM2711, with 58 GPIOs and readable pull registers.
+		 */
+		Bcm2711
+	};
+	/**
+	 * The number of bytes mapped from the device file.
+	 */
+	static constexpr std::size_t MapSize = 4096;
+	/**
+	 * Register offsets in 32-bit words from the start of the GPIO registers.
+	 */
+	enum Register {
+		/**
+		 * The first function select register. There are 6 with 10 pins each.
+		 */
+		GPFSEL0 = 0,
+		/**
+		 * The first output set register. There are 2 with 32 pins each.
+		 */
+		GPSET0 = 7,
+		/**
+		 * The first output clear register. There are 2 with 32 pins each.
+		 */
+		GPCLR0 = 10,
+		/**
+		 * The first pin level register. There are 2 with 32 pins each.
+		 */
+		GPLEV0 = 13,
+		/**
+		 * The pull control register of the BCM283x.
+		 */
+		GPPUD = 37,
+		/**
+		 * The first pull clock register of the BCM283x. There are 2 with 32
+		 * pins each.
+		 */
+		GPPUDCLK0 = 38,
+		/**
+		 * The first pull control register of the BCM2711. There are 4 with 16
+		 * pins each.
+		 */
+		GPIO_PUP_PDN_CNTRL_REG0 = 57
+	};
+private:
+	/**
+	 * The memory mapped registers.
+	 */
+	volatile std::uint32_t *regs;
+	/**
+	 * The Broadcom GPIO number of each pin; the index is the local ID.
+	 */
+	std::vector<std::uint8_t> gpios;
+	/**
+	 * The path of the device file.
+	 */
+	std::string devpath;
+	/**
+	 * The SoC with the registers.
+	 */
+	Soc soc;
+	/**
+	 * Initializes a PinEntry object from the state of the registers.
+	 * @param gpio  The Broadcom GPIO number, or -1 for no pin.
+	 * @param lid   The local ID for the pin.
+	 * @throw GpioMemRangeError  @a gpio is beyond the GPIOs of the SoC.
+	 */
+	void initPin(unsigned int gpio, unsigned int lid);
+	/**
+	 * Sets or clears the output of a single GPIO.
+	 */
+	void writeGpio(unsigned int gpio, bool state) {
+		regs[(state ? GPSET0 : GPCLR0) + (gpio >> 5)] = 1 << (gpio & 31);
+	}
+	/**
+	 * Changes the function select bits of a GPIO; 0 for input, 1 for output.
+	 */
+	void function(unsigned int gpio, std::uint32_t fsel);
+	/**
+	 * Changes the pull resistor of a GPIO.
+	 * @param gpio  The Broadcom GPIO number.
+	 * @param pull  DigitalPinConfig::InputNoPull,
+	 *              DigitalPinConfig::InputPulldown, or
+	 *              DigitalPinConfig::InputPullup.
+	 */
+	void pull(unsigned int gpio, DigitalPinConfig::Flags pull);
+public:
+	/**
+	 * Maps the GPIO registers and makes a port with the given pins.
+	 * @param ids      The Broadcom GPIO numbers. The index of each inside
+	 *                 @a ids will be the local pin ID used by this port. A
+	 *                 value of -1 will create an unavailable pin and may be
+	 *                 used multiple times. Other values must only be used once.
+	 * @param firstid  The gloabl ID that will be assigned to the first pin
+	 *                 (local ID zero) of this port.
+	 * @param model    The SoC with the registers.
+	 * @param path     The path to the device file.
+	 * @throw DigitalPortDoesNotExistError  The device file could not be opened
+	 *                                      or mapped.
+	 * @throw GpioMemRangeError             A GPIO number is beyond the GPIOs
+	 *                                      of the SoC.
+	 */
+	GpioMemPort(
+		const std::vector<unsigned int> &ids,
+		unsigned int firstid = 0,
+		Soc model = DetectSoc,
+		const std::string &path = "/dev/gpiomem"
+	);
+	/**
+	 * Make a GpioMemPort object according to the given configuration, and
+	 * attach to the configuration.
+	 * @param pc            The object with the port configuration data.
+	 * @param name          The name of the port in the configuration.
+	 * @param defaultPath   The default path to the port's device file. This
+	 *                      will be used if not specified in the configuration.
+	 * @param forceDefault  If true, the value in @a defaultPath will be used
+	 *                      even if the device file is specified in the
+	 *                      configuration.
+	 * @throw PortDoesNotExistError         There is no port called @a name in
+	 *                                      the given configuration.
+	 * @throw DigitalPortDoesNotExistError  The device file could not be opened
+	 *                                      or mapped.
+	 * @throw GpioMemRangeError             A GPIO number is beyond the GPIOs
+	 *                                      of the SoC.
+	 */
+	static std::shared_ptr<GpioMemPort> makeConfiguredPort(
+		PinConfiguration &pc,
+		const std::string &name = "default",
+		const std::string &defaultPath = "/dev/gpiomem",
+		bool forceDefault = false
+	);
+	virtual ~GpioMemPort();
+	/**
+	 * Returns the SoC register layout in use.
+	 */
+	Soc model() const {
+		return soc;
+	}
+	/**
+	 * Returns the number of GPIOs on the given SoC.
+	 */
+	static unsigned int gpioCount(Soc model) {
+		return (model == Bcm2711) ? 58 : 54;
+	}
+	/**
+	 * Finds the SoC by reading @c /proc/device-tree/compatible. If the file
+	 * cannot be read or does not name the BCM2711, Bcm283x is returned.
+	 */
+	static Soc detect();
+protected:
+	// virtual functions required by Digitalport
+	virtual void configurePort(
+		unsigned int localPinId,
+		const DigitalPinConfig &cfg,
+		DigitalPinAccessBase::PortData *pdata
+	);
+	virtual bool inputImpl(
+		unsigned int gid,
+		DigitalPinAccessBase::PortData *pdata
+	);
+	virtual std::vector<bool> inputImpl(
+		const std::vector<unsigned int> &pvec,
+		DigitalPinAccessBase::PortData *pdata
+	);
+	virtual void outputImpl(
+		unsigned int lid,
+		bool state,
+		DigitalPinAccessBase::PortData *pdata
+	);
+	/**
+	 * Changes the outputs with at most one write to each of the set and clear
+	 * registers.
+	 */
+	virtual void outputImpl(
+		const std::vector<unsigned int> &pvec,
+		const std::vector<bool> &state,
+		DigitalPinAccessBase::PortData *pdata
+	);
+	/**
+	 * Outputs each step of the waveform with at most one write to each of the
+	 * set and clear registers.
+	 */
+	virtual void outputSequenceImpl(
+		const std::vector<unsigned int> &pvec,
+		const DigitalPinWaveform &wave,
+		DigitalPinAccessBase::PortData *pdata
+	);
+public:
+	/**
+	 * Simultaneous operations are supported for pins in the same bank of 32
+	 * GPIOs; returns true.
+	 */
+	virtual bool simultaneousOperations() const;
+};
+
+} } } } } // namespaces
+
+#endif        //  #ifndef GPIOMEMPORT_HPP
@@ -0,0 +1,174 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+#include <cstring>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+VirtualDevice::VirtualDevice() :
+transDelay(0), byteDelay(0), transCount(0), byteCount(0), transStartBytes(0),
+failPeriod(0), failRemain(0), active(false) { }
+
+VirtualDevice::~VirtualDevice() { }
+
+void VirtualDevice::stopImpl() { }
+
+bool VirtualDevice::start() {
+	if (!active) {
+		++transCount;
+		if (failRemain) {
+			--failRemain;
+			return false;
+		}
+		if (failPeriod && !(transCount % failPeriod)) {
+			return false;
+		}
+		transStartBytes = byteCount;
+		active = true;
+		startImpl(false);
+	} else {
+		startImpl(true);
+	}
+	return true;
+}
+
+void VirtualDevice::stop() {
+	if (!active) {
+		return;
+	}
+	active = false;
+	stopImpl();
+	std::chrono::nanoseconds delay = transDelay +
+		byteDelay * (byteCount - transStartBytes);
+	if (delay.count()) {
+		// busy wait; sleeping would add the scheduler's latency
+		std::chrono::steady_clock::time_point until =
+			std::chrono::steady_clock::now() + delay;
+		while (std::chrono::steady_clock::now() < until) { }
+	}
+}
+
+VirtualRegisterDevice::VirtualRegisterDevice(
+	unsigned int width,
+	bool bigEndian,
+	bool autoIncrement,
+	std::uint8_t addrMask
+) : ptr(0), offset(0), amask(addrMask), addrNext(true), big(bigEndian),
+autoinc(autoIncrement) {
+	if (!width || (width > sizeof(Register::data))) {
+		DUDS_THROW_EXCEPTION(VirtualRegisterWidthError());
+	}
+	std::memset(regs, 0, sizeof(regs));
+	for (Register &r : regs) {
+		r.width = width;
+	}
+}
+
+void VirtualRegisterDevice::width(std::uint8_t addr, unsigned int w) {
+	if (!w || (w > sizeof(Register::data))) {
+		DUDS_THROW_EXCEPTION(VirtualRegisterWidthError());
+	}
+	std::uint32_t v = value(addr);
+	regs[addr].width = w;
+	value(addr, v);
+}
+
+std::uint32_t VirtualRegisterDevice::value(std::uint8_t addr) const {
+	const Register &r = regs[addr];
+	std::uint32_t v = 0;
+	for (int b = 0; b < r.width; ++b) {
+		if (big) {
+			v = (v << 8) | r.data[b];
+		} else {
+			v |= (std::uint32_t)r.data[b] << (b * 8);
+		}
+	}
+	return v;
+}
+
+void VirtualRegisterDevice::value(std::uint8_t addr, std::uint32_t v) {
+	Register &r = regs[addr];
+	for (int b = 0; b < r.width; ++b) {
+		if (big) {
+			r.data[r.width - b - 1] = (std::uint8_t)(v >> (b * 8));
+		} else {
+			r.data[b] = (std::uint8_t)(v >> (b * 8));
+		}
+	}
+}
+
+void VirtualRegisterDevice::put(
+	std::uint8_t addr,
+	std::uint32_t v,
+	unsigned int bytes
+) {
+	for (; bytes; --bytes, ++addr, v >>= 8) {
+		regs[addr].data[0] = (std::uint8_t)v;
+	}
+}
+
+std::uint32_t VirtualRegisterDevice::get(
+	std::uint8_t addr,
+	unsigned int bytes
+) const {
+	std::uint32_t v = 0;
+	for (unsigned int b = 0; b < bytes; ++b) {
+		v |= (std::uint32_t)regs[(std::uint8_t)(addr + b)].data[0] << (b * 8);
+	}
+	return v;
+}
+
+std::uint8_t VirtualRegisterDevice::command(std::uint8_t byte) {
+	return byte & amask;
+}
+
+std::uint8_t VirtualRegisterDevice::next(std::uint8_t addr) {
+	return autoinc ? addr + 1 : addr;
+}
+
+void VirtualRegisterDevice::advance() {
+	if (++offset >= regs[ptr].width) {
+		offset = 0;
+		ptr = next(ptr);
+	}
+}
+
+void VirtualRegisterDevice::startImpl(bool) {
+	addrNext = true;
+	offset = 0;
+}
+
+void VirtualRegisterDevice::writeImpl(std::uint8_t byte) {
+	if (addrNext) {
+		ptr = command(byte);
+		addrNext = false;
+		return;
+	}
+	std::uint8_t addr = ptr;
+	regs[addr].data[offset] = byte;
+	bool last = offset + 1 >= regs[addr].width;
+	advance();
+	if (last && writeHooks[addr]) {
+		writeHooks[addr](*this, addr);
+	}
+}
+
+std::uint8_t VirtualRegisterDevice::readImpl() {
+	// a read ends the chance to write an address
+	addrNext = false;
+	if (!offset && readHooks[ptr]) {
+		readHooks[ptr](*this, ptr);
+	}
+	std::uint8_t byte = regs[ptr].data[offset];
+	advance();
+	return byte;
+}
+
+} } } } // namespaces
@@ -0,0 +1,360 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef VIRTUALDEVICE_HPP
+#define VIRTUALDEVICE_HPP
+
+#include <duds/general/Errors.hpp>
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+/**
+ * A register width of zero, or more than the four bytes a
+ * VirtualRegisterDevice register can hold, was requested.
+ */
+struct VirtualRegisterWidthError :
+virtual std::exception, virtual boost::exception { };
+
+/**
+ * A simulated device on the other end of a simulated bus such as VirtualI2c,
+ * VirtualSmbus, or VirtualMasterSyncSerial. The buses reduce their
+ * communication to transactions of bytes written to and read from the device:
+ * a transaction begins with start(), may include repeated starts, and ends
+ * with stop(). This is the same for I2C, SMBus, and SPI; a repeated start is
+ * the start of each I2C message after the first, and chip select for SPI.
+ *
+ * To make the simulation useful for timing drivers, a delay may be added to
+ * each transaction and to each byte. The delay is a busy wait so that it is
+ * not lengthened by the scheduler. Errors may be injected by making selected
+ * transactions fail to start; the bus will report this as the device not
+ * responding.
+ *
+ * Everything is deterministic; the device only changes in response to the
+ * bus, and the injected errors are chosen by count rather than at random.
+ * Objects are not thread-safe.
+ *
+ * @author  Jeff Jackowski
+ */
+class VirtualDevice : boost::noncopyable {
+	/**
+	 * The delay added to each transaction.
+	 */
+	std::chrono::nanoseconds transDelay;
+	/**
+	 * The delay added for each byte.
+	 */
+	std::chrono::nanoseconds byteDelay;
+	/**
+	 * The number of transactions started.
+	 */
+	std::uint64_t transCount;
+	/**
+	 * The number of bytes transferred.
+	 */
+	std::uint64_t byteCount;
+	/**
+	 * The number of bytes transferred when the current transaction started.
+	 */
+	std::uint64_t transStartBytes;
+	/**
+	 * Every transaction with a count that is a multiple of this value fails.
+	 * Zero disables.
+	 */
+	unsigned int failPeriod;
+	/**
+	 * The number of upcoming transactions that will fail.
+	 */
+	unsigned int failRemain;
+	/**
+	 * True while in a transaction.
+	 */
+	bool active;
+protected:
+	/**
+	 * Called for each start and repeated start.
+	 * @param repeated  True for a repeated start.
+	 */
+	virtual void startImpl(bool repeated) = 0;
+	/**
+	 * Called at the end of a transaction. Does nothing by default.
+	 */
+	virtual void stopImpl();
+	/**
+	 * Receives a byte written by the bus master.
+	 */
+	virtual void writeImpl(std::uint8_t byte) = 0;
+	/**
+	 * Supplies a byte read by the bus master.
+	 */
+	virtual std::uint8_t readImpl() = 0;
+public:
+	VirtualDevice();
+	virtual ~VirtualDevice();
+	/**
+	 * Starts a transaction, or makes a repeated start if a transaction is
+	 * already in progress.
+	 * @return  False if the device failed to respond because of an injected
+	 *          error. The transaction is not started, and the bus should
+	 *          report that the device did not respond.
+	 */
+	bool start();
+	/**
+	 * Ends the transaction and waits for any configured delay. Does nothing
+	 * if no transaction is in progress.
+	 */
+	void stop();
+	/**
+	 * Writes a byte to the device.
+	 * @pre  A transaction is in progress.
+	 */
+	void write(std::uint8_t byte) {
+		++byteCount;
+		writeImpl(byte);
+	}
+	/**
+	 * Reads a byte from the device.
+	 * @pre  A transaction is in progress.
+	 */
+	std::uint8_t read() {
+		++byteCount;
+		return readImpl();
+	}
+	/**
+	 * Sets the delays used to simulate the time taken by the bus.
+	 * @param perTransaction  The time added to each transaction.
+	 * @param perByte         The time added for each byte.
+	 */
+	void latency(
+		std::chrono::nanoseconds perTransaction,
+		std::chrono::nanoseconds perByte = std::chrono::nanoseconds(0)
+	) {
+		transDelay = perTransaction;
+		byteDelay = perByte;
+	}
+	/**
+	 * Makes the transactions whose count, as reported by transactions(), is
+	 * a multiple of @a period fail. Zero stops the failures.
+	 */
+	void failEvery(unsigned int period) {
+		failPeriod = period;
+	}
+	/**
+	 * Makes the next @a count transactions fail.
+	 */
+	void failNext(unsigned int count = 1) {
+		failRemain = count;
+	}
+	/**
+	 * Returns the number of transactions attempted, including failures.
+	 */
+	std::uint64_t transactions() const {
+		return transCount;
+	}
+	/**
+	 * Returns the number of bytes transferred.
+	 */
+	std::uint64_t bytes() const {
+		return byteCount;
+	}
+	/**
+	 * Resets the transaction and byte counts to zero. A transaction in
+	 * progress will only be delayed for the bytes transferred after the
+	 * reset.
+	 */
+	void resetCounts() {
+		transCount = byteCount = transStartBytes = 0;
+	}
+};
+
+/**
+ * A VirtualDevice modeled as registers accessed through an address pointer,
+ * as is typical for I2C, SMBus, and SPI sensors. The first byte written in
+ * each start, or repeated start, sets the address pointer; following bytes
+ * are written to the register at the pointer. Reads use the pointer as left
+ * by the last start. After a register's last byte is accessed, the pointer
+ * moves to the next register, or stays put if auto-increment is off.
+ *
+ * Registers are one byte by default, but each may be given a different width
+ * of up to four bytes. The bytes of a multi-byte register are transferred in
+ * either big or little endian order. Multi-byte values that span several
+ * single byte registers, as used by most of the devices supported by this
+ * library, are accessed with the put() and get() functions.
+ *
+ * Device behavior is scripted with hooks called when a register is read or
+ * written. A read hook is called before the first byte of the register is
+ * read so it may update the value. A write hook is called after the last
+ * byte of the register has been written. Derived classes can change the
+ * handling of the address byte with command(), and the sequence of
+ * registers with next().
+ *
+ * @author  Jeff Jackowski
+ */
+class VirtualRegisterDevice : public VirtualDevice {
+public:
+	/**
+	 * A function called when a register is accessed. It is given the device
+	 * and the register's address.
+	 */
+	typedef std::function<void(VirtualRegisterDevice &, std::uint8_t)>  Hook;
+private:
+	/**
+	 * A register.
+	 */
+	struct Register {
+		/**
+		 * The register's bytes in the order they are transferred.
+		 */
+		std::uint8_t data[4];
+		/**
+		 * The number of bytes in the register.
+		 */
+		std::uint8_t width;
+	};
+	/**
+	 * All the registers.
+	 */
+	Register regs[256];
+	/**
+	 * Hooks called before a register is read.
+	 */
+	Hook readHooks[256];
+	/**
+	 * Hooks called after a register is written.
+	 */
+	Hook writeHooks[256];
+	/**
+	 * The address pointer.
+	 */
+	std::uint8_t ptr;
+	/**
+	 * The byte within the register at @a ptr that will be accessed next.
+	 */
+	std::uint8_t offset;
+	/**
+	 * The mask applied to the address byte by command().
+	 */
+	std::uint8_t amask;
+	/**
+	 * True if the next byte written is an address.
+	 */
+	bool addrNext;
+	/**
+	 * True if multi-byte registers are transferred most significant byte
+	 * first.
+	 */
+	bool big;
+	/**
+	 * True to automatically move to the next register.
+	 */
+	bool autoinc;
+	/**
+	 * Moves the position to the next byte, and to the next register if at the
+	 * end of the current one.
+	 */
+	void advance();
+protected:
+	virtual void startImpl(bool repeated);
+	virtual void writeImpl(std::uint8_t byte);
+	virtual std::uint8_t readImpl();
+	/**
+	 * Converts the address byte written at the start of a transaction to a
+	 * register address. By default, the address mask given to the
+	 * constructor is applied.
+	 */
+	virtual std::uint8_t command(std::uint8_t byte);
+	/**
+	 * Returns the address of the register after @a addr. By default, this is
+	 * @a addr + 1 when auto-increment is enabled, or @a addr when it is not.
+	 */
+	virtual std::uint8_t next(std::uint8_t addr);
+public:
+	/**
+	 * Makes a device with all registers set to zero.
+	 * @param width          The width of every register in bytes, 1 to 4.
+	 * @param bigEndian      True to transfer multi-byte registers most
+	 *                       significant byte first.
+	 * @param autoIncrement  True to move the address pointer to the next
+	 *                       register after each register is accessed.
+	 * @param addrMask       Mask for the address byte to remove bits used
+	 *                       for other purposes, like a read flag or
+	 *                       auto-increment flag.
+	 * @throw VirtualRegisterWidthError  @a width is not 1 to 4.
+	 */
+	VirtualRegisterDevice(
+		unsigned int width = 1,
+		bool bigEndian = false,
+		bool autoIncrement = true,
+		std::uint8_t addrMask = 0xFF
+	);
+	/**
+	 * Changes the width of a register.
+	 * @param addr  The register address.
+	 * @param w     The width in bytes, 1 to 4. The value is preserved as much
+	 *              as it fits.
+	 * @throw VirtualRegisterWidthError  @a w is not 1 to 4. The register is
+	 *                                   not changed.
+	 */
+	void width(std::uint8_t addr, unsigned int w);
+	/**
+	 * Returns the width of a register in bytes.
+	 */
+	unsigned int width(std::uint8_t addr) const {
+		return regs[addr].width;
+	}
+	/**
+	 * Returns the value of a register.
+	 */
+	std::uint32_t value(std::uint8_t addr) const;
+	/**
+	 * Sets the value of a register. Hooks are not called.
+	 */
+	void value(std::uint8_t addr, std::uint32_t v);
+	/**
+	 * Stores a little-endian value across consecutive single byte registers.
+	 * @param addr   The address of the first register.
+	 * @param v      The value.
+	 * @param bytes  The number of bytes, and registers, to use.
+	 */
+	void put(std::uint8_t addr, std::uint32_t v, unsigned int bytes = 2);
+	/**
+	 * Returns a little-endian value held across consecutive single byte
+	 * registers.
+	 * @param addr   The address of the first register.
+	 * @param bytes  The number of bytes, and registers, to use.
+	 */
+	std::uint32_t get(std::uint8_t addr, unsigned int bytes = 2) const;
+	/**
+	 * Returns the current address pointer.
+	 */
+	std::uint8_t pointer() const {
+		return ptr;
+	}
+	/**
+	 * Sets a function to call before the register at @a addr is read.
+	 * An empty function removes the hook.
+	 */
+	void onRead(std::uint8_t addr, const Hook &h) {
+		readHooks[addr] = h;
+	}
+	/**
+	 * Sets a function to call after the register at @a addr is written.
+	 * An empty function removes the hook.
+	 */
+	void onWrite(std::uint8_t addr, const Hook &h) {
+		writeHooks[addr] = h;
+	}
+};
+
+} } } } // namespaces
+
+#endif        //  #ifndef VIRTUALDEVICE_HPP
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/test/VirtualI2c.hpp>
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+#include <duds/hardware/interface/I2cErrors.hpp>
+#include <duds/hardware/interface/Conversation.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+template <class Iter>
+void VirtualI2c::converseParts(Iter iter, Iter end) {
+	try {
+		for (int idx = 0; iter != end; ++iter, ++idx) {
+			const auto &cp = conversationPart(*iter);
+			if (cp.flags() & ConversationPart::MpfBreak) {
+				dev->stop();
+			}
+			if (!dev->start()) {
+				DUDS_THROW_EXCEPTION(I2cErrorNoDevice() <<
+					I2cDeviceAddr(addr) << ConversationPartIndex(idx)
+				);
+			}
+			std::uint8_t *data = (std::uint8_t*)cp.start();
+			std::uint8_t *dend = data + cp.length();
+			if (cp.input()) {
+				for (; data < dend; ++data) {
+					*data = dev->read();
+				}
+			} else {
+				for (; data < dend; ++data) {
+					dev->write(*data);
+				}
+			}
+		}
+	} catch (...) {
+		dev->stop();
+		throw;
+	}
+	dev->stop();
+}
+
+void VirtualI2c::converse(Conversation &conv) {
+	converseParts(conv.cbegin(), conv.cend());
+}
+
+void VirtualI2c::converse(const ConversationArena &conv) {
+	converseParts(conv.begin(), conv.end());
+}
+
+int VirtualI2c::address() const {
+	return addr;
+}
+
+} } } } // namespaces
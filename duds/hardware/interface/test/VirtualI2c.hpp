@@ -0,0 +1,81 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef VIRTUALI2C_HPP
+#define VIRTUALI2C_HPP
+
+#include <duds/hardware/interface/I2c.hpp>
+#include <memory>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+class VirtualDevice;
+
+/**
+ * An I2c implementation that communicates with a simulated VirtualDevice
+ * in the same process. It allows drivers to be tested and timed without
+ * hardware.
+ *
+ * Each conversation part is a message that begins with a start or repeated
+ * start. The @ref ConversationPart::MpfBreak "MpfBreak" flag ends the
+ * transaction with a stop condition before the flagged part. The
+ * @ref ConversationPart::MpfVarlen "MpfVarlen" flag is not honored; input
+ * parts are always filled.
+ *
+ * @author  Jeff Jackowski
+ */
+class VirtualI2c : public I2c {
+	/**
+	 * The simulated device.
+	 */
+	std::shared_ptr<VirtualDevice> dev;
+	/**
+	 * The device address; only used for error reporting.
+	 */
+	int addr;
+	/**
+	 * Conducts the conversation in the given parts.
+	 */
+	template <class Iter>
+	void converseParts(Iter iter, Iter end);
+public:
+	/**
+	 * Makes an I2C interface to a simulated device.
+	 * @param device   The device. It may be shared with other buses, but
+	 *                 not used by more than one thread at a time.
+	 * @param devaddr  The address reported by address() and in errors.
+	 */
+	VirtualI2c(const std::shared_ptr<VirtualDevice> &device, int devaddr) :
+	dev(device), addr(devaddr) { }
+	/**
+	 * Returns the simulated device.
+	 */
+	const std::shared_ptr<VirtualDevice> &device() const {
+		return dev;
+	}
+	/**
+	 * Conducts a conversation with the simulated device.
+	 * @param conv  The conversation to have with the device.
+	 * @throw I2cErrorNoDevice  The device failed to respond because of an
+	 *                          injected error.
+	 */
+	virtual void converse(Conversation &conv);
+	/**
+	 * Conducts a conversation with the simulated device.
+	 * @param conv  The conversation to have with the device.
+	 * @throw I2cErrorNoDevice  The device failed to respond because of an
+	 *                          injected error.
+	 */
+	virtual void converse(const ConversationArena &conv);
+	virtual int address() const;
+};
+
+} } } } // namespaces
+
+#endif        //  #ifndef VIRTUALI2C_HPP
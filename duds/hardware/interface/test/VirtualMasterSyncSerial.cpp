@@ -0,0 +1,60 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/test/VirtualMasterSyncSerial.hpp>
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+#include <duds/hardware/interface/MasterSyncSerialErrors.hpp>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+VirtualMasterSyncSerial::VirtualMasterSyncSerial(
+	const std::shared_ptr<VirtualDevice> &device,
+	Flags flags
+) : MasterSyncSerial(flags, 0), dev(device) {
+	this->flags |= MssReady;
+}
+
+VirtualMasterSyncSerial::~VirtualMasterSyncSerial() {
+	forceClose();
+}
+
+void VirtualMasterSyncSerial::open() { }
+
+void VirtualMasterSyncSerial::close() { }
+
+void VirtualMasterSyncSerial::start() {
+	if (!dev->start()) {
+		DUDS_THROW_EXCEPTION(SyncSerialIoError());
+	}
+}
+
+void VirtualMasterSyncSerial::stop() {
+	dev->stop();
+}
+
+void VirtualMasterSyncSerial::transfer(
+	const std::uint8_t * __restrict__ out,
+	std::uint8_t * __restrict__ in,
+	duds::general::Bits bits
+) {
+	if (bits.blocks() & 7) {
+		DUDS_THROW_EXCEPTION(SyncSerialUnsupported());
+	}
+	std::size_t len = bits.blocks() >> 3;
+	for (std::size_t b = 0; b < len; ++b) {
+		if (out) {
+			dev->write(out[b]);
+		}
+		if (in) {
+			in[b] = dev->read();
+		}
+	}
+}
+
+} } } } // namespaces
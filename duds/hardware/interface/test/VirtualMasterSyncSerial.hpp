@@ -0,0 +1,98 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef VIRTUALMASTERSYNCSERIAL_HPP
+#define VIRTUALMASTERSYNCSERIAL_HPP
+
+#include <duds/hardware/interface/MasterSyncSerial.hpp>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+class VirtualDevice;
+
+/**
+ * A MasterSyncSerial implementation that communicates with a simulated
+ * VirtualDevice in the same process. It allows drivers to be tested and timed
+ * without hardware.
+ *
+ * Selecting the device starts a transaction and deselecting it stops the
+ * transaction. When data is both sent and received in the same transfer,
+ * each output byte is written to the device before the corresponding input
+ * byte is read; the simulated device does not shift data in and out at the
+ * same time. Transfers must be a whole number of bytes.
+ *
+ * @author  Jeff Jackowski
+ */
+class VirtualMasterSyncSerial : public MasterSyncSerial {
+	/**
+	 * The simulated device.
+	 */
+	std::shared_ptr<VirtualDevice> dev;
+protected:
+	/**
+	 * Does nothing.
+	 */
+	virtual void open();
+	/**
+	 * Does nothing.
+	 */
+	virtual void close();
+	/**
+	 * Starts a transaction with the device.
+	 * @throw SyncSerialIoError  The device failed to respond because of an
+	 *                           injected error.
+	 */
+	virtual void start();
+	/**
+	 * Ends the transaction with the device.
+	 */
+	virtual void stop();
+	/**
+	 * Sends and/or receives bytes.
+	 * @throw SyncSerialUnsupported  @a bits is not a multiple of 8.
+	 */
+	virtual void transfer(
+		const std::uint8_t * __restrict__ out,
+		std::uint8_t * __restrict__ in,
+		duds::general::Bits bits
+	);
+public:
+	/**
+	 * Makes a synchronous serial interface to a simulated device.
+	 * @param device  The device. It may be shared with other buses, but not
+	 *                used by more than one thread at a time.
+	 * @param flags   The configuration flags. They do not alter the
+	 *                simulation.
+	 */
+	VirtualMasterSyncSerial(
+		const std::shared_ptr<VirtualDevice> &device,
+		Flags flags = MssSpiMode0 | MssUseSelect
+	);
+	/**
+	 * Makes a VirtualMasterSyncSerial object managed by a std::shared_ptr;
+	 * required to use access().
+	 */
+	static std::shared_ptr<VirtualMasterSyncSerial> make(
+		const std::shared_ptr<VirtualDevice> &device,
+		Flags flags = MssSpiMode0 | MssUseSelect
+	) {
+		return std::make_shared<VirtualMasterSyncSerial>(device, flags);
+	}
+	virtual ~VirtualMasterSyncSerial();
+	/**
+	 * Returns the simulated device.
+	 */
+	const std::shared_ptr<VirtualDevice> &device() const {
+		return dev;
+	}
+};
+
+} } } } // namespaces
+
+#endif        //  #ifndef VIRTUALMASTERSYNCSERIAL_HPP
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/hardware/interface/test/VirtualSmbus.hpp>
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+#include <duds/hardware/interface/SmbusErrors.hpp>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+void VirtualSmbus::start() {
+	if (!dev->start()) {
+		DUDS_THROW_EXCEPTION(SmbusErrorNoDevice() << SmbusDeviceAddr(addr));
+	}
+}
+
+void VirtualSmbus::command(std::uint8_t cmd) {
+	start();
+	dev->write(cmd);
+}
+
+int VirtualSmbus::readBlock(std::uint8_t *in, int maxlen) {
+	start();
+	int len = dev->read();
+	if ((len > 32) || (len > maxlen)) {
+		dev->stop();
+		DUDS_THROW_EXCEPTION(SmbusErrorMessageLength() << SmbusDeviceAddr(addr));
+	}
+	for (int b = 0; b < len; ++b) {
+		in[b] = dev->read();
+	}
+	dev->stop();
+	return len;
+}
+
+std::uint8_t VirtualSmbus::receiveByte() {
+	start();
+	std::uint8_t res = dev->read();
+	dev->stop();
+	return res;
+}
+
+std::uint8_t VirtualSmbus::receiveByte(std::uint8_t cmd) {
+	command(cmd);
+	start();
+	std::uint8_t res = dev->read();
+	dev->stop();
+	return res;
+}
+
+std::uint16_t VirtualSmbus::receiveWord(std::uint8_t cmd) {
+	command(cmd);
+	start();
+	std::uint16_t res = dev->read();
+	res |= (std::uint16_t)dev->read() << 8;
+	dev->stop();
+	return res;
+}
+
+int VirtualSmbus::receive(std::uint8_t cmd, std::uint8_t *in, const int maxlen) {
+	command(cmd);
+	return readBlock(in, maxlen);
+}
+
+void VirtualSmbus::receive(std::uint8_t cmd, std::vector<std::uint8_t> &in) {
+	std::uint8_t buf[32];
+	command(cmd);
+	in.assign(buf, buf + readBlock(buf, 32));
+}
+
+void VirtualSmbus::transmitBool(bool) {
+	// the bit is the read/write flag sent with the address; the simulated
+	// device only sees the transaction
+	start();
+	dev->stop();
+}
+
+void VirtualSmbus::transmitByte(std::uint8_t byte) {
+	start();
+	dev->write(byte);
+	dev->stop();
+}
+
+void VirtualSmbus::transmitByte(std::uint8_t cmd, std::uint8_t byte) {
+	command(cmd);
+	dev->write(byte);
+	dev->stop();
+}
+
+void VirtualSmbus::transmitWord(std::uint8_t cmd, std::uint16_t word) {
+	command(cmd);
+	dev->write((std::uint8_t)word);
+	dev->write((std::uint8_t)(word >> 8));
+	dev->stop();
+}
+
+void VirtualSmbus::transmit(
+	std::uint8_t cmd,
+	const std::uint8_t *out,
+	const int len
+) {
+	if ((len <= 0) || (len > 32)) {
+		DUDS_THROW_EXCEPTION(SmbusErrorMessageLength() << SmbusDeviceAddr(addr));
+	}
+	command(cmd);
+	dev->write((std::uint8_t)len);
+	for (int b = 0; b < len; ++b) {
+		dev->write(out[b]);
+	}
+	dev->stop();
+}
+
+std::uint16_t VirtualSmbus::call(std::uint8_t cmd, std::uint16_t word) {
+	command(cmd);
+	dev->write((std::uint8_t)word);
+	dev->write((std::uint8_t)(word >> 8));
+	start();
+	std::uint16_t res = dev->read();
+	res |= (std::uint16_t)dev->read() << 8;
+	dev->stop();
+	return res;
+}
+
+void VirtualSmbus::call(
+	std::uint8_t cmd,
+	const std::vector<std::uint8_t> &out,
+	std::vector<std::uint8_t> &in
+) {
+	if (out.size() > 32) {
+		DUDS_THROW_EXCEPTION(SmbusErrorMessageLength() << SmbusDeviceAddr(addr));
+	}
+	command(cmd);
+	dev->write((std::uint8_t)out.size());
+	for (std::uint8_t b : out) {
+		dev->write(b);
+	}
+	std::uint8_t buf[32];
+	in.assign(buf, buf + readBlock(buf, 32));
+}
+
+int VirtualSmbus::address() const {
+	return addr;
+}
+
+} } } } // namespaces
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef VIRTUALSMBUS_HPP
+#define VIRTUALSMBUS_HPP
+
+#include <duds/hardware/interface/Smbus.hpp>
+#include <memory>
+
+namespace duds { namespace hardware { namespace interface { namespace test {
+
+class VirtualDevice;
+
+/**
+ * An Smbus implementation that communicates with a simulated VirtualDevice
+ * in the same process. It allows drivers to be tested and timed without
+ * hardware.
+ *
+ * Each operation is a single transaction with the same sequence of bytes
+ * sent over a real bus: the command byte, a repeated start before reading,
+ * the data in little-endian order, and the byte count for block operations.
+ * Packet Error Checking is not simulated.
+ *
+ * @author  Jeff Jackowski
+ */
+class VirtualSmbus : public Smbus {
+	/**
+	 * The simulated device.
+	 */
+	std::shared_ptr<VirtualDevice> dev;
+	/**
+	 * The device address; only used for error reporting.
+	 */
+	int addr;
+	/**
+	 * Starts, or restarts, a transaction.
+	 * @throw SmbusErrorNoDevice  The device failed to respond because of an
+	 *                            injected error.
+	 */
+	void start();
+	/**
+	 * Starts a transaction and writes the command byte.
+	 */
+	void command(std::uint8_t cmd);
+	/**
+	 * Reads a block into @a in after the command has been sent, and ends the
+	 * transaction.
+	 * @return  The number of bytes sent by the device.
+	 */
+	int readBlock(std::uint8_t *in, int maxlen);
+public:
+	/**
+	 * Makes an SMBus interface to a simulated device.
+	 * @param device   The device. It may be shared with other buses, but
+	 *                 not used by more than one thread at a time.
+	 * @param devaddr  The address reported by address() and in errors.
+	 */
+	VirtualSmbus(const std::shared_ptr<VirtualDevice> &device, int devaddr) :
+	dev(device), addr(devaddr) { }
+	/**
+	 * Returns the simulated device.
+	 */
+	const std::shared_ptr<VirtualDevice> &device() const {
+		return dev;
+	}
+	virtual std::uint8_t receiveByte();
+	virtual std::uint8_t receiveByte(std::uint8_t cmd);
+	virtual std::uint16_t receiveWord(std::uint8_t cmd);
+	virtual int receive(std::uint8_t cmd, std::uint8_t *in, const int maxlen);
+	virtual void receive(std::uint8_t cmd, std::vector<std::uint8_t> &in);
+	virtual void transmitBool(bool out);
+	virtual void transmitByte(std::uint8_t byte);
+	virtual void transmitByte(std::uint8_t cmd, std::uint8_t byte);
+	virtual void transmitWord(std::uint8_t cmd, std::uint16_t word);
+	virtual void transmit(
+		std::uint8_t cmd,
+		const std::uint8_t *out,
+		const int len
+	);
+	virtual std::uint16_t call(std::uint8_t cmd, std::uint16_t word);
+	virtual void call(
+		std::uint8_t cmd,
+		const std::vector<std::uint8_t> &out,
+		std::vector<std::uint8_t> &in
+	);
+	virtual int address() const;
+};
+
+} } } } // namespaces
+
+#endif        //  #ifndef VIRTUALSMBUS_HPP
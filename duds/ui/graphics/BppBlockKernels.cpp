@@ -0,0 +1,269 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/ui/graphics/BppBlockKernels.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DUDS_BPP_X86_KERNELS
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DUDS_BPP_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+namespace duds { namespace ui { namespace graphics {
+
+typedef BppBlockKernels::PixelBlock PixelBlock;
+
+// ---- scalar reference implementation ----
+
+static void scalarInvert(PixelBlock *blocks, std::size_t count) {
+	for (PixelBlock *end = blocks + count; blocks < end; ++blocks) {
+		*blocks = ~*blocks;
+	}
+}
+
+static void scalarFill(PixelBlock *blocks, std::size_t count, PixelBlock val) {
+	for (PixelBlock *end = blocks + count; blocks < end; ++blocks) {
+		*blocks = val;
+	}
+}
+
+static bool scalarEqual(
+	const PixelBlock *a,
+	const PixelBlock *b,
+	std::size_t count
+) {
+	for (const PixelBlock *end = a + count; a < end; ++a, ++b) {
+		if (*a != *b) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static const BppBlockKernels ScalarKernels = {
+	"scalar",
+	scalarInvert,
+	scalarFill,
+	scalarEqual
+};
+
+#ifdef DUDS_BPP_X86_KERNELS
+
+// ---- SSE2 implementation ----
+
+/**
+ * The number of PixelBlocks in a 128-bit vector.
+ */
+static constexpr std::size_t Blocks128 = 16 / sizeof(PixelBlock);
+
+__attribute__((target("sse2")))
+static __m128i sse2Splat(PixelBlock val) {
+	if constexpr (sizeof(PixelBlock) == 8) {
+		return _mm_set1_epi64x((long long)val);
+	} else {
+		return _mm_set1_epi32((int)val);
+	}
+}
+
+__attribute__((target("sse2")))
+static void sse2Invert(PixelBlock *blocks, std::size_t count) {
+	const __m128i ones = _mm_set1_epi32(-1);
+	std::size_t i = 0;
+	for (; i + Blocks128 <= count; i += Blocks128) {
+		__m128i *p = (__m128i*)(blocks + i);
+		_mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), ones));
+	}
+	scalarInvert(blocks + i, count - i);
+}
+
+__attribute__((target("sse2")))
+static void sse2Fill(PixelBlock *blocks, std::size_t count, PixelBlock val) {
+	const __m128i v = sse2Splat(val);
+	std::size_t i = 0;
+	for (; i + Blocks128 <= count; i += Blocks128) {
+		_mm_storeu_si128((__m128i*)(blocks + i), v);
+	}
+	scalarFill(blocks + i, count - i, val);
+}
+
+__attribute__((target("sse2")))
+static bool sse2Equal(
+	const PixelBlock *a,
+	const PixelBlock *b,
+	std::size_t count
+) {
+	std::size_t i = 0;
+	for (; i + Blocks128 <= count; i += Blocks128) {
+		__m128i eq = _mm_cmpeq_epi8(
+			_mm_loadu_si128((const __m128i*)(a + i)),
+			_mm_loadu_si128((const __m128i*)(b + i))
+		);
+		if (_mm_movemask_epi8(eq) != 0xFFFF) {
+			return false;
+		}
+	}
+	return scalarEqual(a + i, b + i, count - i);
+}
+
+static const BppBlockKernels Sse2Kernels = {
+	"sse2",
+	sse2Invert,
+	sse2Fill,
+	sse2Equal
+};
+
+// ---- AVX2 implementation ----
+
+/**
+ * The number of PixelBlocks in a 256-bit vector.
+ */
+static constexpr std::size_t Blocks256 = 32 / sizeof(PixelBlock);
+
+__attribute__((target("avx2")))
+static void avx2Invert(PixelBlock *blocks, std::size_t count) {
+	const __m256i ones = _mm256_set1_epi32(-1);
+	std::size_t i = 0;
+	for (; i + Blocks256 <= count; i += Blocks256) {
+		__m256i *p = (__m256i*)(blocks + i);
+		_mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), ones));
+	}
+	sse2Invert(blocks + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2Fill(PixelBlock *blocks, std::size_t count, PixelBlock val) {
+	__m256i v;
+	if constexpr (sizeof(PixelBlock) == 8) {
+		v = _mm256_set1_epi64x((long long)val);
+	} else {
+		v = _mm256_set1_epi32((int)val);
+	}
+	std::size_t i = 0;
+	for (; i + Blocks256 <= count; i += Blocks256) {
+		_mm256_storeu_si256((__m256i*)(blocks + i), v);
+	}
+	sse2Fill(blocks + i, count - i, val);
+}
+
+__attribute__((target("avx2")))
+static bool avx2Equal(
+	const PixelBlock *a,
+	const PixelBlock *b,
+	std::size_t count
+) {
+	std::size_t i = 0;
+	for (; i + Blocks256 <= count; i += Blocks256) {
+		__m256i eq = _mm256_cmpeq_epi8(
+			_mm256_loadu_si256((const __m256i*)(a + i)),
+			_mm256_loadu_si256((const __m256i*)(b + i))
+		);
+		if (_mm256_movemask_epi8(eq) != -1) {
+			return false;
+		}
+	}
+	return sse2Equal(a + i, b + i, count - i);
+}
+
+static const BppBlockKernels Avx2Kernels = {
+	"avx2",
+	avx2Invert,
+	avx2Fill,
+	avx2Equal
+};
+
+#endif  // DUDS_BPP_X86_KERNELS
+
+#ifdef DUDS_BPP_NEON_KERNELS
+
+// ---- NEON implementation ----
+
+/**
+ * The number of PixelBlocks in a 128-bit vector.
+ */
+static constexpr std::size_t BlocksNeon = 16 / sizeof(PixelBlock);
+
+static void neonInvert(PixelBlock *blocks, std::size_t count) {
+	std::size_t i = 0;
+	for (; i + BlocksNeon <= count; i += BlocksNeon) {
+		std::uint8_t *p = (std::uint8_t*)(blocks + i);
+		vst1q_u8(p, vmvnq_u8(vld1q_u8(p)));
+	}
+	scalarInvert(blocks + i, count - i);
+}
+
+static void neonFill(PixelBlock *blocks, std::size_t count, PixelBlock val) {
+	// works with either a 32 or 64-bit PixelBlock
+	PixelBlock pattern[BlocksNeon];
+	scalarFill(pattern, BlocksNeon, val);
+	const uint8x16_t v = vld1q_u8((const std::uint8_t*)pattern);
+	std::size_t i = 0;
+	for (; i + BlocksNeon <= count; i += BlocksNeon) {
+		vst1q_u8((std::uint8_t*)(blocks + i), v);
+	}
+	scalarFill(blocks + i, count - i, val);
+}
+
+static bool neonEqual(
+	const PixelBlock *a,
+	const PixelBlock *b,
+	std::size_t count
+) {
+	std::size_t i = 0;
+	for (; i + BlocksNeon <= count; i += BlocksNeon) {
+		uint64x2_t diff = vreinterpretq_u64_u8(veorq_u8(
+			vld1q_u8((const std::uint8_t*)(a + i)),
+			vld1q_u8((const std::uint8_t*)(b + i))
+		));
+		if (vgetq_lane_u64(diff, 0) | vgetq_lane_u64(diff, 1)) {
+			return false;
+		}
+	}
+	return scalarEqual(a + i, b + i, count - i);
+}
+
+static const BppBlockKernels NeonKernels = {
+	"neon",
+	neonInvert,
+	neonFill,
+	neonEqual
+};
+
+#endif  // DUDS_BPP_NEON_KERNELS
+
+const BppBlockKernels &BppBlockKernels::scalar() {
+	return ScalarKernels;
+}
+
+std::vector<const BppBlockKernels*> BppBlockKernels::available() {
+	std::vector<const BppBlockKernels*> avail = { &ScalarKernels };
+	#ifdef DUDS_BPP_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		avail.push_back(&Sse2Kernels);
+		if (__builtin_cpu_supports("avx2")) {
+			avail.push_back(&Avx2Kernels);
+		}
+	}
+	#endif
+	#ifdef DUDS_BPP_NEON_KERNELS
+	avail.push_back(&NeonKernels);
+	#endif
+	return avail;
+}
+
+const BppBlockKernels &BppBlockKernels::best() {
+	// the last available implementation is the preferred one
+	static const BppBlockKernels &selected = *available().back();
+	return selected;
+}
+
+} } }
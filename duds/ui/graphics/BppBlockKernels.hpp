@@ -0,0 +1,75 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef BPPBLOCKKERNELS_HPP
+#define BPPBLOCKKERNELS_HPP
+
+#include <duds/ui/graphics/BppImage.hpp>
+
+namespace duds { namespace ui { namespace graphics {
+
+/**
+ * A set of functions that operate on a contiguous run of
+ * @ref BppImage::PixelBlock "PixelBlocks" without regard to image lines.
+ * BppImage uses these for whole image and whole line operations like
+ * BppImage::invert(), BppImage::patternLines(), and BppImage::operator==().
+ *
+ * Several implementations may be compiled into the library: a portable
+ * scalar implementation that is always available, SSE2 and AVX2
+ * implementations on x86, and a NEON implementation on ARM processors that
+ * are built with NEON support. The x86 implementations are compiled with
+ * function specific target attributes so that the library does not require
+ * the instructions; best() checks the processor at run-time before selecting
+ * one.
+ *
+ * All functions use unaligned accesses, so the data only needs the alignment
+ * of a PixelBlock.
+ *
+ * @author  Jeff Jackowski
+ */
+struct BppBlockKernels {
+	typedef BppImage::PixelBlock PixelBlock;
+	/**
+	 * The name of the implementation, like "scalar" or "avx2".
+	 */
+	const char *name;
+	/**
+	 * Inverts every bit of @a count blocks starting at @a blocks.
+	 */
+	void (*invert)(PixelBlock *blocks, std::size_t count);
+	/**
+	 * Assigns @a val to @a count blocks starting at @a blocks.
+	 */
+	void (*fill)(PixelBlock *blocks, std::size_t count, PixelBlock val);
+	/**
+	 * Returns true if @a count blocks starting at @a a are identical to
+	 * @a count blocks starting at @a b.
+	 */
+	bool (*equal)(const PixelBlock *a, const PixelBlock *b, std::size_t count);
+	/**
+	 * Returns the portable scalar implementation. Other implementations must
+	 * produce the same results.
+	 */
+	static const BppBlockKernels &scalar();
+	/**
+	 * Returns the fastest implementation supported by the processor running
+	 * the program. The selection is made on the first call.
+	 */
+	static const BppBlockKernels &best();
+	/**
+	 * Returns all the implementations compiled into the library that are
+	 * supported by the processor running the program. The scalar
+	 * implementation is always first.
+	 */
+	static std::vector<const BppBlockKernels*> available();
+};
+
+} } }
+
+#endif        //  #ifndef BPPBLOCKKERNELS_HPP
@@ -7,7 +7,7 @@
  *
  * Copyright (C) 2019  Jeff Jackowski
  */
-#include <duds/ui/graphics/BppFont.hpp>
+#include <duds/ui/graphics/BppFontAtlas.hpp>
 #include <duds/ui/graphics/BppImageErrors.hpp>
 #include <duds/ui/graphics/BppImageArchiveSequence.hpp>
 #include <duds/general/Errors.hpp>
@@ -112,6 +112,16 @@ ConstBppImageSptr BppFont::tryGet(char32_t gc) {
 	return iter->second;
 }
 
+std::shared_ptr<const BppFontAtlas> BppFont::makeAtlas(
+	const std::u32string &chars
+) {
+	for (char32_t gc : chars) {
+		tryGet(gc);
+	}
+	std::lock_guard<duds::general::Spinlock> lock(block);
+	return std::make_shared<BppFontAtlas>(glyphs);
+}
+
 ImageDimensions BppFont::estimatedMaxCharacterSize() {
 	ImageDimensions res(0, 0);
 	for (char32_t check : { '8', 'M', 'q', 'y' }) {
@@ -131,189 +141,297 @@ ImageDimensions BppFont::estimatedMaxCharacterSize() {
 	return res;
 }
 
-/**
- * Used to hold all the glyphs needed to render a string.
- */
-typedef std::vector<const BppImage *>  ImageVec;
+const BppImage *BppFont::findGlyph(char32_t gc) {
+	std::unordered_map<char32_t, ConstBppImageSptr>::const_iterator
+		iter = glyphs.find(gc);
+	if (iter == glyphs.end()) {
+		// may throw
+		ConstBppImageSptr bis = renderGlyph(gc);
+		// keep the glyph in the map so the pointer remains valid
+		ConstBppImageSptr &glyph = glyphs[gc];
+		glyph = std::move(bis);
+		return glyph.get();
+	}
+	return iter->second.get();
+}
 
 /**
- * Information on a line.
+ * Information on a line of text.
  */
-struct LineDimensions {
+struct LineMetrics {
 	/**
 	 * Number of characters in the line.
 	 */
 	int chars;
 	/**
-	 * Minimum dimensions for the line.
+	 * The sum of the widths of all the glyphs in the line.
 	 */
-	ImageDimensions dim;
+	int width;
+	/**
+	 * The maximum width and height of the glyphs in the line.
+	 */
+	ImageDimensions max;
 	/**
 	 * Ensure all fields start with zeros.
 	 */
-	constexpr LineDimensions() : chars(0), dim(0, 0) { }
+	constexpr LineMetrics() : chars(0), width(0), max(0, 0) { }
+	/**
+	 * Returns the width of the line when rendered.
+	 * @param flags     The rendering option flags.
+	 * @param maxGlyph  The maximum glyph dimensions of all the text.
+	 */
+	int renderedWidth(BppFont::Flags flags, const ImageDimensions &maxGlyph)
+	const {
+		if (flags & BppFont::FixedWidthPerLine) {
+			return max.w * chars;
+		} else if (flags & BppFont::FixedWidth) {
+			return maxGlyph.w * chars;
+		}
+		return width;
+	}
+	/**
+	 * Returns the height of the line when rendered.
+	 * @param flags     The rendering option flags.
+	 * @param maxGlyph  The maximum glyph dimensions of all the text.
+	 */
+	int renderedHeight(BppFont::Flags flags, const ImageDimensions &maxGlyph)
+	const {
+		return (flags & BppFont::VariableHeight) ? max.h : maxGlyph.h;
+	}
+	/**
+	 * Returns the horizontal distance to advance after a glyph.
+	 * @param flags     The rendering option flags.
+	 * @param maxGlyph  The maximum glyph dimensions of all the text.
+	 * @param gw        The width of the glyph.
+	 */
+	int advance(BppFont::Flags flags, const ImageDimensions &maxGlyph, int gw)
+	const {
+		// FixedWidthPerLine takes precedence over FixedWidth
+		if (flags & BppFont::FixedWidthPerLine) {
+			return max.w;
+		} else if (flags & BppFont::FixedWidth) {
+			return maxGlyph.w;
+		}
+		return gw;
+	}
 };
 
 /**
- * Information on each line of text to render.
+ * Measures a line of text.
+ * @param begin   The first character of the line.
+ * @param end     The end of the text.
+ * @param lookup  A function that returns a pointer to the glyph image for a
+ *                character.
+ * @param lm      The metrics of the line.
+ * @return        The position of the newline that ends the line, or @a end.
  */
-typedef std::vector<LineDimensions>  DimVec;
-
-/**
- * String converter; UTF-8 to/from UTF-32.
- */
-static std::wstring_convert< std::codecvt_utf8< char32_t >, char32_t > conv;
-
-BppImageSptr BppFont::render(const std::string &text, Flags flags) {
-	// convert UTF-8 to UTF-32, then render
-	std::u32string text32 = conv.from_bytes(text);
-	return render(text32, flags);
+template <class Lookup>
+static std::u32string::const_iterator measureLine(
+	std::u32string::const_iterator begin,
+	std::u32string::const_iterator end,
+	Lookup lookup,
+	LineMetrics &lm
+) {
+	lm = LineMetrics();
+	for (; (begin != end) && (*begin != '\n'); ++begin) {
+		const ImageDimensions &gd = lookup(*begin)->dimensions();
+		lm.width += gd.w;
+		lm.max = lm.max.maxExtent(gd);
+		++lm.chars;
+	}
+	return begin;
 }
 
-BppImageSptr BppFont::render(const std::u32string &text, Flags flags)
-try {
-	// Will store all glyphs needed for output in the same order as text. All
-	// lines are included. Line breaks are not.
-	ImageVec gv;
-	gv.reserve(text.size());
-	// stores dimensions for each line
-	DimVec lineDims(1);
-	// output image dimesions
-	ImageDimensions id(0, 0);
-	// maximum glyph dimesions
-	ImageDimensions md(0, 0);
-	// greatest number of characters on a line
-	int maxline = 0;
-	// find all the needed glyphs
+ImageDimensions BppFont::measure(
+	const std::u32string &text,
+	Flags flags,
+	ImageDimensions &maxGlyph
+) {
+	auto lookup = [this](char32_t gc) { return findGlyph(gc); };
+	maxGlyph = ImageDimensions(0, 0);
+	int maxChars = 0, maxWidth = 0, height = 0, lines = 0;
 	std::u32string::const_iterator titer = text.cbegin();
-	std::unordered_map<char32_t, ConstBppImageSptr>::const_iterator giter;
-	for (; titer != text.cend(); ++titer) {
-		// handle line breaks
-		if (*titer == '\n') {
-			// update maximum characters per line
-			maxline = std::max(maxline, lineDims.back().chars);
-			// update image size
-			if (flags & FixedWidthPerLine) {
-				// work out fixed width size for the line now
-				lineDims.back().dim.w = md.w * lineDims.back().chars;
-				// clear the maximum glyph width for the next line
-				md.w = 0;
-			} else if (!(flags & FixedWidth)) {
-				// image width updated now for variable width; later for fixed
-				id.w = std::max(id.w, lineDims.back().dim.w);
-			}
-			if (flags & VariableHeight) {
-				// image height updated now for variable height; later for fixed
-				id.h += lineDims.back().dim.h;
-			}
-			// create a new line entry
-			lineDims.emplace_back(LineDimensions());
-			// process the next character
-			continue;
-		}
-		{ // get the next glyph
-			std::lock_guard<duds::general::Spinlock> lock(block);
-			giter = glyphs.find(*titer);
-			// no glyph?
-			if (giter == glyphs.end()) {
-				// try to get it again; may throw
-				ConstBppImageSptr glyph = renderGlyph(*titer);
-				gv.emplace_back(glyph.get());
-			} else {
-				// have glyph
-				gv.push_back(giter->second.get());
-			}
+	LineMetrics lm;
+	do {
+		if (lines > 0) {
+			// skip the newline
+			++titer;
 		}
-		// record dimension stats
-		const ImageDimensions &gd = gv.back()->dimensions();
-		lineDims.back().dim.w += gd.w;
-		md.w = std::max(md.w, gd.w);
-		lineDims.back().dim.h = std::max(lineDims.back().dim.h, gd.h);
-		md.h = std::max(md.h, gd.h);
-		++lineDims.back().chars;
+		titer = measureLine(titer, text.cend(), lookup, lm);
+		++lines;
+		maxGlyph = maxGlyph.maxExtent(lm.max);
+		maxChars = std::max(maxChars, lm.chars);
+		// the maximum glyph size is not yet known, so this is only right for
+		// variable width and fixed width per line
+		maxWidth = std::max(maxWidth, lm.renderedWidth(flags, lm.max));
+		height += lm.max.h;
+	} while (titer != text.cend());
+	ImageDimensions id(maxWidth, height);
+	if (!(flags & FixedWidthPerLine) && (flags & FixedWidth)) {
+		id.w = maxChars * maxGlyph.w;
 	}
-	// update maximum characters per line
-	maxline = std::max(maxline, lineDims.back().chars);
-	// update image size
-	if (flags & FixedWidthPerLine) {
-		// enusre the FixedWidth flag is not also set
-		flags |= ~FixedWidth;
-		// work out fixed width size for the line
-		lineDims.back().dim.w = md.w * lineDims.back().chars;
-	} else if (!(flags & FixedWidth)) {
-		// update image width to fit line
-		id.w = std::max(id.w, lineDims.back().dim.w);
-	} else {
-		// fixed width for all characters
-		id.w = maxline * md.w;
-		// width is not set per line in lineDims
+	if (!(flags & VariableHeight)) {
+		id.h = maxGlyph.h * lines;
 	}
-	if (flags & VariableHeight) {
-		// update image height for variable height
-		id.h += lineDims.back().dim.h;
-	} else {
-		// height is the same for all lines
-		id.h = md.h * lineDims.size();
-		// height is not set per line in lineDims
-	}
-
-	// gv now has all the needed glyphs in the order they must be rendered,
-	// id has the final image dimensions, and lineDims has details on each
-	// line.
+	return id;
+}
 
-	// make the destination image
-	BppImageSptr bis = BppImage::make(id);
-	// glyphs might not fill the whole image, so clear the image
-	bis->clearImage();
-	// iterate over the lines and the glyphs
-	DimVec::iterator diter = lineDims.begin();
-	ImageVec::iterator viter = gv.begin();
-	ImageLocation il(0, 0);
-	int tpos = 0;
-	for (; diter != lineDims.end(); ++diter) {
-		// update width & height if fixed across all lines
-		if (flags & FixedWidth) {
-			diter->dim.w = md.w * diter->chars;
-		}
-		if (!(flags & VariableHeight)) {
-			diter->dim.h = md.h;
+void BppFont::draw(
+	BppImage &dest,
+	const ImageLocation &loc,
+	const std::u32string &text,
+	Flags flags,
+	BppImage::Operation op,
+	const ImageDimensions &dim,
+	const ImageDimensions &maxGlyph,
+	bool fill
+) {
+	// pixels outside of glyphs are as if from a cleared image
+	bool state = op == BppImage::OpNot;
+	if (fill) {
+		fill = (op == BppImage::OpSet) || (op == BppImage::OpNot) ||
+			(op == BppImage::OpAnd);
+	}
+	auto lookup = [this](char32_t gc) { return findGlyph(gc); };
+	bool fixed = flags & (FixedWidth | FixedWidthPerLine);
+	int y = loc.y;
+	std::u32string::const_iterator titer = text.cbegin();
+	std::u32string::const_iterator lend;
+	LineMetrics lm;
+	bool first = true;
+	do {
+		if (!first) {
+			// skip the newline
+			++titer;
 		}
+		first = false;
+		lend = measureLine(titer, text.cend(), lookup, lm);
+		int lh = lm.renderedHeight(flags, maxGlyph);
+		int lw = lm.renderedWidth(flags, maxGlyph);
 		// set the left location for the first glyph of this line
+		int x = loc.x;
 		if (flags & AlignCenter) {
-			il.x = (id.w - diter->dim.w) / 2;
+			x += (dim.w - lw) / 2;
 		} else if (flags & AlignRight) {
-			il.x = id.w - diter->dim.w;
-		} else {
-			il.x = 0;
+			x += dim.w - lw;
+		}
+		if (fill) {
+			// space to the left and right of the line
+			dest.drawBoxClipped(ImageLocation(loc.x, y),
+				ImageDimensions(x - loc.x, lh), state);
+			dest.drawBoxClipped(ImageLocation(x + lw, y),
+				ImageDimensions(loc.x + dim.w - x - lw, lh), state);
 		}
 		// render each glyph
-		for (int loop = diter->chars; loop > 0; ++viter, --loop) {
-			const ImageDimensions &gd = (*viter)->dimensions();
-			int adv = gd.w;
-			// glyph may be short
-			ImageLocation loc(il.x, il.y + diter->dim.h - gd.h);
+		for (; titer != lend; ++titer) {
+			const BppImage *glyph = lookup(*titer);
+			const ImageDimensions &gd = glyph->dimensions();
+			int adv = lm.advance(flags, maxGlyph, gd.w);
 			// glyph may be narrow
-			if (flags & FixedWidth) {
-				loc.x += (md.w - gd.w) / 2;
-				adv = md.w;
-			} else if (flags & FixedWidthPerLine) {
-				adv = diter->dim.w / diter->chars;
-				loc.x += (adv - gd.w) / 2;
+			int off = fixed ? (adv - gd.w) / 2 : 0;
+			// glyph may be short
+			int gy = y + lh - gd.h;
+			if (fill) {
+				// above the glyph
+				dest.drawBoxClipped(ImageLocation(x, y),
+					ImageDimensions(adv, lh - gd.h), state);
+				// left and right of the glyph
+				dest.drawBoxClipped(ImageLocation(x, gy),
+					ImageDimensions(off, gd.h), state);
+				dest.drawBoxClipped(ImageLocation(x + off + gd.w, gy),
+					ImageDimensions(adv - off - gd.w, gd.h), state);
+			}
+			if (!gd.empty()) {
+				dest.writeClipped(glyph, ImageLocation(x + off, gy),
+					ImageLocation(0, 0), gd, op);
 			}
-			bis->write(*viter, loc, gd);
-			// advance  position to the left
-			il.x += adv;
+			// advance position to the right
+			x += adv;
 		}
 		// set the upper location for the first glyph of the next line
-		il.y += diter->dim.h;
-	}
+		y += lh;
+	} while (titer != text.cend());
+}
 
+/**
+ * String converter; UTF-8 to/from UTF-32.
+ */
+static std::wstring_convert< std::codecvt_utf8< char32_t >, char32_t > conv;
+
+BppImageSptr BppFont::render(const std::string &text, Flags flags) {
+	// convert UTF-8 to UTF-32, then render
+	std::u32string text32 = conv.from_bytes(text);
+	return render(text32, flags);
+}
+
+BppImageSptr BppFont::render(const std::u32string &text, Flags flags)
+try {
+	std::lock_guard<duds::general::Spinlock> lock(block);
+	ImageDimensions md;
+	ImageDimensions id = measure(text, flags, md);
+	// make the destination image
+	BppImageSptr bis = BppImage::make(id);
+	if (!id.empty()) {
+		// glyphs might not fill the whole image, so clear the image
+		bis->clearImage();
+		draw(*bis, ImageLocation(0, 0), text, flags, BppImage::OpSet, id, md,
+			false);
+	}
 	return bis;
 } catch (boost::exception &be) {
 	be << String(conv.to_bytes(text));
 	throw;
 }
 
+ImageDimensions BppFont::render(
+	BppImage &dest,
+	const ImageLocation &loc,
+	const std::string &text,
+	Flags flags,
+	BppImage::Operation op
+) {
+	// convert UTF-8 to UTF-32, then render
+	std::u32string text32 = conv.from_bytes(text);
+	return render(dest, loc, text32, flags, op);
+}
+
+ImageDimensions BppFont::render(
+	BppImage &dest,
+	const ImageLocation &loc,
+	const std::u32string &text,
+	Flags flags,
+	BppImage::Operation op
+) try {
+	std::lock_guard<duds::general::Spinlock> lock(block);
+	ImageDimensions md;
+	ImageDimensions id = measure(text, flags, md);
+	if (!id.empty()) {
+		draw(dest, loc, text, flags, op, id, md, true);
+	}
+	return id;
+} catch (boost::exception &be) {
+	be << String(conv.to_bytes(text));
+	throw;
+}
+
+ImageDimensions BppFont::textDimensions(const std::string &text, Flags flags) {
+	// convert UTF-8 to UTF-32, then figure dimensions
+	std::u32string text32 = conv.from_bytes(text);
+	return textDimensions(text32, flags);
+}
+
+ImageDimensions BppFont::textDimensions(
+	const std::u32string &text,
+	Flags flags
+) try {
+	std::lock_guard<duds::general::Spinlock> lock(block);
+	ImageDimensions md;
+	return measure(text, flags, md);
+} catch (boost::exception &be) {
+	be << String(conv.to_bytes(text));
+	throw;
+}
+
 ImageDimensions BppFont::lineDimensions(const std::string &text, Flags flags) {
 	// convert UTF-8 to UTF-32, then figure dimensions
 	std::u32string text32 = conv.from_bytes(text);
@@ -16,6 +16,8 @@
 
 namespace duds { namespace ui { namespace graphics {
 
+class BppFontAtlas;
+
 /**
  * Renders strings using a font made of BppImage objects for glyphs.
  * The glyph images may come from a BppImage archive file or stream, may
@@ -149,6 +151,18 @@ public:
 	 *               empty shared pointer if the font lacks the glyph.
 	 */
 	ConstBppImageSptr tryGet(char32_t gc);
+	/**
+	 * Makes an atlas with a copy of all the glyphs in this font. The atlas
+	 * renders text without locking or allocating memory, but it will not
+	 * change when glyphs are later added to this font.
+	 * @param chars  Characters to request from the font with tryGet() before
+	 *               making the atlas. This allows derived classes that render
+	 *               glyphs on demand to include them in the atlas. Characters
+	 *               the font cannot provide are skipped.
+	 */
+	std::shared_ptr<const BppFontAtlas> makeAtlas(
+		const std::u32string &chars = std::u32string()
+	);
 	/**
 	 * Returns a somewhat decent estimate of the largest size of a character
 	 * without actually inspecting all characters. If the result is zero, the
@@ -230,6 +244,76 @@ public:
 	 *                                   by the font.
 	 */
 	BppImageSptr render(const std::u32string &text, Flags flags = AlignLeft);
+	/**
+	 * Renders the given text directly into an existing image. The result is
+	 * the same as writing the image made by
+	 * render(const std::u32string &, Flags) into @a dest at @a loc with
+	 * @a op, including changes to the pixels between glyphs, but without
+	 * making that image. The text is clipped to @a dest.
+	 * @param dest   The image that will receive the text.
+	 * @param loc    The upper-left location of the text in @a dest. It may be
+	 *               outside of the image, including at negative coordinates.
+	 * @param text   The text to render in a UTF-32 string. It may contain
+	 *               newlines.
+	 * @param flags  The option flags, as used by
+	 *               render(const std::u32string &, Flags).
+	 * @param op     The operation used to combine the text with @a dest.
+	 * @return       The dimensions of the rendered text, which may be larger
+	 *               than the part that was written to @a dest.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not provided
+	 *                                   by the font. Nothing will have been
+	 *                                   written to @a dest.
+	 */
+	ImageDimensions render(
+		BppImage &dest,
+		const ImageLocation &loc,
+		const std::u32string &text,
+		Flags flags = AlignLeft,
+		BppImage::Operation op = BppImage::OpSet
+	);
+	/**
+	 * @copybrief render(BppImage &, const ImageLocation &, const std::u32string &, Flags, BppImage::Operation)
+	 * @param dest   The image that will receive the text.
+	 * @param loc    The upper-left location of the text in @a dest.
+	 * @param text   The text to render in a UTF-8 string.
+	 * @param flags  The option flags.
+	 * @param op     The operation used to combine the text with @a dest.
+	 * @return       The dimensions of the rendered text.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not provided
+	 *                                   by the font.
+	 */
+	ImageDimensions render(
+		BppImage &dest,
+		const ImageLocation &loc,
+		const std::string &text,
+		Flags flags = AlignLeft,
+		BppImage::Operation op = BppImage::OpSet
+	);
+	/**
+	 * Returns the dimensions of the image that render() would produce for
+	 * the given text. Unlike lineDimensions(), multiple lines and all the
+	 * rendering flags are supported.
+	 * @param text   The text to consider in a UTF-32 string.
+	 * @param flags  The option flags.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not provided
+	 *                                   by the font.
+	 */
+	ImageDimensions textDimensions(
+		const std::u32string &text,
+		Flags flags = AlignLeft
+	);
+	/**
+	 * Returns the dimensions of the image that render() would produce for
+	 * the given text.
+	 * @param text   The text to consider in a UTF-8 string.
+	 * @param flags  The option flags.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not provided
+	 *                                   by the font.
+	 */
+	ImageDimensions textDimensions(
+		const std::string &text,
+		Flags flags = AlignLeft
+	);
 	/**
 	 * Returns the dimensions of a single-line string without the overhead of
 	 * rendering the string.
@@ -258,6 +342,56 @@ public:
 		const std::u32string &text,
 		Flags flags = Flags::Zero()
 	);
+private:
+	/**
+	 * Returns the glyph for the given character, calling renderGlyph() and
+	 * storing the result in @a glyphs if needed.
+	 * @pre    The thread has a lock on @a block.
+	 * @param gc  The character code of the glyph.
+	 * @return    The glyph image. It remains valid until the lock on @a block
+	 *            is released.
+	 * @throw     GlyphNotFoundError  The glyph is not provided by the font.
+	 */
+	const BppImage *findGlyph(char32_t gc);
+	/**
+	 * Computes the dimensions of rendered text.
+	 * @pre    The thread has a lock on @a block.
+	 * @param text   The text to measure.
+	 * @param flags  The rendering option flags.
+	 * @param maxGlyph  Will be assigned the maximum width and height of the
+	 *                  glyphs in @a text.
+	 * @throw  GlyphNotFoundError  A glyph in @a text is not provided by the
+	 *                             font.
+	 */
+	ImageDimensions measure(
+		const std::u32string &text,
+		Flags flags,
+		ImageDimensions &maxGlyph
+	);
+	/**
+	 * Draws text that has already been measured.
+	 * @pre    The thread has a lock on @a block.
+	 * @param dest      The destination image.
+	 * @param loc       The upper-left location of the text in @a dest.
+	 * @param text      The text to draw.
+	 * @param flags     The rendering option flags.
+	 * @param op        The operation used to modify @a dest.
+	 * @param dim       The dimensions of the text from measure().
+	 * @param maxGlyph  The maximum glyph dimensions from measure().
+	 * @param fill      True to change the pixels inside the text's
+	 *                  dimensions that are not covered by glyphs as if they
+	 *                  were written with @a op from a cleared image.
+	 */
+	void draw(
+		BppImage &dest,
+		const ImageLocation &loc,
+		const std::u32string &text,
+		Flags flags,
+		BppImage::Operation op,
+		const ImageDimensions &dim,
+		const ImageDimensions &maxGlyph,
+		bool fill
+	);
 };
 
 typedef std::shared_ptr<BppFont>  BppFontSptr;
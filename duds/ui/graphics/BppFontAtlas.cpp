@@ -0,0 +1,164 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <duds/ui/graphics/BppFontAtlas.hpp>
+#include <duds/ui/graphics/BppImageErrors.hpp>
+#include <duds/general/Errors.hpp>
+#include <algorithm>
+
+namespace duds { namespace ui { namespace graphics {
+
+/**
+ * The preferred width of the atlas image in pixels. The glyph cells are
+ * arranged in rows to keep the image height within the range of an
+ * ImageDimensions object.
+ */
+static constexpr int AtlasWidth = 256;
+
+BppFontAtlas::BppFontAtlas(
+	const std::unordered_map<char32_t, ConstBppImageSptr> &glyphs
+) : cell(0, 0), missing(nullptr) {
+	direct.fill(0);
+	// sort the characters so the layout does not depend on the hash map
+	std::vector<char32_t> chars;
+	chars.reserve(glyphs.size());
+	for (const auto &g : glyphs) {
+		if (g.second) {
+			chars.push_back(g.first);
+			cell = cell.maxExtent(g.second->dimensions());
+		}
+	}
+	std::sort(chars.begin(), chars.end());
+	if (chars.empty() || cell.empty()) {
+		return;
+	}
+	// arrange the cells in a grid
+	int cols = std::max(AtlasWidth / cell.w, 1);
+	int rows = ((int)chars.size() + cols - 1) / cols;
+	if ((chars.size() > 0xFFFF) || (rows * cell.h > 0x7FFF)) {
+		DUDS_THROW_EXCEPTION(ImageBoundsError() <<
+			ImageErrorDimensions(ImageDimensions(cols * cell.w, rows * cell.h))
+		);
+	}
+	atlas.resize(cols * cell.w, rows * cell.h);
+	atlas.clearImage();
+	slots.reserve(chars.size());
+	extended.reserve(chars.size());
+	int c = 0;
+	ImageLocation loc(0, 0);
+	for (char32_t gc : chars) {
+		const BppImage *img = glyphs.at(gc).get();
+		slots.push_back(Slot { loc, img->dimensions() });
+		if (!img->dimensions().empty()) {
+			atlas.write(img, loc, img->dimensions());
+		}
+		std::uint16_t idx = (std::uint16_t)slots.size();
+		if (gc < direct.size()) {
+			direct[gc] = idx;
+		} else {
+			extended.emplace_back(gc, idx - 1);
+		}
+		// advance to the next cell
+		if (++c == cols) {
+			c = 0;
+			loc.x = 0;
+			loc.y += cell.h;
+		} else {
+			loc.x += cell.w;
+		}
+	}
+	missing = findExtended(9633);
+}
+
+const BppFontAtlas::Slot *BppFontAtlas::findExtended(char32_t gc) const {
+	std::vector<std::pair<char32_t, std::uint16_t> >::const_iterator iter =
+		std::lower_bound(
+			extended.begin(),
+			extended.end(),
+			gc,
+			[](const std::pair<char32_t, std::uint16_t> &e, char32_t c) {
+				return e.first < c;
+			}
+		);
+	if ((iter != extended.end()) && (iter->first == gc)) {
+		return &(slots[iter->second]);
+	}
+	return missing;
+}
+
+ImageDimensions BppFontAtlas::textDimensions(
+	const std::u32string &text,
+	BppFont::Flags flags
+) const {
+	if (text.empty()) {
+		return ImageDimensions(0, 0);
+	}
+	int w = 0, maxw = 0, lines = 1;
+	for (char32_t gc : text) {
+		if (gc == '\n') {
+			maxw = std::max(maxw, w);
+			w = 0;
+			++lines;
+			continue;
+		}
+		const Slot *s = find(gc);
+		if (!s) {
+			DUDS_THROW_EXCEPTION(GlyphNotFoundError() << Character(gc));
+		}
+		w += (flags & BppFont::FixedWidth) ? cell.w : s->dim.w;
+	}
+	return ImageDimensions(std::max(maxw, w), lines * cell.h);
+}
+
+ImageDimensions BppFontAtlas::render(
+	BppImage &dest,
+	const ImageLocation &loc,
+	const std::u32string &text,
+	BppFont::Flags flags,
+	BppImage::Operation op
+) const {
+	if (text.empty()) {
+		return ImageDimensions(0, 0);
+	}
+	int x = loc.x, y = loc.y, maxw = 0;
+	bool fixed = flags & BppFont::FixedWidth;
+	for (char32_t gc : text) {
+		if (gc == '\n') {
+			maxw = std::max(maxw, x - loc.x);
+			x = loc.x;
+			y += cell.h;
+			continue;
+		}
+		const Slot *s = find(gc);
+		if (!s) {
+			DUDS_THROW_EXCEPTION(GlyphNotFoundError() << Character(gc));
+		}
+		// glyphs are aligned along the bottom of the line
+		int gy = y + cell.h - s->dim.h;
+		if (fixed) {
+			dest.writeClipped(
+				&atlas,
+				ImageLocation(x + (cell.w - s->dim.w) / 2, gy),
+				s->loc,
+				s->dim,
+				op
+			);
+			x += cell.w;
+		} else {
+			dest.writeClipped(&atlas, ImageLocation(x, gy), s->loc, s->dim, op);
+			x += s->dim.w;
+		}
+	}
+	return ImageDimensions(
+		std::max(maxw, x - loc.x),
+		y + cell.h - loc.y
+	);
+}
+
+} } }
@@ -0,0 +1,177 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef BPPFONTATLAS_HPP
+#define BPPFONTATLAS_HPP
+
+#include <duds/ui/graphics/BppFont.hpp>
+#include <array>
+
+namespace duds { namespace ui { namespace graphics {
+
+/**
+ * An immutable copy of a font's glyphs packed into a single image, along with
+ * a flat table to find each glyph. The glyphs are placed in a grid of cells
+ * sized to fit the largest glyph. Characters up to 255, the ASCII and
+ * Latin-1 range, are found with a direct index; other characters are found
+ * with a binary search of a sorted vector.
+ *
+ * Since the object cannot be modified after construction, it can be used
+ * from any number of threads without locking. Rendering text writes each
+ * glyph directly from the atlas image into a caller supplied image a
+ * PixelBlock at a time with BppImage::write(), and does not allocate memory.
+ *
+ * Glyphs are aligned to the bottom of each line, and the line height is
+ * always the height of the tallest glyph in the atlas. Unlike
+ * BppFont::render(), this does not depend on the text.
+ *
+ * Make an atlas with BppFont::makeAtlas().
+ *
+ * @author  Jeff Jackowski
+ */
+class BppFontAtlas : boost::noncopyable {
+public:
+	/**
+	 * The location of a glyph in the atlas image.
+	 */
+	struct Slot {
+		/**
+		 * The upper-left corner of the glyph in the atlas image.
+		 */
+		ImageLocation loc;
+		/**
+		 * The dimensions of the glyph.
+		 */
+		ImageDimensions dim;
+	};
+private:
+	/**
+	 * All the glyphs.
+	 */
+	BppImage atlas;
+	/**
+	 * The location of each glyph in @a atlas.
+	 */
+	std::vector<Slot> slots;
+	/**
+	 * Maps a character code below 256 to an index in @a slots plus one. Zero
+	 * is used for glyphs not in the atlas.
+	 */
+	std::array<std::uint16_t, 256> direct;
+	/**
+	 * Maps character codes of 256 and greater to an index in @a slots. Sorted
+	 * by character code.
+	 */
+	std::vector<std::pair<char32_t, std::uint16_t> > extended;
+	/**
+	 * The dimensions of each cell in @a atlas. This is the maximum width and
+	 * height of all glyphs.
+	 */
+	ImageDimensions cell;
+	/**
+	 * The slot of the glyph used when a character is not in the atlas, or
+	 * nullptr if there is no such glyph.
+	 */
+	const Slot *missing;
+public:
+	/**
+	 * Builds an atlas from the given glyphs.
+	 * @param glyphs  The glyph images keyed by character.
+	 * @throw ImageBoundsError  There are more than 65535 glyphs, or they
+	 *                          will not fit in a single image.
+	 */
+	BppFontAtlas(
+		const std::unordered_map<char32_t, ConstBppImageSptr> &glyphs
+	);
+	/**
+	 * Returns the slot for a character's glyph. If the atlas lacks the glyph,
+	 * the slot of the white square glyph (9633, 0x25A1) is returned if it is
+	 * available.
+	 * @param gc  The character code of the glyph.
+	 * @return    The slot, or nullptr if the atlas lacks the glyph and the
+	 *            white square glyph.
+	 */
+	const Slot *find(char32_t gc) const {
+		if (gc < direct.size()) {
+			std::uint16_t idx = direct[gc];
+			return idx ? &(slots[idx - 1]) : missing;
+		}
+		return findExtended(gc);
+	}
+	/**
+	 * Returns the slot for a character code of 256 or greater.
+	 * @copydetails find()
+	 */
+	const Slot *findExtended(char32_t gc) const;
+	/**
+	 * Returns the image that holds all the glyphs.
+	 */
+	const BppImage &image() const {
+		return atlas;
+	}
+	/**
+	 * Returns the number of glyphs in the atlas.
+	 */
+	std::size_t size() const {
+		return slots.size();
+	}
+	/**
+	 * Returns the maximum width and height of all glyphs. The height is the
+	 * height of each rendered line.
+	 */
+	const ImageDimensions &maxGlyphDimensions() const {
+		return cell;
+	}
+	/**
+	 * Returns the dimensions of the given text when rendered.
+	 * @param text   The text to consider. It may contain newlines.
+	 * @param flags  Either zero, for a potentially variable width, or
+	 *               BppFont::FixedWidth to place each glyph in a space as wide
+	 *               as the widest glyph in the atlas.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not in the
+	 *                                   atlas.
+	 */
+	ImageDimensions textDimensions(
+		const std::u32string &text,
+		BppFont::Flags flags = BppFont::Flags::Zero()
+	) const;
+	/**
+	 * Renders text into an existing image. The text is clipped to the
+	 * destination image; glyphs that do not fit are not written, and glyphs
+	 * that partly fit are partly written. Each line starts at the X
+	 * coordinate of @a loc, and lines are separated by the height of the
+	 * tallest glyph in the atlas.
+	 * @param dest   The image that will receive the text.
+	 * @param loc    The upper-left location of the text in @a dest. It may be
+	 *               outside of the image.
+	 * @param text   The text to render. It may contain newlines.
+	 * @param flags  Either zero, for a potentially variable width, or
+	 *               BppFont::FixedWidth to center each glyph in a space as
+	 *               wide as the widest glyph in the atlas.
+	 * @param op     The operation used to combine the glyphs with @a dest.
+	 * @return       The dimensions of the rendered text, which may be larger
+	 *               than the part that was written to @a dest.
+	 * @throw        GlyphNotFoundError  A glyph in @a text is not in the
+	 *                                   atlas. The text prior to the glyph
+	 *                                   will have been written.
+	 */
+	ImageDimensions render(
+		BppImage &dest,
+		const ImageLocation &loc,
+		const std::u32string &text,
+		BppFont::Flags flags = BppFont::Flags::Zero(),
+		BppImage::Operation op = BppImage::OpSet
+	) const;
+};
+
+typedef std::shared_ptr<const BppFontAtlas>  ConstBppFontAtlasSptr;
+
+} } }
+
+#endif        //  #ifndef BPPFONTATLAS_HPP
@@ -9,11 +9,20 @@
  */
 
 #include <duds/ui/graphics/BppImage.hpp>
+#include <duds/ui/graphics/BppBlockKernels.hpp>
 #include <duds/ui/graphics/BppImageErrors.hpp>
 #include <duds/general/Errors.hpp>
+#include <duds/general/ReverseBits.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace duds { namespace ui { namespace graphics {
 
+/**
+ * The number of pixels held in a single PixelBlock.
+ */
+static constexpr int BlockBits = sizeof(BppImage::PixelBlock) * 8;
+
 std::ostream &operator << (std::ostream &os, const ImageLocation &il) {
 	os << '(' << il.x << ',' << il.y << ')';
 	return os;
@@ -25,19 +34,89 @@ std::ostream &operator << (std::ostream &os, const ImageDimensions &id) {
 }
 
 
+void ImageDamage::reset(const ImageDimensions &id) {
+	dim = id;
+	spans.resize(std::max<int>(dim.h, 0));
+	addAll();
+}
+
+void ImageDamage::add(const ImageLocation &loc, const ImageDimensions &id) {
+	// clip to the image
+	int l = std::max<int>(loc.x, 0);
+	int r = std::min<int>(loc.x + id.w, dim.w);
+	int t = std::max<int>(loc.y, 0);
+	int b = std::min<int>(loc.y + id.h, dim.h);
+	if ((l >= r) || (t >= b)) {
+		return;
+	}
+	for (int y = t; y < b; ++y) {
+		Span &sp = spans[y];
+		// undamaged lines may hold old data
+		if (sp.empty() || (y < top) || (y >= bot)) {
+			sp.left = l;
+			sp.right = r;
+		} else {
+			sp.left = std::min<int>(sp.left, l);
+			sp.right = std::max<int>(sp.right, r);
+		}
+	}
+	if (empty()) {
+		top = t;
+		bot = b;
+	} else {
+		// lines between the old and new ranges are not damaged
+		for (int y = b; y < top; ++y) {
+			spans[y].left = spans[y].right = 0;
+		}
+		for (int y = bot; y < t; ++y) {
+			spans[y].left = spans[y].right = 0;
+		}
+		top = std::min(top, t);
+		bot = std::max(bot, b);
+	}
+}
+
+void ImageDamage::addAll() {
+	for (Span &sp : spans) {
+		sp.left = 0;
+		sp.right = dim.w;
+	}
+	if (dim.empty()) {
+		top = bot = 0;
+	} else {
+		top = 0;
+		bot = dim.h;
+	}
+}
+
+void ImageDamage::clear() {
+	top = bot = 0;
+}
+
+
 BppImage::BppImage(const ImageDimensions &id) :
 img(bufferBlockSize(id.w, id.h)), dim(id),
 blkPerLine(bufferBlocksPerLine(id.w))
 { }
 
 BppImage::BppImage(BppImage &&mv) :
-img(std::move(mv.img)), dim(mv.dim), blkPerLine(mv.blkPerLine) {
+img(std::move(mv.img)), dim(mv.dim), blkPerLine(mv.blkPerLine),
+trackDmg(mv.trackDmg) {
+	if (trackDmg) {
+		dmg.reset(dim);
+	}
 	mv.dim.w = mv.dim.h = 0;
 	mv.blkPerLine = 0;
+	mv.trackDamage(false);
 }
 
 BppImage::BppImage(const BppImage &src) :
-img(src.img), dim(src.dim), blkPerLine(src.blkPerLine) { }
+img(src.img), dim(src.dim), blkPerLine(src.blkPerLine), dmg(src.dmg),
+trackDmg(src.trackDmg) { }
+
+BppImage::BppImage(const BppImageView &src) :
+img(src.buffer(), src.buffer() + src.blocksPerLine() * src.height()),
+dim(src.dimensions()), blkPerLine(src.blocksPerLine()) { }
 
 BppImage::BppImage(
 	const char *data
@@ -98,6 +177,8 @@ BppImage &BppImage::operator = (BppImage &&mv) {
 	blkPerLine = mv.blkPerLine;
 	mv.blkPerLine = 0;
 	mv.dim.w = mv.dim.h = 0;
+	trackDamage(mv.trackDmg);
+	mv.trackDamage(false);
 	return *this;
 }
 
@@ -105,6 +186,9 @@ BppImage &BppImage::operator = (const BppImage &src) {
 	img = src.img;
 	dim = src.dim;
 	blkPerLine = src.blkPerLine;
+	if (trackDmg) {
+		dmg.reset(dim);
+	}
 	return *this;
 }
 
@@ -112,12 +196,17 @@ void BppImage::swap(BppImage &other) {
 	img.swap(other.img);
 	std::swap(dim, other.dim);
 	std::swap(blkPerLine, other.blkPerLine);
+	std::swap(dmg, other.dmg);
+	std::swap(trackDmg, other.trackDmg);
 }
 
 void BppImage::clear() {
 	img.clear();
 	dim.w = dim.h = 0;
 	blkPerLine = 0;
+	if (trackDmg) {
+		dmg.reset(dim);
+	}
 }
 
 void BppImage::resize(const duds::ui::graphics::ImageDimensions &newdim) {
@@ -132,6 +221,9 @@ void BppImage::resize(const duds::ui::graphics::ImageDimensions &newdim) {
 		dim = newdim;
 		img.resize(bufferBlockSize(dim.w, dim.h));
 		blkPerLine = bufferBlocksPerLine(dim);
+		if (trackDmg) {
+			dmg.reset(dim);
+		}
 	}
 }
 
@@ -151,22 +243,30 @@ bool BppImage::operator == (const BppImage &other) const {
 	if (dim != other.dim) {
 		return false;
 	}
-	// produce mask for right side of image; might cover whole image
-	PixelBlock mask = PixelBlock(-1) >>
-		(sizeof(PixelBlock) * 8) - (dim.w % (sizeof(PixelBlock) * 8));
+	const BppBlockKernels &kernels = BppBlockKernels::best();
+	const int usedBits = dim.w % BlockBits;
+	// no unused bits at the end of each line?
+	if (!usedBits) {
+		// compare the whole image at once
+		return kernels.equal(&(img[0]), &(other.img[0]), blkPerLine * dim.h);
+	}
+	// produce mask for right side of image
+	PixelBlock mask = PixelBlock(-1) >> (BlockBits - usedBits);
 	// traverse image data
 	const PixelBlock *spot = &(img[0]), *otherspot = &(other.img[0]);
-	for (int y = 0; y < dim.h; ++y, ++spot, ++otherspot) {
-		// visit all but rightmost block; may visit nothing
-		for (int x = 0; x < (blocksPerLine() - 1); ++x, ++spot, ++otherspot) {
-			if (*spot != *otherspot) {
-				return false;
-			}
+	for (int y = 0; y < dim.h; ++y) {
+		// compare all but rightmost block; may compare nothing
+		if (!kernels.equal(spot, otherspot, blkPerLine - 1)) {
+			return false;
 		}
+		spot += blkPerLine - 1;
+		otherspot += blkPerLine - 1;
 		// compare rightmost block
 		if ((*spot & mask) != (*otherspot & mask)) {
 			return false;
 		}
+		++spot;
+		++otherspot;
 	}
 	// everything matches
 	return true;
@@ -308,33 +408,40 @@ void BppImage::state(const ImageLocation &il, bool s) {
 	PixelBlock m;
 	bufferSpot(a, m, il);
 	*a = (*a & ~m) | (s ? m : 0);
+	damaged(il, ImageDimensions(1, 1));
 }
 
 bool BppImage::invertPixel(const ImageLocation &il) {
 	PixelBlock *a;
 	PixelBlock m;
 	bufferSpot(a, m, il);
+	damaged(il, ImageDimensions(1, 1));
 	return ((*a = (*a & ~m) ^ m) & m) != 0;
 }
 
 void BppImage::invert() {
-	for (PixelBlock &b : img) {
-		b = ~b;
+	if (!img.empty()) {
+		BppBlockKernels::best().invert(&(img[0]), img.size());
 	}
+	damagedAll();
 }
 
 void BppImage::invertLines(int start, int height) {
 	PixelBlock *end = bufferLine(start + height);
-	for (PixelBlock *b = bufferLine(start); b < end; ++b) {
-		*b = ~(*b);
+	PixelBlock *b = bufferLine(start);
+	if (b < end) {
+		BppBlockKernels::best().invert(b, end - b);
 	}
+	damaged(ImageLocation(0, start), ImageDimensions(dim.w, height));
 }
 
 void BppImage::patternLines(int start, int height, PixelBlock val) {
 	PixelBlock *end = bufferLine(start + height);
-	for (PixelBlock *b = bufferLine(start); b < end; ++b) {
-		*b = val;
+	PixelBlock *b = bufferLine(start);
+	if (b < end) {
+		BppBlockKernels::best().fill(b, end - b, val);
 	}
+	damaged(ImageLocation(0, start), ImageDimensions(dim.w, height));
 }
 
 void BppImage::blankImage(bool s) {
@@ -344,9 +451,10 @@ void BppImage::blankImage(bool s) {
 	} else {
 		v = 0;
 	}
-	for (PixelBlock &b : img) {
-		b = v;
+	if (!img.empty()) {
+		BppBlockKernels::best().fill(&(img[0]), img.size(), v);
 	}
+	damagedAll();
 }
 
 
@@ -427,6 +535,199 @@ const BppImage::OpFunction BppImage::OpFunctions[OpTotal] = {
 };
 
 
+/**
+ * Block operations used by the word-parallel blitter. Each takes the
+ * destination and the aligned source data, and returns the new destination
+ * data prior to masking. Using types rather than the function pointers in
+ * BppImage::OpFunctions allows the compiler to inline the operation into the
+ * blit loop.
+ */
+struct BlitSet {
+	static BppImage::PixelBlock apply(
+		BppImage::PixelBlock,
+		BppImage::PixelBlock src
+	) {
+		return src;
+	}
+};
+
+struct BlitNot {
+	static BppImage::PixelBlock apply(
+		BppImage::PixelBlock,
+		BppImage::PixelBlock src
+	) {
+		return ~src;
+	}
+};
+
+struct BlitAnd {
+	static BppImage::PixelBlock apply(
+		BppImage::PixelBlock dest,
+		BppImage::PixelBlock src
+	) {
+		return dest & src;
+	}
+};
+
+struct BlitOr {
+	static BppImage::PixelBlock apply(
+		BppImage::PixelBlock dest,
+		BppImage::PixelBlock src
+	) {
+		return dest | src;
+	}
+};
+
+struct BlitXor {
+	static BppImage::PixelBlock apply(
+		BppImage::PixelBlock dest,
+		BppImage::PixelBlock src
+	) {
+		return dest ^ src;
+	}
+};
+
+/**
+ * Copies a rectangular region of pixels one PixelBlock at a time. Source data
+ * is shifted and merged from the two source blocks that span each destination
+ * block, so the source and destination may have different horizontal offsets
+ * within their blocks.
+ * @tparam Op       One of the Blit* operation types.
+ * @param dest      The start of the first destination line.
+ * @param destBpl   The blocks per line of the destination image.
+ * @param dx        The X coordinate of the left-most destination pixel.
+ * @param src       The start of the first source line.
+ * @param srcBpl    The blocks per line of the source image.
+ * @param sx        The X coordinate of the left-most source pixel.
+ * @param w         The width of the region in pixels. Must be positive.
+ * @param h         The height of the region in pixels.
+ */
+template <class Op>
+static void blitLines(
+	BppImage::PixelBlock *dest,
+	int destBpl,
+	int dx,
+	const BppImage::PixelBlock *src,
+	int srcBpl,
+	int sx,
+	int w,
+	int h
+) {
+	static const BppImage::PixelBlock ones = -1;
+	// first and last destination blocks on each line
+	const int first = dx / BlockBits;
+	const int last = (dx + w - 1) / BlockBits;
+	// masks for the partially used destination blocks at each end
+	const BppImage::PixelBlock firstMask = ones << (dx % BlockBits);
+	const int endBits = (dx + w) % BlockBits;
+	const BppImage::PixelBlock lastMask = endBits ?
+		ones >> (BlockBits - endBits) : ones;
+	// Source bit position that lines up with the first bit of destination
+	// block k is (sx - dx + k * BlockBits). Split that into a block index
+	// offset and a shift that are the same for every block.
+	const int diff = sx - dx;
+	int srcOff = diff / BlockBits;
+	int shift = diff % BlockBits;
+	if (shift < 0) {
+		shift += BlockBits;
+		--srcOff;
+	}
+	for (int y = 0; y < h; ++y, dest += destBpl, src += srcBpl) {
+		for (int k = first; k <= last; ++k) {
+			BppImage::PixelBlock mask = ones;
+			if (k == first) {
+				mask &= firstMask;
+			}
+			if (k == last) {
+				mask &= lastMask;
+			}
+			// gather the source pixels for this destination block
+			const int i = k + srcOff;
+			BppImage::PixelBlock sv = (i >= 0) ? (src[i] >> shift) : 0;
+			if (shift && ((i + 1) < srcBpl)) {
+				sv |= src[i + 1] << (BlockBits - shift);
+			}
+			dest[k] = (dest[k] & ~mask) | (Op::apply(dest[k], sv) & mask);
+		}
+	}
+}
+
+/**
+ * Checks that a region lies entirely within an image of the given
+ * dimensions using the same requirements as ConstPixel::origdimloc().
+ * @param dim     The dimensions of the image.
+ * @param origin  The top-left location of the region.
+ * @param size    The size of the region.
+ * @throw ImageBoundsError  The region is empty or extends beyond the image.
+ */
+static void checkRegionBounds(
+	const ImageDimensions &dim,
+	const ImageLocation &origin,
+	const ImageDimensions &size
+) {
+	// same conditions as required by ConstPixel::origdimloc()
+	if (!size.withinBounds(ImageLocation(0, 0))) {
+		DUDS_THROW_EXCEPTION(ImageBoundsError() <<
+			ImageErrorDimensions(size) <<
+			ImageErrorLocation(ImageLocation(0, 0))
+		);
+	}
+	if (!dim.withinBounds(origin) ||
+		!dim.withinBounds(origin - ImageLocation(1,1) + size)
+	) {
+		DUDS_THROW_EXCEPTION(ImageBoundsError() <<
+			ImageErrorDimensions(dim) <<
+			ImageErrorLocation(origin + size)
+		);
+	}
+}
+
+void BppImage::checkRegion(
+	const ImageLocation &origin,
+	const ImageDimensions &size
+) const {
+	if (img.empty()) {
+		DUDS_THROW_EXCEPTION(ImageZeroSizeError());
+	}
+	checkRegionBounds(dim, origin, size);
+}
+
+void BppImage::blit(
+	const PixelBlock *source,
+	int srcBpl,
+	int srcX,
+	const ImageLocation &destLoc,
+	const ImageDimensions &size,
+	Operation op
+) {
+	damaged(destLoc, size);
+	PixelBlock *dest = &(img[blkPerLine * destLoc.y]);
+	switch (op) {
+		case OpSet:
+			blitLines<BlitSet>(dest, blkPerLine, destLoc.x, source,
+				srcBpl, srcX, size.w, size.h);
+			break;
+		case OpNot:
+			blitLines<BlitNot>(dest, blkPerLine, destLoc.x, source,
+				srcBpl, srcX, size.w, size.h);
+			break;
+		case OpAnd:
+			blitLines<BlitAnd>(dest, blkPerLine, destLoc.x, source,
+				srcBpl, srcX, size.w, size.h);
+			break;
+		case OpOr:
+			blitLines<BlitOr>(dest, blkPerLine, destLoc.x, source,
+				srcBpl, srcX, size.w, size.h);
+			break;
+		case OpXor:
+			blitLines<BlitXor>(dest, blkPerLine, destLoc.x, source,
+				srcBpl, srcX, size.w, size.h);
+			break;
+		default:
+			DUDS_THROW_EXCEPTION(ImageError());
+	}
+}
+
 void BppImage::write(
 	const BppImage * const src,
 	const ImageLocation &destLoc,
@@ -439,24 +740,65 @@ void BppImage::write(
 		// bad data
 		DUDS_THROW_EXCEPTION(ImageError());
 	}
-	// source iterator
-	ConstPixel siter = src->cbegin(srcLoc, srcSize, srcDir);
-	ImageDimensions destSize;
-	if ((srcDir == VertInc) || (srcDir == HorizDec)) {
-		// the iteration direction rotates the image 90 degrees; the dimensions
-		// are swapped for writing to the destination image
-		destSize = srcSize.swappedAxes();
-	} else {
-		destSize = srcSize;
+	if (srcDir != HorizInc) {
+		// rotated images are copied one pixel at a time
+		writeRotated(src, destLoc, srcLoc, srcSize, srcDir, op);
+		return;
 	}
-	// destination iterator
-	Pixel diter = begin(destLoc, destSize);
-	// iteratate over the image's pixels
-	/** @todo  Redo, at least for non-rotated images, using drawBox()
-	 *         implementation to operate on more than one pixel at a time. */
-	for (; siter != EndPixel(); ++diter, ++siter) {
-		*diter = OpBitFunctions[op](*diter, *siter);
+	src->checkRegion(srcLoc, srcSize);
+	checkRegion(destLoc, srcSize);
+	blit(&(src->img[src->blkPerLine * srcLoc.y]), src->blkPerLine, srcLoc.x,
+		destLoc, srcSize, op);
+}
+
+void BppImage::write(
+	const BppImageView &src,
+	const ImageLocation &destLoc,
+	const ImageLocation &srcLoc,
+	const ImageDimensions &srcSize,
+	Operation op
+) {
+	if ((op < OpSet) || (op > OpXor)) {
+		// bad data
+		DUDS_THROW_EXCEPTION(ImageError());
 	}
+	if (src.empty()) {
+		DUDS_THROW_EXCEPTION(ImageZeroSizeError());
+	}
+	checkRegionBounds(src.dimensions(), srcLoc, srcSize);
+	checkRegion(destLoc, srcSize);
+	blit(src.bufferLine(srcLoc.y), src.blocksPerLine(), srcLoc.x, destLoc,
+		srcSize, op);
+}
+
+void BppImage::writeRotated(
+	const BppImage * const src,
+	const ImageLocation &destLoc,
+	const ImageLocation &srcLoc,
+	const ImageDimensions &srcSize,
+	Direction srcDir,
+	Operation op
+) {
+	// copy out the source region, rotate it, and write it with the
+	// PixelBlock based implementation
+	src->checkRegion(srcLoc, srcSize);
+	BppImage region(srcSize);
+	region.write(src, ImageLocation(0, 0), srcLoc, srcSize);
+	switch (srcDir) {
+		case VertInc:
+			region.rotate90();
+			break;
+		case HorizDec:
+			region.rotate180();
+			break;
+		case VertDec:
+			region.rotate270();
+			break;
+		default:
+			DUDS_THROW_EXCEPTION(ImageError());
+	}
+	write(&region, destLoc, ImageLocation(0, 0), region.dimensions(),
+		HorizInc, op);
 }
 
 void BppImage::write(
@@ -467,7 +809,7 @@ void BppImage::write(
 ) {
 	ImageDimensions s(src->dimensions());
 	bool swapped = false;
-	if ((srcDir == VertInc) || (srcDir == HorizDec)) {
+	if ((srcDir == VertInc) || (srcDir == VertDec)) {
 		// the iteration direction rotates the image 90 degrees; the dimensions
 		// are swapped for comaprisons to the destination image
 		s.swapAxes();
@@ -482,6 +824,83 @@ void BppImage::write(
 	write(src, dest, ImageLocation(0, 0), d, srcDir, op);
 }
 
+/**
+ * Clips a region to fit inside an image.
+ * @param dim   The dimensions of the image.
+ * @param dest  The location of the region in the image. It is modified to be
+ *              inside the image.
+ * @param off   An offset that is moved along with the left and top edges of
+ *              the region, like a location in a source image.
+ * @param size  The dimensions of the region. It is modified to fit inside
+ *              the image.
+ * @return      True if any part of the region is inside the image.
+ */
+static bool clipToImage(
+	const ImageDimensions &dim,
+	ImageLocation &dest,
+	ImageLocation &off,
+	ImageDimensions &size
+) {
+	int x = dest.x, y = dest.y, w = size.w, h = size.h;
+	if (x < 0) {
+		off.x -= x;
+		w += x;
+		x = 0;
+	}
+	if (y < 0) {
+		off.y -= y;
+		h += y;
+		y = 0;
+	}
+	w = std::min(w, dim.w - x);
+	h = std::min(h, dim.h - y);
+	if ((w <= 0) || (h <= 0)) {
+		return false;
+	}
+	dest = ImageLocation(x, y);
+	size = ImageDimensions(w, h);
+	return true;
+}
+
+void BppImage::writeClipped(
+	const BppImage * const src,
+	const ImageLocation &destLoc,
+	const ImageLocation &srcLoc,
+	const ImageDimensions &srcSize,
+	Operation op
+) {
+	ImageLocation dl(destLoc), sl(srcLoc);
+	ImageDimensions sz(srcSize);
+	if (clipToImage(dim, dl, sl, sz)) {
+		write(src, dl, sl, sz, HorizInc, op);
+	}
+}
+
+void BppImage::writeClipped(
+	const BppImageView &src,
+	const ImageLocation &destLoc,
+	const ImageLocation &srcLoc,
+	const ImageDimensions &srcSize,
+	Operation op
+) {
+	ImageLocation dl(destLoc), sl(srcLoc);
+	ImageDimensions sz(srcSize);
+	if (clipToImage(dim, dl, sl, sz)) {
+		write(src, dl, sl, sz, op);
+	}
+}
+
+void BppImage::drawBoxClipped(
+	ImageLocation ul,
+	ImageDimensions id,
+	bool state
+) {
+	ImageLocation off(0, 0);
+	if (clipToImage(dim, ul, off, id)) {
+		drawBox(ul, id, state);
+	}
+}
+
 void BppImage::drawBox(
 	ImageLocation ul,
 	ImageDimensions id,
@@ -504,6 +923,7 @@ void BppImage::drawBox(
 			ImageErrorLocation(ul - ImageLocation(1,1) + id)
 		);
 	}
+	damaged(ul, id);
 	// compute start and end addresses ingoring line height
 	PixelBlock *next = &(img[blkPerLine * ul.y + (ul.x / (sizeof(PixelBlock) * 8))]);
 	static const PixelBlock ones = -1;
@@ -551,6 +971,217 @@ void BppImage::drawBox(
 	}
 }
 
+/**
+ * Reads 8 pixels, starting from a horizontal location that is a multiple of
+ * 8, from an image line.
+ * @param line  The start of the image line.
+ * @param byte  The index of the group of 8 pixels.
+ */
+static inline std::uint8_t lineByte(
+	const BppImage::PixelBlock *line,
+	int byte
+) {
+	return (std::uint8_t)(line[byte / sizeof(BppImage::PixelBlock)] >>
+		((byte % sizeof(BppImage::PixelBlock)) * 8));
+}
+
+/**
+ * Writes 8 pixels, starting from a horizontal location that is a multiple of
+ * 8, to an image line.
+ * @param line  The start of the image line.
+ * @param byte  The index of the group of 8 pixels.
+ * @param val   The pixels to write.
+ */
+static inline void lineByte(
+	BppImage::PixelBlock *line,
+	int byte,
+	std::uint8_t val
+) {
+	BppImage::PixelBlock &blk = line[byte / sizeof(BppImage::PixelBlock)];
+	const int shift = (byte % sizeof(BppImage::PixelBlock)) * 8;
+	blk = (blk & ~((BppImage::PixelBlock)0xFF << shift)) |
+		((BppImage::PixelBlock)val << shift);
+}
+
+/**
+ * Transposes an 8x8 matrix of bits. Bit (8 * r + c) is moved to bit
+ * (8 * c + r). From Hacker's Delight, 2nd edition, section 7-3.
+ */
+static inline std::uint64_t transpose8x8(std::uint64_t x) {
+	std::uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	return x ^ t ^ (t << 28);
+}
+
+/**
+ * Writes the horizontal mirror image of a line to another line. The lines
+ * must not overlap.
+ * @param dest    The destination line.
+ * @param src     The source line.
+ * @param blocks  The number of blocks in each line.
+ * @param pad     The number of unused bits at the end of the line.
+ */
+static void mirrorLine(
+	BppImage::PixelBlock *dest,
+	const BppImage::PixelBlock *src,
+	int blocks,
+	int pad
+) {
+	// reverse the block order and the bits in each block; the unused bits
+	// end up on the left
+	for (int b = 0; b < blocks; ++b) {
+		dest[b] = duds::general::ReverseBits(src[blocks - b - 1]);
+	}
+	// shift the line left to remove the unused bits from the start
+	if (pad) {
+		for (int b = 0; b < (blocks - 1); ++b) {
+			dest[b] = (dest[b] >> pad) | (dest[b + 1] << (BlockBits - pad));
+		}
+		dest[blocks - 1] >>= pad;
+	}
+}
+
+void BppImage::transpose(BppImage &dest) const {
+	dest.resize(dim.swappedAxes());
+	if (img.empty()) {
+		return;
+	}
+	const int srcBytes = (dim.w + 7) / 8;
+	// work on 8x8 tiles; each tile is 8 lines with one byte from each line
+	for (int y = 0; y < dim.h; y += 8) {
+		const int rows = std::min(8, dim.h - y);
+		const PixelBlock *srcLine = &(img[blkPerLine * y]);
+		for (int xb = 0; xb < srcBytes; ++xb) {
+			// gather the tile; missing lines past the bottom are blank
+			std::uint64_t tile = 0;
+			for (int r = 0; r < rows; ++r) {
+				tile |= (std::uint64_t)lineByte(srcLine + blkPerLine * r, xb) <<
+					(r * 8);
+			}
+			tile = transpose8x8(tile);
+			// each byte of the tile is now a part of a destination line
+			const int cols = std::min(8, dim.w - xb * 8);
+			PixelBlock *destLine = &(dest.img[dest.blkPerLine * xb * 8]);
+			for (int c = 0; c < cols; ++c, destLine += dest.blkPerLine) {
+				lineByte(destLine, y / 8, (std::uint8_t)(tile >> (c * 8)));
+			}
+		}
+	}
+	dest.damagedAll();
+}
+
+void BppImage::mirrorVert() {
+	if (img.empty()) {
+		return;
+	}
+	PixelBlock *top = &(img[0]);
+	PixelBlock *bot = &(img[blkPerLine * (dim.h - 1)]);
+	for (; top < bot; top += blkPerLine, bot -= blkPerLine) {
+		std::swap_ranges(top, top + blkPerLine, bot);
+	}
+	damagedAll();
+}
+
+void BppImage::mirrorVert(BppImage &dest) const {
+	if (&dest == this) {
+		dest.mirrorVert();
+		return;
+	}
+	dest.resize(dim);
+	for (int y = 0; y < dim.h; ++y) {
+		std::memcpy(
+			&(dest.img[blkPerLine * (dim.h - y - 1)]),
+			&(img[blkPerLine * y]),
+			blkPerLine * sizeof(PixelBlock)
+		);
+	}
+	dest.damagedAll();
+}
+
+void BppImage::mirrorHoriz() {
+	if (img.empty()) {
+		return;
+	}
+	std::vector<PixelBlock> line(blkPerLine);
+	const int pad = blkPerLine * BlockBits - dim.w;
+	for (PixelBlock *spot = &(img[0]); spot < (&(img[0]) + img.size());
+	spot += blkPerLine) {
+		mirrorLine(&(line[0]), spot, blkPerLine, pad);
+		std::copy(line.begin(), line.end(), spot);
+	}
+	damagedAll();
+}
+
+void BppImage::mirrorHoriz(BppImage &dest) const {
+	if (&dest == this) {
+		dest.mirrorHoriz();
+		return;
+	}
+	dest.resize(dim);
+	const int pad = blkPerLine * BlockBits - dim.w;
+	for (int y = 0; y < dim.h; ++y) {
+		mirrorLine(&(dest.img[blkPerLine * y]), &(img[blkPerLine * y]),
+			blkPerLine, pad);
+	}
+	dest.damagedAll();
+}
+
+void BppImage::rotate90(BppImage &dest) const {
+	if (&dest == this) {
+		dest.rotate90();
+		return;
+	}
+	transpose(dest);
+	dest.mirrorVert();
+}
+
+void BppImage::rotate90() {
+	BppImage rot;
+	rotate90(rot);
+	// move assignment takes the damage tracking setting from rot
+	rot.trackDamage(trackDmg);
+	*this = std::move(rot);
+}
+
+void BppImage::rotate180(BppImage &dest) const {
+	if (&dest == this) {
+		dest.rotate180();
+		return;
+	}
+	dest.resize(dim);
+	const int pad = blkPerLine * BlockBits - dim.w;
+	for (int y = 0; y < dim.h; ++y) {
+		mirrorLine(&(dest.img[blkPerLine * (dim.h - y - 1)]),
+			&(img[blkPerLine * y]), blkPerLine, pad);
+	}
+	dest.damagedAll();
+}
+
+void BppImage::rotate180() {
+	mirrorVert();
+	mirrorHoriz();
+}
+
+void BppImage::rotate270(BppImage &dest) const {
+	if (&dest == this) {
+		dest.rotate270();
+		return;
+	}
+	transpose(dest);
+	dest.mirrorHoriz();
+}
+
+void BppImage::rotate270() {
+	BppImage rot;
+	rotate270(rot);
+	rot.trackDamage(trackDmg);
+	*this = std::move(rot);
+}
+
 // -------------------------------------------------------------------
 
 BppImage::ConstPixel::ConstPixel(
@@ -781,6 +1412,7 @@ bool BppImage::ConstPixel::state() const {
 void BppImage::Pixel::state(bool s) {
 	if (blk) {
 		*blk = (*blk & ~mask) | (s ? mask : 0);
+		src->damaged(orig + pos, ImageDimensions(1, 1));
 	} else {
 		DUDS_THROW_EXCEPTION(ImageIteratorEndError());
 	}
@@ -788,6 +1420,7 @@ void BppImage::Pixel::state(bool s) {
 
 bool BppImage::Pixel::toggle() {
 	if (blk) {
+		src->damaged(orig + pos, ImageDimensions(1, 1));
 		return ((*blk = (*blk & ~mask) ^ mask) & mask) != 0;
 	} else {
 		DUDS_THROW_EXCEPTION(ImageIteratorEndError());
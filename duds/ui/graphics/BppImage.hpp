@@ -281,6 +281,139 @@ constexpr ImageLocation ImageLocation::operator - (
 	return ImageLocation(x - id.w, y - id.h);
 }
 
+/**
+ * Records the portions of an image that have been modified. The damage is
+ * kept as a span of horizontal positions for each line of the image, so the
+ * memory used does not grow with the number of modifications, and the result
+ * is well suited to displays that are updated a line at a time. A rectangle
+ * is recorded by widening the span of each line it covers.
+ *
+ * BppImage maintains an ImageDamage object when damage tracking is enabled
+ * with BppImage::trackDamage().
+ *
+ * @author  Jeff Jackowski
+ */
+class ImageDamage {
+public:
+	/**
+	 * The horizontal extent of the damage on a single line.
+	 */
+	struct Span {
+		/**
+		 * The left-most damaged X coordinate.
+		 */
+		std::int16_t left;
+		/**
+		 * One past the right-most damaged X coordinate.
+		 */
+		std::int16_t right;
+		/**
+		 * True if no part of the line is damaged.
+		 */
+		constexpr bool empty() const {
+			return left >= right;
+		}
+		/**
+		 * The number of damaged pixels on the line, including any undamaged
+		 * pixels between damaged pixels.
+		 */
+		constexpr int width() const {
+			return empty() ? 0 : right - left;
+		}
+	};
+private:
+	/**
+	 * The damage for each line of the image.
+	 */
+	std::vector<Span> spans;
+	/**
+	 * The dimensions of the image.
+	 */
+	ImageDimensions dim;
+	/**
+	 * The first damaged line.
+	 */
+	int top;
+	/**
+	 * One past the last damaged line.
+	 */
+	int bot;
+public:
+	/**
+	 * Makes an object for an image of zero size.
+	 */
+	ImageDamage() : dim(0, 0), top(0), bot(0) { }
+	/**
+	 * Makes an object for an image of the given size with all of the image
+	 * marked as damaged.
+	 */
+	ImageDamage(const ImageDimensions &id) {
+		reset(id);
+	}
+	/**
+	 * Changes the size of the image and marks all of it as damaged.
+	 */
+	void reset(const ImageDimensions &id);
+	/**
+	 * Marks a rectangular area as damaged. The area is clipped to the image
+	 * dimensions.
+	 * @param loc  The upper-left corner of the area.
+	 * @param id   The dimensions of the area.
+	 */
+	void add(const ImageLocation &loc, const ImageDimensions &id);
+	/**
+	 * Marks all of the image as damaged.
+	 */
+	void addAll();
+	/**
+	 * Marks all of the image as undamaged.
+	 */
+	void clear();
+	/**
+	 * True if no part of the image is damaged.
+	 */
+	bool empty() const {
+		return top >= bot;
+	}
+	/**
+	 * Returns the dimensions of the image.
+	 */
+	const ImageDimensions &dimensions() const {
+		return dim;
+	}
+	/**
+	 * Returns the first damaged line. If empty() is true, this is the same as
+	 * endLine().
+	 */
+	int firstLine() const {
+		return top;
+	}
+	/**
+	 * Returns one past the last damaged line.
+	 */
+	int endLine() const {
+		return bot;
+	}
+	/**
+	 * Returns the damage for a single line. Lines outside the image are
+	 * reported as undamaged.
+	 * @param y  The line.
+	 */
+	Span line(int y) const {
+		if ((y < top) || (y >= bot)) {
+			return Span { 0, 0 };
+		}
+		return spans[y];
+	}
+	/**
+	 * True if the given line has any damage.
+	 * @param y  The line.
+	 */
+	bool lineDamaged(int y) const {
+		return !line(y).empty();
+	}
+};
+
 /**
  * An image location relevant to the error.
  */
@@ -303,6 +436,104 @@ typedef boost::error_info<struct Info_FrameDimensions, ImageDimensions>
 	ImageErrorTargetDimensions;
 
 
+/**
+ * A non-owning, read-only reference to bit-per-pixel image data stored in the
+ * same layout used by BppImage. This allows image data held elsewhere, such
+ * as in a memory mapped BppImageArchiveMap, to be written into a BppImage
+ * without first copying it into another BppImage object.
+ *
+ * The referenced data must outlive the view.
+ *
+ * @author  Jeff Jackowski
+ */
+class BppImageView {
+public:
+	/**
+	 * The type used to hold pixel values; the same as BppImage::PixelBlock.
+	 */
+	typedef std::uintptr_t  PixelBlock;
+private:
+	/**
+	 * The image data.
+	 */
+	const PixelBlock *buf;
+	/**
+	 * The dimensions of the image.
+	 */
+	ImageDimensions dim;
+	/**
+	 * Number of @ref PixelBlock "PixelBlocks" used for each horizontal line.
+	 */
+	int blkPerLine;
+public:
+	/**
+	 * Makes a view of nothing.
+	 */
+	constexpr BppImageView() : buf(nullptr), dim(0, 0), blkPerLine(0) { }
+	/**
+	 * Makes a view of the given image data.
+	 * @param data  The image data. Each line must start on a new PixelBlock,
+	 *              and the LSb of each block is the left-most pixel.
+	 * @param id    The dimensions of the image.
+	 */
+	constexpr BppImageView(const PixelBlock *data, const ImageDimensions &id) :
+		buf(data), dim(id),
+		blkPerLine(id.w / (sizeof(PixelBlock) * 8) +
+		((id.w % (sizeof(PixelBlock) * 8)) ? 1 : 0)) { }
+	/**
+	 * Returns the image data.
+	 */
+	const PixelBlock *buffer() const {
+		return buf;
+	}
+	/**
+	 * Returns the start of the image data for the given line. No bounds
+	 * checking is performed.
+	 */
+	const PixelBlock *bufferLine(int py) const {
+		return buf + blkPerLine * py;
+	}
+	/**
+	 * Returns the dimensions of the image.
+	 */
+	const ImageDimensions &dimensions() const {
+		return dim;
+	}
+	/**
+	 * Returns the width of the image.
+	 */
+	int width() const {
+		return dim.w;
+	}
+	/**
+	 * Returns the height of the image.
+	 */
+	int height() const {
+		return dim.h;
+	}
+	/**
+	 * Returns the number of @ref PixelBlock "PixelBlocks" used for each line.
+	 */
+	int blocksPerLine() const {
+		return blkPerLine;
+	}
+	/**
+	 * True if the view does not reference any image data.
+	 */
+	bool empty() const {
+		return !buf || dim.empty();
+	}
+	/**
+	 * Returns the state of the pixel at the given location. No bounds
+	 * checking is performed.
+	 */
+	bool state(int x, int y) const {
+		return (bufferLine(y)[x / (sizeof(PixelBlock) * 8)] >>
+			(x % (sizeof(PixelBlock) * 8))) & 1;
+	}
+};
+
+
 /**
  * An image that uses a single bit to represent the state of each pixel; a
  * black @b or white picture.
@@ -313,6 +544,10 @@ typedef boost::error_info<struct Info_FrameDimensions, ImageDimensions>
  * to the right. PixelBlocks do not span rows, so unused space will fill the
  * higher value bits of the right-most PixelBlock at the end of each row.
  *
+ * The image can optionally keep track of the areas modified by its member
+ * functions in an ImageDamage object; see trackDamage(). Displays can use
+ * this to avoid checking or sending unchanged parts of a frame.
+ *
  * @note  Operations that modify images are not thread-safe.
  *
  * @author  Jeff Jackowski
@@ -338,6 +573,31 @@ private:
 	 * A whole number is always used, save for the case of a zero size image.
 	 */
 	int blkPerLine;
+	/**
+	 * The areas modified since damage tracking was enabled or clearDamage()
+	 * was called. Only maintained when @a trackDmg is true.
+	 */
+	ImageDamage dmg;
+	/**
+	 * True when modifications are recorded in @a dmg.
+	 */
+	bool trackDmg = false;
+	/**
+	 * Records a modified area if damage tracking is enabled.
+	 */
+	void damaged(const ImageLocation &loc, const ImageDimensions &id) {
+		if (trackDmg) {
+			dmg.add(loc, id);
+		}
+	}
+	/**
+	 * Records modification of the whole image if damage tracking is enabled.
+	 */
+	void damagedAll() {
+		if (trackDmg) {
+			dmg.addAll();
+		}
+	}
 public:
 	/**
 	 * Returns the size of an image buffer as the number of
@@ -972,7 +1232,9 @@ public:
 	 */
 	BppImage(int width, int height) : BppImage(ImageDimensions(width, height)) { }
 	/**
-	 * Move constructor.
+	 * Move constructor. The damage tracking setting is taken from @a mv, and
+	 * if tracking is enabled, the whole image is marked as damaged. @a mv is
+	 * left empty with damage tracking disabled.
 	 */
 	BppImage(BppImage &&mv);
 	/**
@@ -1011,6 +1273,11 @@ public:
 	 *                             more data.
 	 */
 	BppImage(const std::vector<char> &data);
+	/**
+	 * Copies the image data referenced by a view into a new image.
+	 * @param src  The image data to copy.
+	 */
+	explicit BppImage(const BppImageView &src);
 	/**
 	 * Convenience function to make a shared pointer to an image using the
 	 * BppImage(const ImageDimensions &) constructor.
@@ -1040,11 +1307,14 @@ public:
 		return std::make_shared<BppImage>(data);
 	}
 	/**
-	 * Move assignment.
+	 * Move assignment. Like the move constructor, the damage tracking setting
+	 * is taken from @a mv, and if tracking is enabled, the whole image is
+	 * marked as damaged. @a mv is left empty with damage tracking disabled.
 	 */
 	BppImage &operator = (BppImage &&mv);
 	/**
-	 * Copy assignment.
+	 * Copy assignment. The damage tracking setting of this image is
+	 * unchanged. If tracking is enabled, the whole image is marked as damaged.
 	 */
 	BppImage &operator = (const BppImage &src);
 	/**
@@ -1080,6 +1350,53 @@ public:
 	bool empty() const {
 		return img.empty();
 	}
+	/**
+	 * Enables or disables recording of the areas modified by this object's
+	 * member functions, including writes through Pixel objects. Changes made
+	 * directly to the image data through buffer() or bufferLine() are not
+	 * recorded; use markDamage() for those.
+	 * @param track  True to record damage. When enabled, the whole image is
+	 *               initially marked as damaged because its relation to any
+	 *               earlier content is unknown.
+	 */
+	void trackDamage(bool track) {
+		trackDmg = track;
+		if (track) {
+			dmg.reset(dim);
+		} else {
+			dmg.reset(ImageDimensions(0, 0));
+		}
+	}
+	/**
+	 * True if damage tracking is enabled.
+	 */
+	bool trackingDamage() const {
+		return trackDmg;
+	}
+	/**
+	 * Returns the areas modified since damage tracking was enabled or
+	 * clearDamage() was last called. Only meaningful if trackingDamage() is
+	 * true.
+	 */
+	const ImageDamage &damage() const {
+		return dmg;
+	}
+	/**
+	 * Marks an area as damaged if damage tracking is enabled. This is needed
+	 * after modifying the image data directly.
+	 * @param loc  The upper-left corner of the area.
+	 * @param id   The dimensions of the area.
+	 */
+	void markDamage(const ImageLocation &loc, const ImageDimensions &id) {
+		damaged(loc, id);
+	}
+	/**
+	 * Marks the whole image as undamaged. This is normally done after the
+	 * image has been written to every display that shows it.
+	 */
+	void clearDamage() {
+		dmg.clear();
+	}
 	/**
 	 * Returns the number of @ref PixelBlock "PixelBlocks", not bytes, that
 	 * make up the image buffer. This result includes space allocated but not
@@ -1133,6 +1450,13 @@ public:
 	const std::vector<PixelBlock> &data() const {
 		return img;
 	}
+	/**
+	 * Returns a non-owning view of this image. The view is invalidated by
+	 * any operation that changes the size of this image.
+	 */
+	BppImageView view() const {
+		return BppImageView(img.data(), dim);
+	}
 	/**
 	 * Returns true if the contents of the two images are identical.
 	 */
@@ -1515,6 +1839,77 @@ public:
 	void setImage() {
 		blankImage(true);
 	}
+	/**
+	 * Writes the transpose of this image into another image; the pixel at
+	 * (x, y) is moved to (y, x). The work is done on 8x8 pixel tiles rather
+	 * than on individual pixels.
+	 * @param dest  The destination image. It will be resized to this image's
+	 *              dimensions with swapped axes. It must not be this image.
+	 */
+	void transpose(BppImage &dest) const;
+	/**
+	 * Mirrors the image across its vertical axis, swapping left and right.
+	 */
+	void mirrorHoriz();
+	/**
+	 * Writes a copy of this image mirrored across its vertical axis into
+	 * another image.
+	 * @param dest  The destination image. It will be resized to match this
+	 *              image. If it is this image, the image is mirrored in place.
+	 */
+	void mirrorHoriz(BppImage &dest) const;
+	/**
+	 * Mirrors the image across its horizontal axis, swapping top and bottom.
+	 */
+	void mirrorVert();
+	/**
+	 * Writes a copy of this image mirrored across its horizontal axis into
+	 * another image.
+	 * @param dest  The destination image. It will be resized to match this
+	 *              image. If it is this image, the image is mirrored in place.
+	 */
+	void mirrorVert(BppImage &dest) const;
+	/**
+	 * Rotates the image by 90 degrees counter-clockwise. This produces the
+	 * same result as writing the image with the direction Rotate90DCCW, but
+	 * works on 8x8 pixel tiles rather than individual pixels.
+	 * @post  The width and height are swapped.
+	 */
+	void rotate90();
+	/**
+	 * Writes a copy of this image rotated by 90 degrees counter-clockwise into
+	 * another image.
+	 * @param dest  The destination image. It will be resized to this image's
+	 *              dimensions with swapped axes. If it is this image, the
+	 *              image is rotated in place.
+	 */
+	void rotate90(BppImage &dest) const;
+	/**
+	 * Rotates the image by 180 degrees. This produces the same result as
+	 * writing the image with the direction Rotate180DCCW.
+	 */
+	void rotate180();
+	/**
+	 * Writes a copy of this image rotated by 180 degrees into another image.
+	 * @param dest  The destination image. It will be resized to match this
+	 *              image. If it is this image, the image is rotated in place.
+	 */
+	void rotate180(BppImage &dest) const;
+	/**
+	 * Rotates the image by 270 degrees counter-clockwise. This produces the
+	 * same result as writing the image with the direction Rotate270DCCW, but
+	 * works on 8x8 pixel tiles rather than individual pixels.
+	 * @post  The width and height are swapped.
+	 */
+	void rotate270();
+	/**
+	 * Writes a copy of this image rotated by 270 degrees counter-clockwise into
+	 * another image.
+	 * @param dest  The destination image. It will be resized to this image's
+	 *              dimensions with swapped axes. If it is this image, the
+	 *              image is rotated in place.
+	 */
+	void rotate270(BppImage &dest) const;
 	/**
 	 * Tells how to modify the destination pixel with the source pixel data.
 	 */
@@ -1564,9 +1959,57 @@ private:
 	 * implementations of an operation than OpBitFunctions.
 	 */
 	static const OpFunction OpFunctions[OpTotal];
+	/**
+	 * Checks that a region lies entirely within this image using the same
+	 * requirements as ConstPixel::origdimloc().
+	 * @param origin  The top-left location of the region.
+	 * @param size    The size of the region. It must not be empty.
+	 * @throw ImageZeroSizeError  This image has no image data.
+	 * @throw ImageBoundsError    The region is empty or extends beyond the
+	 *                            bounds of this image.
+	 */
+	void checkRegion(
+		const ImageLocation &origin,
+		const ImageDimensions &size
+	) const;
+	/**
+	 * Copies a region of source image data into this image without rotation.
+	 * The regions must already be bounds checked.
+	 * @param source   The first source line of the region.
+	 * @param srcBpl   The blocks per line of the source image.
+	 * @param srcX     The X coordinate of the left-most source pixel.
+	 * @param destLoc  The top-left location of the region in this image.
+	 * @param size     The dimensions of the region.
+	 * @param op       The operation used to modify this image.
+	 */
+	void blit(
+		const PixelBlock *source,
+		int srcBpl,
+		int srcX,
+		const ImageLocation &destLoc,
+		const ImageDimensions &size,
+		Operation op
+	);
+	/**
+	 * Implements write() for source directions other than HorizInc by copying
+	 * the source region into a temporary image, rotating it, and then writing
+	 * the result.
+	 */
+	void writeRotated(
+		const BppImage * const src,
+		const ImageLocation &destLoc,
+		const ImageLocation &srcLoc,
+		const ImageDimensions &srcSize,
+		Direction srcDir,
+		Operation op
+	);
 public:
 	/**
 	 * Writes the specified portion of the source into this image.
+	 * The image data is copied a whole PixelBlock at a time, shifting the
+	 * source data as needed to line up with the destination. Directions other
+	 * than HorizInc first copy and rotate the source region into a temporary
+	 * image, so they are somewhat slower and allocate memory.
 	 * @param src      The source image.
 	 * @param destLoc  The top-left location on this image where the source
 	 *                 image will be placed.
@@ -1577,6 +2020,9 @@ public:
 	 * @param srcDir   The iteration direction on the source image. This allows
 	 *                 the source to be rotated by 0, 90, 180, or 270 degrees.
 	 * @param op       The operation used to modify this image.
+	 * @throw ImageZeroSizeError  Either image has no image data.
+	 * @throw ImageBoundsError    The region to copy is empty or does not fit
+	 *                            within either image.
 	 */
 	void write(
 		const BppImage * const src,
@@ -1685,13 +2131,101 @@ public:
 	) {
 		write(src.get(), dest, srcDir, op);
 	}
+	/**
+	 * Writes the part of a region of the source image that lands inside this
+	 * image. Unlike write(), the destination location may be outside this
+	 * image, including at negative coordinates, and nothing is written if
+	 * the region lands entirely outside this image.
+	 * @param src      The source image.
+	 * @param destLoc  The location on this image for the upper-left corner of
+	 *                 the source region.
+	 * @param srcLoc   The top-left location of the region in the source image.
+	 * @param srcSize  The dimensions of the region in the source image.
+	 * @param op       The operation used to modify this image.
+	 * @throw ImageBoundsError  The region does not fit inside the source
+	 *                          image.
+	 */
+	void writeClipped(
+		const BppImage * const src,
+		const ImageLocation &destLoc,
+		const ImageLocation &srcLoc,
+		const ImageDimensions &srcSize,
+		Operation op = OpSet
+	);
+	/**
+	 * Writes a region of the image referenced by a view into this image.
+	 * @param src      The source image data.
+	 * @param destLoc  The top-left location on this image where the source
+	 *                 region will be placed.
+	 * @param srcLoc   The top-left location of the region in the source.
+	 * @param srcSize  The width and height of the region.
+	 * @param op       The operation used to modify this image.
+	 * @throw ImageZeroSizeError  Either image has no image data.
+	 * @throw ImageBoundsError    The region to copy is empty or does not fit
+	 *                            within either image.
+	 */
+	void write(
+		const BppImageView &src,
+		const ImageLocation &destLoc,
+		const ImageLocation &srcLoc,
+		const ImageDimensions &srcSize,
+		Operation op = OpSet
+	);
+	/**
+	 * Writes the whole image referenced by a view into this image.
+	 * @param src      The source image data.
+	 * @param destLoc  The top-left location on this image where the source
+	 *                 image will be placed.
+	 * @param op       The operation used to modify this image.
+	 * @throw ImageZeroSizeError  Either image has no image data.
+	 * @throw ImageBoundsError    The source does not fit within this image.
+	 */
+	void write(
+		const BppImageView &src,
+		const ImageLocation &destLoc,
+		Operation op = OpSet
+	) {
+		write(src, destLoc, ImageLocation(0, 0), src.dimensions(), op);
+	}
+	/**
+	 * Writes the part of a region of the image referenced by a view that
+	 * lands inside this image. The destination location may be outside this
+	 * image, including at negative coordinates.
+	 * @param src      The source image data.
+	 * @param destLoc  The location on this image for the upper-left corner of
+	 *                 the source region.
+	 * @param srcLoc   The top-left location of the region in the source.
+	 * @param srcSize  The dimensions of the region in the source.
+	 * @param op       The operation used to modify this image.
+	 * @throw ImageBoundsError  The region does not fit inside the source
+	 *                          image.
+	 */
+	void writeClipped(
+		const BppImageView &src,
+		const ImageLocation &destLoc,
+		const ImageLocation &srcLoc,
+		const ImageDimensions &srcSize,
+		Operation op = OpSet
+	);
+	/**
+	 * Draws the part of a box that lands inside this image. Nothing is drawn
+	 * if the box is entirely outside this image.
+	 * @param ul     The upper-left location of the box. It may be outside this
+	 *               image, including at negative coordinates.
+	 * @param id     The dimensions of the box.
+	 * @param state  The state to give the pixels in the box.
+	 */
+	void drawBoxClipped(
+		ImageLocation ul,
+		ImageDimensions id,
+		bool state
+	);
 	/**
 	 * Draws a box into this image.
 	 * @note      This function exists partly as a test of how to write data
 	 *            into an image one PixelBlock at a time. The overhead may not
 	 *            make this function worthwhile unless a PixelBlock is large
-	 *            enough, and 32-bits might not be large enough. The algorithm
-	 *            could be adapted for use in the write() functions.
+	 *            enough, and 32-bits might not be large enough.
 	 * @param ul  The upper-left location of the box.
 	 * @param id  The dimensions of the box.
 	 * @param op  The bit-wise operation to perform to draw the box. One
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#include <boost/exception/errinfo_errno.hpp>
+#include <duds/ui/graphics/BppImageArchiveMap.hpp>
+#include <duds/ui/graphics/BppImageErrors.hpp>
+#include <duds/general/Errors.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace duds { namespace ui { namespace graphics {
+
+/**
+ * The header at the start of a version 1 image archive.
+ */
+struct MapHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t blockBytes;
+	std::uint32_t count;
+	std::uint32_t indexOffset;
+	std::uint32_t fileSize;
+	std::uint32_t reserved[2];
+};
+
+static_assert(sizeof(MapHeader) == 32, "MapHeader has padding");
+static_assert(
+	sizeof(BppImageArchiveMap::Entry) == 16,
+	"BppImageArchiveMap::Entry has padding"
+);
+
+/**
+ * True if the system stores integers in little endian form.
+ */
+static bool littleEndian() {
+	const std::uint16_t one = 1;
+	return *(const char*)&one == 1;
+}
+
+BppImageArchiveMap::BppImageArchiveMap(const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		DUDS_THROW_EXCEPTION(ImageArchiveStreamError() <<
+			boost::errinfo_errno(errno) << ImageArchiveFileName(path)
+		);
+	}
+	struct stat st;
+	if (fstat(fd, &st)) {
+		int err = errno;
+		close(fd);
+		DUDS_THROW_EXCEPTION(ImageArchiveStreamError() <<
+			boost::errinfo_errno(err) << ImageArchiveFileName(path)
+		);
+	}
+	length = st.st_size;
+	if (length < sizeof(MapHeader)) {
+		close(fd);
+		DUDS_THROW_EXCEPTION(ImageNotArchiveStreamError() <<
+			ImageArchiveFileName(path)
+		);
+	}
+	void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	int err = errno;
+	// the mapping remains after the file is closed
+	close(fd);
+	if (addr == MAP_FAILED) {
+		DUDS_THROW_EXCEPTION(ImageArchiveStreamError() <<
+			boost::errinfo_errno(err) << ImageArchiveFileName(path)
+		);
+	}
+	base = (const char*)addr;
+	try {
+		const MapHeader *hdr = (const MapHeader*)base;
+		if (std::memcmp(hdr->magic, "BPPI", 4)) {
+			DUDS_THROW_EXCEPTION(ImageNotArchiveStreamError());
+		}
+		if (!littleEndian()) {
+			DUDS_THROW_EXCEPTION(ImageArchiveIncompatibleError());
+		}
+		if (hdr->version != 1) {
+			DUDS_THROW_EXCEPTION(ImageArchiveUnsupportedVersionError() <<
+				ImageArchiveVersion(hdr->version)
+			);
+		}
+		if (hdr->blockBytes != sizeof(BppImage::PixelBlock)) {
+			DUDS_THROW_EXCEPTION(ImageArchiveIncompatibleError() <<
+				ImageArchiveBlockSize(hdr->blockBytes)
+			);
+		}
+		count = hdr->count;
+		if ((hdr->fileSize != length) ||
+			(hdr->indexOffset % alignof(Entry)) ||
+			(hdr->indexOffset > length) ||
+			(((length - hdr->indexOffset) / sizeof(Entry)) < count)
+		) {
+			DUDS_THROW_EXCEPTION(ImageArchiveStreamTruncatedError());
+		}
+		index = (const Entry*)(base + hdr->indexOffset);
+		// check that the index only references data inside the file so that
+		// get() needs no checks
+		for (const Entry *e = index; e < (index + count); ++e) {
+			std::size_t data = BppImage::bufferByteSize(e->width, e->height);
+			if ((e->nameOffset > length) ||
+				(e->nameLength > (length - e->nameOffset)) ||
+				(e->dataOffset % sizeof(BppImage::PixelBlock)) ||
+				(e->dataOffset > length) ||
+				(data > (length - e->dataOffset))
+			) {
+				DUDS_THROW_EXCEPTION(ImageArchiveStreamTruncatedError() <<
+					ImageArchiveImageName(std::string(
+						base + std::min<std::size_t>(e->nameOffset, length),
+						std::min<std::size_t>(
+							e->nameLength,
+							length - std::min<std::size_t>(e->nameOffset, length)
+						)
+					))
+				);
+			}
+		}
+	} catch (boost::exception &be) {
+		munmap((void*)base, length);
+		be << ImageArchiveFileName(path);
+		throw;
+	}
+}
+
+BppImageArchiveMap::~BppImageArchiveMap() {
+	munmap((void*)base, length);
+}
+
+const BppImageArchiveMap::Entry *BppImageArchiveMap::find(
+	std::string_view name
+) const {
+	const Entry *end = index + count;
+	const Entry *iter = std::lower_bound(
+		index,
+		end,
+		name,
+		[this](const Entry &e, std::string_view n) {
+			return std::string_view(base + e.nameOffset, e.nameLength) < n;
+		}
+	);
+	if ((iter != end) &&
+		(std::string_view(base + iter->nameOffset, iter->nameLength) == name)
+	) {
+		return iter;
+	}
+	return nullptr;
+}
+
+BppImageView BppImageArchiveMap::get(std::string_view name) const {
+	const Entry *e = find(name);
+	if (!e) {
+		DUDS_THROW_EXCEPTION(ImageNotFoundError() <<
+			ImageArchiveImageName(std::string(name))
+		);
+	}
+	return image(e - index);
+}
+
+BppImageView BppImageArchiveMap::tryGet(std::string_view name) const {
+	const Entry *e = find(name);
+	if (!e) {
+		return BppImageView();
+	}
+	return image(e - index);
+}
+
+} } }
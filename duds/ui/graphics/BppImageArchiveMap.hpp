@@ -0,0 +1,182 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+#ifndef BPPIMAGEARCHIVEMAP_HPP
+#define BPPIMAGEARCHIVEMAP_HPP
+
+#include <duds/ui/graphics/BppImage.hpp>
+#include <boost/noncopyable.hpp>
+#include <string_view>
+
+namespace duds { namespace ui { namespace graphics {
+
+/**
+ * A read-only archive of images that is memory mapped from a file rather than
+ * read and parsed. The images are not copied; get() returns a BppImageView
+ * that references the mapped file, so opening an archive takes about the
+ * same time regardless of the number of images, and the pages holding the
+ * image data are shared with the page cache.
+ *
+ * The file is made by the @ref DUDStoolsBppic "Bit-Per-Pixel Image Compiler"
+ * (bppic) with its @c --map option. It is version 1 of the archive format;
+ * BppImageArchive reads version 0. All values are little endian:
+ * - Header, 32 bytes:
+ *   - "BPPI"
+ *   - 4 byte version number; 1.
+ *   - 4 byte size of a PixelBlock in bytes.
+ *   - 4 byte number of images.
+ *   - 4 byte offset of the index from the start of the file.
+ *   - 4 byte size of the file.
+ *   - 8 bytes reserved, all zero.
+ * - Index, 16 bytes per image, sorted by the byte values of the names:
+ *   - 4 byte offset of the name.
+ *   - 4 byte length of the name.
+ *   - 4 byte offset of the image data. It is a multiple of the PixelBlock
+ *     size.
+ *   - 2 byte width.
+ *   - 2 byte height.
+ * - The names, without terminators.
+ * - The image data in the same format used by BppImage; each line is a whole
+ *   number of PixelBlocks.
+ *
+ * Since the image data is used in place, the archive must be made with the
+ * PixelBlock size of the system that will use it, and can only be used on
+ * little endian systems.
+ *
+ * This class is thread safe; it cannot be modified after construction.
+ *
+ * @author  Jeff Jackowski
+ */
+class BppImageArchiveMap : boost::noncopyable {
+public:
+	/**
+	 * An entry in the archive's index.
+	 */
+	struct Entry {
+		/**
+		 * The offset of the name from the start of the file.
+		 */
+		std::uint32_t nameOffset;
+		/**
+		 * The length of the name in bytes.
+		 */
+		std::uint32_t nameLength;
+		/**
+		 * The offset of the image data from the start of the file.
+		 */
+		std::uint32_t dataOffset;
+		/**
+		 * The width of the image.
+		 */
+		std::uint16_t width;
+		/**
+		 * The height of the image.
+		 */
+		std::uint16_t height;
+	};
+private:
+	/**
+	 * The start of the mapped file.
+	 */
+	const char *base;
+	/**
+	 * The size of the mapped file.
+	 */
+	std::size_t length;
+	/**
+	 * The start of the sorted index.
+	 */
+	const Entry *index;
+	/**
+	 * The number of images.
+	 */
+	std::uint32_t count;
+	/**
+	 * Returns the index entry for the named image, or nullptr if there is no
+	 * such image.
+	 */
+	const Entry *find(std::string_view name) const;
+public:
+	/**
+	 * Maps the given archive file into memory and checks that its index
+	 * references data inside the file. The image data is not read.
+	 * @param path  The path of the archive file.
+	 * @throw ImageArchiveStreamError      Failed to open or map the file.
+	 * @throw ImageNotArchiveStreamError   The file is not an image archive.
+	 * @throw ImageArchiveUnsupportedVersionError
+	 *        The file is not version 1 of the archive format.
+	 * @throw ImageArchiveIncompatibleError
+	 *        The archive uses a different PixelBlock size, or this system is
+	 *        not little endian.
+	 * @throw ImageArchiveStreamTruncatedError
+	 *        The file is shorter than its header claims, or the index
+	 *        references data outside the file.
+	 */
+	BppImageArchiveMap(const std::string &path);
+	/**
+	 * Unmaps the file. All views obtained from this object become invalid.
+	 */
+	~BppImageArchiveMap();
+	/**
+	 * Returns a new BppImageArchiveMap object in a shared pointer.
+	 * @param path  The path of the archive file.
+	 */
+	static std::shared_ptr<BppImageArchiveMap> make(const std::string &path) {
+		return std::make_shared<BppImageArchiveMap>(path);
+	}
+	/**
+	 * Returns the number of images in the archive.
+	 */
+	std::size_t size() const {
+		return count;
+	}
+	/**
+	 * Returns the name of the image at the given position in the sorted
+	 * index. No bounds checking is performed.
+	 * @param idx  The position of the image; less than size().
+	 */
+	std::string_view name(std::size_t idx) const {
+		return std::string_view(
+			base + index[idx].nameOffset,
+			index[idx].nameLength
+		);
+	}
+	/**
+	 * Returns the image at the given position in the sorted index. No bounds
+	 * checking is performed.
+	 * @param idx  The position of the image; less than size().
+	 */
+	BppImageView image(std::size_t idx) const {
+		return BppImageView(
+			(const BppImage::PixelBlock*)(base + index[idx].dataOffset),
+			ImageDimensions(index[idx].width, index[idx].height)
+		);
+	}
+	/**
+	 * Returns the image with the given name using a binary search.
+	 * @param name  The name of the image to find.
+	 * @return      A view of the image inside the mapped file. It is valid
+	 *              for the life of this object.
+	 * @throw       ImageNotFoundError  The image @a name is not in the archive.
+	 */
+	BppImageView get(std::string_view name) const;
+	/**
+	 * Returns the image with the given name using a binary search.
+	 * @param name  The name of the image to find.
+	 * @return      A view of the image inside the mapped file, or an empty
+	 *              view if the image is not in the archive.
+	 */
+	BppImageView tryGet(std::string_view name) const;
+};
+
+typedef std::shared_ptr<BppImageArchiveMap>  BppImageArchiveMapSptr;
+
+} } }
+
+#endif        //  #ifndef BPPIMAGEARCHIVEMAP_HPP
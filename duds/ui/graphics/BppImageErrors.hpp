@@ -81,6 +81,12 @@ struct ImageArchiveStreamTruncatedError : ImageArchiveStreamError { };
  */
 struct ImageArchivePastEndError : ImageArchiveStreamError { };
 
+/**
+ * The archive's image data layout, such as its PixelBlock size or byte order,
+ * does not match the layout used on this system.
+ */
+struct ImageArchiveIncompatibleError : ImageArchiveStreamError { };
+
 /**
  * The name of the image involved in an ImageArchiveError.
  */
@@ -101,6 +107,12 @@ typedef boost::error_info<struct Info_ImageArcFileName, std::string>
 typedef boost::error_info<struct Info_ImageArcName, std::uint32_t>
 	ImageArchiveVersion;
 
+/**
+ * The size of a PixelBlock in bytes used by an image archive.
+ */
+typedef boost::error_info<struct Info_ImageArcBlockSize, std::uint32_t>
+	ImageArchiveBlockSize;
+
 /**
  * A glyph required to render a string is not availble in the font.
  */
@@ -14,11 +14,20 @@
 
 namespace duds { namespace ui { namespace graphics {
 
+BppStringCache::BppString::BppString(
+	ConstBppImageSptr &&i,
+	const std::u32string &t,
+	BppFont::Flags f,
+	std::uint64_t u
+) : img(std::move(i)), text(t), flags(f),
+bytes(img->data().size() * sizeof(BppImage::PixelBlock)), used(u) { }
+
 BppStringCache::BppStringCache(
 	const BppFontSptr &font,
 	unsigned int maxBytes,
 	unsigned int maxStrings
-) : fnt(font), maxB(maxBytes), maxS(maxStrings) {
+) : fnt(font), maxB(maxBytes), maxS(maxStrings), curB(0), curS(0), clock(0),
+hitCnt(0), missCnt(0), evictCnt(0) {
 	if (!maxS) {
 		DUDS_THROW_EXCEPTION(StringCacheZeroSize());
 	}
@@ -28,16 +37,153 @@ BppStringCache::BppStringCache(
 	BppFontSptr &&font,
 	unsigned int maxBytes,
 	unsigned int maxStrings
-) : fnt(std::move(font)), maxB(maxBytes), maxS(maxStrings) {
+) : fnt(std::move(font)), maxB(maxBytes), maxS(maxStrings), curB(0), curS(0),
+clock(0), hitCnt(0), missCnt(0), evictCnt(0) {
 	if (!maxS) {
 		DUDS_THROW_EXCEPTION(StringCacheZeroSize());
 	}
 }
 
+std::size_t BppStringCache::hash(
+	const std::u32string &str,
+	BppFont::Flags flags
+) {
+	std::size_t h = std::hash<std::u32string>()(str);
+	// combine with the flags like boost::hash_combine
+	return h ^ (flags.flags() + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
 void BppStringCache::clear() {
-	std::lock_guard<duds::general::Spinlock> lock(block);
-	cache.clear();
-	curB = 0;
+	for (Shard &s : shards) {
+		std::unique_lock<std::shared_mutex> lock(s.block);
+		for (const Cache::value_type &item : s.cache) {
+			curB -= item.second.bytes;
+		}
+		curS -= s.cache.size();
+		s.cache.clear();
+	}
+}
+
+void BppStringCache::resetStatistics() {
+	hitCnt = 0;
+	missCnt = 0;
+	evictCnt = 0;
+}
+
+BppStringCache::Cache::iterator BppStringCache::oldest(
+	Cache &cache,
+	const BppString *keep
+) {
+	Cache::iterator old = cache.end();
+	std::uint64_t oldUse = 0;
+	Cache::iterator iter = cache.begin();
+	for (; iter != cache.end(); ++iter) {
+		std::uint64_t use = iter->second.used.load(std::memory_order_relaxed);
+		if (
+			(&(iter->second) != keep) &&
+			((old == cache.end()) || (use < oldUse))
+		) {
+			old = iter;
+			oldUse = use;
+		}
+	}
+	return old;
+}
+
+bool BppStringCache::evictOne(const BppString *keep) {
+	// Other threads may use the cache between finding the shard and locking
+	// it for the removal, so try again if the shard has become empty.
+	for (int tries = ShardCount; tries > 0; --tries) {
+		// find the shard holding the least recently used string
+		Shard *victim = nullptr;
+		std::uint64_t oldUse = 0;
+		for (Shard &s : shards) {
+			std::shared_lock<std::shared_mutex> lock(s.block);
+			Cache::iterator iter = oldest(s.cache, keep);
+			if (iter != s.cache.end()) {
+				std::uint64_t use =
+					iter->second.used.load(std::memory_order_relaxed);
+				if (!victim || (use < oldUse)) {
+					victim = &s;
+					oldUse = use;
+				}
+			}
+		}
+		if (!victim) {
+			return false;
+		}
+		std::unique_lock<std::shared_mutex> lock(victim->block);
+		Cache::iterator iter = oldest(victim->cache, keep);
+		if (iter != victim->cache.end()) {
+			curB -= iter->second.bytes;
+			--curS;
+			victim->cache.erase(iter);
+			++evictCnt;
+			return true;
+		}
+	}
+	return false;
+}
+
+ConstBppImageSptr BppStringCache::find(
+	const std::u32string &str,
+	BppFont::Flags flags,
+	std::size_t hash
+) {
+	Shard &s = shard(hash);
+	{
+		std::shared_lock<std::shared_mutex> lock(s.block);
+		// attempt to find a match
+		std::pair<Cache::const_iterator, Cache::const_iterator> range =
+			s.cache.equal_range(hash);
+		for (; range.first != range.second; ++range.first) {
+			const BppString &item = range.first->second;
+			if ((item.flags == flags) && (item.text == str)) {
+				// mark as recently used; avoid writing to memory shared between
+				// threads if already marked
+				std::uint64_t now = clock.load(std::memory_order_relaxed);
+				if (item.used.load(std::memory_order_relaxed) != now) {
+					item.used.store(now, std::memory_order_relaxed);
+				}
+				++hitCnt;
+				return item.img;
+			}
+		}
+	}
+	// no match; it must be rendered without holding a lock
+	++missCnt;
+	ConstBppImageSptr img = fnt->render(str, flags);
+	const BppString *added;
+	{
+		std::unique_lock<std::shared_mutex> lock(s.block);
+		// Another thread may have rendered the same string while the lock was
+		// not held. Use the existing image so only one is kept.
+		std::pair<Cache::const_iterator, Cache::const_iterator> range =
+			s.cache.equal_range(hash);
+		for (; range.first != range.second; ++range.first) {
+			const BppString &item = range.first->second;
+			if ((item.flags == flags) && (item.text == str)) {
+				return item.img;
+			}
+		}
+		Cache::iterator iter = s.cache.emplace(
+			std::piecewise_construct,
+			std::forward_as_tuple(hash),
+			std::forward_as_tuple(std::move(img), str, flags, ++clock)
+		);
+		added = &(iter->second);
+		curB += added->bytes;
+		++curS;
+		img = added->img;
+	}
+	// enforce the cache size limits; keep the just added item even if it
+	// alone exceeds the byte limit
+	while (((curB > maxB) || (curS > maxS)) && (curS > 1)) {
+		if (!evictOne(added)) {
+			break;
+		}
+	}
+	return img;
 }
 
 ConstBppImageSptr BppStringCache::text(
@@ -50,57 +196,14 @@ ConstBppImageSptr BppStringCache::text(
 		// what the font already holds
 		return fnt->get(str[0]);
 	}
-	{
-		std::lock_guard<duds::general::Spinlock> lock(block);
-		// attempt to find a match
-		Cache::iterator iter = cache.find(std::make_tuple(str, flags));
-		if (iter != cache.end()) {
-			// move item to the end of the sequence
-			Cache::index<index_seq>::type::iterator siter =
-				cache.project<index_seq>(iter);
-			Cache::index<index_seq>::type &sidx = cache.get<index_seq>();
-			sidx.relocate(sidx.end(), siter);
-			return iter->img;
-		}
-	}
-	// no match; it must be rendered
-	BppImageSptr img = fnt->render(str, flags);
-	// much easier to get to size this way than through res later
-	unsigned int imgSize = img->data().size();
-	std::lock_guard<duds::general::Spinlock> lock(block);
-	// store the result for later
-	std::pair<Cache::iterator, bool> res =
-		cache.emplace(BppString{std::move(img), str, flags});
-	// insertion check
-	if (res.second) {
-		// update current image size sum
-		curB += imgSize * sizeof(BppImage::PixelBlock);
-		// cache size limit hit?
-		if ((curB > maxB) || (cache.size() > maxS)) {
-			Cache::index<index_seq>::type &sidx = cache.get<index_seq>();
-			// loop through removals
-			Cache::index<index_seq>::type::iterator iter = sidx.begin();
-			do {
-				// remove area from the sum
-				curB -= iter->img->data().size() * sizeof(BppImage::PixelBlock);
-				// remove item
-				iter = sidx.erase(iter);
-			}
-			// loop until size of data is within limits, or the just added item
-			// is the only item left
-			while ((curB > maxB) && (cache.size() > 1));
-		}
+	return find(str, flags, hash(str, flags));
+}
+
+ConstBppImageSptr BppStringCache::text(const Key &key) {
+	if (key.text().length() == 1) {
+		return fnt->get(key.text()[0]);
 	}
-	// else {
-		// Must have had multiple requests for the same string simultaneously
-		// that resulted in multiple renderings during time without a lock.
-		// Moving the lock to cover the whole function will prevent this, but
-		// I suspect this condition will be very rare, and releasing the lock
-		// during rendering will allow more time for multiple threads to use
-		// the cache without blocking.
-	// }
-	// return from item in cache
-	return res.first->img;
+	return find(key.text(), key.flags(), key.hash());
 }
 
 ConstBppImageSptr BppStringCache::text(
@@ -10,11 +10,10 @@
 #ifndef BPPSTRINGCACHE_HPP
 #define BPPSTRINGCACHE_HPP
 #include <duds/ui/graphics/BppFont.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/composite_key.hpp>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <array>
 
 namespace duds { namespace ui { namespace graphics {
 
@@ -23,9 +22,81 @@ namespace duds { namespace ui { namespace graphics {
  * strings that may need to be shown many times. The cache is limited in
  * size by the number of strings and the total size of all the rendered
  * images in bytes. All operations are thread-safe.
+ *
+ * The cache is split into several shards, each with its own lock, to reduce
+ * contention between threads. Finding a string already in the cache only
+ * requires a shared lock on one shard, so threads rendering to different
+ * displays can use the same cache concurrently. When the cache exceeds its
+ * limits, the least recently used string in the whole cache is removed.
+ * Finding it examines every shard, so removals cost more than finding a
+ * string. The hash of a string can be computed once and reused with a Key
+ * object.
+ *
  * @author  Jeff Jackowski
  */
 class BppStringCache : boost::noncopyable {
+public:
+	/**
+	 * A string, its rendering flags, and their hash. Using a Key object that
+	 * persists across many requests avoids hashing the string for each
+	 * request.
+	 */
+	class Key {
+		/**
+		 * The text.
+		 */
+		std::u32string txt;
+		/**
+		 * The font rendering flags.
+		 */
+		BppFont::Flags flgs;
+		/**
+		 * The hash of @a txt and @a flgs.
+		 */
+		std::size_t hsh;
+	public:
+		/**
+		 * Makes a key for the given string and flags.
+		 */
+		Key(
+			const std::u32string &str,
+			BppFont::Flags flags = BppFont::AlignLeft
+		) :
+		txt(str), flgs(flags), hsh(BppStringCache::hash(txt, flgs)) { }
+		/**
+		 * Makes a key for the given string and flags. The string is moved.
+		 */
+		Key(
+			std::u32string &&str,
+			BppFont::Flags flags = BppFont::AlignLeft
+		) :
+		txt(std::move(str)), flgs(flags), hsh(BppStringCache::hash(txt, flgs)) { }
+		/**
+		 * Returns the text.
+		 */
+		const std::u32string &text() const {
+			return txt;
+		}
+		/**
+		 * Returns the font rendering flags.
+		 */
+		BppFont::Flags flags() const {
+			return flgs;
+		}
+		/**
+		 * Returns the hash of the text and flags.
+		 */
+		std::size_t hash() const {
+			return hsh;
+		}
+	};
+	/**
+	 * Computes the hash used to find a rendered string in the cache.
+	 * @param str    The text.
+	 * @param flags  The font rendering flags.
+	 */
+	static std::size_t hash(const std::u32string &str, BppFont::Flags flags);
+private:
 	/**
 	 * The font to use for rendering.
 	 */
@@ -46,43 +117,55 @@ class BppStringCache : boost::noncopyable {
 		 * The font rendering flags.
 		 */
 		BppFont::Flags flags;
+		/**
+		 * The size of the image data in bytes.
+		 */
+		unsigned int bytes;
+		/**
+		 * The value of @a clock when the string was last requested. Updated
+		 * while only holding a shared lock.
+		 */
+		mutable std::atomic<std::uint64_t> used;
+		/**
+		 * Makes a new cache entry.
+		 */
+		BppString(
+			ConstBppImageSptr &&i,
+			const std::u32string &t,
+			BppFont::Flags f,
+			std::uint64_t u
+		);
+	};
+	/**
+	 * The container type for the rendered strings of a shard. It is keyed by
+	 * the hash of the string and flags; strings with the same hash are
+	 * compared to find a match.
+	 */
+	typedef std::unordered_multimap<std::size_t, BppString>  Cache;
+	/**
+	 * A portion of the cache with its own lock.
+	 */
+	struct Shard {
+		/**
+		 * The rendered strings.
+		 */
+		Cache cache;
+		/**
+		 * Protects @a cache. A shared lock is used for finding strings, and an
+		 * exclusive lock for changing the container.
+		 */
+		mutable std::shared_mutex block;
+	};
+	enum {
+		/**
+		 * The number of shards.
+		 */
+		ShardCount = 8
 	};
 	/**
-	 * The container type for the rendered strings.
-	 * It has two indices:
-	 * -# A combination of the string and the font rendering flags. Used to find
-	 *    existing items.
-	 * -# The sequence of access. Used to determine which item(s) to remove when
-	 *    the cache grows past its limits.
-	 */
-	typedef boost::multi_index::multi_index_container<
-		BppString,
-		boost::multi_index::indexed_by<
-			boost::multi_index::hashed_non_unique<
-				boost::multi_index::tag<struct index_text>,
-				boost::multi_index::composite_key<
-					BppString,
-					boost::multi_index::member<
-						BppString,
-						std::u32string,
-						&BppString::text
-					>,
-					boost::multi_index::member<
-						BppString,
-						BppFont::Flags,
-						&BppString::flags
-					>
-				>
-			>,
-			boost::multi_index::sequenced<
-				boost::multi_index::tag<struct index_seq>
-			>
-		>
-	> Cache;
-	/**
-	 * The cache of rendered strings.
-	 */
-	Cache cache;
+	 * The cache of rendered strings split into shards.
+	 */
+	std::array<Shard, ShardCount> shards;
 	/**
 	 * The maximum number of strings the cache may hold.
 	 */
@@ -94,11 +177,60 @@ class BppStringCache : boost::noncopyable {
 	/**
 	 * The current size of all rendered text images in the cache.
 	 */
-	unsigned int curB = 0;
+	std::atomic<unsigned int> curB;
+	/**
+	 * The current number of strings in the cache.
+	 */
+	std::atomic<unsigned int> curS;
+	/**
+	 * Advanced each time a string is added to the cache. Used to record when
+	 * strings were last requested. Requests that find a string use the
+	 * current value without changing it, so strings found between
+	 * additions are all equally recent.
+	 */
+	std::atomic<std::uint64_t> clock;
+	/**
+	 * Number of requests that found the string in the cache.
+	 */
+	std::atomic<std::uint64_t> hitCnt;
+	/**
+	 * Number of requests that required rendering the string.
+	 */
+	std::atomic<std::uint64_t> missCnt;
+	/**
+	 * Number of strings removed from the cache to respect the size limits.
+	 */
+	std::atomic<std::uint64_t> evictCnt;
+	/**
+	 * Returns the shard that holds strings with the given hash.
+	 */
+	Shard &shard(std::size_t hash) {
+		return shards[(hash ^ (hash >> 16)) % ShardCount];
+	}
+	/**
+	 * Finds a string in the cache, or renders it and adds it to the cache.
+	 * @param str    The text.
+	 * @param flags  The font rendering flags.
+	 * @param hash   The result of hash(str, flags).
+	 */
+	ConstBppImageSptr find(
+		const std::u32string &str,
+		BppFont::Flags flags,
+		std::size_t hash
+	);
 	/**
-	 * Used for thread safety.
+	 * Returns the least recently used string in @a cache other than @a keep,
+	 * or the end iterator if there is no such string.
+	 * @pre  The caller has a lock on the shard that holds @a cache.
 	 */
-	duds::general::Spinlock block;
+	static Cache::iterator oldest(Cache &cache, const BppString *keep);
+	/**
+	 * Removes the least recently used string in any shard other than
+	 * @a keep.
+	 * @param keep  The string that must not be removed.
+	 * @return      True if a string was removed.
+	 */
+	bool evictOne(const BppString *keep);
 public:
 	/**
 	 * Creates a cache of rendered strings made using the given font.
@@ -272,8 +404,33 @@ public:
 	 * Returns the number of currently stored cached strings.
 	 */
 	unsigned int strings() const {
-		return cache.size();
+		return curS;
+	}
+	/**
+	 * Returns the number of requests that found the string in the cache.
+	 * Requests for single character strings are not counted.
+	 */
+	std::uint64_t hits() const {
+		return hitCnt;
+	}
+	/**
+	 * Returns the number of requests that did not find the string in the
+	 * cache and caused it to be rendered.
+	 */
+	std::uint64_t misses() const {
+		return missCnt;
 	}
+	/**
+	 * Returns the number of strings removed from the cache to keep it within
+	 * its size limits. Strings removed by clear() are not counted.
+	 */
+	std::uint64_t evictions() const {
+		return evictCnt;
+	}
+	/**
+	 * Sets the hit, miss, and eviction counts to zero.
+	 */
+	void resetStatistics();
 	/**
 	 * Clears all text images from the cache.
 	 */
@@ -320,6 +477,17 @@ public:
 		const std::u32string &str,
 		BppFont::Flags flags = BppFont::AlignLeft
 	);
+	/**
+	 * Returns an image of the requested string either from a pre-rendered
+	 * item in the cache or by rendering a new image. This works like
+	 * text(const std::u32string &, BppFont::Flags), but uses the hash stored
+	 * in @a key rather than computing it.
+	 * @param key    The text and flags to render.
+	 * @return       A const image with the rendered text.
+	 * @throw        GlyphNotFoundError  A glyph in the text is not provided
+	 *                                   by the font.
+	 */
+	ConstBppImageSptr text(const Key &key);
 };
 
 /**
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * A benchmark comparing BppImage::write(), which copies a PixelBlock at a
+ * time, with copying the same image one pixel at a time using the ConstPixel
+ * and Pixel iterators. The images are sized like glyphs from an 8x16 font
+ * being written across a 128x64 display frame, such as an ST7920.
+ */
+
+#include <duds/ui/graphics/BppImage.hpp>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/program_options.hpp>
+
+namespace graphics = duds::ui::graphics;
+
+/**
+ * Writes the source into the destination one pixel at a time using image
+ * iterators. This is how BppImage::write() used to operate.
+ */
+void iterWrite(
+	graphics::BppImage &dest,
+	const graphics::BppImage &src,
+	const graphics::ImageLocation &loc,
+	graphics::BppImage::Operation op
+) {
+	graphics::BppImage::ConstPixel siter = src.cbegin(
+		graphics::ImageLocation(0, 0), src.dimensions()
+	);
+	graphics::BppImage::Pixel diter = dest.begin(loc, src.dimensions());
+	for (; siter != graphics::BppImage::EndPixel(); ++diter, ++siter) {
+		bool d = *diter, s = *siter;
+		switch (op) {
+			case graphics::BppImage::OpSet:
+				d = s;
+				break;
+			case graphics::BppImage::OpNot:
+				d = !s;
+				break;
+			case graphics::BppImage::OpAnd:
+				d = d && s;
+				break;
+			case graphics::BppImage::OpOr:
+				d = d || s;
+				break;
+			case graphics::BppImage::OpXor:
+				d = d ^ s;
+				break;
+			default:
+				break;
+		}
+		*diter = d;
+	}
+}
+
+/**
+ * Fills a frame with glyph sized images using the given function, and
+ * returns the time taken in nanoseconds.
+ */
+template <class WriteFunc>
+double timeFrames(
+	graphics::BppImage &frame,
+	const graphics::BppImage &glyph,
+	int frames,
+	WriteFunc func
+) {
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	for (int f = 0; f < frames; ++f) {
+		// offset each frame by a pixel to vary the block alignment
+		int off = f % glyph.width();
+		for (int y = 0; y + glyph.height() <= frame.height(); y += glyph.height()) {
+			for (
+				int x = off;
+				x + glyph.width() <= frame.width();
+				x += glyph.width()
+			) {
+				func(frame, glyph, graphics::ImageLocation(x, y));
+			}
+		}
+	}
+	std::chrono::steady_clock::time_point end =
+		std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main(int argc, char *argv[])
+try {
+	int frames, frameW, frameH, glyphW, glyphH;
+	{ // option parsing
+		boost::program_options::options_description optdesc(
+			"Options for bit-per-pixel image write benchmark"
+		);
+		optdesc.add_options()
+			( // help info
+				"help,h",
+				"Show this help message"
+			)
+			(
+				"frames,f",
+				boost::program_options::value<int>(&frames)->
+					default_value(2000),
+				"Number of frames to fill for each operation"
+			)
+			(
+				"width,x",
+				boost::program_options::value<int>(&frameW)->
+					default_value(128),
+				"Frame width in pixels"
+			)
+			(
+				"height,y",
+				boost::program_options::value<int>(&frameH)->
+					default_value(64),
+				"Frame height in pixels"
+			)
+			(
+				"gwidth",
+				boost::program_options::value<int>(&glyphW)->
+					default_value(8),
+				"Glyph width in pixels"
+			)
+			(
+				"gheight",
+				boost::program_options::value<int>(&glyphH)->
+					default_value(16),
+				"Glyph height in pixels"
+			)
+		;
+		boost::program_options::variables_map vm;
+		boost::program_options::store(
+			boost::program_options::parse_command_line(argc, argv, optdesc),
+			vm
+		);
+		boost::program_options::notify(vm);
+		if (vm.count("help")) {
+			std::cout << "Bit-per-pixel image write benchmark\n\t" << argv[0] <<
+			" [options]\n" << optdesc << std::endl;
+			return 0;
+		}
+	}
+	// make a glyph with random content
+	graphics::BppImage glyph(glyphW, glyphH);
+	std::mt19937 rng(7920);
+	for (int y = 0; y < glyphH; ++y) {
+		for (int x = 0; x < glyphW; ++x) {
+			glyph.state(x, y, (rng() & 1) != 0);
+		}
+	}
+	graphics::BppImage iterFrame(frameW, frameH), blitFrame(frameW, frameH);
+	static const char *opNames[graphics::BppImage::OpTotal] = {
+		"OpSet", "OpNot", "OpAnd", "OpOr", "OpXor"
+	};
+	std::cout << "Filling " << frames << " frames of " << frameW << 'x' <<
+	frameH << " with " << glyphW << 'x' << glyphH << " images\n";
+	for (int o = 0; o < graphics::BppImage::OpTotal; ++o) {
+		graphics::BppImage::Operation op = (graphics::BppImage::Operation)o;
+		iterFrame.clearImage();
+		blitFrame.clearImage();
+		double iterTime = timeFrames(iterFrame, glyph, frames,
+			[op](
+				graphics::BppImage &dest,
+				const graphics::BppImage &src,
+				const graphics::ImageLocation &loc
+			) {
+				iterWrite(dest, src, loc, op);
+			}
+		);
+		double blitTime = timeFrames(blitFrame, glyph, frames,
+			[op](
+				graphics::BppImage &dest,
+				const graphics::BppImage &src,
+				const graphics::ImageLocation &loc
+			) {
+				dest.write(&src, loc, src.dimensions(),
+					graphics::BppImage::HorizInc, op);
+			}
+		);
+		std::cout << opNames[o] << ":\n\titerator  " <<
+		iterTime / frames / 1000.0 << " us/frame\n\twrite()   " <<
+		blitTime / frames / 1000.0 << " us/frame\n\tspeedup   " <<
+		iterTime / blitTime << "x\n";
+		if (!(iterFrame == blitFrame)) {
+			std::cerr << "Results differ for " << opNames[o] << std::endl;
+			return 1;
+		}
+	}
+} catch (...) {
+	std::cerr << "Benchmark failed in main():\n" <<
+	boost::current_exception_diagnostic_information() << std::endl;
+	return 1;
+}
@@ -0,0 +1,211 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * A benchmark of the CPU time taken by instrument drivers to sample their
+ * devices. The devices are simulated using the buses in
+ * duds/hardware/interface/test and the device models in
+ * duds/hardware/devices/test, so no hardware is needed. The simulated bus
+ * latency adds to the elapsed time, but not much to the CPU time since it is
+ * a busy wait that is excluded from the reported driver cost.
+ */
+
+#include <duds/hardware/interface/test/VirtualI2c.hpp>
+#include <duds/hardware/interface/test/VirtualSmbus.hpp>
+#include <duds/hardware/devices/test/INA219Model.hpp>
+#include <duds/hardware/devices/test/MCP9808Model.hpp>
+#include <duds/hardware/devices/test/TSL2591Model.hpp>
+#include <duds/hardware/devices/test/LSM9DS1Model.hpp>
+#include <duds/hardware/devices/test/AMG88xxModel.hpp>
+#include <duds/hardware/devices/instruments/INA219.hpp>
+#include <duds/hardware/devices/instruments/MCP9808.hpp>
+#include <duds/hardware/devices/instruments/TSL2591.hpp>
+#include <duds/hardware/devices/instruments/LSM9DS1.hpp>
+#include <duds/hardware/devices/instruments/AMG88xx.hpp>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/program_options.hpp>
+
+namespace dhi = duds::hardware::interface;
+namespace dhit = duds::hardware::interface::test;
+namespace dhdt = duds::hardware::devices::test;
+namespace instr = duds::hardware::devices::instruments;
+
+/**
+ * Options applied to every simulated device.
+ */
+struct BenchConfig {
+	std::chrono::nanoseconds transLatency;
+	std::chrono::nanoseconds byteLatency;
+	unsigned int failPeriod;
+	int samples;
+};
+
+/**
+ * Applies the latency and error injection options to a device, then calls
+ * the sampling function repeatedly and reports the cost per sample.
+ * @param name     The name of the driver.
+ * @param dev      The simulated device.
+ * @param perCall  The number of samples obtained by each call to @a func.
+ * @post  Errors are no longer injected, but the latency remains.
+ */
+template <class SampleFunc>
+void bench(
+	const char *name,
+	const BenchConfig &bc,
+	dhit::VirtualDevice &dev,
+	int perCall,
+	SampleFunc func
+) {
+	dev.latency(bc.transLatency, bc.byteLatency);
+	dev.failEvery(bc.failPeriod);
+	dev.resetCounts();
+	int calls = bc.samples / perCall, fails = 0;
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	std::clock_t cpuStart = std::clock();
+	for (int c = 0; c < calls; ++c) {
+		try {
+			func();
+		} catch (...) {
+			++fails;
+		}
+	}
+	std::clock_t cpuEnd = std::clock();
+	std::chrono::steady_clock::time_point end =
+		std::chrono::steady_clock::now();
+	// allow the device to be reconfigured without errors
+	dev.failEvery(0);
+	double wall = std::chrono::duration<double, std::micro>(end - start).count();
+	double cpu = (double)(cpuEnd - cpuStart) * 1e6 / CLOCKS_PER_SEC;
+	// the busy wait for the latency counts as CPU time; remove it
+	double delay = std::chrono::duration<double, std::micro>(
+		bc.transLatency * dev.transactions() + bc.byteLatency * dev.bytes()
+	).count();
+	int samples = calls * perCall;
+	std::cout << std::left << std::setw(18) << name << std::right <<
+	std::fixed << std::setprecision(3) <<
+	std::setw(10) << (cpu - delay) / samples << " us CPU" <<
+	std::setw(10) << wall / samples << " us total" <<
+	std::setw(8) << (double)dev.transactions() / samples << " trans" <<
+	std::setw(9) << (double)dev.bytes() / samples << " bytes";
+	if (fails) {
+		std::cout << std::setw(7) << fails << " failures";
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
+try {
+	BenchConfig bc;
+	{ // option parsing
+		int tlat, blat;
+		boost::program_options::options_description optdesc(
+			"Options for simulated instrument driver benchmark"
+		);
+		optdesc.add_options()
+			( // help info
+				"help,h",
+				"Show this help message"
+			)
+			(
+				"samples,n",
+				boost::program_options::value<int>(&bc.samples)->
+					default_value(100000),
+				"Number of samples to take from each device"
+			)
+			(
+				"latency,l",
+				boost::program_options::value<int>(&tlat)->
+					default_value(0),
+				"Simulated time for each bus transaction in nanoseconds"
+			)
+			(
+				"bytelatency,b",
+				boost::program_options::value<int>(&blat)->
+					default_value(0),
+				"Simulated time for each byte in nanoseconds"
+			)
+			(
+				"fail,f",
+				boost::program_options::value<unsigned int>(&bc.failPeriod)->
+					default_value(0),
+				"Fail every Nth bus transaction; 0 for no failures"
+			)
+		;
+		boost::program_options::variables_map vm;
+		boost::program_options::store(
+			boost::program_options::parse_command_line(argc, argv, optdesc),
+			vm
+		);
+		boost::program_options::notify(vm);
+		if (vm.count("help")) {
+			std::cout << "Simulated instrument driver benchmark\n\t" <<
+			argv[0] << " [options]\n" << optdesc << std::endl;
+			return 0;
+		}
+		bc.transLatency = std::chrono::nanoseconds(tlat);
+		bc.byteLatency = std::chrono::nanoseconds(blat);
+	}
+	std::cout << "Cost per sample over " << bc.samples << " samples\n";
+	{
+		std::shared_ptr<dhdt::INA219Model> dev =
+			std::make_shared<dhdt::INA219Model>();
+		std::unique_ptr<dhi::Smbus> smbus(new dhit::VirtualSmbus(dev, 0x40));
+		instr::INA219 meter(smbus, 0.1);
+		bench("INA219", bc, *dev, 1, [&meter]() { meter.sample(); });
+	}
+	{
+		std::shared_ptr<dhdt::MCP9808Model> dev =
+			std::make_shared<dhdt::MCP9808Model>();
+		std::unique_ptr<dhi::Smbus> smbus(new dhit::VirtualSmbus(dev, 0x18));
+		instr::MCP9808 therm(smbus);
+		therm.start();
+		bench("MCP9808", bc, *dev, 1, [&therm]() { therm.sample(); });
+	}
+	{
+		std::shared_ptr<dhdt::TSL2591Model> dev =
+			std::make_shared<dhdt::TSL2591Model>();
+		std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(dev, 0x29));
+		instr::TSL2591 light(i2c);
+		light.init(1, 100);
+		bench("TSL2591", bc, *dev, 1, [&light]() { light.sample(); });
+	}
+	{
+		std::shared_ptr<dhdt::AMG88xxModel> dev =
+			std::make_shared<dhdt::AMG88xxModel>();
+		std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(dev, 0x69));
+		instr::AMG88xx cam(i2c);
+		cam.start();
+		bench("AMG88xx", bc, *dev, 1, [&cam]() { cam.sample(); });
+	}
+	{
+		std::shared_ptr<dhdt::LSM9DS1AccelGyroModel> dev =
+			std::make_shared<dhdt::LSM9DS1AccelGyroModel>();
+		std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(dev, 0x6B));
+		instr::LSM9DS1AccelGyro imu(i2c);
+		instr::LSM9DS1AccelGyro::Settings cfg = { };
+		cfg.accelerometer = cfg.gyroscope = 1;
+		imu.configure(952, cfg);
+		bench("LSM9DS1", bc, *dev, 1, [&imu]() { imu.sample(); });
+		cfg.fifo = 1;
+		imu.configure(952, cfg);
+		// a full FIFO on every read
+		dev->fifoLevel(32);
+		bench("LSM9DS1 FIFO", bc, *dev, 32, [&imu]() { imu.sampleFifo(); });
+	}
+} catch (...) {
+	std::cerr << "Benchmark failed in main():\n" <<
+	boost::current_exception_diagnostic_information() << std::endl;
+	return 1;
+}
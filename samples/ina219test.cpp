@@ -9,6 +9,7 @@
  */
 #include <duds/hardware/devices/instruments/INA219.hpp>
 #include <duds/hardware/interface/linux/DevSmbus.hpp>
+#include <duds/hardware/devices/SampleScheduler.hpp>
 #include <iostream>
 #include <thread>
 #include <iomanip>
@@ -16,31 +17,26 @@
 #include <boost/exception/diagnostic_information.hpp>
 
 constexpr int valw = 8;
-bool quit = false;
 
-void runtest(duds::hardware::devices::instruments::INA219 &ina) {
-	std::cout.precision(5);
+void showSample(duds::hardware::devices::instruments::INA219 &ina) {
 	std::int16_t sv, bv;
-	do {
-		ina.sample();
-		duds::data::Quantity shnV = ina.shuntVoltage();
-		duds::data::Quantity busV = ina.busVoltage();
-		duds::data::Quantity busI = ina.busCurrent();
-		assert(busV.unit == duds::data::units::Volt);
-		assert(busI.unit == duds::data::units::Ampere);
-		assert(shnV.unit == duds::data::units::Volt);
-		duds::data::Quantity busP = busV * busI;
-		assert(busP.unit == duds::data::units::Watt);
-		ina.vals(sv, bv);
-		std::cout << "Shunt: " << std::setw(valw) << shnV.value <<
-			"v   Bus: " << std::setw(valw) << busV.value << "v  " <<
-			std::setw(valw) << busI.value << "A  " << std::setw(valw) << 
-			busP.value <<
-			//'W' << std::endl;
-			"W   s = " << std::setw(valw-2) << sv << " b = " << 
-			std::setw(valw-2) << bv << std::endl;
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-	} while (!quit);
+	ina.sample();
+	duds::data::Quantity shnV = ina.shuntVoltage();
+	duds::data::Quantity busV = ina.busVoltage();
+	duds::data::Quantity busI = ina.busCurrent();
+	assert(busV.unit == duds::data::units::Volt);
+	assert(busI.unit == duds::data::units::Ampere);
+	assert(shnV.unit == duds::data::units::Volt);
+	duds::data::Quantity busP = busV * busI;
+	assert(busP.unit == duds::data::units::Watt);
+	ina.vals(sv, bv);
+	std::cout << "Shunt: " << std::setw(valw) << shnV.value <<
+		"v   Bus: " << std::setw(valw) << busV.value << "v  " <<
+		std::setw(valw) << busI.value << "A  " << std::setw(valw) << 
+		busP.value <<
+		//'W' << std::endl;
+		"W   s = " << std::setw(valw-2) << sv << " b = " << 
+		std::setw(valw-2) << bv << std::endl;
 }
 
 int main(void)
@@ -54,10 +50,24 @@ try {
 	);
 	duds::hardware::devices::instruments::INA219 meter(smbus, 0.1);
 	std::this_thread::sleep_for(std::chrono::milliseconds(2));
-	std::thread doit(runtest, std::ref(meter));
+	std::cout.precision(5);
+	// sample once a second without drifting
+	duds::hardware::devices::SampleScheduler sched;
+	unsigned int task = sched.add(
+		[&meter]() { showSample(meter); },
+		std::chrono::seconds(1),
+		"/dev/i2c-1"
+	);
+	sched.start();
 	std::cin.get();
-	quit = true;
-	doit.join();
+	sched.stop();
+	duds::hardware::devices::SampleScheduler::Statistics st =
+		sched.statistics(task);
+	std::cout << "Samples: " << st.runs << "  overruns: " << st.overruns <<
+		"  max jitter: " << st.maxJitter.count() << "ns" << std::endl;
+	if (st.failures) {
+		std::rethrow_exception(sched.lastError(task));
+	}
 } catch (...) {
 	std::cerr << "ERROR: " << boost::current_exception_diagnostic_information()
 	<< std::endl;
@@ -0,0 +1,151 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of duds::hardware::display::AsyncBppGraphicDisplay.
+ */
+#include <duds/hardware/display/AsyncBppGraphicDisplay.hpp>
+#include <duds/hardware/display/DisplayErrors.hpp>
+#include <duds/general/Errors.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <condition_variable>
+#include <mutex>
+
+namespace DHD = duds::hardware::display;
+namespace BPPN = duds::ui::graphics;
+
+/**
+ * A display that waits for the test to allow each frame to be output and
+ * remembers the frames it was given.
+ */
+class SlowDisplay : public DHD::BppGraphicDisplay {
+	std::mutex block;
+	std::condition_variable cv;
+	/**
+	 * The number of frames that may be output before waiting again; negative
+	 * to never wait.
+	 */
+	int permits;
+	/**
+	 * The number of calls to outputFrame().
+	 */
+	int entered = 0;
+	virtual void outputFrame(
+		const BPPN::BppImage *img,
+		const BPPN::ImageDamage *
+	) {
+		{
+			std::unique_lock<std::mutex> lock(block);
+			++entered;
+			cv.notify_all();
+			cv.wait(lock, [this]() { return permits != 0; });
+			if (permits > 0) {
+				--permits;
+			}
+		}
+		if (fail) {
+			fail = false;
+			DUDS_THROW_EXCEPTION(DHD::DisplayUninitialized());
+		}
+		frmbuf = *img;
+		shown.push_back(img->state(0, 0) ? 1 : 0);
+		sentBytes(3);
+	}
+public:
+	std::vector<int> shown;
+	bool fail = false;
+	SlowDisplay(int p = -1) :
+	BppGraphicDisplay(BPPN::ImageDimensions(16, 8)), permits(p) {
+		// as if sent while initializing
+		sentBytes(10);
+	}
+	/**
+	 * Allows @a n more frames to be output.
+	 */
+	void allow(int n) {
+		std::lock_guard<std::mutex> lock(block);
+		permits += n;
+		cv.notify_all();
+	}
+	/**
+	 * Waits until outputFrame() has been called @a n times.
+	 */
+	void waitEntered(int n) {
+		std::unique_lock<std::mutex> lock(block);
+		cv.wait(lock, [this, n]() { return entered >= n; });
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(AsyncBppGraphicDisplay)
+
+BOOST_AUTO_TEST_CASE(AsyncBppGraphicDisplay_LatestWins) {
+	std::shared_ptr<SlowDisplay> slow = std::make_shared<SlowDisplay>(0);
+	DHD::AsyncBppGraphicDisplay async(slow);
+	BOOST_CHECK_EQUAL(async.dimensions(), slow->dimensions());
+	BOOST_CHECK_EQUAL(async.totalBytes(), 10);
+	BPPN::BppImage img(16, 8);
+	img.clearImage();
+	// first frame is taken by the worker, which then waits on the display
+	async.write(&img);
+	slow->waitEntered(1);
+	// these replace each other while the first is output
+	for (int i = 0; i < 4; ++i) {
+		img.state(0, 0, (i & 1) == 0);
+		async.write(&img);
+	}
+	BOOST_CHECK(async.frame() == img);
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	slow->allow(2);
+	async.flush();
+	DHD::AsyncBppGraphicDisplay::Statistics stats = async.statistics();
+	BOOST_CHECK_EQUAL(stats.output, 2);
+	BOOST_CHECK_EQUAL(stats.dropped, 3);
+	BOOST_CHECK(stats.maxLatency >= std::chrono::milliseconds(2));
+	BOOST_CHECK(stats.totalLatency >= stats.maxLatency);
+	BOOST_REQUIRE_EQUAL(slow->shown.size(), 2);
+	BOOST_CHECK_EQUAL(slow->shown[1], 0);
+	BOOST_CHECK(slow->frame() == img);
+	async.resetStatistics();
+	BOOST_CHECK_EQUAL(async.statistics().output, 0);
+	// byte counts come from the wrapped display
+	BOOST_CHECK_EQUAL(async.frames(), 5);
+	BOOST_CHECK_EQUAL(async.lastFrameBytes(), 3);
+	BOOST_CHECK_EQUAL(async.totalBytes(), 16);
+	BOOST_CHECK_EQUAL(slow->totalBytes(), 16);
+	async.resetCounters();
+	BOOST_CHECK_EQUAL(async.frames(), 0);
+	BOOST_CHECK_EQUAL(async.lastFrameBytes(), 0);
+	BOOST_CHECK_EQUAL(async.totalBytes(), 0);
+	BOOST_CHECK_EQUAL(slow->totalBytes(), 16);
+	slow->allow(1);
+	async.write(&img);
+	async.flush();
+	BOOST_CHECK_EQUAL(async.totalBytes(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncBppGraphicDisplay_Error) {
+	std::shared_ptr<SlowDisplay> slow = std::make_shared<SlowDisplay>();
+	DHD::AsyncBppGraphicDisplay async(slow);
+	BPPN::BppImage img(16, 8);
+	img.clearImage();
+	slow->fail = true;
+	async.write(&img);
+	BOOST_CHECK_THROW(async.flush(), DHD::DisplayUninitialized);
+	// error is only reported once
+	BOOST_CHECK_NO_THROW(async.write(&img));
+	BOOST_CHECK_NO_THROW(async.flush());
+	BOOST_CHECK_EQUAL(async.statistics().output, 1);
+	// wrong size
+	BPPN::BppImage big(17, 8);
+	BOOST_CHECK_THROW(async.write(&big), DHD::DisplaySizeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,11 +15,32 @@
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 #include <duds/ui/graphics/BppFontPool.hpp>
+#include <duds/ui/graphics/BppFontAtlas.hpp>
+#include <duds/ui/graphics/BppStringCache.hpp>
+#include <duds/ui/graphics/BppImageErrors.hpp>
+#include <atomic>
 #include <set>
 #include <iostream>
+#include <random>
+#include <thread>
 
 namespace BPPN = duds::ui::graphics; // Bit Per Pixel Namespace
 
+/**
+ * Returns the path to the 8x16 font archive.
+ */
+static std::string fontPath() {
+	std::string imgpath(boost::unit_test::framework::master_test_suite().argv[0]);
+	int found = 0;
+	while (!imgpath.empty() && (found < 3)) {
+		imgpath.pop_back();
+		if (imgpath.back() == '/') {
+			++found;
+		}
+	}
+	return imgpath + "images/font_8x16.bppia";
+}
+
 BOOST_AUTO_TEST_SUITE(BppFont)
 
 BOOST_AUTO_TEST_CASE(BppFont_Pool) {
@@ -27,17 +48,7 @@ BOOST_AUTO_TEST_CASE(BppFont_Pool) {
 	BPPN::BppFontSptr font = pool.getFont("8x16");
 	BOOST_CHECK(!font);
 	// find the path to the font
-	std::string imgpath(boost::unit_test::framework::master_test_suite().argv[0]);
-	{
-		int found = 0;
-		while (!imgpath.empty() && (found < 3)) {
-			imgpath.pop_back();
-			if (imgpath.back() == '/') {
-				++found;
-			}
-		}
-		imgpath += "images/font_8x16.bppia";
-	}
+	std::string imgpath = fontPath();
 	// test adding font to the pool
 	BOOST_REQUIRE_NO_THROW(pool.addWithCache("8x16", imgpath));
 	font = pool.getFont("8x16");
@@ -83,4 +94,205 @@ BOOST_AUTO_TEST_CASE(BppFont_Pool) {
 	BOOST_CHECK(pool.getFont("8x16") == pool.getFont("TallFont"));
 }
 
+BOOST_AUTO_TEST_CASE(BppFont_Atlas) {
+	BPPN::BppFontSptr font;
+	BOOST_REQUIRE_NO_THROW(font = BPPN::BppFont::make(fontPath()));
+	BPPN::ConstBppFontAtlasSptr atlas = font->makeAtlas();
+	BOOST_REQUIRE(atlas);
+	BOOST_CHECK(atlas->size() > 90);
+	BOOST_CHECK_EQUAL(atlas->maxGlyphDimensions(), BPPN::ImageDimensions(8, 16));
+	BOOST_REQUIRE(atlas->find('W'));
+	BOOST_CHECK_EQUAL(atlas->find('W')->dim, font->get('W')->dimensions());
+	// same output as BppFont::render()
+	const std::u32string text(U"Hi, Atlas!");
+	BPPN::BppImageSptr ref = font->render(text);
+	BOOST_CHECK_EQUAL(atlas->textDimensions(text), ref->dimensions());
+	BPPN::BppImage img(ref->dimensions());
+	img.clearImage();
+	BOOST_CHECK_EQUAL(
+		atlas->render(img, BPPN::ImageLocation(0, 0), text),
+		ref->dimensions()
+	);
+	BOOST_CHECK(img == *ref);
+	// fixed width and multiple lines
+	ref = font->render(U"ab\ncd", BPPN::BppFont::FixedWidth);
+	img.resize(ref->dimensions());
+	img.clearImage();
+	atlas->render(img, BPPN::ImageLocation(0, 0), U"ab\ncd",
+		BPPN::BppFont::FixedWidth);
+	BOOST_CHECK(img == *ref);
+	// clipped at every edge; compare with a larger image
+	BPPN::BppImage big(40, 40), clip(20, 20);
+	big.clearImage();
+	clip.clearImage();
+	atlas->render(big, BPPN::ImageLocation(5, 7), U"XYZ\nxyz");
+	atlas->render(clip, BPPN::ImageLocation(-5, -3), U"XYZ\nxyz");
+	for (int y = 0; y < 20; ++y) {
+		for (int x = 0; x < 20; ++x) {
+			BOOST_CHECK_EQUAL(clip.state(x, y), big.state(x + 10, y + 10));
+		}
+	}
+	// a glyph the font lacks
+	BPPN::BppFontSptr empty = BPPN::BppFont::make();
+	atlas = empty->makeAtlas();
+	BOOST_CHECK_EQUAL(atlas->size(), 0);
+	BOOST_CHECK_THROW(atlas->render(img, BPPN::ImageLocation(0, 0), U"a"),
+		BPPN::GlyphNotFoundError);
+}
+
+BOOST_AUTO_TEST_CASE(BppFont_RenderInto) {
+	// font with glyphs of varying sizes and random content
+	BPPN::BppFontSptr font = BPPN::BppFont::make();
+	std::mt19937 rng(8);
+	const char32_t chars[] = U"abcdefg";
+	for (int c = 0; chars[c]; ++c) {
+		BPPN::BppImageSptr g = BPPN::BppImage::make(3 + c % 4, 4 + (c * 3) % 5);
+		for (int y = 0; y < g->height(); ++y) {
+			for (int x = 0; x < g->width(); ++x) {
+				g->state(x, y, (rng() & 1) != 0);
+			}
+		}
+		font->add(chars[c], g);
+	}
+	const std::u32string text(U"abc\ndefga\n\ng");
+	const BPPN::BppFont::Flags flagSets[] = {
+		BPPN::BppFont::AlignLeft,
+		BPPN::BppFont::AlignCenter,
+		BPPN::BppFont::AlignRight | BPPN::BppFont::VariableHeight,
+		BPPN::BppFont::FixedWidth | BPPN::BppFont::AlignCenter,
+		BPPN::BppFont::FixedWidthPerLine | BPPN::BppFont::AlignRight,
+		BPPN::BppFont::FixedWidth | BPPN::BppFont::VariableHeight
+	};
+	for (BPPN::BppFont::Flags flags : flagSets) {
+		BPPN::BppImageSptr txt = font->render(text, flags);
+		BOOST_CHECK_EQUAL(font->textDimensions(text, flags), txt->dimensions());
+		for (int o = 0; o < BPPN::BppImage::OpTotal; ++o) {
+			BPPN::BppImage::Operation op = (BPPN::BppImage::Operation)o;
+			BPPN::BppImage dest(64, 48);
+			for (int y = 0; y < dest.height(); ++y) {
+				for (int x = 0; x < dest.width(); ++x) {
+					dest.state(x, y, (rng() & 1) != 0);
+				}
+			}
+			BPPN::BppImage ref(dest);
+			ref.write(txt, BPPN::ImageLocation(5, 3), BPPN::BppImage::HorizInc,
+				op);
+			BOOST_CHECK_EQUAL(
+				font->render(dest, BPPN::ImageLocation(5, 3), text, flags, op),
+				txt->dimensions()
+			);
+			BOOST_CHECK(dest == ref);
+			// clipped on the upper-left
+			BPPN::BppImage clip(8, 8);
+			clip.clearImage();
+			ref = clip;
+			font->render(clip, BPPN::ImageLocation(-3, -2), text, flags, op);
+			ref.writeClipped(txt.get(), BPPN::ImageLocation(-3, -2),
+				BPPN::ImageLocation(0, 0), txt->dimensions(), op);
+			BOOST_CHECK(clip == ref);
+		}
+	}
+	// missing glyph leaves the image alone
+	BPPN::BppImage dest(20, 20);
+	dest.clearImage();
+	BOOST_CHECK_THROW(
+		font->render(dest, BPPN::ImageLocation(0, 0), U"az"),
+		BPPN::GlyphNotFoundError
+	);
+	BPPN::BppImage blank(20, 20);
+	blank.clearImage();
+	BOOST_CHECK(dest == blank);
+}
+
+BOOST_AUTO_TEST_CASE(BppFont_StringCacheLimits) {
+	BPPN::BppFontSptr font;
+	BOOST_REQUIRE_NO_THROW(font = BPPN::BppFont::make(fontPath()));
+	BPPN::BppStringCache cache(font, 1024 * 1024, 4);
+	const std::u32string strs[] = { U"ab", U"cd", U"ef", U"gh", U"ij", U"kl" };
+	for (const std::u32string &str : strs) {
+		cache.text(str);
+	}
+	BOOST_CHECK_EQUAL(cache.strings(), 4);
+	BOOST_CHECK_EQUAL(cache.misses(), 6);
+	BOOST_CHECK_EQUAL(cache.evictions(), 2);
+	BOOST_CHECK_EQUAL(cache.hits(), 0);
+	// each image is 16x16 and uses a whole number of PixelBlocks per line
+	BOOST_CHECK_EQUAL(cache.bytes(), 4 * 16 * sizeof(BPPN::BppImage::PixelBlock));
+	// the most recent string is kept
+	BPPN::ConstBppImageSptr img = cache.text(U"kl");
+	BOOST_CHECK_EQUAL(cache.hits(), 1);
+	// a key with a precomputed hash finds the same image
+	BPPN::BppStringCache::Key key(U"kl");
+	BOOST_CHECK(cache.text(key) == img);
+	BOOST_CHECK_EQUAL(cache.hits(), 2);
+	// flags are part of the key
+	BOOST_CHECK(cache.text(U"kl", BPPN::BppFont::FixedWidth) != img);
+	BOOST_CHECK_EQUAL(cache.misses(), 7);
+	cache.clear();
+	BOOST_CHECK_EQUAL(cache.strings(), 0);
+	BOOST_CHECK_EQUAL(cache.bytes(), 0);
+	cache.resetStatistics();
+	BOOST_CHECK_EQUAL(cache.misses(), 0);
+	// a byte limit below the size of one image keeps only the newest image
+	BPPN::BppStringCache tiny(font, 1);
+	tiny.text(U"ab");
+	tiny.text(U"cd");
+	BOOST_CHECK_EQUAL(tiny.strings(), 1);
+	BOOST_CHECK_EQUAL(tiny.evictions(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(BppFont_StringCacheLeastRecent) {
+	BPPN::BppFontSptr font;
+	BOOST_REQUIRE_NO_THROW(font = BPPN::BppFont::make(fontPath()));
+	BPPN::BppStringCache cache(font, 1024 * 1024, 4);
+	cache.text(U"ab");
+	cache.text(U"cd");
+	cache.text(U"ef");
+	cache.text(U"gh");
+	// make "ab" recently used so that "cd" is the oldest in any shard
+	cache.text(U"ab");
+	cache.text(U"ij");
+	BOOST_CHECK_EQUAL(cache.evictions(), 1);
+	BOOST_CHECK_EQUAL(cache.misses(), 5);
+	const std::u32string kept[] = { U"ab", U"ef", U"gh", U"ij" };
+	for (const std::u32string &str : kept) {
+		cache.text(str);
+	}
+	BOOST_CHECK_EQUAL(cache.misses(), 5);
+	BOOST_CHECK_EQUAL(cache.hits(), 5);
+	cache.text(U"cd");
+	BOOST_CHECK_EQUAL(cache.misses(), 6);
+}
+
+BOOST_AUTO_TEST_CASE(BppFont_StringCacheThreads) {
+	BPPN::BppFontSptr font;
+	BOOST_REQUIRE_NO_THROW(font = BPPN::BppFont::make(fontPath()));
+	BPPN::BppStringCache cache(font, 1024 * 1024, 24);
+	std::vector<std::thread> threads;
+	// Boost.Test checks are not thread-safe; count failures for checking
+	// after the threads finish
+	std::atomic<int> badWidths(0);
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&cache, &badWidths, t]() {
+			std::mt19937 rng(t);
+			for (int i = 0; i < 2000; ++i) {
+				std::u32string str(U"s");
+				str.push_back(U'a' + rng() % 26);
+				BPPN::ConstBppImageSptr img = cache.text(str);
+				if (img->width() != 16) {
+					++badWidths;
+				}
+			}
+		});
+	}
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	BOOST_CHECK_EQUAL(badWidths.load(), 0);
+	BOOST_CHECK(cache.strings() <= 24);
+	BOOST_CHECK_EQUAL(cache.hits() + cache.misses(), 8000);
+	// a miss that loses a race to render the same string is not stored
+	BOOST_CHECK(cache.strings() <= cache.misses() - cache.evictions());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,9 +15,13 @@
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 #include <duds/ui/graphics/BppImageArchive.hpp>
+#include <duds/ui/graphics/BppImageArchiveMap.hpp>
+#include <duds/ui/graphics/BppBlockKernels.hpp>
 #include <duds/ui/graphics/BppImageErrors.hpp>
 #include <set>
 #include <iostream>
+#include <random>
+#include <algorithm>
 
 namespace BPPN = duds::ui::graphics; // Bit Per Pixel Namespace
 
@@ -60,6 +64,74 @@ BOOST_AUTO_TEST_CASE(BppImage_Archive) {
 	BOOST_CHECK_EQUAL(names.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(BppImage_ArchiveMap) {
+	BOOST_CHECK_THROW(
+		BPPN::BppImageArchiveMap("not_there"),
+		BPPN::ImageArchiveStreamError
+	);
+	// the stream format is version 0
+	BOOST_CHECK_THROW(
+		BPPN::BppImageArchiveMap(TEST_PATH "BppImageGood.bppia"),
+		BPPN::ImageArchiveUnsupportedVersionError
+	);
+	BPPN::BppImageArchiveMapSptr map;
+	BOOST_REQUIRE_NO_THROW(
+		map = BPPN::BppImageArchiveMap::make(TEST_PATH "BppImageGood.bppim")
+	);
+	BOOST_CHECK_THROW(map->get("not_there"), BPPN::ImageNotFoundError);
+	BOOST_CHECK(map->tryGet("not_there").empty());
+	BOOST_CHECK(map->tryGet("Zebr").empty());
+	BOOST_CHECK(map->tryGet("Zebras").empty());
+	// same images as the stream format, sorted by name
+	BPPN::BppImageArchive arc(TEST_PATH "BppImageGood.bppia");
+	BOOST_REQUIRE_EQUAL(map->size(), 6);
+	for (std::size_t i = 0; i < map->size(); ++i) {
+		if (i) {
+			BOOST_CHECK(map->name(i - 1) < map->name(i));
+		}
+		std::string name(map->name(i));
+		BPPN::BppImageView view;
+		BOOST_REQUIRE_NO_THROW(view = map->get(name));
+		BOOST_CHECK_EQUAL(view.buffer(), map->image(i).buffer());
+		BPPN::BppImageSptr img = arc.get(name);
+		BOOST_CHECK_EQUAL(view.width(), img->width());
+		BOOST_CHECK_EQUAL(view.height(), img->height());
+		BOOST_CHECK(BPPN::BppImage(view) == *img);
+	}
+	// write from a view
+	BPPN::BppImageView zebra = map->get("Zebra");
+	BPPN::BppImage dest(12, 10);
+	dest.clearImage();
+	dest.write(zebra, BPPN::ImageLocation(3, 1));
+	BPPN::BppImage expect(12, 10);
+	expect.clearImage();
+	expect.write(arc.get("Zebra"), BPPN::ImageLocation(3, 1));
+	BOOST_CHECK(dest == expect);
+	BOOST_CHECK_THROW(
+		dest.write(zebra, BPPN::ImageLocation(5, 5)),
+		BPPN::ImageBoundsError
+	);
+	dest.clearImage();
+	dest.writeClipped(
+		zebra,
+		BPPN::ImageLocation(-2, 6),
+		BPPN::ImageLocation(0, 0),
+		zebra.dimensions(),
+		BPPN::BppImage::OpXor
+	);
+	expect.clearImage();
+	expect.writeClipped(
+		arc.get("Zebra").get(),
+		BPPN::ImageLocation(-2, 6),
+		BPPN::ImageLocation(0, 0),
+		zebra.dimensions(),
+		BPPN::BppImage::OpXor
+	);
+	BOOST_CHECK(dest == expect);
+	// a view of an image
+	BOOST_CHECK(BPPN::BppImage(expect.view()) == expect);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -400,3 +472,429 @@ BOOST_AUTO_TEST_CASE(BppImage_BarsVertDec) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+
+
+/**
+ * Writes one image into another using the pixel iterators; the reference
+ * result for the PixelBlock based write.
+ */
+static void pixelWrite(
+	BPPN::BppImage &dest,
+	const BPPN::BppImage &src,
+	const BPPN::ImageLocation &destLoc,
+	const BPPN::ImageLocation &srcLoc,
+	const BPPN::ImageDimensions &size,
+	BPPN::BppImage::Operation op
+) {
+	for (int y = 0; y < size.h; ++y) {
+		for (int x = 0; x < size.w; ++x) {
+			bool s = src.state(srcLoc.x + x, srcLoc.y + y);
+			bool d = dest.state(destLoc.x + x, destLoc.y + y);
+			switch (op) {
+				case BPPN::BppImage::OpSet:
+					d = s;
+					break;
+				case BPPN::BppImage::OpNot:
+					d = !s;
+					break;
+				case BPPN::BppImage::OpAnd:
+					d = d && s;
+					break;
+				case BPPN::BppImage::OpOr:
+					d = d || s;
+					break;
+				case BPPN::BppImage::OpXor:
+					d = d ^ s;
+					break;
+				default:
+					break;
+			}
+			dest.state(destLoc.x + x, destLoc.y + y, d);
+		}
+	}
+}
+
+static void randomImage(BPPN::BppImage &img, std::mt19937 &rng) {
+	for (int y = 0; y < img.height(); ++y) {
+		for (int x = 0; x < img.width(); ++x) {
+			img.state(x, y, (rng() & 1) != 0);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(BppImage_Blit)
+
+BOOST_AUTO_TEST_CASE(BppImage_BlitMatchesPixels) {
+	std::mt19937 rng(7920);
+	// source wider than two PixelBlocks to cover shifts across blocks
+	BPPN::BppImage src(150, 12);
+	randomImage(src, rng);
+	BPPN::BppImage dest(200, 12), ref;
+	randomImage(dest, rng);
+	const BPPN::ImageLocation srcLocs[] = {
+		{ 0, 0 }, { 1, 2 }, { 31, 1 }, { 63, 0 }, { 64, 3 }, { 77, 1 }
+	};
+	const BPPN::ImageDimensions sizes[] = {
+		{ 1, 1 }, { 5, 5 }, { 32, 4 }, { 64, 6 }, { 65, 2 }, { 70, 7 }
+	};
+	const int destXs[] = { 0, 1, 7, 31, 32, 63, 64, 100, 129 };
+	for (int o = BPPN::BppImage::OpSet; o < BPPN::BppImage::OpTotal; ++o) {
+		BPPN::BppImage::Operation op = (BPPN::BppImage::Operation)o;
+		for (const BPPN::ImageLocation &sl : srcLocs) {
+			for (const BPPN::ImageDimensions &sz : sizes) {
+				for (int dx : destXs) {
+					BPPN::ImageLocation dl(dx, 3);
+					ref = dest;
+					pixelWrite(ref, src, dl, sl, sz, op);
+					BOOST_REQUIRE_NO_THROW(dest.write(&src, dl, sl, sz,
+						BPPN::BppImage::HorizInc, op));
+					BOOST_CHECK_MESSAGE(
+						dest == ref,
+						"Bad blit with op " << o << " from " << sl << ' ' << sz <<
+						" to " << dl
+					);
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_BlitBounds) {
+	BPPN::BppImage src(20, 10), dest(40, 10), empty;
+	src.clearImage();
+	dest.clearImage();
+	// source region beyond source image
+	BOOST_CHECK_THROW(
+		dest.write(&src, BPPN::ImageLocation(0, 0), BPPN::ImageLocation(10, 0),
+		BPPN::ImageDimensions(11, 1)),
+		BPPN::ImageBoundsError
+	);
+	// destination region beyond destination image
+	BOOST_CHECK_THROW(
+		dest.write(&src, BPPN::ImageLocation(30, 5), BPPN::ImageLocation(0, 0),
+		BPPN::ImageDimensions(20, 6)),
+		BPPN::ImageBoundsError
+	);
+	// empty source image
+	BOOST_CHECK_THROW(
+		dest.write(&empty, BPPN::ImageLocation(0, 0), BPPN::ImageLocation(0, 0),
+		BPPN::ImageDimensions(1, 1)),
+		BPPN::ImageZeroSizeError
+	);
+	// the whole source fits
+	BOOST_CHECK_NO_THROW(dest.write(&src, BPPN::ImageLocation(20, 0)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+BOOST_AUTO_TEST_SUITE(BppImage_Kernels)
+
+BOOST_AUTO_TEST_CASE(BppImage_KernelsMatchScalar) {
+	typedef BPPN::BppBlockKernels::PixelBlock PixelBlock;
+	const BPPN::BppBlockKernels &scalar = BPPN::BppBlockKernels::scalar();
+	std::vector<const BPPN::BppBlockKernels*> avail =
+		BPPN::BppBlockKernels::available();
+	BOOST_REQUIRE(!avail.empty());
+	BOOST_CHECK_EQUAL(avail.front(), &scalar);
+	BOOST_CHECK(std::find(avail.begin(), avail.end(),
+		&BPPN::BppBlockKernels::best()) != avail.end());
+	std::mt19937 rng(2020);
+	std::vector<PixelBlock> orig(48), ref, work, other;
+	for (PixelBlock &b : orig) {
+		b = (PixelBlock)rng() * (PixelBlock)0x100000001ull;
+	}
+	for (const BPPN::BppBlockKernels *k : avail) {
+		// vary the start offset and length to cover partial vectors
+		for (int start = 0; start < 4; ++start) {
+			for (int len = 0; len <= 40; ++len) {
+				// invert
+				ref = work = orig;
+				scalar.invert(&ref[start], len);
+				k->invert(&work[start], len);
+				BOOST_CHECK_MESSAGE(ref == work, k->name << " invert failed, start "
+					<< start << ", length " << len);
+				// fill
+				ref = work = orig;
+				scalar.fill(&ref[start], len, orig[47]);
+				k->fill(&work[start], len, orig[47]);
+				BOOST_CHECK_MESSAGE(ref == work, k->name << " fill failed, start "
+					<< start << ", length " << len);
+				// equal
+				other = orig;
+				BOOST_CHECK(k->equal(&orig[start], &other[start], len));
+				if (len) {
+					// change one bit in each position in turn
+					for (int d = 0; d < len; ++d) {
+						other = orig;
+						other[start + d] ^= (PixelBlock)1 << (d % 8);
+						BOOST_CHECK_MESSAGE(
+							!k->equal(&orig[start], &other[start], len),
+							k->name << " equal failed, start " << start <<
+							", length " << len << ", difference at " << d
+						);
+					}
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_Equality) {
+	std::mt19937 rng(7);
+	// widths with and without unused bits in the last block of each line
+	for (int w : { 5, 64, 100, 128, 130 }) {
+		BPPN::BppImage a(w, 9);
+		randomImage(a, rng);
+		BPPN::BppImage b(a);
+		BOOST_CHECK(a == b);
+		// differences in the unused bits do not matter
+		if (w % (sizeof(BPPN::BppImage::PixelBlock) * 8)) {
+			*(b.bufferLine(4) + b.blocksPerLine() - 1) ^=
+				(BPPN::BppImage::PixelBlock)1 <<
+				(sizeof(BPPN::BppImage::PixelBlock) * 8 - 1);
+			BOOST_CHECK(a == b);
+		}
+		b.state(w - 1, 8, !b.state(w - 1, 8));
+		BOOST_CHECK(!(a == b));
+		b.state(w - 1, 8, !b.state(w - 1, 8));
+		b.state(0, 3, !b.state(0, 3));
+		BOOST_CHECK(!(a == b));
+		b.invert();
+		b.invert();
+		b.state(0, 3, !b.state(0, 3));
+		BOOST_CHECK(a == b);
+		b.blankImage(true);
+		for (int y = 0; y < b.height(); ++y) {
+			for (int x = 0; x < b.width(); ++x) {
+				BOOST_CHECK(b.state(x, y));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+BOOST_AUTO_TEST_SUITE(BppImage_Transforms)
+
+BOOST_AUTO_TEST_CASE(BppImage_RotateMirror) {
+	std::mt19937 rng(90);
+	const BPPN::ImageDimensions sizes[] = {
+		{ 1, 1 }, { 8, 8 }, { 13, 29 }, { 70, 9 }, { 64, 64 }, { 128, 64 }
+	};
+	for (const BPPN::ImageDimensions &sz : sizes) {
+		BPPN::BppImage src(sz), dest;
+		randomImage(src, rng);
+		const int w = sz.w, h = sz.h;
+		// rotate 90 degrees counter-clockwise
+		src.rotate90(dest);
+		BOOST_REQUIRE_EQUAL(dest.dimensions(), sz.swappedAxes());
+		for (int y = 0; y < w; ++y) {
+			for (int x = 0; x < h; ++x) {
+				BOOST_CHECK_EQUAL(dest.state(x, y), src.state(w - 1 - y, x));
+			}
+		}
+		// rotate 180 degrees
+		src.rotate180(dest);
+		BOOST_REQUIRE_EQUAL(dest.dimensions(), sz);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				BOOST_CHECK_EQUAL(dest.state(x, y),
+					src.state(w - 1 - x, h - 1 - y));
+			}
+		}
+		// rotate 270 degrees counter-clockwise
+		src.rotate270(dest);
+		BOOST_REQUIRE_EQUAL(dest.dimensions(), sz.swappedAxes());
+		for (int y = 0; y < w; ++y) {
+			for (int x = 0; x < h; ++x) {
+				BOOST_CHECK_EQUAL(dest.state(x, y), src.state(y, h - 1 - x));
+			}
+		}
+		// mirror images
+		src.mirrorHoriz(dest);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				BOOST_CHECK_EQUAL(dest.state(x, y), src.state(w - 1 - x, y));
+			}
+		}
+		src.mirrorVert(dest);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				BOOST_CHECK_EQUAL(dest.state(x, y), src.state(x, h - 1 - y));
+			}
+		}
+		// in place operations return to the original
+		dest = src;
+		dest.rotate90();
+		dest.rotate270();
+		BOOST_CHECK(dest == src);
+		dest.rotate180();
+		dest.rotate180();
+		BOOST_CHECK(dest == src);
+		dest.mirrorHoriz();
+		dest.mirrorVert();
+		BPPN::BppImage rot;
+		src.rotate180(rot);
+		BOOST_CHECK(dest == rot);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_RotatedWrite) {
+	std::mt19937 rng(270);
+	BPPN::BppImage src(21, 11);
+	randomImage(src, rng);
+	// iteration directions for the source and the matching rotations
+	const BPPN::BppImage::Direction dirs[] = {
+		BPPN::BppImage::Rotate90DCCW,
+		BPPN::BppImage::Rotate180DCCW,
+		BPPN::BppImage::Rotate270DCCW
+	};
+	for (BPPN::BppImage::Direction dir : dirs) {
+		BPPN::BppImage dest(40, 40), ref(40, 40);
+		dest.clearImage();
+		ref.clearImage();
+		// write part of the source with the rotation
+		BPPN::ImageLocation sl(3, 2);
+		BPPN::ImageDimensions sz(15, 7);
+		BOOST_REQUIRE_NO_THROW(dest.write(&src, BPPN::ImageLocation(5, 6), sl,
+			sz, dir, BPPN::BppImage::OpXor));
+		// reference result from iterating over the source
+		BPPN::ImageDimensions dsz = (dir == BPPN::BppImage::Rotate180DCCW) ?
+			sz : sz.swappedAxes();
+		BPPN::BppImage::ConstPixel siter = src.cbegin(sl, sz, dir);
+		BPPN::BppImage::Pixel diter = ref.begin(BPPN::ImageLocation(5, 6), dsz);
+		for (; siter != BPPN::BppImage::EndPixel(); ++siter, ++diter) {
+			*diter = (bool)*siter;
+		}
+		BOOST_CHECK(dest == ref);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(BppImage_Damage)
+
+BOOST_AUTO_TEST_CASE(BppImage_DamageDisabled) {
+	BPPN::BppImage img(40, 20);
+	BOOST_CHECK(!img.trackingDamage());
+	img.clearImage();
+	img.state(3, 3, true);
+	BOOST_CHECK(img.damage().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_DamageSpans) {
+	BPPN::BppImage img(40, 20);
+	img.trackDamage(true);
+	// initially all damaged
+	BOOST_CHECK(!img.damage().empty());
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 0);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 20);
+	BOOST_CHECK_EQUAL(img.damage().line(7).left, 0);
+	BOOST_CHECK_EQUAL(img.damage().line(7).right, 40);
+	img.clearDamage();
+	BOOST_CHECK(img.damage().empty());
+	for (int y = 0; y < 20; ++y) {
+		BOOST_CHECK(!img.damage().lineDamaged(y));
+	}
+	// single pixel
+	img.state(5, 4, true);
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 4);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 5);
+	BOOST_CHECK_EQUAL(img.damage().line(4).left, 5);
+	BOOST_CHECK_EQUAL(img.damage().line(4).right, 6);
+	// box widens and extends the damage
+	img.drawBox(BPPN::ImageLocation(10, 2), BPPN::ImageDimensions(8, 5), true);
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 2);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 7);
+	BOOST_CHECK_EQUAL(img.damage().line(2).left, 10);
+	BOOST_CHECK_EQUAL(img.damage().line(2).right, 18);
+	BOOST_CHECK_EQUAL(img.damage().line(4).left, 5);
+	BOOST_CHECK_EQUAL(img.damage().line(4).right, 18);
+	// a separate area leaves the lines between undamaged
+	BPPN::BppImage src(6, 3);
+	src.setImage();
+	img.write(&src, BPPN::ImageLocation(30, 15));
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 18);
+	BOOST_CHECK(!img.damage().lineDamaged(10));
+	BOOST_CHECK_EQUAL(img.damage().line(16).left, 30);
+	BOOST_CHECK_EQUAL(img.damage().line(16).right, 36);
+	// writes through Pixel objects are tracked
+	img.clearDamage();
+	BPPN::BppImage::Pixel pix = img.begin(BPPN::ImageLocation(20, 9),
+		BPPN::ImageDimensions(2, 2));
+	*pix = true;
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 9);
+	BOOST_CHECK_EQUAL(img.damage().line(9).left, 20);
+	BOOST_CHECK_EQUAL(img.damage().line(9).right, 21);
+	// clipped to the image
+	img.clearDamage();
+	img.markDamage(BPPN::ImageLocation(-5, 18), BPPN::ImageDimensions(10, 10));
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 18);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 20);
+	BOOST_CHECK_EQUAL(img.damage().line(19).left, 0);
+	BOOST_CHECK_EQUAL(img.damage().line(19).right, 5);
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_DamageWholeImage) {
+	BPPN::BppImage img(33, 9);
+	img.trackDamage(true);
+	img.clearDamage();
+	img.invertLines(3, 2);
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 3);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 5);
+	BOOST_CHECK_EQUAL(img.damage().line(4).right, 33);
+	img.clearDamage();
+	img.rotate90();
+	// tracking is kept and the new size is damaged
+	BOOST_CHECK(img.trackingDamage());
+	BOOST_CHECK_EQUAL(img.damage().dimensions(), BPPN::ImageDimensions(9, 33));
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 33);
+	img.clearDamage();
+	// assignment keeps tracking and damages everything
+	BPPN::BppImage other(9, 33);
+	img = other;
+	BOOST_CHECK(img.trackingDamage());
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 33);
+	BOOST_CHECK(!other.trackingDamage());
+	img.trackDamage(false);
+	BOOST_CHECK(img.damage().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BppImage_DamageMove) {
+	BPPN::BppImage src(16, 4);
+	src.trackDamage(true);
+	src.clearDamage();
+	src.state(1, 1, true);
+	// construction takes the tracking setting and damages everything
+	BPPN::BppImage img(std::move(src));
+	BOOST_CHECK(img.trackingDamage());
+	BOOST_CHECK_EQUAL(img.damage().firstLine(), 0);
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 4);
+	BOOST_CHECK(!src.trackingDamage());
+	BOOST_CHECK(src.damage().empty());
+	BOOST_CHECK(src.dimensions().empty());
+	// assignment does the same
+	BPPN::BppImage other(8, 8);
+	other.trackDamage(true);
+	other.clearDamage();
+	other.state(2, 2, true);
+	img.clearDamage();
+	img = std::move(other);
+	BOOST_CHECK(img.trackingDamage());
+	BOOST_CHECK_EQUAL(img.damage().dimensions(), BPPN::ImageDimensions(8, 8));
+	BOOST_CHECK_EQUAL(img.damage().endLine(), 8);
+	BOOST_CHECK_EQUAL(img.damage().line(5).right, 8);
+	BOOST_CHECK(!other.trackingDamage());
+	BOOST_CHECK(other.damage().empty());
+	// an untracked source turns tracking off
+	img = BPPN::BppImage(8, 8);
+	BOOST_CHECK(!img.trackingDamage());
+	BOOST_CHECK(img.damage().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
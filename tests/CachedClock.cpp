@@ -0,0 +1,164 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of duds::hardware::devices::clocks::CachedClock.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/hardware/devices/clocks/CachedClock.hpp>
+#include <duds/hardware/devices/clocks/PosixClock.hpp>
+#include <thread>
+
+namespace clk = duds::hardware::devices::clocks;
+namespace dti = duds::time::interstellar;
+using namespace std::chrono_literals;
+
+/**
+ * A source clock that reports CLOCK_MONOTONIC_RAW plus an offset, counts
+ * how often it is sampled, and reports a fixed accuracy. The time since
+ * construction may be scaled to simulate a source running at a different
+ * rate.
+ */
+class FakeSourceClock : public clk::Clock {
+	struct Token { };
+public:
+	std::atomic<int> samples;
+	std::int64_t offset;
+	std::int64_t base;
+	double slew;
+	float accuracy;
+	FakeSourceClock(Token) : clk::Clock(clk::PosixClockDeviceId),
+	samples(0), offset(1000000000000ll), base(raw()), slew(1.0),
+	accuracy(0.001f) { }
+	static std::shared_ptr<FakeSourceClock> make() {
+		return std::make_shared<FakeSourceClock>(Token());
+	}
+	static std::int64_t raw() {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+		return (std::int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+	}
+	/**
+	 * Returns the time the source reports for the given raw time.
+	 */
+	std::int64_t value(std::int64_t r) const {
+		return base + std::llround((double)(r - base) * slew) + offset;
+	}
+	virtual void sampleTime(Measurement::TimeSample &time) {
+		++samples;
+		time.value = dti::NanoTime(dti::Nanoseconds(value(raw())));
+		time.accuracy = accuracy;
+		time.estError = 0.0001f;
+		time.precision = 1e-6f;
+		time.resolution = 1e-9f;
+	}
+	virtual void sample() { }
+	virtual void sample(const ClockSptr &) { }
+	virtual bool unambiguous() const noexcept {
+		return true;
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(CachedClock)
+
+BOOST_AUTO_TEST_CASE(CachedClock_OneSourceSample) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 1s);
+	// sampled once when made
+	BOOST_CHECK_EQUAL(src->samples, 1);
+	BOOST_CHECK_EQUAL(cc->sourceSamples(), 1);
+	BOOST_CHECK(cc->unambiguous());
+	clk::CachedClock::Measurement::TimeSample prev = cc->sampleTime();
+	for (int i = 0; i < 1000; ++i) {
+		clk::CachedClock::Measurement::TimeSample ts = cc->sampleTime();
+		BOOST_CHECK(ts.value >= prev.value);
+		prev = ts;
+	}
+	BOOST_CHECK_EQUAL(src->samples, 1);
+	// follows the source closely
+	std::int64_t expect = src->value(FakeSourceClock::raw());
+	std::int64_t got = prev.value.time_since_epoch().count();
+	BOOST_CHECK_LT(std::abs(expect - got), 1000000);
+	// quality carried over with a larger accuracy bound
+	BOOST_CHECK_GE(prev.accuracy, src->accuracy);
+	BOOST_CHECK_LT(prev.accuracy, src->accuracy + 0.0001f);
+	BOOST_CHECK_EQUAL(prev.precision, 1e-6f);
+	BOOST_CHECK_EQUAL(prev.resolution, 1e-9f);
+	BOOST_CHECK(prev.origin == cc->sensor()->uuid());
+}
+
+BOOST_AUTO_TEST_CASE(CachedClock_Interval) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 5ms);
+	BOOST_CHECK(cc->interval() == 5ms);
+	std::this_thread::sleep_for(6ms);
+	cc->sampleTime();
+	BOOST_CHECK_EQUAL(src->samples, 2);
+	cc->sampleTime();
+	BOOST_CHECK_EQUAL(src->samples, 2);
+	cc->update();
+	BOOST_CHECK_EQUAL(cc->sourceSamples(), 3);
+	cc->interval(1h);
+	std::this_thread::sleep_for(6ms);
+	cc->sampleTime();
+	BOOST_CHECK_EQUAL(src->samples, 3);
+}
+
+BOOST_AUTO_TEST_CASE(CachedClock_Rate) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	// 200ppm fast; within MaxDrift
+	src->slew = 1.0002;
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 1h);
+	BOOST_CHECK_EQUAL(cc->rate(), 1.0);
+	// long enough that the time taken to sample the source is a small part
+	// of the measured rate
+	std::this_thread::sleep_for(100ms);
+	cc->update();
+	BOOST_CHECK_CLOSE(cc->rate(), src->slew, 0.005);
+	// the interpolated time follows the slewed source
+	std::this_thread::sleep_for(100ms);
+	std::int64_t got = cc->sampleTime().value.time_since_epoch().count();
+	std::int64_t expect = src->value(FakeSourceClock::raw());
+	BOOST_CHECK_LT(std::abs(expect - got), 20000);
+}
+
+BOOST_AUTO_TEST_CASE(CachedClock_Stepped) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 1h);
+	// step the source clock by a second; the rate is not used
+	src->offset += 1000000000ll;
+	cc->update();
+	BOOST_CHECK_EQUAL(cc->rate(), 1.0);
+	std::int64_t expect = src->value(FakeSourceClock::raw());
+	std::int64_t got = cc->sampleTime().value.time_since_epoch().count();
+	BOOST_CHECK_LT(std::abs(expect - got), 1000000);
+}
+
+BOOST_AUTO_TEST_CASE(CachedClock_Unsynchronized) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	src->accuracy = duds::data::unspecified<float>();
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 1h);
+	std::this_thread::sleep_for(1ms);
+	BOOST_CHECK(std::isinf(cc->sampleTime().accuracy));
+}
+
+BOOST_AUTO_TEST_CASE(CachedClock_Sample) {
+	std::shared_ptr<FakeSourceClock> src = FakeSourceClock::make();
+	clk::CachedClockSptr cc = clk::CachedClock::make(src, 1h);
+	cc->sample(cc);
+	clk::CachedClock::ConstMeasurementSptr m = cc->currentMeasurement();
+	BOOST_REQUIRE(m);
+	BOOST_CHECK(boost::get<dti::NanoTime>(m->measured.value) == m->timestamp.value);
+	BOOST_CHECK_EQUAL(src->samples, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
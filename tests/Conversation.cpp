@@ -11,7 +11,7 @@
  * @file
  * Test of the duds::hardware::interface::Conversation and releated classes.
  */
-#include <duds/hardware/interface/ConversationExtractor.hpp>
+#include <duds/hardware/interface/ConversationArena.hpp>
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 
@@ -252,4 +252,49 @@ BOOST_AUTO_TEST_CASE(Conversation_I2Clike) {
 	BOOST_CHECK(extr.end());
 }
 
+BOOST_AUTO_TEST_CASE(Conversation_Arena) {
+	dhi::FixedConversation<8, 3> con;
+	BOOST_CHECK(con.empty());
+	BOOST_CHECK_EQUAL(con.partCapacity(), 3);
+	BOOST_CHECK_EQUAL(con.byteCapacity(), 8);
+	char *out = con.addOutput({ 0x12, 0x34 });
+	BOOST_CHECK_EQUAL(out[0], 0x12);
+	BOOST_CHECK_EQUAL(out[1], 0x34);
+	char *in = con.addInput(4);
+	BOOST_CHECK_EQUAL(in, out + 2);
+	BOOST_CHECK_EQUAL(con.size(), 2);
+	BOOST_CHECK_EQUAL(con.bytesUsed(), 6);
+	BOOST_CHECK(con[0].output());
+	BOOST_CHECK(!con[0].extract());
+	BOOST_CHECK(con[1].input());
+	BOOST_CHECK(con[1].extract());
+	BOOST_CHECK_EQUAL(con[1].start(), in);
+	BOOST_CHECK_EQUAL(con[1].length(), 4);
+	// too many bytes
+	BOOST_CHECK_THROW(con.addOutput(3), dhi::ConversationArenaFull);
+	BOOST_CHECK_EQUAL(con.size(), 2);
+	con.addOutput(2, dhi::ConversationPart::MpfBreak);
+	BOOST_CHECK(con[2].output());
+	BOOST_CHECK(con[2].flags() & dhi::ConversationPart::MpfBreak);
+	BOOST_CHECK_EQUAL(con.bytesUsed(), 8);
+	// too many parts
+	BOOST_CHECK_THROW(con.addOutput(0), dhi::ConversationArenaFull);
+	// extract input
+	in[0] = 1;
+	in[1] = 2;
+	in[2] = 3;
+	in[3] = 4;
+	dhi::ConversationExtractor ce = con.extract(1);
+	std::uint16_t i;
+	ce.readBe(i);
+	BOOST_CHECK_EQUAL(i, 0x0102);
+	ce.readLe(i);
+	BOOST_CHECK_EQUAL(i, 0x0403);
+	BOOST_CHECK(ce.end());
+	// reuse after clear
+	con.clear();
+	BOOST_CHECK(con.empty());
+	BOOST_CHECK_EQUAL(con.addOutput(8), out);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
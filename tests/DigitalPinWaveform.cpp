@@ -0,0 +1,85 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Test of duds::hardware::interface::DigitalPinWaveform and its output
+ * through a DigitalPinSetAccess object.
+ */
+#include <duds/hardware/interface/test/VirtualPort.hpp>
+#include <duds/hardware/interface/DigitalPinSetAccess.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace dhi = duds::hardware::interface;
+
+BOOST_AUTO_TEST_SUITE(DigitalPinWaveform)
+
+BOOST_AUTO_TEST_CASE(DigitalPinWaveform_Build) {
+	dhi::DigitalPinWaveform wave;
+	BOOST_CHECK(wave.empty());
+	BOOST_CHECK_EQUAL(wave.width(), 0);
+	// a wait on an empty waveform makes a step with no changes
+	wave.wait(std::chrono::microseconds(2));
+	BOOST_CHECK_EQUAL(wave.size(), 1);
+	BOOST_CHECK_EQUAL(wave.pinsUsed(), 0);
+	wave.write(0xA, 4);
+	wave.output(5, true, std::chrono::microseconds(1));
+	wave.wait(std::chrono::microseconds(3));
+	BOOST_CHECK_EQUAL(wave.size(), 3);
+	BOOST_CHECK_EQUAL(wave.pinsUsed(), 0x2F);
+	BOOST_CHECK_EQUAL(wave.width(), 6);
+	BOOST_CHECK(wave.duration() == std::chrono::microseconds(6));
+	BOOST_CHECK_EQUAL(wave.steps()[1].states, 0xA);
+	BOOST_CHECK_EQUAL(wave.steps()[1].mask, 0xF);
+	BOOST_CHECK(wave.steps()[2].delay == std::chrono::microseconds(4));
+	// states outside the mask are dropped
+	wave.add(0xFF, 0x3);
+	BOOST_CHECK_EQUAL(wave.steps().back().states, 0x3);
+	// range errors
+	BOOST_CHECK_THROW(wave.write(0x10, 4), dhi::DigitalPinNumericRangeError);
+	BOOST_CHECK_THROW(wave.write(0, 0), dhi::PinRangeError);
+	BOOST_CHECK_THROW(wave.write(0, 65), dhi::PinRangeError);
+	BOOST_CHECK_THROW(wave.output(64, true), dhi::PinRangeError);
+	BOOST_CHECK_EQUAL(wave.size(), 4);
+	wave.clear();
+	BOOST_CHECK(wave.empty());
+	BOOST_CHECK_EQUAL(wave.pinsUsed(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DigitalPinWaveform_Output) {
+	std::shared_ptr<dhi::test::VirtualPort> port =
+		std::make_shared<dhi::test::VirtualPort>(4);
+	dhi::DigitalPinSetAccess acc;
+	port->access({ 0, 1, 2, 3 }, acc);
+	dhi::DigitalPinWaveform wave;
+	wave.write(0x5, 4);
+	wave.output(0, false);
+	wave.output(3, true, std::chrono::microseconds(50));
+	std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	acc.output(wave);
+	BOOST_CHECK(
+		(std::chrono::steady_clock::now() - start) >=
+		std::chrono::microseconds(50)
+	);
+	// final states: 0b1100
+	const bool expected[4] = { false, false, true, true };
+	for (unsigned int pos = 0; pos < 4; ++pos) {
+		BOOST_CHECK_EQUAL(
+			(acc.configuration(pos) & dhi::DigitalPinConfig::OutputState) > 0,
+			expected[pos]
+		);
+	}
+	// too many pins for the access object
+	wave.output(4, true);
+	BOOST_CHECK_THROW(acc.output(wave), dhi::PinRangeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
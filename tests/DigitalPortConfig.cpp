@@ -0,0 +1,78 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Test of the configuration bookkeeping used by objects that reserve pins
+ * outside of an access object, like
+ * duds::hardware::interface::linux::GpioDevEvents.
+ */
+#include <duds/hardware/interface/test/VirtualPort.hpp>
+#include <duds/hardware/interface/DigitalPinAccess.hpp>
+#include <duds/hardware/interface/DigitalPinSetAccess.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace dhi = duds::hardware::interface;
+
+/**
+ * Makes the configuration bookkeeping functions public.
+ */
+class ConfigPort : public dhi::test::VirtualPort {
+public:
+	ConfigPort(unsigned int numpins) : VirtualPort(numpins) { }
+	using VirtualPort::exchangeConfig;
+	using VirtualPort::restoreConfig;
+};
+
+BOOST_AUTO_TEST_SUITE(DigitalPortConfig)
+
+BOOST_AUTO_TEST_CASE(DigitalPortConfig_ExchangeRestore) {
+	std::shared_ptr<ConfigPort> port = std::make_shared<ConfigPort>(4);
+	// make pin 3 an output
+	{
+		std::unique_ptr<dhi::DigitalPinAccess> out = port->access(3);
+		out->modifyConfig(
+			dhi::DigitalPinConfig(dhi::DigitalPinConfig::DirOutput)
+		);
+		out->output(true);
+	}
+	dhi::DigitalPinConfig before1 = port->configuration(1);
+	dhi::DigitalPinConfig before3 = port->configuration(3);
+	BOOST_CHECK(before1.options & dhi::DigitalPinConfig::DirInput);
+	BOOST_CHECK(before3.options & dhi::DigitalPinConfig::DirOutput);
+	{
+		// reserve the pins like GpioDevEvents
+		dhi::DigitalPinSetAccess acc;
+		port->access({ 1, 3 }, acc);
+		std::vector<dhi::DigitalPinConfig> prev = port->exchangeConfig(
+			acc.localIds(),
+			dhi::DigitalPinConfig::DirMask | dhi::DigitalPinConfig::EventMask,
+			dhi::DigitalPinConfig::DirInput |
+			dhi::DigitalPinConfig::EventEdgeRising
+		);
+		BOOST_REQUIRE_EQUAL(prev.size(), 2);
+		BOOST_CHECK(prev[0].options == before1.options);
+		BOOST_CHECK(prev[1].options == before3.options);
+		for (unsigned int gid : { 1, 3 }) {
+			dhi::DigitalPinConfig::Flags opts = port->configuration(gid).options;
+			BOOST_CHECK(opts & dhi::DigitalPinConfig::DirInput);
+			BOOST_CHECK(!(opts & dhi::DigitalPinConfig::DirOutput));
+			BOOST_CHECK(opts & dhi::DigitalPinConfig::EventEdgeRising);
+		}
+		// other pins are not changed
+		BOOST_CHECK(!(port->configuration(0).options &
+			dhi::DigitalPinConfig::EventMask));
+		port->restoreConfig(acc.localIds(), prev);
+	}
+	BOOST_CHECK(port->configuration(1).options == before1.options);
+	BOOST_CHECK(port->configuration(3).options == before3.options);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the bookkeeping done by the GPIO character device version 2 line
+ * request used by duds::hardware::interface::linux::GpioDevPort. These do
+ * not need a GPIO device; the lines are never requested from the kernel.
+ */
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/hardware/interface/linux/GpioRequest.hpp>
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+namespace dhil = duds::hardware::interface::linux;
+
+BOOST_AUTO_TEST_SUITE(GpioLineRequest)
+
+BOOST_AUTO_TEST_CASE(GpioLineRequest_Config) {
+	dhil::GpioLineRequest glr("test");
+	glr.addOffset(4, false, false);
+	glr.addOffset(7, true, true);
+	glr.addOffset(2, true, false);
+	BOOST_CHECK_EQUAL(glr.size(), 3);
+	BOOST_CHECK_EQUAL(glr.offset(1), 7);
+	BOOST_CHECK_EQUAL(glr.outputs(), 6);
+	BOOST_CHECK_EQUAL(glr.outputStates(), 2);
+	gpio_v2_line_config cfg;
+	glr.makeConfig(cfg);
+	BOOST_CHECK_EQUAL(cfg.flags, GPIO_V2_LINE_FLAG_INPUT);
+	BOOST_REQUIRE_EQUAL(cfg.num_attrs, 2);
+	BOOST_CHECK_EQUAL(cfg.attrs[0].attr.id, GPIO_V2_LINE_ATTR_ID_FLAGS);
+	BOOST_CHECK_EQUAL(cfg.attrs[0].attr.flags, GPIO_V2_LINE_FLAG_OUTPUT);
+	BOOST_CHECK_EQUAL(cfg.attrs[0].mask, 6);
+	BOOST_CHECK_EQUAL(cfg.attrs[1].attr.id, GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES);
+	BOOST_CHECK_EQUAL(cfg.attrs[1].attr.values, 2);
+	BOOST_CHECK_EQUAL(cfg.attrs[1].mask, 6);
+	// change an input into an output without involving the kernel
+	glr.outputState(4, true);
+	BOOST_CHECK_EQUAL(glr.outputs(), 7);
+	BOOST_CHECK_EQUAL(glr.outputStates(), 3);
+	glr.makeConfig(cfg);
+	BOOST_CHECK_EQUAL(cfg.attrs[0].mask, 7);
+	BOOST_CHECK_EQUAL(cfg.attrs[1].attr.values, 3);
+	BOOST_CHECK(!glr.requested());
+}
+
+BOOST_AUTO_TEST_CASE(GpioLineRequest_InputsOnly) {
+	dhil::GpioLineRequest glr("test");
+	glr.addOffset(0, false, true);
+	glr.addOffset(1, false, false);
+	BOOST_CHECK_EQUAL(glr.outputs(), 0);
+	gpio_v2_line_config cfg;
+	glr.makeConfig(cfg);
+	BOOST_CHECK_EQUAL(cfg.flags, GPIO_V2_LINE_FLAG_INPUT);
+	BOOST_CHECK_EQUAL(cfg.num_attrs, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GpioLineRequest_Limit) {
+	dhil::GpioLineRequest glr("test");
+	// mixed inputs and outputs share the one request
+	for (unsigned int l = 0; l < GPIO_V2_LINES_MAX; ++l) {
+		glr.addOffset(l, l & 1, false);
+	}
+	BOOST_CHECK_EQUAL(glr.size(), GPIO_V2_LINES_MAX);
+	BOOST_CHECK_EQUAL(glr.outputs(), 0xAAAAAAAAAAAAAAAAull);
+	BOOST_CHECK_THROW(
+		glr.addOffset(GPIO_V2_LINES_MAX, false, false),
+		dhil::GpioDevTooManyLines
+	);
+	BOOST_CHECK_EQUAL(glr.size(), GPIO_V2_LINES_MAX);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif  // #ifdef GPIO_V2_GET_LINE_IOCTL
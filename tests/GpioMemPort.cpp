@@ -0,0 +1,154 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Test of duds::hardware::interface::linux::bcm283x::GpioMemPort using a
+ * regular file in place of the GPIO registers.
+ */
+#include <duds/hardware/interface/linux/bcm283x/GpioMemPort.hpp>
+#include <duds/hardware/interface/DigitalPinSetAccess.hpp>
+#include <duds/hardware/interface/DigitalPinAccess.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace dhi = duds::hardware::interface;
+namespace dhib = duds::hardware::interface::linux::bcm283x;
+
+/**
+ * Makes a temporary file to stand in for /dev/gpiomem, and maps it so the
+ * test can inspect and alter the register values.
+ */
+struct FakeRegisters {
+	std::string path;
+	volatile std::uint32_t *regs;
+	FakeRegisters() {
+		char name[] = "/tmp/dudsgpiomemXXXXXX";
+		int fd = mkstemp(name);
+		BOOST_REQUIRE(fd >= 0);
+		path = name;
+		BOOST_REQUIRE(ftruncate(fd, dhib::GpioMemPort::MapSize) == 0);
+		void *addr = mmap(
+			nullptr,
+			dhib::GpioMemPort::MapSize,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED,
+			fd,
+			0
+		);
+		close(fd);
+		BOOST_REQUIRE(addr != MAP_FAILED);
+		regs = (volatile std::uint32_t*)addr;
+	}
+	~FakeRegisters() {
+		munmap((void*)regs, dhib::GpioMemPort::MapSize);
+		unlink(path.c_str());
+	}
+	/**
+	 * Clears the write-only set and clear registers.
+	 */
+	void clearWrites() {
+		regs[dhib::GpioMemPort::GPSET0] = regs[dhib::GpioMemPort::GPSET0 + 1] =
+		regs[dhib::GpioMemPort::GPCLR0] = regs[dhib::GpioMemPort::GPCLR0 + 1] =
+			0;
+	}
+};
+
+BOOST_FIXTURE_TEST_SUITE(GpioMemPort, FakeRegisters)
+
+BOOST_AUTO_TEST_CASE(GpioMemPort_Init) {
+	// GPIO 4 is an output, 17 uses an alternate function, 34 is high
+	regs[dhib::GpioMemPort::GPFSEL0] = 1 << 12;
+	regs[dhib::GpioMemPort::GPFSEL0 + 1] = 4 << 21;
+	regs[dhib::GpioMemPort::GPLEV0 + 1] = 1 << 2;
+	// GPIO 4 has a pull-up on the BCM2711
+	regs[dhib::GpioMemPort::GPIO_PUP_PDN_CNTRL_REG0] = 1 << 8;
+	dhib::GpioMemPort port(
+		{ 4, 17, (unsigned int)-1, 34 }, 0, dhib::GpioMemPort::Bcm2711, path
+	);
+	BOOST_CHECK(port.configuration(0) & dhi::DigitalPinConfig::DirOutput);
+	BOOST_CHECK(port.configuration(0) & dhi::DigitalPinConfig::InputPullup);
+	BOOST_CHECK(port.configuration(1) & dhi::DigitalPinConfig::DirInput);
+	BOOST_CHECK(!port.exists(2));
+	BOOST_CHECK(port.configuration(3) & dhi::DigitalPinConfig::OutputState);
+	BOOST_CHECK_THROW(
+		dhib::GpioMemPort({ 54 }, 0, dhib::GpioMemPort::Bcm283x, path),
+		dhib::GpioMemRangeError
+	);
+}
+
+BOOST_AUTO_TEST_CASE(GpioMemPort_Output) {
+	dhib::GpioMemPort port(
+		{ 2, 3, 40 }, 0, dhib::GpioMemPort::Bcm283x, path
+	);
+	dhi::DigitalPinSetAccess acc;
+	port.access({ 0, 1, 2 }, acc);
+	// set the output state before changing to output
+	acc.output(std::vector<bool> { true, false, true });
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0], 0);
+	acc.modifyConfig(dhi::DigitalPinConfig(
+		dhi::DigitalPinConfig::DirOutput | dhi::DigitalPinConfig::OutputPushPull
+	));
+	// function select of GPIO 2, 3, and 40
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPFSEL0], (1 << 6) | (1 << 9));
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPFSEL0 + 4], 1);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0], 1 << 2);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPCLR0], 1 << 3);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0 + 1], 1 << 8);
+	// multiple pins in one write
+	clearWrites();
+	acc.write(6u, 3);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0], 1 << 3);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPCLR0], 1 << 2);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0 + 1], 1 << 8);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPCLR0 + 1], 0);
+	// the registers keep the last value written by the waveform steps
+	clearWrites();
+	dhi::DigitalPinWaveform wave;
+	wave.write(0, 3);
+	wave.output(1, true);
+	acc.output(wave);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPSET0], 1 << 3);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPCLR0], (1 << 2) | (1 << 3));
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPCLR0 + 1], 1 << 8);
+	BOOST_CHECK(port.configuration(1) & dhi::DigitalPinConfig::OutputState);
+	BOOST_CHECK(!(port.configuration(2) & dhi::DigitalPinConfig::OutputState));
+	// back to input
+	acc.modifyConfig(dhi::DigitalPinConfig(dhi::DigitalPinConfig::DirInput));
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPFSEL0], 0);
+	BOOST_CHECK_EQUAL(regs[dhib::GpioMemPort::GPFSEL0 + 4], 0);
+}
+
+BOOST_AUTO_TEST_CASE(GpioMemPort_Input) {
+	dhib::GpioMemPort port(
+		{ 5, 33 }, 0, dhib::GpioMemPort::Bcm2711, path
+	);
+	dhi::DigitalPinSetAccess acc;
+	port.access({ 0, 1 }, acc);
+	regs[dhib::GpioMemPort::GPLEV0] = 1 << 5;
+	std::vector<bool> in = acc.input();
+	BOOST_CHECK(in[0]);
+	BOOST_CHECK(!in[1]);
+	regs[dhib::GpioMemPort::GPLEV0] = 0;
+	regs[dhib::GpioMemPort::GPLEV0 + 1] = 1 << 1;
+	BOOST_CHECK(!acc.input(0));
+	BOOST_CHECK(acc.input(1));
+	// pull-down on GPIO 33
+	acc.modifyConfig(1, dhi::DigitalPinConfig(
+		dhi::DigitalPinConfig::DirInput | dhi::DigitalPinConfig::InputPulldown
+	));
+	BOOST_CHECK_EQUAL(
+		regs[dhib::GpioMemPort::GPIO_PUP_PDN_CNTRL_REG0 + 2], 2 << 2
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
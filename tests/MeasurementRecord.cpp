@@ -0,0 +1,128 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of duds::data::GenericMeasurementRecord and its conversions.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/data/MeasurementRecord.hpp>
+#include <duds/data/Units.hpp>
+#include <boost/uuid/random_generator.hpp>
+
+namespace dd = duds::data;
+
+BOOST_AUTO_TEST_SUITE(MeasurementRecord)
+
+BOOST_AUTO_TEST_CASE(MeasurementRecord_Layout) {
+	BOOST_CHECK(std::is_trivially_copyable<dd::MeasurementRecord>::value);
+	BOOST_CHECK(std::is_standard_layout<dd::MeasurementRecord>::value);
+	BOOST_CHECK(std::is_trivially_copyable<dd::TriaxialMeasurementRecord>::value);
+	BOOST_CHECK(std::is_standard_layout<dd::TriaxialMeasurementRecord>::value);
+	// much smaller than the generic form
+	BOOST_CHECK_LE(sizeof(dd::MeasurementRecord), 48);
+	BOOST_CHECK_LT(sizeof(dd::TriaxialMeasurementRecord), sizeof(dd::Measurement) / 3);
+}
+
+BOOST_AUTO_TEST_CASE(MeasurementRecord_IndexTable) {
+	dd::InstrumentIndexTable table;
+	boost::uuids::random_generator gen;
+	boost::uuids::uuid a = gen(), b = gen();
+	BOOST_CHECK_EQUAL(table.index(a), 0);
+	BOOST_CHECK_EQUAL(table.index(b), 1);
+	BOOST_CHECK_EQUAL(table.index(a), 0);
+	BOOST_CHECK_EQUAL(table.size(), 2);
+	BOOST_CHECK(table.origin(1) == b);
+	BOOST_CHECK_THROW(table.origin(2), dd::MeasurementRecordBadIndex);
+}
+
+BOOST_AUTO_TEST_CASE(MeasurementRecord_Scalar) {
+	boost::uuids::uuid origin = boost::uuids::random_generator()();
+	dd::MeasurementRecord rec;
+	rec.clear();
+	rec.time = duds::time::interstellar::NanoTime(
+		duds::time::interstellar::Nanoseconds(123456789)
+	);
+	rec.instrument = 0;
+	rec.unit = dd::units::Volt;
+	rec.quality.accuracy = 0.01f;
+	rec.length = 1;
+	rec.values[0] = 4.25;
+	dd::Measurement m = dd::toMeasurement(rec, origin);
+	BOOST_CHECK(m.measured.origin == origin);
+	BOOST_CHECK(m.timestamp.value == rec.time);
+	BOOST_CHECK_CLOSE(m.measured.accuracy, 0.01, 1e-4);
+	BOOST_CHECK(std::isinf(m.measured.precision));
+	const dd::Quantity *q = boost::get<dd::Quantity>(&m.measured.value);
+	BOOST_REQUIRE(q);
+	BOOST_CHECK_EQUAL(q->value, 4.25);
+	BOOST_CHECK(q->unit == dd::units::Volt);
+	// and back again
+	dd::MeasurementRecord back;
+	dd::fromMeasurement(back, m, 7);
+	BOOST_CHECK_EQUAL(back.instrument, 7);
+	BOOST_CHECK_EQUAL(back.length, 1);
+	BOOST_CHECK_EQUAL(back.values[0], 4.25);
+	BOOST_CHECK(back.unit == dd::units::Volt);
+	BOOST_CHECK(back.time == rec.time);
+	BOOST_CHECK_EQUAL(back.quality.accuracy, 0.01f);
+	BOOST_CHECK(std::isinf(back.quality.resolution));
+}
+
+BOOST_AUTO_TEST_CASE(MeasurementRecord_Vector) {
+	boost::uuids::uuid origin = boost::uuids::random_generator()();
+	dd::TriaxialMeasurementRecord rec;
+	rec.clear();
+	rec.instrument = 3;
+	rec.unit = dd::units::Tesla;
+	rec.length = 3;
+	rec.values[0] = 1.5f;
+	rec.values[1] = -2.0f;
+	rec.values[2] = 0.25f;
+	dd::Measurement m = dd::toMeasurement(rec, origin);
+	const dd::QuantityNddArray *qa =
+		boost::get<dd::QuantityNddArray>(&m.measured.value);
+	BOOST_REQUIRE(qa);
+	BOOST_CHECK_EQUAL(qa->array.size(), 3);
+	BOOST_CHECK(qa->unit == dd::units::Tesla);
+	BOOST_CHECK_EQUAL(qa->array.at({1}), -2.0);
+	dd::TriaxialMeasurementRecord back;
+	dd::fromMeasurement(back, m, 3);
+	BOOST_CHECK_EQUAL(back.length, 3);
+	for (int i = 0; i < 3; ++i) {
+		BOOST_CHECK_EQUAL(back.values[i], rec.values[i]);
+	}
+	// too many values for a scalar record
+	dd::MeasurementRecord scalar;
+	BOOST_CHECK_THROW(
+		dd::fromMeasurement(scalar, m, 3),
+		dd::MeasurementRecordTooLong
+	);
+	// unitless arrays of numbers
+	m.measured.value = std::array<std::int32_t, 4>{ 1, 2, 3, 4 };
+	BOOST_CHECK_THROW(
+		dd::fromMeasurement(back, m, 3),
+		dd::MeasurementRecordTooLong
+	);
+	m.measured.value = std::array<double, 2>{ 5.0, 6.0 };
+	dd::fromMeasurement(back, m, 3);
+	BOOST_CHECK_EQUAL(back.length, 2);
+	BOOST_CHECK_EQUAL(back.values[1], 6.0f);
+	BOOST_CHECK(back.unit == dd::Unit(0));
+	// not a number
+	m.measured.value = std::string("nope");
+	BOOST_CHECK_THROW(
+		dd::fromMeasurement(back, m, 3),
+		dd::MeasurementRecordBadType
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
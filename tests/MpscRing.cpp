@@ -0,0 +1,172 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the duds::general::MpscRing template.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/general/MpscRing.hpp>
+#include <vector>
+
+typedef duds::general::MpscRing<int>  IntRing;
+
+BOOST_AUTO_TEST_SUITE(MpscRing)
+
+BOOST_AUTO_TEST_CASE(MpscRing_Order) {
+	IntRing ring(5);
+	BOOST_CHECK_EQUAL(ring.capacity(), 8);
+	BOOST_CHECK(ring.empty());
+	int v = -1;
+	BOOST_CHECK(!ring.pop(v));
+	BOOST_CHECK_EQUAL(v, -1);
+	// go around the ring a few times
+	for (int r = 0; r < 20; r += 5) {
+		for (int i = 0; i < 5; ++i) {
+			BOOST_CHECK(ring.push(r + i));
+		}
+		BOOST_CHECK_EQUAL(ring.size(), 5);
+		for (int i = 0; i < 5; ++i) {
+			BOOST_CHECK(ring.pop(v));
+			BOOST_CHECK_EQUAL(v, r + i);
+		}
+		BOOST_CHECK(ring.empty());
+	}
+	BOOST_CHECK_EQUAL(ring.highWaterMark(), 5);
+	BOOST_CHECK_EQUAL(ring.dropped(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MpscRing_Drain) {
+	IntRing ring(16);
+	for (int i = 0; i < 10; ++i) {
+		ring.push(i);
+	}
+	std::vector<int> out;
+	auto app = [&out](int &&i) { out.push_back(i); };
+	BOOST_CHECK_EQUAL(ring.drain(app, 4), 4);
+	BOOST_CHECK_EQUAL(ring.size(), 6);
+	BOOST_CHECK_EQUAL(ring.drain(app), 6);
+	BOOST_CHECK_EQUAL(ring.drain(app), 0);
+	BOOST_REQUIRE_EQUAL(out.size(), 10);
+	for (int i = 0; i < 10; ++i) {
+		BOOST_CHECK_EQUAL(out[i], i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(MpscRing_Overflow) {
+	IntRing ring(4, IntRing::DropNewest);
+	for (int i = 0; i < 4; ++i) {
+		BOOST_CHECK(ring.push(i));
+	}
+	BOOST_CHECK(!ring.push(4));
+	BOOST_CHECK(!ring.push(5));
+	BOOST_CHECK_EQUAL(ring.dropped(), 2);
+	BOOST_CHECK_EQUAL(ring.highWaterMark(), 4);
+	int v;
+	BOOST_CHECK(ring.pop(v));
+	BOOST_CHECK_EQUAL(v, 0);
+	ring.policy(IntRing::DropOldest);
+	BOOST_CHECK(ring.push(6));
+	BOOST_CHECK(ring.push(7));
+	BOOST_CHECK_EQUAL(ring.dropped(), 3);
+	std::vector<int> out;
+	ring.drain([&out](int &&i) { out.push_back(i); });
+	BOOST_CHECK((out == std::vector<int>{2, 3, 6, 7}));
+	ring.resetCounters();
+	BOOST_CHECK_EQUAL(ring.dropped(), 0);
+	BOOST_CHECK_EQUAL(ring.highWaterMark(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MpscRing_DropDuringDrain) {
+	IntRing ring(8, IntRing::DropOldest);
+	for (int i = 0; i < 8; ++i) {
+		ring.push(i);
+	}
+	std::thread producer;
+	std::vector<int> out;
+	// push to the full ring while the consumer holds two taken items
+	BOOST_CHECK_EQUAL(ring.drain([&](int &&v) {
+		if (out.empty()) {
+			producer = std::thread([&ring]() {
+				ring.push(100);
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		out.push_back(v);
+	}, 2), 2);
+	producer.join();
+	// the push waited for a taken slot to be released instead of dropping
+	// the queued items
+	BOOST_CHECK_EQUAL(ring.dropped(), 0);
+	ring.drain([&out](int &&v) { out.push_back(v); });
+	BOOST_CHECK((out == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 100}));
+}
+
+BOOST_AUTO_TEST_CASE(MpscRing_Destruction) {
+	std::shared_ptr<int> sp = std::make_shared<int>(1);
+	{
+		duds::general::MpscRing< std::shared_ptr<int> > ring(4);
+		ring.push(sp);
+		ring.push(sp);
+		BOOST_CHECK_EQUAL(sp.use_count(), 3);
+		std::shared_ptr<int> out;
+		ring.pop(out);
+		out.reset();
+		BOOST_CHECK_EQUAL(sp.use_count(), 2);
+		// drops destroy the item
+		ring.push(sp);
+		ring.push(sp);
+		ring.push(sp);
+		ring.push(sp);
+		BOOST_CHECK_EQUAL(ring.dropped(), 1);
+		BOOST_CHECK_EQUAL(sp.use_count(), 5);
+	}
+	// destructor destroys the items
+	BOOST_CHECK_EQUAL(sp.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MpscRing_Threads) {
+	constexpr int Producers = 4;
+	constexpr int Items = 20000;
+	IntRing ring(64, IntRing::Block);
+	std::vector<std::thread> threads;
+	for (int p = 0; p < Producers; ++p) {
+		threads.emplace_back([&ring, p]() {
+			for (int i = 0; i < Items; ++i) {
+				ring.push(p * Items + i);
+			}
+		});
+	}
+	// items from each producer must arrive in order, and none may be lost
+	std::vector<int> next(Producers, 0);
+	int total = 0;
+	bool ordered = true;
+	while (total < Producers * Items) {
+		total += ring.drain([&next, &ordered](int &&v) {
+			int p = v / Items;
+			if (v % Items != next[p]++) {
+				ordered = false;
+			}
+		});
+	}
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	BOOST_CHECK(ordered);
+	BOOST_CHECK(ring.empty());
+	BOOST_CHECK_EQUAL(ring.dropped(), 0);
+	BOOST_CHECK_LE(ring.highWaterMark(), ring.capacity());
+	for (int p = 0; p < Producers; ++p) {
+		BOOST_CHECK_EQUAL(next[p], Items);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
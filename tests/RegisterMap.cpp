@@ -0,0 +1,94 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Test of the register descriptions in
+ * duds/hardware/interface/RegisterMap.hpp.
+ */
+#include <duds/hardware/interface/RegisterMap.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace dhi = duds::hardware::interface;
+
+typedef dhi::Register<0x10, 2>  Le16;
+typedef dhi::Register<0x12, 2, true, true>  BeS16;
+typedef dhi::Register<0x14, 3, false, true>  LeS24;
+typedef dhi::Register<0x17>  Ctrl;
+typedef dhi::RegisterField<Ctrl, 0, 3>  CtrlMode;
+typedef dhi::RegisterField<Ctrl, 4, 4, true>  CtrlOffset;
+typedef dhi::RegisterArray<
+	dhi::RegisterField<dhi::Register<0x18, 2>, 0, 12, true>, 2
+>  Pixels;
+typedef dhi::RegisterBurst<Le16, BeS16, LeS24, Ctrl, Pixels>  All;
+
+static constexpr char testData[] = {
+	0x34, 0x12,                     // Le16
+	(char)0xFF, (char)0xFE,         // BeS16
+	(char)0xFE, (char)0xFF, (char)0xFF, // LeS24
+	(char)0x95,                     // Ctrl
+	0x01, 0x08, (char)0xFF, 0x07    // Pixels
+};
+
+// decoding can happen at compile time
+static_assert(Le16::decode(testData) == 0x1234, "");
+static_assert(BeS16::decode(testData + 2) == -2, "");
+static_assert(LeS24::decode(testData + 4) == -2, "");
+static_assert(CtrlMode::decode(testData + 7) == 5, "");
+static_assert(CtrlOffset::decode(testData + 7) == -7, "");
+static_assert(All::address == 0x10, "");
+static_assert(All::size == 12, "");
+static_assert(dhi::RegisterOffset<All, Ctrl>() == 7, "");
+
+BOOST_AUTO_TEST_SUITE(RegisterMap)
+
+BOOST_AUTO_TEST_CASE(RegisterMap_Read) {
+	dhi::RegisterRead<All, 0x80> rr;
+	const dhi::ConversationArena &con = rr.conversation();
+	BOOST_REQUIRE_EQUAL(con.size(), 2);
+	BOOST_CHECK(con[0].output());
+	BOOST_CHECK_EQUAL(con[0].length(), 1);
+	BOOST_CHECK_EQUAL((std::uint8_t)*con[0].start(), 0x90);
+	BOOST_CHECK(con[1].input());
+	BOOST_CHECK_EQUAL(con[1].length(), 12);
+	// act like the device
+	std::memcpy(con[1].start(), testData, sizeof(testData));
+	BOOST_CHECK_EQUAL(rr.get<Le16>(), 0x1234);
+	BOOST_CHECK_EQUAL(rr.get<BeS16>(), -2);
+	BOOST_CHECK_EQUAL(rr.get<LeS24>(), -2);
+	BOOST_CHECK_EQUAL(rr.get<Ctrl>(), 0x95);
+	BOOST_CHECK_EQUAL(rr.get<CtrlMode>(), 5);
+	BOOST_CHECK_EQUAL(rr.get<CtrlOffset>(), -7);
+	BOOST_CHECK_EQUAL(rr.get<Pixels>(0), -2047);
+	BOOST_CHECK_EQUAL(rr.get<Pixels>(1), 2047);
+}
+
+BOOST_AUTO_TEST_CASE(RegisterMap_Write) {
+	dhi::RegisterWrite<dhi::RegisterBurst<BeS16, Ctrl>> rw;
+	const dhi::ConversationArena &con = rw.conversation();
+	BOOST_REQUIRE_EQUAL(con.size(), 1);
+	BOOST_CHECK(con[0].output());
+	// address and 6 bytes from 0x12 through 0x17
+	BOOST_REQUIRE_EQUAL(con[0].length(), 7);
+	const char *data = con[0].start();
+	BOOST_CHECK_EQUAL(data[0], 0x12);
+	rw.set<BeS16>(-2).set<CtrlMode>(3).set<CtrlOffset>(-1);
+	BOOST_CHECK_EQUAL((std::uint8_t)data[1], 0xFF);
+	BOOST_CHECK_EQUAL((std::uint8_t)data[2], 0xFE);
+	BOOST_CHECK_EQUAL((std::uint8_t)data[6], 0xF3);
+	// change a field without altering the rest of the register
+	rw.set<CtrlMode>(0);
+	BOOST_CHECK_EQUAL((std::uint8_t)data[6], 0xF0);
+	// the unused registers in between remain zero
+	BOOST_CHECK_EQUAL(data[3], 0);
+	BOOST_CHECK_EQUAL(data[5], 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
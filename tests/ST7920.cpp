@@ -0,0 +1,100 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the frame update planning done by
+ * duds::hardware::devices::displays::ST7920.
+ */
+#include <duds/hardware/devices/displays/ST7920.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace DDD = duds::hardware::devices::displays;
+namespace BPPN = duds::ui::graphics;
+
+typedef std::vector<DDD::ST7920::Transfer>  Plan;
+
+/**
+ * Checks one transfer of a plan.
+ */
+static void checkTransfer(
+	const Plan &plan,
+	std::size_t idx,
+	int line,
+	int first,
+	int last
+) {
+	BOOST_REQUIRE_LT(idx, plan.size());
+	BOOST_CHECK_EQUAL(plan[idx].line, line);
+	BOOST_CHECK_EQUAL(plan[idx].first, first);
+	BOOST_CHECK_EQUAL(plan[idx].last, last);
+}
+
+BOOST_AUTO_TEST_SUITE(ST7920)
+
+BOOST_AUTO_TEST_CASE(ST7920_PlanMerge) {
+	BOOST_REQUIRE_EQUAL(DDD::ST7920::maxMergeGap, 1);
+	// 8 words on each line
+	BPPN::BppImage current(128, 4);
+	current.clearImage();
+	BPPN::BppImage next(current);
+	// words 1 & 3; the one word gap is resent rather than readdressed
+	next.state(16, 0, true);
+	next.state(63, 0, true);
+	// words 0 & 3; a two word gap costs more than a new address
+	next.state(0, 1, true);
+	next.state(48, 1, true);
+	// two changes in word 6
+	next.state(100, 2, true);
+	next.state(101, 2, true);
+	// adjacent words 4 & 5
+	next.state(79, 3, true);
+	next.state(80, 3, true);
+	Plan plan;
+	DDD::ST7920::planFrame(plan, current, next, nullptr);
+	BOOST_REQUIRE_EQUAL(plan.size(), 5);
+	checkTransfer(plan, 0, 0, 1, 3);
+	checkTransfer(plan, 1, 1, 0, 0);
+	checkTransfer(plan, 2, 1, 3, 3);
+	checkTransfer(plan, 3, 2, 6, 6);
+	checkTransfer(plan, 4, 3, 4, 5);
+	// nothing to do for matching images; old contents are removed
+	DDD::ST7920::planFrame(plan, next, next, nullptr);
+	BOOST_CHECK(plan.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ST7920_PlanDamage) {
+	BPPN::BppImage current(128, 4);
+	current.clearImage();
+	BPPN::BppImage next(current);
+	next.trackDamage(true);
+	next.clearDamage();
+	// no damage, no transfers
+	Plan plan;
+	DDD::ST7920::planFrame(plan, current, next, &next.damage());
+	BOOST_CHECK(plan.empty());
+	// a change made without recording damage is not examined
+	next.bufferLine(0)[0] = 1;
+	// damaged and changed
+	next.state(50, 1, true);
+	next.state(127, 3, true);
+	// damaged but unchanged
+	next.drawBox(BPPN::ImageLocation(0, 2), BPPN::ImageDimensions(32, 1), false);
+	DDD::ST7920::planFrame(plan, current, next, &next.damage());
+	BOOST_REQUIRE_EQUAL(plan.size(), 2);
+	checkTransfer(plan, 0, 1, 3, 3);
+	checkTransfer(plan, 1, 3, 7, 7);
+	// without damage the whole image is compared
+	DDD::ST7920::planFrame(plan, current, next, nullptr);
+	BOOST_REQUIRE_EQUAL(plan.size(), 3);
+	checkTransfer(plan, 0, 0, 0, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
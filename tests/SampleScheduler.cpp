@@ -0,0 +1,155 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of duds::hardware::devices::SampleScheduler.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/hardware/devices/SampleScheduler.hpp>
+
+namespace ddev = duds::hardware::devices;
+using namespace std::chrono_literals;
+
+/**
+ * Stands in for an instrument; counts samples and checks that it is not
+ * sampled on two threads at once.
+ */
+struct FakeInstrument {
+	std::atomic<int> samples;
+	std::atomic<bool> busy;
+	std::atomic<bool> overlap;
+	std::chrono::microseconds delay;
+	FakeInstrument(std::chrono::microseconds d = 0us) :
+	samples(0), busy(false), overlap(false), delay(d) { }
+	void sample() {
+		if (busy.exchange(true)) {
+			overlap = true;
+		}
+		if (delay.count()) {
+			std::this_thread::sleep_for(delay);
+		}
+		++samples;
+		busy = false;
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(SampleScheduler)
+
+BOOST_AUTO_TEST_CASE(SampleScheduler_Errors) {
+	ddev::SampleScheduler sched;
+	BOOST_CHECK_THROW(
+		sched.add([]() { }, 0ns),
+		ddev::SampleSchedulerBadPeriod
+	);
+	unsigned int id = sched.add([]() { }, 1ms);
+	BOOST_CHECK_EQUAL(id, 0);
+	BOOST_CHECK_THROW(sched.statistics(1), ddev::SampleSchedulerBadTask);
+	sched.start();
+	BOOST_CHECK(sched.running());
+	BOOST_CHECK_THROW(
+		sched.add([]() { }, 1ms),
+		ddev::SampleSchedulerRunning
+	);
+	sched.stop();
+	BOOST_CHECK(!sched.running());
+	// can add again once stopped
+	BOOST_CHECK_EQUAL(sched.add([]() { }, 1ms), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SampleScheduler_Rate) {
+	ddev::SampleScheduler sched(2);
+	std::shared_ptr<FakeInstrument> fast = std::make_shared<FakeInstrument>();
+	std::shared_ptr<FakeInstrument> slow = std::make_shared<FakeInstrument>();
+	unsigned int fid = sched.addInstrument(fast, 5ms);
+	unsigned int sid = sched.addInstrument(slow, 20ms);
+	sched.start();
+	BOOST_CHECK_EQUAL(sched.groupCount(), 2);
+	BOOST_CHECK_EQUAL(sched.workerCount(), 2);
+	std::this_thread::sleep_for(205ms);
+	sched.stop();
+	// first sample at the start, then one per period; allow for a loaded
+	// machine running late
+	BOOST_CHECK_LE(fast->samples, 42);
+	BOOST_CHECK_GE(fast->samples, 30);
+	BOOST_CHECK_LE(slow->samples, 11);
+	BOOST_CHECK_GE(slow->samples, 8);
+	ddev::SampleScheduler::Statistics st = sched.statistics(fid);
+	BOOST_CHECK_EQUAL(st.runs, fast->samples);
+	BOOST_CHECK_EQUAL(st.failures, 0);
+	BOOST_CHECK(st.lastJitter <= st.maxJitter);
+	BOOST_CHECK(st.maxJitter <= st.totalJitter);
+	BOOST_CHECK_EQUAL(sched.statistics(sid).runs, slow->samples);
+	sched.resetStatistics();
+	BOOST_CHECK_EQUAL(sched.statistics(fid).runs, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SampleScheduler_SharedBus) {
+	// more workers than buses
+	ddev::SampleScheduler sched(4);
+	std::shared_ptr<FakeInstrument> a =
+		std::make_shared<FakeInstrument>(std::chrono::microseconds(1500));
+	// the same instrument sampled by two tasks on the same bus must never
+	// be used by two threads at once
+	sched.addInstrument(a, 2ms, "/dev/i2c-1");
+	sched.addInstrument(a, 3ms, "/dev/i2c-1");
+	std::shared_ptr<FakeInstrument> b = std::make_shared<FakeInstrument>();
+	sched.addInstrument(b, 2ms, "spi0");
+	sched.start();
+	BOOST_CHECK_EQUAL(sched.groupCount(), 2);
+	BOOST_CHECK_EQUAL(sched.workerCount(), 2);
+	std::this_thread::sleep_for(100ms);
+	sched.stop();
+	BOOST_CHECK(!a->overlap);
+	BOOST_CHECK_GT(a->samples, 20);
+	BOOST_CHECK_GT(b->samples, 20);
+}
+
+BOOST_AUTO_TEST_CASE(SampleScheduler_Overrun) {
+	ddev::SampleScheduler sched;
+	std::shared_ptr<FakeInstrument> slow =
+		std::make_shared<FakeInstrument>(std::chrono::microseconds(12000));
+	unsigned int id = sched.addInstrument(slow, 5ms);
+	sched.start();
+	std::this_thread::sleep_for(100ms);
+	sched.stop();
+	ddev::SampleScheduler::Statistics st = sched.statistics(id);
+	// each run misses two deadlines rather than running in a burst
+	BOOST_CHECK_GE(st.overruns, 2 * st.runs - 2);
+	BOOST_CHECK_LE(st.runs, 9);
+	BOOST_CHECK(st.maxDuration >= 12ms);
+}
+
+BOOST_AUTO_TEST_CASE(SampleScheduler_Failure) {
+	ddev::SampleScheduler sched;
+	int runs = 0;
+	unsigned int id = sched.add(
+		[&runs]() {
+			if (++runs & 1) {
+				throw std::runtime_error("odd");
+			}
+		},
+		2ms
+	);
+	BOOST_CHECK(!sched.lastError(id));
+	sched.start();
+	std::this_thread::sleep_for(30ms);
+	sched.stop();
+	ddev::SampleScheduler::Statistics st = sched.statistics(id);
+	BOOST_CHECK_EQUAL(st.runs, runs);
+	BOOST_CHECK_EQUAL(st.failures, (runs + 1) / 2);
+	BOOST_CHECK_THROW(
+		std::rethrow_exception(sched.lastError(id)),
+		std::runtime_error
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
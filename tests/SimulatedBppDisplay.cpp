@@ -0,0 +1,122 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the damage and byte counting support of
+ * duds::hardware::display::BppGraphicDisplay using
+ * duds::hardware::devices::displays::SimulatedBppDisplay.
+ */
+#include <duds/hardware/devices/displays/SimulatedBppDisplay.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <sstream>
+
+namespace DDD = duds::hardware::devices::displays;
+namespace BPPN = duds::ui::graphics;
+
+/**
+ * Writes an image to the display and returns the text the display sent to
+ * std::cout, keeping it out of the test output.
+ */
+static std::string show(
+	DDD::SimulatedBppDisplay &disp,
+	const BPPN::BppImage &img
+) {
+	std::ostringstream out;
+	std::streambuf *orig = std::cout.rdbuf(out.rdbuf());
+	try {
+		disp.write(&img);
+	} catch (...) {
+		std::cout.rdbuf(orig);
+		throw;
+	}
+	std::cout.rdbuf(orig);
+	return out.str();
+}
+
+/**
+ * Counts the lines of image output; each starts with a '|'.
+ */
+static int imageLines(const std::string &s) {
+	int lines = 0;
+	for (std::string::size_type pos = s.find('|'); pos != std::string::npos;
+	pos = s.find('|', pos + 1)) {
+		// the border at the end of a line is followed by a newline
+		if ((pos + 1 < s.size()) && (s[pos + 1] == '\n')) {
+			++lines;
+		}
+	}
+	return lines;
+}
+
+BOOST_AUTO_TEST_SUITE(SimulatedBppDisplay)
+
+BOOST_AUTO_TEST_CASE(SimulatedBppDisplay_Damage) {
+	DDD::SimulatedBppDisplay disp(16, 4);
+	BOOST_CHECK_EQUAL(disp.frames(), 0);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 0);
+	BPPN::BppImage img(16, 4);
+	img.clearImage();
+	img.trackDamage(true);
+	// first frame is drawn in full: 2 bytes for each of 4 lines
+	BOOST_CHECK_EQUAL(imageLines(show(disp, img)), 4);
+	BOOST_CHECK_EQUAL(disp.frames(), 1);
+	BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 8);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 8);
+	// one changed pixel only redraws its line
+	img.clearDamage();
+	img.state(3, 2, true);
+	std::string out = show(disp, img);
+	BOOST_CHECK_EQUAL(imageLines(out), 1);
+	BOOST_CHECK(out.find("\033[3A|   X            |\n\033[2B") !=
+		std::string::npos);
+	BOOST_CHECK_EQUAL(disp.frames(), 2);
+	BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 2);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 10);
+	BOOST_CHECK(disp.frame() == img);
+	// no damage, nothing sent
+	img.clearDamage();
+	BOOST_CHECK_EQUAL(imageLines(show(disp, img)), 0);
+	BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 0);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 10);
+	// a different image object has no usable damage
+	BPPN::BppImage other(img);
+	other.trackDamage(true);
+	other.clearDamage();
+	BOOST_CHECK_EQUAL(imageLines(show(disp, other)), 4);
+	BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 8);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 18);
+	// configuring the display forgets the last image
+	disp.configure(16, 4);
+	BOOST_CHECK_EQUAL(imageLines(show(disp, other)), 4);
+	BOOST_CHECK_EQUAL(disp.frames(), 5);
+	disp.resetCounters();
+	BOOST_CHECK_EQUAL(disp.frames(), 0);
+	BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 0);
+	BOOST_CHECK_EQUAL(disp.totalBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SimulatedBppDisplay_Untracked) {
+	DDD::SimulatedBppDisplay disp(12, 3);
+	BPPN::BppImage img(12, 3);
+	img.clearImage();
+	// without damage tracking every write sends the whole frame
+	for (int i = 1; i <= 3; ++i) {
+		img.state(i, 1, true);
+		BOOST_CHECK_EQUAL(imageLines(show(disp, img)), 3);
+		BOOST_CHECK_EQUAL(disp.lastFrameBytes(), 6);
+		BOOST_CHECK_EQUAL(disp.totalBytes(), 6 * i);
+	}
+	BOOST_CHECK_EQUAL(disp.frames(), 3);
+	BOOST_CHECK(disp.frame() == img);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
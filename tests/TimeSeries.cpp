@@ -0,0 +1,345 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the time series files: duds::data::TimeSeriesWriter,
+ * duds::data::TimeSeriesReader, and duds::data::TimeSeriesStore.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <duds/data/TimeSeriesStore.hpp>
+#include <duds/data/TimeSeriesErrors.hpp>
+#include <duds/data/Units.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dd = duds::data;
+namespace dti = duds::time::interstellar;
+
+/**
+ * Makes a temporary directory for the files of a test, and removes it and
+ * the files afterward.
+ */
+struct TimeSeriesDir {
+	std::string dir;
+	TimeSeriesDir() {
+		char name[] = "/tmp/dudsTimeSeriesXXXXXX";
+		BOOST_REQUIRE(mkdtemp(name));
+		dir = name;
+	}
+	~TimeSeriesDir() {
+		std::system(("rm -rf " + dir).c_str());
+	}
+	std::string file(const char *name) const {
+		return dir + '/' + name;
+	}
+};
+
+static dti::NanoTime nanoTime(std::uint64_t ns) {
+	return dti::NanoTime(dti::Nanoseconds(ns));
+}
+
+BOOST_AUTO_TEST_SUITE(TimeSeries)
+
+BOOST_AUTO_TEST_CASE(TimeSeries_Delta) {
+	const std::int64_t deltas[] = {
+		0, 1, -1, 63, -64, 64, 1000000, -1000000,
+		INT64_MAX, INT64_MIN
+	};
+	for (std::int64_t d : deltas) {
+		std::uint8_t buf[dd::TimeSeriesMaxDeltaBytes];
+		std::size_t len = dd::timeSeriesEncodeDelta(d, buf);
+		BOOST_CHECK_LE(len, dd::TimeSeriesMaxDeltaBytes);
+		const std::uint8_t *in = buf;
+		BOOST_CHECK_EQUAL(dd::timeSeriesDecodeDelta(in), d);
+		BOOST_CHECK_EQUAL(in - buf, len);
+	}
+	// small differences of either sign use one byte
+	std::uint8_t buf[dd::TimeSeriesMaxDeltaBytes];
+	BOOST_CHECK_EQUAL(dd::timeSeriesEncodeDelta(-64, buf), 1);
+	// a millisecond takes three bytes
+	BOOST_CHECK_EQUAL(dd::timeSeriesEncodeDelta(1000000, buf), 3);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_Double) {
+	TimeSeriesDir tmp;
+	boost::uuids::uuid origin = boost::uuids::random_generator()();
+	std::string name = tmp.file("d.dts");
+	{
+		dd::TimeSeriesWriter w(name, origin, dd::TimeSeriesDouble, dd::units::Volt);
+		for (int i = 0; i < 1000; ++i) {
+			w.append(nanoTime(1000000000ull + i * 1000000ull), i * 0.5);
+		}
+		BOOST_CHECK_EQUAL(w.segmentCount(), 1);
+		BOOST_CHECK_THROW(
+			w.append(nanoTime(0), dd::int128_w(1)),
+			dd::TimeSeriesTypeMismatch
+		);
+	}
+	dd::TimeSeriesReader r(name);
+	BOOST_CHECK(r.origin() == origin);
+	BOOST_CHECK_EQUAL(r.type(), dd::TimeSeriesDouble);
+	BOOST_CHECK(r.unit() == dd::units::Volt);
+	BOOST_CHECK_EQUAL(r.size(), 1000);
+	int expect = 0;
+	std::size_t found = r.scan<double>(
+		nanoTime(0),
+		nanoTime(UINT64_MAX),
+		[&expect](const dti::NanoTime &t, double v) {
+			BOOST_CHECK_EQUAL(
+				t.time_since_epoch().count(),
+				1000000000ull + expect * 1000000ull
+			);
+			BOOST_CHECK_EQUAL(v, expect * 0.5);
+			++expect;
+		}
+	);
+	BOOST_CHECK_EQUAL(found, 1000);
+	// inclusive range
+	found = r.scan<double>(
+		nanoTime(1000000000ull + 10 * 1000000ull),
+		nanoTime(1000000000ull + 19 * 1000000ull),
+		[](const dti::NanoTime &, double) { }
+	);
+	BOOST_CHECK_EQUAL(found, 10);
+	BOOST_CHECK_THROW(
+		r.scan<dd::int128_w>(
+			nanoTime(0), nanoTime(1), [](const dti::NanoTime &, dd::int128_w) { }
+		),
+		dd::TimeSeriesTypeMismatch
+	);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_XyzInt128) {
+	TimeSeriesDir tmp;
+	boost::uuids::random_generator gen;
+	std::string xname = tmp.file("x.dts"), iname = tmp.file("i.dts");
+	{
+		dd::TimeSeriesWriter xw(xname, gen(), dd::TimeSeriesXyz, dd::units::Tesla);
+		dd::TimeSeriesWriter iw(iname, gen(), dd::TimeSeriesInt128, dd::Unit(0));
+		for (int i = 0; i < 100; ++i) {
+			xw.append(nanoTime(500 + i), std::array<double, 3>{ 1.0 * i, -2.0 * i, 0.5 });
+			#ifdef HAVE_INT128
+			iw.append(nanoTime(500 + i), dd::int128_w((dd::int128_t)-i << 70));
+			#else
+			iw.append(nanoTime(500 + i), dd::int128_w(dd::int128_t(-i) << 70));
+			#endif
+		}
+	}
+	dd::TimeSeriesReader xr(xname), ir(iname);
+	int n = 0;
+	xr.scan< std::array<double, 3> >(nanoTime(0), nanoTime(1000),
+		[&n](const dti::NanoTime &, const std::array<double, 3> &v) {
+			BOOST_CHECK_EQUAL(v[0], 1.0 * n);
+			BOOST_CHECK_EQUAL(v[1], -2.0 * n);
+			BOOST_CHECK_EQUAL(v[2], 0.5);
+			++n;
+		}
+	);
+	BOOST_CHECK_EQUAL(n, 100);
+	n = 0;
+	ir.scan<dd::int128_w>(nanoTime(0), nanoTime(1000),
+		[&n](const dti::NanoTime &, const dd::int128_w &v) {
+			BOOST_CHECK(v.value == (dd::int128_t(-n) << 70));
+			++n;
+		}
+	);
+	BOOST_CHECK_EQUAL(n, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_Segments) {
+	TimeSeriesDir tmp;
+	boost::uuids::uuid origin = boost::uuids::random_generator()();
+	std::string name = tmp.file("s.dts");
+	const std::size_t page = dd::timeSeriesPageSize();
+	const int total = 10000;
+	{
+		dd::TimeSeriesWriter w(
+			name, origin, dd::TimeSeriesDouble, dd::Unit(0), page
+		);
+		BOOST_CHECK_EQUAL(w.segmentBytes(), page);
+		for (int i = 0; i < total / 2; ++i) {
+			w.append(nanoTime(i * 1000ull), (double)i);
+		}
+	}
+	// reopen and continue appending
+	{
+		dd::TimeSeriesWriter w(
+			name, origin, dd::TimeSeriesDouble, dd::Unit(0)
+		);
+		// an existing file keeps its segment size
+		BOOST_CHECK_EQUAL(w.segmentBytes(), page);
+		for (int i = total / 2; i < total; ++i) {
+			w.append(nanoTime(i * 1000ull), (double)i);
+		}
+		BOOST_CHECK_GT(w.segmentCount(), 10);
+		// a different instrument or type is not allowed
+		BOOST_CHECK_THROW(
+			dd::TimeSeriesWriter(
+				name, boost::uuids::random_generator()(),
+				dd::TimeSeriesDouble, dd::Unit(0)
+			),
+			dd::TimeSeriesTypeMismatch
+		);
+		BOOST_CHECK_THROW(
+			dd::TimeSeriesWriter(name, origin, dd::TimeSeriesXyz, dd::Unit(0)),
+			dd::TimeSeriesTypeMismatch
+		);
+	}
+	dd::TimeSeriesReader r(name);
+	BOOST_CHECK_GT(r.segments(), 10);
+	BOOST_CHECK_EQUAL(r.size(), total);
+	// range across segment boundaries
+	double expect = 4000;
+	std::size_t found = r.scan<double>(
+		nanoTime(4000 * 1000ull),
+		nanoTime(6999 * 1000ull),
+		[&expect](const dti::NanoTime &t, double v) {
+			BOOST_CHECK_EQUAL(v, expect);
+			BOOST_CHECK_EQUAL(t.time_since_epoch().count(), expect * 1000);
+			++expect;
+		}
+	);
+	BOOST_CHECK_EQUAL(found, 3000);
+	// outside the range
+	found = r.scan<double>(
+		nanoTime(total * 1000ull),
+		nanoTime(UINT64_MAX),
+		[](const dti::NanoTime &, double) { }
+	);
+	BOOST_CHECK_EQUAL(found, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_OutOfOrder) {
+	TimeSeriesDir tmp;
+	std::string name = tmp.file("o.dts");
+	dd::TimeSeriesWriter w(
+		name,
+		boost::uuids::random_generator()(),
+		dd::TimeSeriesDouble,
+		dd::Unit(0),
+		dd::timeSeriesPageSize()
+	);
+	// times going backwards, spread over several segments
+	for (int i = 0; i < 2000; ++i) {
+		w.append(nanoTime(((i * 7919) % 2000) * 10ull), (double)i);
+	}
+	dd::TimeSeriesReader r(name);
+	BOOST_CHECK_GT(r.segments(), 1);
+	std::size_t found = r.scan<double>(
+		nanoTime(100 * 10), nanoTime(199 * 10),
+		[](const dti::NanoTime &t, double) {
+			BOOST_CHECK_GE(t.time_since_epoch().count(), 1000);
+			BOOST_CHECK_LE(t.time_since_epoch().count(), 1990);
+		}
+	);
+	BOOST_CHECK_EQUAL(found, 100);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_ReadWhileWriting) {
+	TimeSeriesDir tmp;
+	std::string name = tmp.file("rw.dts");
+	dd::TimeSeriesWriter w(
+		name,
+		boost::uuids::random_generator()(),
+		dd::TimeSeriesDouble,
+		dd::Unit(0),
+		dd::timeSeriesPageSize()
+	);
+	w.append(nanoTime(1), 1.0);
+	dd::TimeSeriesReader r(name);
+	BOOST_CHECK_EQUAL(r.size(), 1);
+	w.append(nanoTime(2), 2.0);
+	// same segment; seen without a refresh
+	BOOST_CHECK_EQUAL(r.size(), 2);
+	for (int i = 3; i < 2000; ++i) {
+		w.append(nanoTime(i), (double)i);
+	}
+	r.refresh();
+	BOOST_CHECK_EQUAL(r.size(), 1999);
+	BOOST_CHECK_EQUAL(r.segments(), w.segmentCount());
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_BadFile) {
+	TimeSeriesDir tmp;
+	std::string name = tmp.file("bad.dts");
+	BOOST_CHECK_THROW(dd::TimeSeriesReader r(name), dd::TimeSeriesFileError);
+	std::system(("head -c 8192 /dev/zero > " + name).c_str());
+	BOOST_CHECK_THROW(dd::TimeSeriesReader r(name), dd::TimeSeriesNotStoreError);
+	BOOST_CHECK_THROW(
+		dd::TimeSeriesWriter(
+			tmp.file("small.dts"),
+			boost::uuids::random_generator()(),
+			dd::TimeSeriesDouble,
+			dd::Unit(0),
+			0
+		),
+		dd::TimeSeriesBadSegmentSize
+	);
+}
+
+BOOST_AUTO_TEST_CASE(TimeSeries_Store) {
+	TimeSeriesDir tmp;
+	boost::uuids::random_generator gen;
+	boost::uuids::uuid volts = gen(), field = gen();
+	dd::TimeSeriesStore store(tmp.dir);
+	dd::Measurement m;
+	m.measured.origin = volts;
+	for (int i = 0; i < 10; ++i) {
+		m.timestamp.value = nanoTime(100 + i);
+		m.measured.value = dd::Quantity(i * 0.25, dd::units::Volt);
+		store.append(m);
+	}
+	// wrong units for the file
+	m.measured.value = dd::Quantity(1.0, dd::units::Tesla);
+	BOOST_CHECK_THROW(store.append(m), dd::TimeSeriesTypeMismatch);
+	// a three axis vector
+	m.measured.origin = field;
+	dd::QuantityNddArray qa;
+	qa.unit = dd::units::Tesla;
+	qa.array.remake({3});
+	qa.array.at({0}) = 1.0;
+	qa.array.at({1}) = 2.0;
+	qa.array.at({2}) = 3.0;
+	m.measured.value = qa;
+	store.append(m);
+	// not storable; no file is made
+	m.measured.origin = gen();
+	m.measured.value = std::string("nope");
+	BOOST_CHECK_THROW(store.append(m), dd::TimeSeriesUnsupportedValue);
+	struct stat st;
+	BOOST_CHECK(stat(store.path(m.measured.origin).c_str(), &st) != 0);
+	store.sync();
+	std::unique_ptr<dd::TimeSeriesReader> r = store.reader(volts);
+	BOOST_CHECK(r->unit() == dd::units::Volt);
+	double expect = 0;
+	BOOST_CHECK_EQUAL(
+		r->scan<double>(nanoTime(0), nanoTime(1000),
+			[&expect](const dti::NanoTime &, double v) {
+				BOOST_CHECK_EQUAL(v, expect);
+				expect += 0.25;
+			}
+		),
+		10
+	);
+	r = store.reader(field);
+	BOOST_CHECK_EQUAL(r->type(), dd::TimeSeriesXyz);
+	r->scan< std::array<double, 3> >(nanoTime(0), nanoTime(1000),
+		[](const dti::NanoTime &t, const std::array<double, 3> &v) {
+			BOOST_CHECK_EQUAL(t.time_since_epoch().count(), 109);
+			BOOST_CHECK_EQUAL(v[2], 3.0);
+		}
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
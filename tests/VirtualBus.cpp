@@ -0,0 +1,255 @@
+/*
+ * This file is part of the DUDS project. It is subject to the BSD-style
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at https://github.com/jjackowski/duds/blob/master/LICENSE.
+ * No part of DUDS, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the LICENSE file.
+ *
+ * Copyright (C) 2020  Jeff Jackowski
+ */
+/**
+ * @file
+ * Tests of the simulated buses in duds/hardware/interface/test, and of
+ * drivers using them with the simulated devices in duds/hardware/devices/test.
+ */
+#include <duds/hardware/interface/test/VirtualI2c.hpp>
+#include <duds/hardware/interface/test/VirtualSmbus.hpp>
+#include <duds/hardware/interface/test/VirtualMasterSyncSerial.hpp>
+#include <duds/hardware/interface/test/VirtualDevice.hpp>
+#include <duds/hardware/interface/I2cErrors.hpp>
+#include <duds/hardware/interface/SmbusErrors.hpp>
+#include <duds/hardware/interface/MasterSyncSerialErrors.hpp>
+#include <duds/hardware/interface/RegisterMap.hpp>
+#include <duds/hardware/devices/test/INA219Model.hpp>
+#include <duds/hardware/devices/test/MCP9808Model.hpp>
+#include <duds/hardware/devices/test/TSL2591Model.hpp>
+#include <duds/hardware/devices/test/LSM9DS1Model.hpp>
+#include <duds/hardware/devices/test/AMG88xxModel.hpp>
+#include <duds/hardware/devices/instruments/INA219.hpp>
+#include <duds/hardware/devices/instruments/MCP9808.hpp>
+#include <duds/hardware/devices/instruments/TSL2591.hpp>
+#include <duds/hardware/devices/instruments/LSM9DS1.hpp>
+#include <duds/hardware/devices/instruments/AMG88xx.hpp>
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace dhi = duds::hardware::interface;
+namespace dhit = duds::hardware::interface::test;
+namespace dhdt = duds::hardware::devices::test;
+namespace instr = duds::hardware::devices::instruments;
+
+BOOST_AUTO_TEST_SUITE(VirtualBus)
+
+BOOST_AUTO_TEST_CASE(VirtualBus_I2cRegisters) {
+	std::shared_ptr<dhit::VirtualRegisterDevice> dev =
+		std::make_shared<dhit::VirtualRegisterDevice>();
+	dhit::VirtualI2c i2c(dev, 0x40);
+	BOOST_CHECK_EQUAL(i2c.address(), 0x40);
+	typedef dhi::Register<0x10, 2>  Word;
+	typedef dhi::Register<0x12>  Byte;
+	dhi::RegisterWrite<dhi::RegisterBurst<Word, Byte>> rw;
+	rw.set<Word>(0x1234).set<Byte>(0x56);
+	rw.converse(i2c);
+	BOOST_CHECK_EQUAL(dev->get(0x10), 0x1234);
+	BOOST_CHECK_EQUAL(dev->value(0x12), 0x56);
+	BOOST_CHECK_EQUAL(dev->transactions(), 1);
+	BOOST_CHECK_EQUAL(dev->bytes(), 4);
+	dev->put(0x10, 0xBEEF);
+	dhi::RegisterRead<Word> rr;
+	rr.converse(i2c);
+	BOOST_CHECK_EQUAL(rr.get(), 0xBEEF);
+	BOOST_CHECK_EQUAL(dev->transactions(), 2);
+	// hooks
+	int reads = 0;
+	dev->onRead(0x10, [&reads](dhit::VirtualRegisterDevice &d, std::uint8_t a) {
+		d.value(a, ++reads);
+	});
+	rr.converse(i2c);
+	BOOST_CHECK_EQUAL(reads, 1);
+	BOOST_CHECK_EQUAL(rr.get(), 0xBE01);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_RegisterWidth) {
+	BOOST_CHECK_THROW(
+		dhit::VirtualRegisterDevice(0),
+		dhit::VirtualRegisterWidthError
+	);
+	BOOST_CHECK_THROW(
+		dhit::VirtualRegisterDevice(5),
+		dhit::VirtualRegisterWidthError
+	);
+	dhit::VirtualRegisterDevice dev(4, true);
+	dev.value(0x20, 0x12345678);
+	BOOST_CHECK_THROW(dev.width(0x20, 5), dhit::VirtualRegisterWidthError);
+	BOOST_CHECK_EQUAL(dev.width(0x20), 4);
+	BOOST_CHECK_EQUAL(dev.value(0x20), 0x12345678);
+	dev.width(0x20, 2);
+	BOOST_CHECK_EQUAL(dev.value(0x20), 0x5678);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_Faults) {
+	std::shared_ptr<dhit::VirtualRegisterDevice> dev =
+		std::make_shared<dhit::VirtualRegisterDevice>();
+	dhit::VirtualI2c i2c(dev, 0x40);
+	dhi::RegisterRead<dhi::Register<0>> rr;
+	dev->failNext(2);
+	BOOST_CHECK_THROW(rr.converse(i2c), dhi::I2cErrorNoDevice);
+	BOOST_CHECK_THROW(rr.converse(i2c), dhi::I2cErrorNoDevice);
+	BOOST_CHECK_NO_THROW(rr.converse(i2c));
+	dev->resetCounts();
+	dev->failEvery(3);
+	BOOST_CHECK_NO_THROW(rr.converse(i2c));
+	BOOST_CHECK_NO_THROW(rr.converse(i2c));
+	BOOST_CHECK_THROW(rr.converse(i2c), dhi::I2cErrorNoDevice);
+	BOOST_CHECK_NO_THROW(rr.converse(i2c));
+	dhit::VirtualSmbus smbus(dev, 0x40);
+	dev->failNext();
+	BOOST_CHECK_THROW(smbus.receiveByte(0), dhi::SmbusErrorNoDevice);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_Smbus) {
+	std::shared_ptr<dhit::VirtualRegisterDevice> dev =
+		std::make_shared<dhit::VirtualRegisterDevice>(2, true, false);
+	dhit::VirtualSmbus smbus(dev, 0x41);
+	smbus.transmitWordBe(3, 0x1234);
+	BOOST_CHECK_EQUAL(dev->value(3), 0x1234);
+	BOOST_CHECK_EQUAL(smbus.receiveWordBe(3), 0x1234);
+	BOOST_CHECK_EQUAL(smbus.receiveWord(3), 0x3412);
+	// no auto-increment; the pointer stays on the register
+	BOOST_CHECK_EQUAL(dev->pointer(), 3);
+	BOOST_CHECK_EQUAL(smbus.receiveByte(), 0x12);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_MasterSyncSerial) {
+	std::shared_ptr<dhdt::LSM9DS1AccelGyroModel> dev =
+		std::make_shared<dhdt::LSM9DS1AccelGyroModel>();
+	std::shared_ptr<dhit::VirtualMasterSyncSerial> mss =
+		dhit::VirtualMasterSyncSerial::make(dev);
+	// SPI read flag on the address
+	dhi::RegisterRead<dhi::Register<0x0F>, 0x80> id;
+	id.converse(*mss);
+	BOOST_CHECK_EQUAL(id.get(), 0x68);
+	dev->failNext();
+	BOOST_CHECK_THROW(id.converse(*mss), dhi::SyncSerialIoError);
+	BOOST_CHECK_NO_THROW(id.converse(*mss));
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_SmbusDrivers) {
+	std::shared_ptr<dhdt::INA219Model> ina =
+		std::make_shared<dhdt::INA219Model>();
+	std::unique_ptr<dhi::Smbus> smbus(new dhit::VirtualSmbus(ina, 0x40));
+	instr::INA219 meter(smbus, 0.1);
+	BOOST_CHECK(!smbus);
+	ina->shuntVoltage(1000);
+	ina->busVoltage(1250);
+	meter.sample();
+	BOOST_CHECK_CLOSE(meter.shuntVoltage().value, 0.01, 1e-6);
+	BOOST_CHECK_CLOSE(meter.busVoltage().value, 5.0, 1e-6);
+
+	std::shared_ptr<dhdt::MCP9808Model> mcp =
+		std::make_shared<dhdt::MCP9808Model>();
+	smbus.reset(new dhit::VirtualSmbus(mcp, 0x18));
+	instr::MCP9808 therm(smbus);
+	mcp->temperature(25.0625);
+	therm.sample();
+	BOOST_CHECK_CLOSE(therm.temperature().value, 298.2125, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_I2cDrivers) {
+	std::shared_ptr<dhdt::TSL2591Model> tsl =
+		std::make_shared<dhdt::TSL2591Model>();
+	std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(tsl, 0x29));
+	instr::TSL2591 light(i2c);
+	light.init(1, 100);
+	tsl->channels(0x1234, 0x0567);
+	light.sample();
+	BOOST_CHECK_EQUAL(light.brightnessCount(), 0x1234);
+	BOOST_CHECK_EQUAL(light.brightnessIrCount(), 0x0567);
+
+	std::shared_ptr<dhdt::AMG88xxModel> amg =
+		std::make_shared<dhdt::AMG88xxModel>();
+	i2c.reset(new dhit::VirtualI2c(amg, 0x69));
+	instr::AMG88xx cam(i2c);
+	amg->thermistor(-10.5);
+	amg->pixel(9, 20.25);
+	amg->pixel(10, -3.5);
+	cam.sample();
+	BOOST_CHECK_CLOSE(cam.temperature().value, 262.65, 1e-6);
+	BOOST_CHECK_CLOSE(cam.image()[1][1], 293.4, 1e-6);
+	BOOST_CHECK_CLOSE(cam.image()[1][2], 269.65, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_LSM9DS1Fifo) {
+	std::shared_ptr<dhdt::LSM9DS1AccelGyroModel> dev =
+		std::make_shared<dhdt::LSM9DS1AccelGyroModel>();
+	std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(dev, 0x6B));
+	instr::LSM9DS1AccelGyro imu(i2c);
+	instr::LSM9DS1AccelGyro::Settings cfg = { };
+	cfg.accelerometer = cfg.gyroscope = cfg.fifo = 1;
+	cfg.fifoThreshold = 16;
+	imu.configure(952, cfg);
+	BOOST_CHECK_EQUAL(dev->value(0x2E), 0xC0 | 16);
+	BOOST_CHECK(dev->value(0x23) & 2);
+	dev->accelerometer(1, -2, 3);
+	dev->gyroscope(-4, 5, -6);
+	dev->fifoLevel(20);
+	dev->resetCounts();
+	BOOST_REQUIRE_EQUAL(imu.sampleFifo(), 20);
+	// one query of the status and one burst
+	BOOST_CHECK_EQUAL(dev->transactions(), 2);
+	BOOST_CHECK_EQUAL(dev->bytes(), 2 + 1 + 20 * 12);
+	const instr::LSM9DS1AccelGyro::FifoSample *fs = imu.fifoSamples();
+	for (int s = 0; s < 20; ++s) {
+		BOOST_CHECK_EQUAL(fs[s].accl.x, 1);
+		BOOST_CHECK_EQUAL(fs[s].accl.y, -2);
+		BOOST_CHECK_EQUAL(fs[s].accl.z, 3);
+		BOOST_CHECK_EQUAL(fs[s].gyro.x, -4);
+		BOOST_CHECK_EQUAL(fs[s].gyro.y, 5);
+		BOOST_CHECK_EQUAL(fs[s].gyro.z, -6);
+		if (s) {
+			// sample period for 952Hz
+			BOOST_CHECK_EQUAL(
+				(fs[s].time - fs[s - 1].time).count(),
+				(std::uint64_t)(1e9 / 952.0)
+			);
+		}
+	}
+	BOOST_CHECK(!imu.fifoOverrun());
+	dev->fifoLevel(0);
+	BOOST_CHECK(!imu.sample());
+}
+
+BOOST_AUTO_TEST_CASE(VirtualBus_LSM9DS1Sample) {
+	std::shared_ptr<dhdt::LSM9DS1AccelGyroModel> dev =
+		std::make_shared<dhdt::LSM9DS1AccelGyroModel>();
+	std::unique_ptr<dhi::I2c> i2c(new dhit::VirtualI2c(dev, 0x6B));
+	instr::LSM9DS1AccelGyro imu(i2c);
+	instr::LSM9DS1AccelGyro::Settings cfg = { };
+	cfg.accelerometer = cfg.gyroscope = 1;
+	imu.configure(119, cfg);
+	dev->accelerometer(7, -8, 9);
+	dev->gyroscope(-10, 11, -12);
+	dev->resetCounts();
+	BOOST_REQUIRE(imu.sample());
+	// the status, then both samples in one read
+	BOOST_CHECK_EQUAL(dev->transactions(), 2);
+	BOOST_CHECK_EQUAL(dev->bytes(), 2 + 1 + 12);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().x, 7);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().y, -8);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().z, 9);
+	BOOST_CHECK_EQUAL(imu.rawGyroscope().x, -10);
+	BOOST_CHECK_EQUAL(imu.rawGyroscope().y, 11);
+	BOOST_CHECK_EQUAL(imu.rawGyroscope().z, -12);
+	// accelerometer only
+	cfg.gyroscope = 0;
+	imu.configure(119, cfg);
+	dev->accelerometer(-1, 2, -3);
+	dev->resetCounts();
+	BOOST_REQUIRE(imu.sample());
+	BOOST_CHECK_EQUAL(dev->bytes(), 2 + 1 + 6);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().x, -1);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().y, 2);
+	BOOST_CHECK_EQUAL(imu.rawAccelerometer().z, -3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <map>
 #include <assert.h>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/program_options.hpp>
@@ -486,6 +487,85 @@ public:
 			parseImage(is);
 		} while (is.good());
 	}
+	/**
+	 * Appends a little endian integer of @a bytes bytes to @a dest.
+	 */
+	static void putLe(std::vector<char> &dest, std::uint32_t val, int bytes) {
+		for (; bytes > 0; --bytes, val >>= 8) {
+			dest.push_back(val & 0xFF);
+		}
+	}
+	/**
+	 * Stores the little endian integer @a val at @a pos in @a dest.
+	 */
+	static void setLe(std::vector<char> &dest, std::size_t pos, std::uint32_t val) {
+		for (int b = 0; b < 4; ++b, val >>= 8) {
+			dest[pos + b] = val & 0xFF;
+		}
+	}
+	/**
+	 * Writes a version 1 archive that is memory mapped by BppImageArchiveMap.
+	 * The image data is stored as PixelBlocks of @a blockBytes bytes so that
+	 * it can be used in place.
+	 */
+	void writeMappable(std::ostream &out, int blockBytes) const {
+		// sort by name; a later image replaces an earlier one of the same name
+		std::map<std::string, const NddArray<char> *> sorted;
+		for (auto const &p : images) {
+			if (!p.first.empty()) {
+				sorted[p.first] = &p.second;
+			}
+		}
+		std::vector<char> file;
+		// header; sizes filled in later
+		file.insert(file.end(), { 'B', 'P', 'P', 'I' });
+		putLe(file, 1, 4);  // version
+		putLe(file, blockBytes, 4);
+		putLe(file, sorted.size(), 4);
+		putLe(file, 32, 4);  // index offset
+		putLe(file, 0, 4);   // file size
+		putLe(file, 0, 4);
+		putLe(file, 0, 4);
+		// index; offsets filled in later
+		const std::size_t indexPos = file.size();
+		file.resize(indexPos + sorted.size() * 16, 0);
+		// names
+		std::size_t entry = indexPos;
+		for (auto const &p : sorted) {
+			setLe(file, entry, file.size());
+			setLe(file, entry + 4, p.first.size());
+			file.insert(file.end(), p.first.begin(), p.first.end());
+			entry += 16;
+		}
+		// image data
+		entry = indexPos;
+		for (auto const &p : sorted) {
+			std::vector<unsigned char> src = makeData(*p.second);
+			std::size_t width = p.second->dim(0);
+			std::size_t height = p.second->dim(1);
+			std::size_t srcLine = width / 8 + ((width % 8) ? 1 : 0);
+			std::size_t destLine = (width / (blockBytes * 8) +
+				((width % (blockBytes * 8)) ? 1 : 0)) * blockBytes;
+			// align the image data to a PixelBlock
+			file.resize(
+				(file.size() + blockBytes - 1) / blockBytes * blockBytes,
+				0
+			);
+			setLe(file, entry + 8, file.size());
+			setLe(file, entry + 12, width | (height << 16));
+			// lines are padded to a whole number of PixelBlocks; the pixel at
+			// the LSb of the first byte stays the left-most pixel when the
+			// little endian block is loaded
+			for (std::size_t y = 0; y < height; ++y) {
+				const unsigned char *line = &(src[4 + y * srcLine]);
+				file.insert(file.end(), line, line + srcLine);
+				file.resize(file.size() + destLine - srcLine, 0);
+			}
+			entry += 16;
+		}
+		setLe(file, 20, file.size());
+		out.write(&(file[0]), file.size());
+	}
 	void writeCpp(std::ostream &out) const {
 		if (badIdent >= 0) {
 			BOOST_THROW_EXCEPTION(BadIdentifierError() << LineNumber(line));
@@ -516,7 +596,8 @@ public:
 
 int main(int argc, char *argv[])
 try {
-	std::string srcpath, cpppath, arcpath;
+	std::string srcpath, cpppath, arcpath, mappath;
+	int blockBytes = sizeof(std::uintptr_t);
 	{ // option parsing
 		boost::program_options::options_description optdesc(
 			"Options for BPP image compiler"
@@ -541,6 +622,17 @@ try {
 				boost::program_options::value<std::string>(&arcpath),
 				"BPP binary archive output file"
 			)
+			(
+				"map,m",
+				boost::program_options::value<std::string>(&mappath),
+				"BPP memory mappable archive output file"
+			)
+			(
+				"block,b",
+				boost::program_options::value<int>(&blockBytes),
+				"Bytes per PixelBlock in the mappable archive; must match "
+				"the target system"
+			)
 		;
 		boost::program_options::positional_options_description pod;
 		pod.add("input", -1);
@@ -587,6 +679,20 @@ try {
 		out.write(ver, 4);
 		p.writeLoadable(out);
 	}
+	if (!mappath.empty()) {
+		if ((blockBytes != 4) && (blockBytes != 8)) {
+			std::cerr << "ERROR: The PixelBlock size must be 4 or 8 bytes."
+			<< std::endl;
+			return 1;
+		}
+		std::ofstream out(mappath, std::ios::binary);
+		if (!out.good()) {
+			std::cerr << "ERROR: Could not open output file " << mappath << '.'
+			<< std::endl;
+			return 1;
+		}
+		p.writeMappable(out, blockBytes);
+	}
 	if (!cpppath.empty()) {
 		std::ofstream out(cpppath);
 		if (!out.good()) {
@@ -597,7 +703,7 @@ try {
 		out << "/*\n * Bit-Per-Pixel image data autogenerated by bppc from\n * " <<
 		srcpath << "\n */\n\n";
 		p.writeCpp(out);
-	} else if (arcpath.empty()) {
+	} else if (arcpath.empty() && mappath.empty()) {
 		// output to stdout if no other output requested
 		std::cout <<
 		"/*\n * Bit-Per-Pixel image data autogenerated by bppc from\n * " <<